@@ -0,0 +1,280 @@
+#include <algorithm>
+#include <vector>
+
+#include "colt/algorithm/GroupAggregate.h"
+#include "colt/algorithm/HashJoin.h"
+#include "colt/algorithm/Scan.h"
+#include "colt/algorithm/Select.h"
+#include "colt/algorithm/SetOps.h"
+
+#include "Benchmark.h"
+
+using namespace colt;
+using namespace colt::bench;
+
+namespace
+{
+  /// @brief Generates 'count' pseudo-random keys in [0, key_range)
+  /// @param count The count of keys
+  /// @param key_range The count of distinct keys
+  /// @param seed The seed of the generator
+  /// @return The keys
+  std::vector<u64> make_random_keys(size_t count, u64 key_range, u64 seed)
+  {
+    std::vector<u64> keys;
+    keys.reserve(count);
+    for (size_t i = 0; i < count; i++)
+    {
+      u64 x = seed + (i + 1) * 0x9e3779b97f4a7c15;
+      x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+      x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+      keys.push_back((x ^ (x >> 31)) % key_range);
+    }
+    return keys;
+  }
+}
+
+COLT_BENCH_SUITE(GroupAggregate)
+{
+  //Sum, count and max of a column grouped by key: few groups fit in the cache, many do not
+  constexpr size_t count = 4194304;
+  for (size_t group_count : { 1024, 1048576 })
+  {
+    const std::vector<u64> keys = make_random_keys(count, group_count, 1);
+    std::vector<u32> values;
+    values.reserve(count);
+    for (size_t i = 0; i < count; i++)
+      values.push_back(static_cast<u32>(keys[i] * 31 + i));
+    const ContiguousView<u64> key_view = { keys.data(), keys.size() };
+    const ContiguousView<u32> value_view = { values.data(), values.size() };
+
+    struct Aggregate
+    {
+      u64 sum;
+      u64 count;
+      u32 max;
+    };
+    runner.run("GroupAggregate", make_name("Map find+insert", group_count), count, [&]()
+      {
+        Map<u64, Aggregate> map = Map<u64, Aggregate>{ static_cast<size_t>(group_count / 0.7f) + 16 };
+        for (size_t i = 0; i < count; i++)
+        {
+          if (auto slot = map.find(keys[i]))
+          {
+            slot->second.sum += values[i];
+            ++slot->second.count;
+            slot->second.max = slot->second.max < values[i] ? values[i] : slot->second.max;
+          }
+          else
+            map.insert(keys[i], Aggregate{ values[i], 1, values[i] });
+        }
+        DoNotOptimize(map.get_size());
+      });
+    runner.run("GroupAggregate", make_name("group_aggregate/1", group_count), count, [&]()
+      {
+        auto result = algo::group_aggregate<DefaultHash<u64>, DefaultEqual<u64>>({ 1 }, key_view, value_view,
+          algo::Sum{}, algo::Count{}, algo::Max{});
+        DoNotOptimize(result.get_size());
+      });
+    runner.run("GroupAggregate", make_name("group_aggregate/1/hint", group_count), count, [&]()
+      {
+        auto result = algo::group_aggregate<DefaultHash<u64>, DefaultEqual<u64>>({ 1, group_count }, key_view, value_view,
+          algo::Sum{}, algo::Count{}, algo::Max{});
+        DoNotOptimize(result.get_size());
+      });
+    runner.run("GroupAggregate", make_name("group_aggregate", group_count), count, [&]()
+      {
+        auto result = algo::group_aggregate(key_view, value_view, algo::Sum{}, algo::Count{}, algo::Max{});
+        DoNotOptimize(result.get_size());
+      });
+  }
+}
+
+COLT_BENCH_SUITE(HashJoin)
+{
+  //Foreign key join: each probe row matches one build row (or none)
+  for (size_t build_count : { 65536, 4194304 })
+  {
+    const size_t probe_count = build_count * 2;
+    std::vector<u64> build_keys = make_random_keys(build_count, ~u64(0) - 1, 1);
+    std::vector<u64> probe_keys = make_random_keys(probe_count, build_count, 2);
+    for (auto& key : probe_keys)
+      key = build_keys[key];
+    const ContiguousView<u64> build_view = { build_keys.data(), build_keys.size() };
+    const ContiguousView<u64> probe_view = { probe_keys.data(), probe_keys.size() };
+
+    runner.run("HashJoin", make_name("Map", build_count), probe_count, [&]()
+      {
+        Map<u64, size_t, FastIntHash> table = Map<u64, size_t, FastIntHash>{ static_cast<size_t>(build_count / 0.7f) + 16 };
+        for (size_t i = 0; i < build_count; i++)
+          table.insert(build_keys[i], i);
+        Vector<std::pair<size_t, size_t>> result;
+        for (size_t i = 0; i < probe_count; i++)
+          if (auto slot = table.find(probe_keys[i]))
+            result.push_back({ slot->second, i });
+        DoNotOptimize(result.get_size());
+      });
+    runner.run("HashJoin", make_name("IntMap", build_count), probe_count, [&]()
+      {
+        IntMap<u64, size_t> table = IntMap<u64, size_t>{ build_count };
+        for (size_t i = 0; i < build_count; i++)
+          table.insert(build_keys[i], i);
+        Vector<std::pair<size_t, size_t>> result;
+        for (size_t i = 0; i < probe_count; i++)
+          if (auto index = table.find(probe_keys[i]))
+            result.push_back({ *index, i });
+        DoNotOptimize(result.get_size());
+      });
+    runner.run("HashJoin", make_name("hash_join/1", build_count), probe_count, [&]()
+      {
+        DoNotOptimize(algo::hash_join(build_view, probe_view, 1).get_size());
+      });
+    runner.run("HashJoin", make_name("hash_join", build_count), probe_count, [&]()
+      {
+        DoNotOptimize(algo::hash_join(build_view, probe_view).get_size());
+      });
+  }
+}
+
+COLT_BENCH_SUITE(SetOps)
+{
+  //Posting lists: sorted document identifiers, of similar or very different sizes
+  constexpr size_t count = 1048576;
+  for (size_t other_count : { count, count / 64 })
+  {
+    auto make_list = [](size_t size, u64 seed)
+      {
+        std::vector<u32> list;
+        for (u64 key : make_random_keys(size, size * 4, seed))
+          list.push_back(static_cast<u32>(key));
+        std::sort(list.begin(), list.end());
+        list.erase(std::unique(list.begin(), list.end()), list.end());
+        return list;
+      };
+    const std::vector<u32> a = make_list(count, 1);
+    std::vector<u32> b = make_list(other_count, 2);
+    //Spreads the smaller list over the range of the larger one
+    for (auto& value : b)
+      value = static_cast<u32>(value * (count / other_count));
+    const ContiguousView<u32> a_view = { a.data(), a.size() };
+    const ContiguousView<u32> b_view = { b.data(), b.size() };
+    const size_t total = a.size() + b.size();
+
+    runner.run("SetOps", make_name("intersection/merge", other_count), total, [&]()
+      {
+        Vector<u32> out;
+        size_t i = 0;
+        size_t j = 0;
+        while (i < a.size() && j < b.size())
+        {
+          if (a[i] < b[j])
+            ++i;
+          else if (b[j] < a[i])
+            ++j;
+          else
+          {
+            out.push_back(a[i]);
+            ++i;
+            ++j;
+          }
+        }
+        DoNotOptimize(out.get_size());
+      });
+    runner.run("SetOps", make_name("set_intersection", other_count), total, [&]()
+      {
+        Vector<u32> out;
+        algo::set_intersection(a_view, b_view, out);
+        DoNotOptimize(out.get_size());
+      });
+    runner.run("SetOps", make_name("set_union", other_count), total, [&]()
+      {
+        Vector<u32> out;
+        algo::set_union(a_view, b_view, out);
+        DoNotOptimize(out.get_size());
+      });
+    runner.run("SetOps", make_name("set_difference", other_count), total, [&]()
+      {
+        Vector<u32> out;
+        algo::set_difference(a_view, b_view, out);
+        DoNotOptimize(out.get_size());
+      });
+  }
+}
+
+COLT_BENCH_SUITE(Select)
+{
+  //Median and top 100 of a column of scores
+  constexpr size_t count = 4194304;
+  std::vector<u32> scores;
+  for (u64 key : make_random_keys(count, ~u32(0), 3))
+    scores.push_back(static_cast<u32>(key));
+  const ContiguousView<u32> view = { scores.data(), scores.size() };
+
+  runner.run("Select", "std::nth_element", count, [&]()
+    {
+      std::vector<u32> copy = scores;
+      std::nth_element(copy.begin(), copy.begin() + count / 2, copy.end());
+      DoNotOptimize(copy[count / 2]);
+    });
+  runner.run("Select", "nth_element", count, [&]()
+    {
+      Vector<u32> copy = Vector<u32>{ view };
+      algo::nth_element(copy, count / 2);
+      DoNotOptimize(copy[count / 2]);
+    });
+  runner.run("Select", "std::partial_sort/100", count, [&]()
+    {
+      std::vector<u32> copy = scores;
+      std::partial_sort(copy.begin(), copy.begin() + 100, copy.end(), std::greater<u32>{});
+      DoNotOptimize(copy[99]);
+    });
+  runner.run("Select", "TopK::push/100", count, [&]()
+    {
+      algo::TopK<u32> top = algo::TopK<u32>{ 100 };
+      for (u32 score : scores)
+        top.push(score);
+      DoNotOptimize(top.get_threshold());
+    });
+  runner.run("Select", "TopK::push_all/100", count, [&]()
+    {
+      algo::TopK<u32> top = algo::TopK<u32>{ 100 };
+      top.push_all(view);
+      DoNotOptimize(top.get_threshold());
+    });
+  runner.run("Select", "top_k/100", count, [&]()
+    {
+      DoNotOptimize(algo::top_k(view, 100).get_size());
+    });
+}
+
+COLT_BENCH_SUITE(Scan)
+{
+  //Offsets from counts: in the cache, then in memory
+  for (size_t count : { 65536, 16777216 })
+  {
+    std::vector<u32> counts;
+    for (u64 key : make_random_keys(count, 16, 4))
+      counts.push_back(static_cast<u32>(key));
+    std::vector<u32> offsets(count);
+    const ContiguousView<u32> view = { counts.data(), counts.size() };
+
+    runner.run("Scan", make_name("loop", count), count, [&]()
+      {
+        u32 total = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+          offsets[i] = total;
+          total += counts[i];
+        }
+        DoNotOptimize(total);
+      });
+    runner.run("Scan", make_name("exclusive_scan/1", count), count, [&]()
+      {
+        DoNotOptimize(algo::exclusive_scan(view, offsets.data(), 0u, 1));
+      });
+    runner.run("Scan", make_name("exclusive_scan", count), count, [&]()
+      {
+        DoNotOptimize(algo::exclusive_scan(view, offsets.data()));
+      });
+  }
+}
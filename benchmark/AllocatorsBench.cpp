@@ -0,0 +1,110 @@
+#include <cstdlib>
+
+#include "colt/details/allocator.h"
+
+#include "Benchmark.h"
+
+using namespace colt;
+using namespace colt::bench;
+
+namespace
+{
+  /// @brief Count of blocks allocated then freed by each benchmark
+  constexpr size_t BLOCK_COUNT = 256;
+
+  template<typename Allocator>
+  /// @brief Allocates BLOCK_COUNT blocks of 'size' bytes through 'alloc', then frees them in reverse order
+  /// @tparam Allocator The allocator type
+  /// @param alloc The allocator
+  /// @param size The size of each block
+  void alloc_free_batch(Allocator& alloc, size_t size) noexcept
+  {
+    memory::MemBlock blocks[BLOCK_COUNT];
+    for (size_t i = 0; i < BLOCK_COUNT; i++)
+    {
+      blocks[i] = alloc.allocate({ size });
+      DoNotOptimize(blocks[i]);
+    }
+    for (size_t i = BLOCK_COUNT; i != 0; i--)
+      alloc.deallocate(blocks[i - 1]);
+  }
+}
+
+COLT_BENCH_SUITE(Allocators)
+{
+  for (size_t size : { 16, 64, 256, 4096 })
+  {
+    runner.run("Allocators/alloc_free", make_name("memory::allocate", size), BLOCK_COUNT, [size]()
+      {
+        memory::MemBlock blocks[BLOCK_COUNT];
+        for (size_t i = 0; i < BLOCK_COUNT; i++)
+        {
+          blocks[i] = memory::allocate({ size });
+          DoNotOptimize(blocks[i]);
+        }
+        for (size_t i = BLOCK_COUNT; i != 0; i--)
+          memory::deallocate(blocks[i - 1]);
+      });
+    runner.run("Allocators/alloc_free", make_name("malloc", size), BLOCK_COUNT, [size]()
+      {
+        void* blocks[BLOCK_COUNT];
+        for (size_t i = 0; i < BLOCK_COUNT; i++)
+        {
+          blocks[i] = std::malloc(size);
+          DoNotOptimize(blocks[i]);
+        }
+        for (size_t i = BLOCK_COUNT; i != 0; i--)
+          std::free(blocks[i - 1]);
+      });
+    runner.run("Allocators/alloc_free", make_name("Mallocator", size), BLOCK_COUNT, [size]()
+      {
+        memory::Mallocator alloc;
+        alloc_free_batch(alloc, size);
+      });
+
+    //The FreeList outlives the measured function so that its nodes are reused
+    memory::FreeList<memory::Mallocator, 8, 4096> free_list;
+    runner.run("Allocators/alloc_free", make_name("FreeList<Mallocator>", size), BLOCK_COUNT, [&free_list, size]()
+      {
+        alloc_free_batch(free_list, size);
+      });
+    memory::SmallAllocator_t bucket_alloc;
+    runner.run("Allocators/alloc_free", make_name("SmallAllocator_t", size), BLOCK_COUNT, [&bucket_alloc, size]()
+      {
+        alloc_free_batch(bucket_alloc, size);
+      });
+    //Blocks are freed in reverse order, which the StackAllocator can reclaim
+    memory::FallbackAllocator<memory::StackAllocator<16384>, memory::Mallocator> stack_alloc;
+    runner.run("Allocators/alloc_free", make_name("FallbackAllocator<StackAllocator>", size), BLOCK_COUNT, [&stack_alloc, size]()
+      {
+        alloc_free_batch(stack_alloc, size);
+      });
+  }
+
+  struct Object
+  {
+    u64 a, b, c, d;
+  };
+  runner.run("Allocators/new_delete", "memory::new_t", BLOCK_COUNT, []()
+    {
+      memory::TypedBlock<Object> blocks[BLOCK_COUNT];
+      for (size_t i = 0; i < BLOCK_COUNT; i++)
+      {
+        blocks[i] = memory::new_t<Object>();
+        DoNotOptimize(blocks[i]);
+      }
+      for (size_t i = BLOCK_COUNT; i != 0; i--)
+        memory::delete_t<Object>(blocks[i - 1]);
+    });
+  runner.run("Allocators/new_delete", "new", BLOCK_COUNT, []()
+    {
+      Object* blocks[BLOCK_COUNT];
+      for (size_t i = 0; i < BLOCK_COUNT; i++)
+      {
+        blocks[i] = new Object();
+        DoNotOptimize(blocks[i]);
+      }
+      for (size_t i = BLOCK_COUNT; i != 0; i--)
+        delete blocks[i - 1];
+    });
+}
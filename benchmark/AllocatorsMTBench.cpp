@@ -0,0 +1,368 @@
+#include <atomic>
+#include <thread>
+
+#include "colt/details/allocator.h"
+#include "colt/data_structs/Vector.h"
+#include "colt/utility/Histogram.h"
+
+#include "Benchmark.h"
+
+using namespace colt;
+using namespace colt::bench;
+
+namespace
+{
+  /// @brief Count of operations performed by each thread in a scenario
+  constexpr size_t OPS_PER_THREAD = 50000;
+
+  /// @brief Small and fast pseudo-random generator (xorshift64)
+  struct Random
+  {
+    /// @brief The state of the generator (non-zero)
+    u64 state;
+
+    /// @brief Returns the next pseudo-random value
+    /// @return The value
+    u64 next() noexcept
+    {
+      state ^= state << 13;
+      state ^= state >> 7;
+      state ^= state << 17;
+      return state;
+    }
+
+    /// @brief Returns an allocation size: mostly small, with a tail of larger sizes
+    /// @return The size in bytes (in [16, 8192])
+    size_t next_size() noexcept
+    {
+      const u64 value = next();
+      const u64 bucket = value % 100;
+      if (bucket < 70)
+        return 16 + (value >> 8) % 113;
+      if (bucket < 95)
+        return 128 + (value >> 8) % 897;
+      return 1024 + (value >> 8) % 7169;
+    }
+  };
+
+  /// @brief Allocator using the global allocator (memory::allocate/deallocate)
+  struct GlobalAllocator
+  {
+    memory::MemBlock allocate(sizes::ByteSize size) noexcept { return memory::allocate(size); }
+    void deallocate(memory::MemBlock blk) noexcept { memory::deallocate(blk); }
+  };
+
+  /// @brief The measurements of a multi-threaded scenario
+  struct ThreadedRun
+  {
+    /// @brief The duration from the start of the threads to the end of the last one
+    double wall_ns = 0.0;
+    /// @brief The latencies of all the operations of all the threads
+    LatencyHistogram<> latencies;
+  };
+
+  /// @brief Returns the nanoseconds elapsed since 'begin'
+  /// @param begin The start of the operation
+  /// @return The elapsed nanoseconds
+  u64 elapsed_ns(std::chrono::steady_clock::time_point begin) noexcept
+  {
+    return static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - begin).count());
+  }
+
+  template<typename Fn>
+  /// @brief Runs 'fn(thread_index, latencies)' on 'threads' threads started together.
+  /// Each thread records in its own histogram, which are merged at the end.
+  /// @tparam Fn The function type
+  /// @param threads The count of threads
+  /// @param fn The function to run, which records the latency of each of its operations
+  /// @return The measurements
+  ThreadedRun run_threads(size_t threads, Fn&& fn)
+  {
+    using clock = std::chrono::steady_clock;
+
+    std::vector<LatencyHistogram<>> latencies(threads);
+    std::atomic<size_t> ready_count = 0;
+    std::atomic<bool> start = false;
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (size_t i = 0; i < threads; i++)
+    {
+      workers.emplace_back([&, i]()
+        {
+          ready_count.fetch_add(1, std::memory_order_acq_rel);
+          while (!start.load(std::memory_order_acquire))
+            std::this_thread::yield();
+          fn(i, latencies[i]);
+        });
+    }
+    while (ready_count.load(std::memory_order_acquire) != threads)
+      std::this_thread::yield();
+
+    auto begin = clock::now();
+    start.store(true, std::memory_order_release);
+    for (auto& worker : workers)
+      worker.join();
+
+    ThreadedRun result;
+    result.wall_ns = std::chrono::duration<double, std::nano>(clock::now() - begin).count();
+    for (auto& thread_latencies : latencies)
+      result.latencies.merge(thread_latencies);
+    return result;
+  }
+
+  /// @brief Adds the result of a multi-threaded scenario to the runner
+  /// @param runner The runner
+  /// @param group The group of the benchmark
+  /// @param name The name of the allocator
+  /// @param threads The count of threads
+  /// @param run The measurements
+  void add_threaded_result(Runner& runner, const std::string& group, const std::string& name, size_t threads, const ThreadedRun& run)
+  {
+    Result result;
+    result.group = group;
+    result.name = name + "/threads=" + std::to_string(threads);
+    result.items = static_cast<size_t>(run.latencies.get_count());
+    result.calls = 1;
+
+    const auto& latencies = run.latencies;
+    result.ns_per_op.min = static_cast<double>(latencies.get_min());
+    result.ns_per_op.p10 = static_cast<double>(latencies.get_percentile(10.0));
+    result.ns_per_op.median = static_cast<double>(latencies.get_percentile(50.0));
+    result.ns_per_op.mean = latencies.get_mean();
+    result.ns_per_op.p90 = static_cast<double>(latencies.get_percentile(90.0));
+    result.ns_per_op.p99 = static_cast<double>(latencies.get_percentile(99.0));
+    result.ns_per_op.max = static_cast<double>(latencies.get_max());
+
+    result.metrics.emplace_back("threads", static_cast<double>(threads));
+    result.metrics.emplace_back("throughput_mops", static_cast<double>(result.items) * 1e3 / run.wall_ns);
+    result.metrics.emplace_back("p999_ns", static_cast<double>(latencies.get_percentile(99.9)));
+    runner.add_result(std::move(result));
+  }
+
+  template<typename Allocator>
+  /// @brief Each thread keeps 128 live blocks, replacing a random one per operation
+  /// @tparam Allocator The allocator type (shared by all the threads)
+  /// @param runner The runner
+  /// @param alloc The allocator
+  /// @param name The name of the allocator
+  /// @param threads The count of threads
+  void mixed_sizes(Runner& runner, Allocator& alloc, const std::string& name, size_t threads)
+  {
+    if (!runner.is_selected("AllocatorsMT/mixed_sizes", name))
+      return;
+    auto run = run_threads(threads, [&](size_t index, LatencyHistogram<>& latencies)
+      {
+        using clock = std::chrono::steady_clock;
+        constexpr size_t LIVE_COUNT = 128;
+        memory::MemBlock live[LIVE_COUNT];
+        Random rng = { 0x9e3779b97f4a7c15 * (index + 1) };
+        for (size_t i = 0; i < OPS_PER_THREAD; i++)
+        {
+          const size_t slot = rng.next() % LIVE_COUNT;
+          const size_t size = rng.next_size();
+          auto begin = clock::now();
+          if (live[slot].is_not_empty())
+            alloc.deallocate(live[slot]);
+          live[slot] = alloc.allocate({ size });
+          *static_cast<char*>(live[slot].get_ptr()) = 1;
+          latencies.record(elapsed_ns(begin));
+        }
+        for (auto& blk : live)
+        {
+          if (blk.is_not_empty())
+            alloc.deallocate(blk);
+        }
+      });
+    add_threaded_result(runner, "AllocatorsMT/mixed_sizes", name, threads, run);
+  }
+
+  template<typename Allocator>
+  /// @brief Each thread allocates a short-lived temporary and frees it immediately
+  /// @tparam Allocator The allocator type (shared by all the threads)
+  /// @param runner The runner
+  /// @param alloc The allocator
+  /// @param name The name of the allocator
+  /// @param threads The count of threads
+  void temporaries(Runner& runner, Allocator& alloc, const std::string& name, size_t threads)
+  {
+    if (!runner.is_selected("AllocatorsMT/temporaries", name))
+      return;
+    auto run = run_threads(threads, [&](size_t index, LatencyHistogram<>& latencies)
+      {
+        using clock = std::chrono::steady_clock;
+        Random rng = { 0x9e3779b97f4a7c15 * (index + 1) };
+        for (size_t i = 0; i < OPS_PER_THREAD; i++)
+        {
+          const size_t size = 16 + rng.next() % 241;
+          auto begin = clock::now();
+          memory::MemBlock blk = alloc.allocate({ size });
+          *static_cast<char*>(blk.get_ptr()) = 1;
+          DoNotOptimize(blk);
+          alloc.deallocate(blk);
+          latencies.record(elapsed_ns(begin));
+        }
+      });
+    add_threaded_result(runner, "AllocatorsMT/temporaries", name, threads, run);
+  }
+
+  /// @brief Single-producer/single-consumer ring of blocks
+  struct BlockRing
+  {
+    /// @brief The capacity of the ring
+    static constexpr size_t CAPACITY = 1024;
+    /// @brief The blocks in the ring
+    memory::MemBlock blocks[CAPACITY];
+    /// @brief The index of the next block to pop (written by the consumer)
+    alignas(64) std::atomic<size_t> head = 0;
+    /// @brief The index of the next block to push (written by the producer)
+    alignas(64) std::atomic<size_t> tail = 0;
+  };
+
+  template<typename Allocator>
+  /// @brief Half of the threads allocate blocks that the other half frees.
+  /// Each producer is paired with a consumer through a single-producer/single-consumer ring.
+  /// @tparam Allocator The allocator type (shared by all the threads)
+  /// @param runner The runner
+  /// @param alloc The allocator
+  /// @param name The name of the allocator
+  /// @param threads The count of threads (at least 2)
+  void producer_consumer(Runner& runner, Allocator& alloc, const std::string& name, size_t threads)
+  {
+    if (threads < 2 || !runner.is_selected("AllocatorsMT/producer_consumer", name))
+      return;
+
+    std::vector<BlockRing> rings(threads / 2);
+
+    auto run = run_threads(rings.size() * 2, [&](size_t index, LatencyHistogram<>& latencies)
+      {
+        using clock = std::chrono::steady_clock;
+        BlockRing& ring = rings[index / 2];
+        if (index % 2 == 0) //producer
+        {
+          Random rng = { 0x9e3779b97f4a7c15 * (index + 1) };
+          for (size_t i = 0; i < OPS_PER_THREAD; i++)
+          {
+            const size_t size = rng.next_size();
+            const size_t tail = ring.tail.load(std::memory_order_relaxed);
+            while (tail - ring.head.load(std::memory_order_acquire) == BlockRing::CAPACITY)
+              std::this_thread::yield();
+            auto begin = clock::now();
+            memory::MemBlock blk = alloc.allocate({ size });
+            latencies.record(elapsed_ns(begin));
+            *static_cast<char*>(blk.get_ptr()) = 1;
+            ring.blocks[tail % BlockRing::CAPACITY] = blk;
+            ring.tail.store(tail + 1, std::memory_order_release);
+          }
+        }
+        else //consumer
+        {
+          for (size_t i = 0; i < OPS_PER_THREAD; i++)
+          {
+            const size_t head = ring.head.load(std::memory_order_relaxed);
+            while (ring.tail.load(std::memory_order_acquire) == head)
+              std::this_thread::yield();
+            memory::MemBlock blk = ring.blocks[head % BlockRing::CAPACITY];
+            ring.head.store(head + 1, std::memory_order_release);
+            auto begin = clock::now();
+            alloc.deallocate(blk);
+            latencies.record(elapsed_ns(begin));
+          }
+        }
+      });
+    add_threaded_result(runner, "AllocatorsMT/producer_consumer", name, rings.size() * 2, run);
+  }
+
+  template<typename Allocator>
+  /// @brief Runs all the allocator scenarios for an allocator
+  /// @tparam Allocator The allocator type
+  /// @param runner The runner
+  /// @param alloc The allocator (which must be thread-safe)
+  /// @param name The name of the allocator
+  /// @param thread_counts The counts of threads to measure
+  void run_scenarios(Runner& runner, Allocator& alloc, const std::string& name, const std::vector<size_t>& thread_counts)
+  {
+    for (size_t threads : thread_counts)
+    {
+      mixed_sizes(runner, alloc, name, threads);
+      temporaries(runner, alloc, name, threads);
+      producer_consumer(runner, alloc, name, threads);
+    }
+  }
+
+  /// @brief Returns the counts of threads to measure: powers of 2 and the maximum
+  /// @param max_threads The maximum count of threads
+  /// @return The counts of threads
+  std::vector<size_t> get_thread_counts(size_t max_threads)
+  {
+    std::vector<size_t> counts;
+    for (size_t i = 1; i < max_threads; i *= 2)
+      counts.push_back(i);
+    counts.push_back(max_threads);
+    return counts;
+  }
+}
+
+COLT_BENCH_SUITE(AllocatorsMT)
+{
+  const std::vector<size_t> thread_counts = get_thread_counts(runner.get_options().max_threads);
+
+  GlobalAllocator global_alloc;
+  run_scenarios(runner, global_alloc, "memory::allocate", thread_counts);
+  memory::Mallocator mallocator;
+  run_scenarios(runner, mallocator, "Mallocator", thread_counts);
+  memory::ThreadSafeAllocator<memory::Mallocator> thread_safe;
+  run_scenarios(runner, thread_safe, "ThreadSafeAllocator<Mallocator>", thread_counts);
+  memory::ThreadSafeAllocator<memory::FreeList<memory::Mallocator, 8, 8192>> thread_safe_free_list;
+  run_scenarios(runner, thread_safe_free_list, "ThreadSafeAllocator<FreeList<Mallocator>>", thread_counts);
+  memory::ThreadSafeAllocator<memory::SmallAllocator_t> thread_safe_small;
+  run_scenarios(runner, thread_safe_small, "ThreadSafeAllocator<SmallAllocator_t>", thread_counts);
+  memory::AtomicFreeList<memory::Mallocator, 8, 8192> atomic_free_list;
+  run_scenarios(runner, atomic_free_list, "AtomicFreeList<Mallocator>", thread_counts);
+
+  //Workloads that go through the global allocator indirectly
+  for (size_t threads : thread_counts)
+  {
+    if (runner.is_selected("AllocatorsMT/new_delete", "memory::new_t"))
+    {
+      struct Object
+      {
+        u64 a, b, c, d;
+      };
+      auto run = run_threads(threads, [](size_t, LatencyHistogram<>& latencies)
+        {
+          using clock = std::chrono::steady_clock;
+          for (size_t i = 0; i < OPS_PER_THREAD; i++)
+          {
+            auto begin = clock::now();
+            auto blk = memory::new_t<Object>();
+            DoNotOptimize(blk);
+            memory::delete_t<Object>(blk);
+            latencies.record(elapsed_ns(begin));
+          }
+        });
+      add_threaded_result(runner, "AllocatorsMT/new_delete", "memory::new_t", threads, run);
+    }
+    if (runner.is_selected("AllocatorsMT/container_growth", "colt::Vector"))
+    {
+      //Each operation grows a Vector to 256 elements, then destroys it
+      auto run = run_threads(threads, [](size_t, LatencyHistogram<>& latencies)
+        {
+          using clock = std::chrono::steady_clock;
+          for (size_t i = 0; i < OPS_PER_THREAD / 64; i++)
+          {
+            auto begin = clock::now();
+            {
+              Vector<u64> vec;
+              for (u64 j = 0; j < 256; j++)
+                vec.push_back(j);
+              DoNotOptimize(vec.get_data());
+            }
+            latencies.record(elapsed_ns(begin));
+          }
+        });
+      add_threaded_result(runner, "AllocatorsMT/container_growth", "colt::Vector", threads, run);
+    }
+  }
+}
@@ -0,0 +1,444 @@
+/** @file Benchmark.h
+* Contains the micro-benchmark harness used by 'colt_bench'.
+* A benchmark is a function that performs 'items' operations per call.
+* The harness calibrates the count of calls per repetition so that a
+* repetition lasts at least 'min_time_ms', runs warmup repetitions, then
+* measures 'repetitions' repetitions, from which the statistics (min,
+* median, mean, percentiles and max) of the time per operation are computed.
+* Benchmarks are grouped in suites (COLT_BENCH_SUITE), registered
+* statically, and run by 'main.cpp'.
+* If 'Options::perf_counters' is true, the hardware counters of PerfCounters.h
+* are measured around the repetitions and reported per operation in the metrics.
+* The harness uses the standard library rather than colt containers,
+* so that measuring a container does not depend on that same container.
+*/
+
+#ifndef HG_COLT_BENCHMARK
+#define HG_COLT_BENCHMARK
+
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <memory>
+#include <thread>
+
+#include "PerfCounters.h"
+
+#if defined(_MSC_VER) && !defined(__clang__)
+  #include <intrin.h>
+#endif
+
+namespace colt::bench
+{
+#if defined(__GNUC__) || defined(__clang__)
+  template<typename T>
+  /// @brief Prevents the compiler from optimizing away the computation of 'value'
+  /// @tparam T The type of the value
+  /// @param value The value that should be considered as used
+  inline void DoNotOptimize(const T& value) noexcept
+  {
+    asm volatile("" : : "r,m"(value) : "memory");
+  }
+
+  template<typename T>
+  /// @brief Prevents the compiler from optimizing away the computation of 'value',
+  /// and from assuming the value is not modified.
+  /// @tparam T The type of the value
+  /// @param value The value that should be considered as used and modified
+  inline void DoNotOptimize(T& value) noexcept
+  {
+#if defined(__clang__)
+    asm volatile("" : "+r,m"(value) : : "memory");
+#else
+    asm volatile("" : "+m,r"(value) : : "memory");
+#endif
+  }
+
+  /// @brief Forces the compiler to perform all pending writes to memory
+  inline void ClobberMemory() noexcept
+  {
+    asm volatile("" : : : "memory");
+  }
+#else
+  namespace details
+  {
+    /// @brief Function whose calls cannot be removed, used as a sink
+    /// @param  The pointer to consider as used
+    __declspec(noinline) inline void use_char_pointer(const volatile char*) noexcept {}
+  }
+
+  template<typename T>
+  /// @brief Prevents the compiler from optimizing away the computation of 'value'
+  /// @tparam T The type of the value
+  /// @param value The value that should be considered as used
+  inline void DoNotOptimize(const T& value) noexcept
+  {
+    details::use_char_pointer(&reinterpret_cast<const volatile char&>(value));
+    _ReadWriteBarrier();
+  }
+
+  /// @brief Forces the compiler to perform all pending writes to memory
+  inline void ClobberMemory() noexcept
+  {
+    _ReadWriteBarrier();
+  }
+#endif
+
+  /// @brief The options of a benchmark run
+  struct Options
+  {
+    /// @brief The count of repetitions whose results are discarded
+    size_t warmup = 2;
+    /// @brief The count of measured repetitions
+    size_t repetitions = 15;
+    /// @brief The minimum duration of a repetition (in milliseconds)
+    double min_time_ms = 5.0;
+    /// @brief If not null, only benchmarks whose full name contains 'filter' are run
+    const char* filter = nullptr;
+    /// @brief If true, measure hardware performance counters (when available)
+    bool perf_counters = false;
+    /// @brief The maximum count of threads used by multi-threaded benchmarks
+    size_t max_threads = std::thread::hardware_concurrency() == 0 ? 1 : std::thread::hardware_concurrency();
+  };
+
+  /// @brief Statistics over the repetitions of a benchmark (nanoseconds per operation)
+  struct Statistics
+  {
+    double min = 0.0;
+    double p10 = 0.0;
+    double median = 0.0;
+    double mean = 0.0;
+    double p90 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+  };
+
+  /// @brief Computes the statistics of a set of samples
+  /// @param samples The samples (which are sorted by this function)
+  /// @return The statistics
+  inline Statistics compute_statistics(std::vector<double>& samples) noexcept
+  {
+    Statistics stats;
+    if (samples.empty())
+      return stats;
+    std::sort(samples.begin(), samples.end());
+
+    //Nearest-rank percentile
+    auto percentile = [&](double p)
+    {
+      size_t rank = static_cast<size_t>(p * static_cast<double>(samples.size()) + 0.5);
+      rank = rank == 0 ? 0 : rank - 1;
+      return samples[rank < samples.size() ? rank : samples.size() - 1];
+    };
+
+    double sum = 0.0;
+    for (double sample : samples)
+      sum += sample;
+
+    stats.min = samples.front();
+    stats.p10 = percentile(0.10);
+    stats.median = samples.size() % 2 == 1
+      ? samples[samples.size() / 2]
+      : (samples[samples.size() / 2 - 1] + samples[samples.size() / 2]) / 2.0;
+    stats.mean = sum / static_cast<double>(samples.size());
+    stats.p90 = percentile(0.90);
+    stats.p99 = percentile(0.99);
+    stats.max = samples.back();
+    return stats;
+  }
+
+  /// @brief The result of a benchmark
+  struct Result
+  {
+    /// @brief The group of the benchmark (usually the container/operation)
+    std::string group;
+    /// @brief The name of the benchmark (usually the implementation and its parameters)
+    std::string name;
+    /// @brief The count of operations per call
+    size_t items = 0;
+    /// @brief The count of calls per repetition
+    size_t calls = 0;
+    /// @brief The statistics of the time per operation (in nanoseconds)
+    Statistics ns_per_op = {};
+    /// @brief Additional named metrics (such as hardware counters)
+    std::vector<std::pair<std::string, double>> metrics = {};
+
+    /// @brief Returns the count of operations per second (from the median)
+    /// @return Operations per second
+    double get_ops_per_second() const noexcept
+    {
+      return ns_per_op.median == 0.0 ? 0.0 : 1e9 / ns_per_op.median;
+    }
+  };
+
+  /// @brief Runs benchmarks and collects their results
+  class Runner
+  {
+    /// @brief The options of the run
+    Options options;
+    /// @brief The results of all the benchmarks run
+    std::vector<Result> results;
+    /// @brief The hardware counters, or nullptr if not requested or not available
+    std::unique_ptr<PerfCounters> counters;
+
+  public:
+    /// @brief Constructs a Runner
+    /// @param options The options of the run
+    explicit Runner(const Options& options) noexcept
+      : options(options)
+    {
+      if (!options.perf_counters)
+        return;
+      counters = std::make_unique<PerfCounters>();
+      if (!counters->is_available())
+      {
+        std::fputs("Hardware performance counters are not available: only timings are reported.\n", stderr);
+        counters.reset();
+      }
+    }
+
+    /// @brief Returns the options of the run
+    /// @return The options
+    const Options& get_options() const noexcept { return options; }
+
+    /// @brief Returns the results of all the benchmarks run
+    /// @return The results
+    const std::vector<Result>& get_results() const noexcept { return results; }
+
+    /// @brief Check if a benchmark should be run according to the filter
+    /// @param group The group of the benchmark
+    /// @param name The name of the benchmark
+    /// @return True if the benchmark should run
+    bool is_selected(const std::string& group, const std::string& name) const noexcept
+    {
+      if (options.filter == nullptr)
+        return true;
+      return (group + "/" + name).find(options.filter) != std::string::npos;
+    }
+
+    /// @brief Adds a result that was not measured through 'run' (such as multi-threaded scenarios)
+    /// @param result The result to add
+    void add_result(Result result) noexcept
+    {
+      print_result(stdout, result);
+      results.push_back(std::move(result));
+    }
+
+    template<typename Fn>
+    /// @brief Runs a benchmark.
+    /// @tparam Fn The function type
+    /// @param group The group of the benchmark
+    /// @param name The name of the benchmark
+    /// @param items The count of operations performed per call of 'fn'
+    /// @param fn The function to measure
+    void run(const std::string& group, const std::string& name, size_t items, Fn&& fn)
+    {
+      if (!is_selected(group, name))
+        return;
+
+      using clock = std::chrono::steady_clock;
+
+      //Calibrate the count of calls per repetition
+      size_t calls = 1;
+      for (;;)
+      {
+        auto begin = clock::now();
+        for (size_t i = 0; i < calls; i++)
+          fn();
+        ClobberMemory();
+        const double elapsed_ms = std::chrono::duration<double, std::milli>(clock::now() - begin).count();
+        if (elapsed_ms >= options.min_time_ms || calls >= (size_t(1) << 30))
+          break;
+        //Aim slightly above the minimum time, growing at most 100x per step
+        const double factor = elapsed_ms <= 0.0 ? 100.0 : (options.min_time_ms * 1.2) / elapsed_ms;
+        const size_t next = static_cast<size_t>(static_cast<double>(calls) * (factor > 100.0 ? 100.0 : factor));
+        calls = next > calls ? next : calls + 1;
+      }
+
+      for (size_t i = 0; i < options.warmup; i++)
+      {
+        for (size_t j = 0; j < calls; j++)
+          fn();
+      }
+
+      std::vector<double> samples;
+      samples.reserve(options.repetitions);
+      PerfValues counted;
+      for (size_t i = 0; i < options.repetitions; i++)
+      {
+        //The counters are started outside of the timed region
+        if (counters)
+          counters->start();
+        auto begin = clock::now();
+        for (size_t j = 0; j < calls; j++)
+          fn();
+        ClobberMemory();
+        const double elapsed_ns = std::chrono::duration<double, std::nano>(clock::now() - begin).count();
+        if (counters)
+        {
+          counters->stop();
+          counted.add(counters->read());
+        }
+        samples.push_back(elapsed_ns / static_cast<double>(calls * (items == 0 ? 1 : items)));
+      }
+
+      Result result;
+      result.group = group;
+      result.name = name;
+      result.items = items;
+      result.calls = calls;
+      result.ns_per_op = compute_statistics(samples);
+      if (counters)
+        add_counter_metrics(result, counted, options.repetitions * calls * (items == 0 ? 1 : items));
+      add_result(std::move(result));
+    }
+
+    /// @brief Prints a human readable line for a result
+    /// @param file The file to which to print
+    /// @param result The result to print
+    static void print_result(FILE* file, const Result& result) noexcept
+    {
+      std::fprintf(file, "%-28s %-40s %12.3f ns/op (p10 %10.3f, p90 %10.3f) %14.0f op/s",
+        result.group.c_str(), result.name.c_str(),
+        result.ns_per_op.median, result.ns_per_op.p10, result.ns_per_op.p90,
+        result.get_ops_per_second());
+      for (auto& [metric, value] : result.metrics)
+        std::fprintf(file, " %s=%.3f", metric.c_str(), value);
+      std::fputc('\n', file);
+      std::fflush(file);
+    }
+
+    /// @brief Writes all the results as JSON
+    /// @param file The file to which to write
+    void write_json(FILE* file) const noexcept
+    {
+      std::fputs("{\n  \"context\": {\n", file);
+      std::fprintf(file, "    \"compiler\": \"%s\",\n", get_compiler_name());
+      std::fprintf(file, "    \"warmup\": %zu,\n", options.warmup);
+      std::fprintf(file, "    \"repetitions\": %zu,\n", options.repetitions);
+      std::fprintf(file, "    \"min_time_ms\": %g,\n", options.min_time_ms);
+      std::fprintf(file, "    \"max_threads\": %zu,\n", options.max_threads);
+      std::fprintf(file, "    \"perf_counters\": %s\n", counters ? "true" : "false");
+      std::fputs("  },\n  \"benchmarks\": [", file);
+      for (size_t i = 0; i < results.size(); i++)
+      {
+        const Result& result = results[i];
+        std::fputs(i == 0 ? "\n    {" : ",\n    {", file);
+        std::fputs("\"group\": ", file);
+        write_json_string(file, result.group);
+        std::fputs(", \"name\": ", file);
+        write_json_string(file, result.name);
+        std::fprintf(file, ", \"items\": %zu, \"calls\": %zu, \"ops_per_second\": %.3f",
+          result.items, result.calls, result.get_ops_per_second());
+        const Statistics& st = result.ns_per_op;
+        std::fprintf(file, ", \"ns_per_op\": {\"min\": %.4f, \"p10\": %.4f, \"median\": %.4f, \"mean\": %.4f, \"p90\": %.4f, \"p99\": %.4f, \"max\": %.4f}",
+          st.min, st.p10, st.median, st.mean, st.p90, st.p99, st.max);
+        std::fputs(", \"metrics\": {", file);
+        for (size_t j = 0; j < result.metrics.size(); j++)
+        {
+          if (j != 0)
+            std::fputs(", ", file);
+          write_json_string(file, result.metrics[j].first);
+          std::fprintf(file, ": %.6g", result.metrics[j].second);
+        }
+        std::fputs("}}", file);
+      }
+      std::fputs("\n  ]\n}\n", file);
+    }
+
+  private:
+    /// @brief Adds the per operation value of each counter to the metrics of a result
+    /// @param result The result to which to add the metrics
+    /// @param counted The values of the counters over all the repetitions
+    /// @param operations The total count of operations performed
+    static void add_counter_metrics(Result& result, const PerfValues& counted, size_t operations)
+    {
+      const double ops = static_cast<double>(operations);
+      for (size_t i = 0; i < static_cast<size_t>(PerfEvent::EVENT_COUNT); i++)
+      {
+        if (counted.is_valid[i])
+          result.metrics.emplace_back(get_perf_event_name(static_cast<PerfEvent>(i)), counted.values[i] / ops);
+      }
+      const size_t cycles = static_cast<size_t>(PerfEvent::CYCLES);
+      const size_t instructions = static_cast<size_t>(PerfEvent::INSTRUCTIONS);
+      if (counted.is_valid[cycles] && counted.is_valid[instructions] && counted.values[cycles] != 0.0)
+        result.metrics.emplace_back("ipc", counted.values[instructions] / counted.values[cycles]);
+    }
+
+    /// @brief Writes a JSON string, escaping quotes and backslashes
+    /// @param file The file to which to write
+    /// @param str The string to write
+    static void write_json_string(FILE* file, const std::string& str) noexcept
+    {
+      std::fputc('"', file);
+      for (char c : str)
+      {
+        if (c == '"' || c == '\\')
+          std::fputc('\\', file);
+        std::fputc(c, file);
+      }
+      std::fputc('"', file);
+    }
+
+    /// @brief Returns the name of the compiler used
+    /// @return The name of the compiler
+    static const char* get_compiler_name() noexcept
+    {
+#if defined(__clang__)
+      return "clang " __clang_version__;
+#elif defined(__GNUC__)
+      return "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+      return "msvc";
+#else
+      return "unknown";
+#endif
+    }
+  };
+
+  /// @brief A suite is a function that runs related benchmarks
+  using suite_fn_t = void(*)(Runner&);
+
+  /// @brief Returns all the registered suites
+  /// @return Vector of pair of the suite name and function
+  inline std::vector<std::pair<const char*, suite_fn_t>>& get_suites() noexcept
+  {
+    static std::vector<std::pair<const char*, suite_fn_t>> suites;
+    return suites;
+  }
+
+  /// @brief Registers a suite on construction (see COLT_BENCH_SUITE)
+  struct SuiteRegistrar
+  {
+    /// @brief Registers a suite
+    /// @param name The name of the suite
+    /// @param fn The suite function
+    SuiteRegistrar(const char* name, suite_fn_t fn) noexcept
+    {
+      get_suites().emplace_back(name, fn);
+    }
+  };
+
+  /// @brief Returns a name of the form 'prefix/value'
+  /// @param prefix The prefix
+  /// @param value The value to append
+  /// @return The name
+  inline std::string make_name(const char* prefix, size_t value)
+  {
+    return std::string(prefix) + "/" + std::to_string(value);
+  }
+}
+
+/// @brief Declares and registers a benchmark suite.
+/// Usage: COLT_BENCH_SUITE(Vector) { runner.run(...); }
+#define COLT_BENCH_SUITE(NAME) \
+  static void colt_bench_suite_##NAME(::colt::bench::Runner& runner); \
+  static const ::colt::bench::SuiteRegistrar colt_bench_registrar_##NAME(#NAME, &colt_bench_suite_##NAME); \
+  static void colt_bench_suite_##NAME(::colt::bench::Runner& runner)
+
+#endif //!HG_COLT_BENCHMARK
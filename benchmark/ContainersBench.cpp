@@ -0,0 +1,665 @@
+#include <vector>
+#include <list>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "colt/data_structs/Vector.h"
+#include "colt/data_structs/Map.h"
+#include "colt/data_structs/IntMap.h"
+#include "colt/data_structs/MultiMap.h"
+#include "colt/data_structs/Set.h"
+#include "colt/data_structs/List.h"
+#include "colt/data_structs/SharedString.h"
+#include "colt/data_structs/StringBuilder.h"
+
+#include "Benchmark.h"
+
+using namespace colt;
+using namespace colt::bench;
+
+namespace
+{
+  /// @brief Generates 'count' pseudo-random distinct 64-bit keys
+  /// @param count The count of keys
+  /// @param seed The seed of the generator
+  /// @return The keys
+  std::vector<u64> make_keys(size_t count, u64 seed)
+  {
+    std::vector<u64> keys;
+    keys.reserve(count);
+    //splitmix64 is a bijection: distinct inputs give distinct keys
+    for (size_t i = 0; i < count; i++)
+    {
+      u64 x = seed + (i + 1) * 0x9e3779b97f4a7c15;
+      x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+      x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+      keys.push_back(x ^ (x >> 31));
+    }
+    return keys;
+  }
+
+  /// @brief Returns the capacity to reserve for a Map to contain 'count' keys without reallocating
+  /// @param count The count of keys
+  /// @param load_factor The load factor of the Map
+  /// @return The capacity to reserve
+  size_t map_capacity_for(size_t count, float load_factor)
+  {
+    return static_cast<size_t>(static_cast<double>(count) / load_factor) + 16;
+  }
+}
+
+COLT_BENCH_SUITE(Vector)
+{
+  for (size_t count : { 64, 4096, 262144 })
+  {
+    runner.run("Vector/push_back", make_name("colt::Vector", count), count, [count]()
+      {
+        Vector<u64> vec;
+        for (size_t i = 0; i < count; i++)
+          vec.push_back(i);
+        DoNotOptimize(vec.get_data());
+      });
+    runner.run("Vector/push_back", make_name("colt::Vector+ScratchScope", count), count, [count]()
+      {
+        memory::ScratchScope scope;
+        Vector<u64> vec = Vector<u64>(16, InScratch);
+        for (size_t i = 0; i < count; i++)
+          vec.push_back(i);
+        DoNotOptimize(vec.get_data());
+      });
+    runner.run("Vector/push_back", make_name("colt::SmallVector<16>", count), count, [count]()
+      {
+        SmallVector<u64, 16> vec;
+        for (size_t i = 0; i < count; i++)
+          vec.push_back(i);
+        DoNotOptimize(vec.get_data());
+      });
+    runner.run("Vector/push_back", make_name("std::vector", count), count, [count]()
+      {
+        std::vector<u64> vec;
+        for (size_t i = 0; i < count; i++)
+          vec.push_back(i);
+        DoNotOptimize(vec.data());
+      });
+
+    Vector<u64> colt_vec;
+    SmallVector<u64, 16> colt_small_vec;
+    std::vector<u64> std_vec;
+    for (size_t i = 0; i < count; i++)
+    {
+      colt_vec.push_back(i);
+      colt_small_vec.push_back(i);
+      std_vec.push_back(i);
+    }
+    runner.run("Vector/iterate", make_name("colt::Vector", count), count, [&]()
+      {
+        u64 sum = 0;
+        for (auto i : colt_vec)
+          sum += i;
+        DoNotOptimize(sum);
+      });
+    runner.run("Vector/iterate", make_name("colt::SmallVector<16>", count), count, [&]()
+      {
+        u64 sum = 0;
+        for (auto i : colt_small_vec)
+          sum += i;
+        DoNotOptimize(sum);
+      });
+    runner.run("Vector/iterate", make_name("std::vector", count), count, [&]()
+      {
+        u64 sum = 0;
+        for (auto i : std_vec)
+          sum += i;
+        DoNotOptimize(sum);
+      });
+  }
+}
+
+COLT_BENCH_SUITE(Map)
+{
+  for (size_t count : { 1024, 16384, 262144 })
+  {
+    const std::vector<u64> keys = make_keys(count, 1);
+    const std::vector<u64> missing = make_keys(count, 2);
+
+    for (float load_factor : { 0.5f, 0.7f, 0.9f })
+    {
+      const std::string suffix = std::to_string(count) + "/lf=" + std::to_string(load_factor).substr(0, 3);
+
+      //Growing a Map through repeated insertions is quadratic for large sizes
+      if (count <= 16384)
+      {
+        runner.run("Map/insert", "colt::Map/" + suffix, count, [&]()
+          {
+            Map<u64, u64> map = Map<u64, u64>{ load_factor };
+            for (auto key : keys)
+              map.insert(key, key);
+            DoNotOptimize(map.get_size());
+          });
+      }
+      runner.run("Map/insert_reserved", "colt::Map/" + suffix, count, [&]()
+        {
+          Map<u64, u64> map = Map<u64, u64>{ map_capacity_for(count, load_factor), load_factor };
+          for (auto key : keys)
+            map.insert(key, key);
+          DoNotOptimize(map.get_size());
+        });
+      runner.run("Map/insert_reserved", "std::unordered_map/" + suffix, count, [&]()
+        {
+          std::unordered_map<u64, u64> map;
+          map.max_load_factor(load_factor);
+          map.reserve(count);
+          for (auto key : keys)
+            map.emplace(key, key);
+          DoNotOptimize(map.size());
+        });
+
+      Map<u64, u64> colt_map = Map<u64, u64>{ map_capacity_for(count, load_factor), load_factor };
+      std::unordered_map<u64, u64> std_map;
+      std_map.max_load_factor(load_factor);
+      std_map.reserve(count);
+      for (auto key : keys)
+      {
+        colt_map.insert(key, key);
+        std_map.emplace(key, key);
+      }
+
+      runner.run("Map/find_hit", "colt::Map/" + suffix, count, [&]()
+        {
+          u64 sum = 0;
+          for (auto key : keys)
+            sum += colt_map.find(key)->second;
+          DoNotOptimize(sum);
+        });
+      runner.run("Map/find_hit", "std::unordered_map/" + suffix, count, [&]()
+        {
+          u64 sum = 0;
+          for (auto key : keys)
+            sum += std_map.find(key)->second;
+          DoNotOptimize(sum);
+        });
+      runner.run("Map/find_miss", "colt::Map/" + suffix, count, [&]()
+        {
+          size_t found = 0;
+          for (auto key : missing)
+            found += colt_map.find(key) != nullptr;
+          DoNotOptimize(found);
+        });
+      runner.run("Map/find_miss", "std::unordered_map/" + suffix, count, [&]()
+        {
+          size_t found = 0;
+          for (auto key : missing)
+            found += std_map.find(key) != std_map.end();
+          DoNotOptimize(found);
+        });
+
+      //Measures building then erasing all the keys
+      runner.run("Map/insert_erase", "colt::Map/" + suffix, count, [&]()
+        {
+          Map<u64, u64> map = Map<u64, u64>{ map_capacity_for(count, load_factor), load_factor };
+          for (auto key : keys)
+            map.insert(key, key);
+          for (auto key : keys)
+            map.erase(key);
+          DoNotOptimize(map.get_size());
+        });
+      runner.run("Map/insert_erase", "std::unordered_map/" + suffix, count, [&]()
+        {
+          std::unordered_map<u64, u64> map;
+          map.max_load_factor(load_factor);
+          map.reserve(count);
+          for (auto key : keys)
+            map.emplace(key, key);
+          for (auto key : keys)
+            map.erase(key);
+          DoNotOptimize(map.size());
+        });
+    }
+  }
+}
+
+COLT_BENCH_SUITE(MapHasher)
+{
+  //Compares the hash policies of a Map on the same keys
+  for (size_t count : { 16384, 262144 })
+  {
+    const std::vector<u64> keys = make_keys(count, 1);
+    const size_t capacity = map_capacity_for(count, 0.7f);
+
+    Map<u64, u64> default_map = Map<u64, u64>{ capacity };
+    Map<u64, u64, FastIntHash> fast_map = Map<u64, u64, FastIntHash>{ capacity };
+    Map<u64, u64, IdentityHash> identity_map = Map<u64, u64, IdentityHash>{ capacity };
+    Map<u64, u64, SeededHash> seeded_map = Map<u64, u64, SeededHash>{ capacity };
+    for (auto key : keys)
+    {
+      default_map.insert(key, key);
+      fast_map.insert(key, key);
+      identity_map.insert(key, key);
+      seeded_map.insert(key, key);
+    }
+
+    runner.run("MapHasher/find_hit", make_name("DefaultHash", count), count, [&]()
+      {
+        u64 sum = 0;
+        for (auto key : keys)
+          sum += default_map.find(key)->second;
+        DoNotOptimize(sum);
+      });
+    runner.run("MapHasher/find_hit", make_name("FastIntHash", count), count, [&]()
+      {
+        u64 sum = 0;
+        for (auto key : keys)
+          sum += fast_map.find(key)->second;
+        DoNotOptimize(sum);
+      });
+    runner.run("MapHasher/find_hit", make_name("IdentityHash", count), count, [&]()
+      {
+        u64 sum = 0;
+        for (auto key : keys)
+          sum += identity_map.find(key)->second;
+        DoNotOptimize(sum);
+      });
+    runner.run("MapHasher/find_hit", make_name("SeededHash", count), count, [&]()
+      {
+        u64 sum = 0;
+        for (auto key : keys)
+          sum += seeded_map.find(key)->second;
+        DoNotOptimize(sum);
+      });
+  }
+}
+
+COLT_BENCH_SUITE(MapBulkBuild)
+{
+  for (size_t count : { 262144, 4194304 })
+  {
+    const std::vector<u64> keys = make_keys(count, 1);
+    std::vector<std::pair<u64, u64>> pairs;
+    pairs.reserve(count);
+    for (auto key : keys)
+      pairs.emplace_back(key, key);
+    const ContiguousView<std::pair<u64, u64>> view = { pairs.data(), pairs.size() };
+
+    runner.run("MapBulkBuild/build", make_name("insert_reserved", count), count, [&]()
+      {
+        Map<u64, u64> map = Map<u64, u64>{ map_capacity_for(count, 0.7f) };
+        for (auto key : keys)
+          map.insert(key, key);
+        DoNotOptimize(map.get_size());
+      });
+    runner.run("MapBulkBuild/build", make_name("bulk_build/1", count), count, [&]()
+      {
+        Map<u64, u64> map;
+        map.bulk_build(view, 1);
+        DoNotOptimize(map.get_size());
+      });
+    runner.run("MapBulkBuild/build", make_name("bulk_build", count), count, [&]()
+      {
+        Map<u64, u64> map;
+        map.bulk_build(view);
+        DoNotOptimize(map.get_size());
+      });
+
+    //Doubling the capacity rehashes all the keys (on multiple threads for large Maps)
+    runner.run("MapBulkBuild/rehash", make_name("colt::Map", count), count, [&]()
+      {
+        Map<u64, u64> map;
+        map.bulk_build(view);
+        map.reserve(map.get_capacity() * 2);
+        DoNotOptimize(map.get_size());
+      });
+  }
+}
+
+COLT_BENCH_SUITE(IntMap)
+{
+  //u64 to u32 id translation: the keys and values of IntMap share their cache lines
+  for (size_t count : { 16384, 262144, 4194304 })
+  {
+    const std::vector<u64> keys = make_keys(count, 1);
+    const std::vector<u64> missing = make_keys(count, 2);
+
+    Map<u64, u32, FastIntHash> map = Map<u64, u32, FastIntHash>{ map_capacity_for(count, 0.7f) };
+    IntMap<u64, u32> int_map = IntMap<u64, u32>{ count };
+    for (size_t i = 0; i < count; i++)
+    {
+      map.insert(keys[i], static_cast<u32>(i));
+      int_map.insert(keys[i], static_cast<u32>(i));
+    }
+
+    runner.run("IntMap/insert", make_name("colt::Map", count), count, [&]()
+      {
+        Map<u64, u32, FastIntHash> built = Map<u64, u32, FastIntHash>{ map_capacity_for(count, 0.7f) };
+        for (size_t i = 0; i < count; i++)
+          built.insert(keys[i], static_cast<u32>(i));
+        DoNotOptimize(built.get_size());
+      });
+    runner.run("IntMap/insert", make_name("colt::IntMap", count), count, [&]()
+      {
+        IntMap<u64, u32> built = IntMap<u64, u32>{ count };
+        for (size_t i = 0; i < count; i++)
+          built.insert(keys[i], static_cast<u32>(i));
+        DoNotOptimize(built.get_size());
+      });
+    runner.run("IntMap/find_hit", make_name("colt::Map", count), count, [&]()
+      {
+        u64 sum = 0;
+        for (auto key : keys)
+          sum += map.find(key)->second;
+        DoNotOptimize(sum);
+      });
+    runner.run("IntMap/find_hit", make_name("colt::IntMap", count), count, [&]()
+      {
+        u64 sum = 0;
+        for (auto key : keys)
+          sum += *int_map.find(key);
+        DoNotOptimize(sum);
+      });
+    runner.run("IntMap/find_miss", make_name("colt::Map", count), count, [&]()
+      {
+        size_t found = 0;
+        for (auto key : missing)
+          found += map.find(key) != nullptr;
+        DoNotOptimize(found);
+      });
+    runner.run("IntMap/find_miss", make_name("colt::IntMap", count), count, [&]()
+      {
+        size_t found = 0;
+        for (auto key : missing)
+          found += int_map.find(key) != nullptr;
+        DoNotOptimize(found);
+      });
+  }
+}
+
+COLT_BENCH_SUITE(MultiMap)
+{
+  //One-to-many index of 8 values per key on average: a Map of Vector allocates per key
+  for (size_t count : { 16384, 262144, 4194304 })
+  {
+    const size_t key_count = count / 8;
+    const std::vector<u64> distinct = make_keys(key_count, 1);
+    std::vector<std::pair<u64, u32>> pairs;
+    pairs.reserve(count);
+    for (size_t i = 0; i < count; i++)
+      pairs.push_back({ distinct[(i * 0x9e3779b9) % key_count], static_cast<u32>(i) });
+    const ContiguousView<std::pair<u64, u32>> view = { pairs.data(), pairs.size() };
+
+    auto build_map = [&]()
+      {
+        Map<u64, Vector<u32>> map = Map<u64, Vector<u32>>{ map_capacity_for(key_count, 0.7f) };
+        for (auto& pair : pairs)
+        {
+          auto slot = map.find(pair.first);
+          if (slot == nullptr)
+            slot = map.insert(pair.first, Vector<u32>{}).first;
+          slot->second.push_back(pair.second);
+        }
+        return map;
+      };
+    const Map<u64, Vector<u32>> map = build_map();
+    const MultiMap<u64, u32> multi_map = MultiMap<u64, u32>::build(view);
+
+    runner.run("MultiMap/build", make_name("Map<Vector>", count), count, [&]()
+      {
+        DoNotOptimize(build_map().get_size());
+      });
+    runner.run("MultiMap/build", make_name("MultiMap", count), count, [&]()
+      {
+        MultiMap<u64, u32> built;
+        for (auto& pair : pairs)
+          built.insert(pair.first, pair.second);
+        built.freeze();
+        DoNotOptimize(built.get_value_count());
+      });
+    runner.run("MultiMap/find", make_name("Map<Vector>", count), key_count, [&]()
+      {
+        u64 sum = 0;
+        for (auto key : distinct)
+          for (auto value : map.find(key)->second)
+            sum += value;
+        DoNotOptimize(sum);
+      });
+    runner.run("MultiMap/find", make_name("MultiMap", count), key_count, [&]()
+      {
+        u64 sum = 0;
+        for (auto key : distinct)
+          for (auto value : multi_map.find(key))
+            sum += value;
+        DoNotOptimize(sum);
+      });
+  }
+}
+
+COLT_BENCH_SUITE(StringKeys)
+{
+  constexpr size_t count = 4096;
+  const std::vector<u64> keys = make_keys(count, 3);
+
+  //Hostname-like keys, longer than the small buffer of String
+  std::vector<String> strings;
+  std::vector<SharedString> shared_strings;
+  for (auto key : keys)
+  {
+    const std::string name = "host-" + std::to_string(key) + ".internal";
+    strings.emplace_back(StringView{ name.c_str() });
+    shared_strings.emplace_back(StringView{ name.c_str() });
+  }
+
+  runner.run("StringKeys/copy", make_name("colt::String", count), count, [&]()
+    {
+      Vector<String> copies = Vector<String>{ count };
+      for (const auto& str : strings)
+        copies.push_back(str);
+      DoNotOptimize(copies.get_data());
+    });
+  runner.run("StringKeys/copy", make_name("colt::SharedString", count), count, [&]()
+    {
+      Vector<SharedString> copies = Vector<SharedString>{ count };
+      for (const auto& str : shared_strings)
+        copies.push_back(str);
+      DoNotOptimize(copies.get_data());
+    });
+
+  Map<String, u64> string_map = Map<String, u64>{ map_capacity_for(count, 0.7f), 0.7f };
+  Map<SharedString, u64> shared_map = Map<SharedString, u64>{ map_capacity_for(count, 0.7f), 0.7f };
+  for (size_t i = 0; i < count; i++)
+  {
+    string_map.insert(strings[i], i);
+    shared_map.insert(shared_strings[i], i);
+  }
+  runner.run("StringKeys/find_hit", make_name("colt::Map<String>", count), count, [&]()
+    {
+      u64 sum = 0;
+      for (const auto& str : strings)
+        sum += string_map.find(str)->second;
+      DoNotOptimize(sum);
+    });
+  runner.run("StringKeys/find_hit", make_name("colt::Map<SharedString>", count), count, [&]()
+    {
+      u64 sum = 0;
+      for (const auto& str : shared_strings)
+        sum += shared_map.find(str)->second;
+      DoNotOptimize(sum);
+    });
+}
+
+COLT_BENCH_SUITE(StringBuilder)
+{
+  //Appends short pieces, as when formatting a report or a payload
+  const StringView piece = "key=value, ";
+  for (size_t count : { 4096, 262144 })
+  {
+    runner.run("StringBuilder/append", make_name("colt::String", count), count, [&]()
+      {
+        String str;
+        for (size_t i = 0; i < count; i++)
+          str.append(piece);
+        DoNotOptimize(str.get_data());
+      });
+    runner.run("StringBuilder/append", make_name("colt::StringBuilder", count), count, [&]()
+      {
+        StringBuilder builder;
+        for (size_t i = 0; i < count; i++)
+          builder.append(piece);
+        DoNotOptimize(builder.get_size());
+      });
+    runner.run("StringBuilder/append_to_string", make_name("colt::StringBuilder", count), count, [&]()
+      {
+        StringBuilder builder;
+        for (size_t i = 0; i < count; i++)
+          builder.append(piece);
+        auto str = builder.to_string();
+        DoNotOptimize(str.get_data());
+      });
+  }
+}
+
+COLT_BENCH_SUITE(StableSet)
+{
+  for (size_t count : { 1024, 16384 })
+  {
+    //Each key is inserted twice: half of the insertions find an existing key
+    std::vector<u64> keys = make_keys(count / 2, 3);
+    keys.insert(keys.end(), keys.begin(), keys.end());
+
+    runner.run("StableSet/insert", make_name("colt::StableSet", count), count, [&]()
+      {
+        StableSet<u64> set;
+        for (auto key : keys)
+          set.insert(key);
+        DoNotOptimize(set.get_size());
+      });
+    runner.run("StableSet/insert", make_name("std::unordered_set", count), count, [&]()
+      {
+        std::unordered_set<u64> set;
+        for (auto key : keys)
+          set.insert(key);
+        DoNotOptimize(set.size());
+      });
+  }
+}
+
+COLT_BENCH_SUITE(SetMembership)
+{
+  for (size_t count : { 1024, 16384, 262144 })
+  {
+    const std::vector<u64> keys = make_keys(count, 4);
+    const std::vector<u64> missing = make_keys(count, 5);
+
+    HashSet<u64> hash_set = HashSet<u64>{ map_capacity_for(count, 0.7f), 0.7f };
+    StableSet<u64> stable_set = StableSet<u64>{ map_capacity_for(count, 0.7f), 0.7f };
+    std::unordered_set<u64> std_set;
+    std_set.max_load_factor(0.7f);
+    std_set.reserve(count);
+    for (auto key : keys)
+    {
+      hash_set.insert(key);
+      stable_set.insert(key);
+      std_set.insert(key);
+    }
+
+    runner.run("SetMembership/hit", make_name("colt::HashSet", count), count, [&]()
+      {
+        size_t found = 0;
+        for (auto key : keys)
+          found += hash_set.contains(key);
+        DoNotOptimize(found);
+      });
+    runner.run("SetMembership/hit", make_name("colt::StableSet", count), count, [&]()
+      {
+        size_t found = 0;
+        for (auto key : keys)
+          found += stable_set.contains(key);
+        DoNotOptimize(found);
+      });
+    runner.run("SetMembership/hit", make_name("std::unordered_set", count), count, [&]()
+      {
+        size_t found = 0;
+        for (auto key : keys)
+          found += std_set.count(key);
+        DoNotOptimize(found);
+      });
+    runner.run("SetMembership/miss", make_name("colt::HashSet", count), count, [&]()
+      {
+        size_t found = 0;
+        for (auto key : missing)
+          found += hash_set.contains(key);
+        DoNotOptimize(found);
+      });
+    runner.run("SetMembership/miss", make_name("colt::StableSet", count), count, [&]()
+      {
+        size_t found = 0;
+        for (auto key : missing)
+          found += stable_set.contains(key);
+        DoNotOptimize(found);
+      });
+    runner.run("SetMembership/miss", make_name("std::unordered_set", count), count, [&]()
+      {
+        size_t found = 0;
+        for (auto key : missing)
+          found += std_set.count(key);
+        DoNotOptimize(found);
+      });
+  }
+}
+
+COLT_BENCH_SUITE(FlatList)
+{
+  for (size_t count : { 64, 4096, 262144 })
+  {
+    runner.run("FlatList/push_back", make_name("colt::FlatList<16>", count), count, [count]()
+      {
+        FlatList<u64, 16> list;
+        for (size_t i = 0; i < count; i++)
+          list.push_back(i);
+        DoNotOptimize(list.get_size());
+      });
+    runner.run("FlatList/push_back", make_name("std::list", count), count, [count]()
+      {
+        std::list<u64> list;
+        for (size_t i = 0; i < count; i++)
+          list.push_back(i);
+        DoNotOptimize(list.size());
+      });
+    runner.run("FlatList/push_back", make_name("std::deque", count), count, [count]()
+      {
+        std::deque<u64> list;
+        for (size_t i = 0; i < count; i++)
+          list.push_back(i);
+        DoNotOptimize(list.size());
+      });
+
+    FlatList<u64, 16> colt_list;
+    std::list<u64> std_list;
+    std::deque<u64> std_deque;
+    for (size_t i = 0; i < count; i++)
+    {
+      colt_list.push_back(i);
+      std_list.push_back(i);
+      std_deque.push_back(i);
+    }
+    runner.run("FlatList/iterate", make_name("colt::FlatList<16>", count), count, [&]()
+      {
+        u64 sum = 0;
+        for (auto i : colt_list)
+          sum += i;
+        DoNotOptimize(sum);
+      });
+    runner.run("FlatList/iterate", make_name("std::list", count), count, [&]()
+      {
+        u64 sum = 0;
+        for (auto i : std_list)
+          sum += i;
+        DoNotOptimize(sum);
+      });
+    runner.run("FlatList/iterate", make_name("std::deque", count), count, [&]()
+      {
+        u64 sum = 0;
+        for (auto i : std_deque)
+          sum += i;
+        DoNotOptimize(sum);
+      });
+  }
+}
@@ -0,0 +1,64 @@
+#include <string>
+#include <vector>
+#include <filesystem>
+
+#include "colt/utility/FileLoader.h"
+
+#include "Benchmark.h"
+
+using namespace colt;
+using namespace colt::bench;
+
+COLT_BENCH_SUITE(Files)
+{
+  //Small source-like files: the page cache is warm after the first repetition,
+  //which measures the cost of the system calls rather than the one of the disk.
+  constexpr size_t count = 2048;
+  constexpr size_t file_size = 4096;
+
+  std::error_code error;
+  const auto directory = std::filesystem::temp_directory_path(error) / "colt_files_bench";
+  std::filesystem::create_directories(directory, error);
+  if (error)
+    return;
+
+  std::vector<std::string> names;
+  const std::string content(file_size, 'x');
+  for (size_t i = 0; i < count; i++)
+  {
+    names.push_back((directory / ("file" + std::to_string(i) + ".txt")).string());
+    if (FILE* file = std::fopen(names.back().c_str(), "wb"))
+    {
+      std::fwrite(content.data(), 1, content.size(), file);
+      std::fclose(file);
+    }
+  }
+  std::vector<StringView> paths;
+  for (const auto& name : names)
+    paths.push_back(StringView{ name.data(), name.data() + name.size() });
+  const ContiguousView<StringView> view = { paths.data(), paths.size() };
+
+  runner.run("Files/load", make_name("String::getFileContent", count), count, [&]()
+    {
+      size_t total = 0;
+      for (const auto& name : names)
+        total += String::getFileContent(name.c_str())->get_size();
+      DoNotOptimize(total);
+    });
+  runner.run("Files/load", make_name("threads", count), count, [&]()
+    {
+      Vector<Expected<String, StringError>> results = Vector<Expected<String, StringError>>(count, InPlace);
+      colt::details::load_files_threaded(view, results, get_default_thread_count() * 4);
+      DoNotOptimize(results.get_data());
+    });
+#ifdef COLT_DETAILS_FILE_LOADER_IO_URING
+  runner.run("Files/load", make_name("io_uring", count), count, [&]()
+    {
+      Vector<Expected<String, StringError>> results = Vector<Expected<String, StringError>>(count, InPlace);
+      colt::details::load_files_io_uring(view, results, 64);
+      DoNotOptimize(results.get_data());
+    });
+#endif
+
+  std::filesystem::remove_all(directory, error);
+}
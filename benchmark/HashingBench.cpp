@@ -0,0 +1,82 @@
+#include <string>
+#include <string_view>
+
+#include "colt/data_structs/String.h"
+#include "colt/utility/Hash.h"
+
+#include "Benchmark.h"
+
+using namespace colt;
+using namespace colt::bench;
+
+COLT_BENCH_SUITE(Hashing)
+{
+  for (size_t length : { 8, 64, 1024 })
+  {
+    //Hash 64 different strings so that the results cannot be cached
+    constexpr size_t STRING_COUNT = 64;
+    std::string storage;
+    storage.reserve(STRING_COUNT * length);
+    for (size_t i = 0; i < STRING_COUNT * length; i++)
+      storage.push_back(static_cast<char>('a' + (i * 7 + i / length) % 26));
+
+    runner.run("Hashing/string", make_name("colt::GetHash", length), STRING_COUNT, [&]()
+      {
+        size_t seed = 0;
+        for (size_t i = 0; i < STRING_COUNT; i++)
+        {
+          const char* begin = storage.data() + i * length;
+          seed ^= GetHash(StringView{ begin, begin + length });
+        }
+        DoNotOptimize(seed);
+      });
+    runner.run("Hashing/string", make_name("colt::SeededHash", length), STRING_COUNT, [&]()
+      {
+        const SeededHash hasher = SeededHash{ 1, 2 };
+        size_t seed = 0;
+        for (size_t i = 0; i < STRING_COUNT; i++)
+        {
+          const char* begin = storage.data() + i * length;
+          seed ^= hasher(StringView{ begin, begin + length });
+        }
+        DoNotOptimize(seed);
+      });
+    runner.run("Hashing/string", make_name("std::hash", length), STRING_COUNT, [&]()
+      {
+        size_t seed = 0;
+        for (size_t i = 0; i < STRING_COUNT; i++)
+          seed ^= std::hash<std::string_view>{}(std::string_view{ storage.data() + i * length, length });
+        DoNotOptimize(seed);
+      });
+  }
+
+  runner.run("Hashing/u64", "colt::GetHash", 1024, []()
+    {
+      size_t seed = 0;
+      for (u64 i = 0; i < 1024; i++)
+        seed ^= GetHash(i);
+      DoNotOptimize(seed);
+    });
+  runner.run("Hashing/u64", "colt::FastIntHash", 1024, []()
+    {
+      size_t seed = 0;
+      for (u64 i = 0; i < 1024; i++)
+        seed ^= FastIntHash{}(i);
+      DoNotOptimize(seed);
+    });
+  runner.run("Hashing/u64", "colt::SeededHash", 1024, []()
+    {
+      const SeededHash hasher = SeededHash{ 1, 2 };
+      size_t seed = 0;
+      for (u64 i = 0; i < 1024; i++)
+        seed ^= hasher(i);
+      DoNotOptimize(seed);
+    });
+  runner.run("Hashing/u64", "std::hash", 1024, []()
+    {
+      size_t seed = 0;
+      for (u64 i = 0; i < 1024; i++)
+        seed ^= std::hash<u64>{}(i);
+      DoNotOptimize(seed);
+    });
+}
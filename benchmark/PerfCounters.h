@@ -0,0 +1,256 @@
+/** @file PerfCounters.h
+* Contains PerfCounters, a group of hardware performance counters read
+* through the Linux 'perf_event_open' system call.
+* The counters only measure the current thread in user space, so that
+* they can be opened with the default 'perf_event_paranoid' setting.
+* Counters that cannot be opened (in containers, virtual machines or
+* on other operating systems) are skipped: if none can be opened, the
+* group is not available and the benchmarks only report their timings.
+*/
+
+#ifndef HG_COLT_PERF_COUNTERS
+#define HG_COLT_PERF_COUNTERS
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__linux__)
+  #include <unistd.h>
+  #include <sys/ioctl.h>
+  #include <sys/syscall.h>
+  #include <linux/perf_event.h>
+#endif
+
+namespace colt::bench
+{
+  /// @brief The hardware events that can be measured
+  enum class PerfEvent
+  {
+    /// @brief CPU cycles
+    CYCLES,
+    /// @brief Retired instructions
+    INSTRUCTIONS,
+    /// @brief L1 data cache read misses
+    L1D_MISSES,
+    /// @brief Last level cache misses
+    LLC_MISSES,
+    /// @brief Mispredicted branches
+    BRANCH_MISSES,
+    /// @brief Data TLB read misses
+    DTLB_MISSES,
+    /// @brief The count of events (not an event)
+    EVENT_COUNT
+  };
+
+  /// @brief Returns the name of an event, as used in the results
+  /// @param event The event
+  /// @return The name of the event
+  constexpr const char* get_perf_event_name(PerfEvent event) noexcept
+  {
+    switch (event)
+    {
+    case PerfEvent::CYCLES: return "cycles";
+    case PerfEvent::INSTRUCTIONS: return "instructions";
+    case PerfEvent::L1D_MISSES: return "l1d_misses";
+    case PerfEvent::LLC_MISSES: return "llc_misses";
+    case PerfEvent::BRANCH_MISSES: return "branch_misses";
+    case PerfEvent::DTLB_MISSES: return "dtlb_misses";
+    default: return "unknown";
+    }
+  }
+
+  /// @brief The values read from a PerfCounters group
+  struct PerfValues
+  {
+    /// @brief The value of each event (scaled if the counters were multiplexed)
+    double values[static_cast<size_t>(PerfEvent::EVENT_COUNT)] = {};
+    /// @brief True for each event whose counter is open and ran (was scheduled)
+    bool is_valid[static_cast<size_t>(PerfEvent::EVENT_COUNT)] = {};
+
+    /// @brief Adds the values of another measurement
+    /// @param other The values to add
+    void add(const PerfValues& other) noexcept
+    {
+      for (size_t i = 0; i < static_cast<size_t>(PerfEvent::EVENT_COUNT); i++)
+      {
+        values[i] += other.values[i];
+        is_valid[i] = other.is_valid[i];
+      }
+    }
+  };
+
+  /// @brief Group of hardware performance counters of the current thread.
+  /// All the counters are started and stopped together.
+  class PerfCounters
+  {
+    /// @brief The file descriptor of each event (or -1 if not open)
+    int fds[static_cast<size_t>(PerfEvent::EVENT_COUNT)];
+    /// @brief The file descriptor of the group leader (or -1)
+    int leader = -1;
+    /// @brief The count of open counters
+    size_t open_count = 0;
+
+  public:
+    /// @brief Opens all the counters that are supported
+    PerfCounters() noexcept;
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    /// @brief Closes all the open counters
+    ~PerfCounters() noexcept;
+
+    /// @brief Check if at least one counter could be opened
+    /// @return True if the counters can be used
+    bool is_available() const noexcept { return leader != -1; }
+
+    /// @brief Check if the counter of an event could be opened
+    /// @param event The event to check for
+    /// @return True if the event is measured
+    bool is_available(PerfEvent event) const noexcept { return fds[static_cast<size_t>(event)] != -1; }
+
+    /// @brief Resets the counters to 0 and starts counting
+    void start() noexcept;
+
+    /// @brief Stops counting
+    void stop() noexcept;
+
+    /// @brief Reads the current values of the counters
+    /// @return The values (all invalid if not available)
+    PerfValues read() const noexcept;
+  };
+
+#if defined(__linux__)
+  namespace details
+  {
+    /// @brief Opens a counter of the current thread in user space
+    /// @param type The type of the event (PERF_TYPE_*)
+    /// @param config The configuration of the event
+    /// @param group_fd The file descriptor of the group leader, or -1 to create a group
+    /// @return The file descriptor of the counter, or -1 on failure
+    inline int open_perf_event(uint32_t type, uint64_t config, int group_fd) noexcept
+    {
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = type;
+      attr.config = config;
+      attr.disabled = group_fd == -1 ? 1 : 0;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+      return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0));
+    }
+
+    /// @brief Returns the configuration of a hardware cache read miss event
+    /// @param cache The cache (PERF_COUNT_HW_CACHE_*)
+    /// @return The configuration
+    constexpr uint64_t cache_read_miss(uint64_t cache) noexcept
+    {
+      return cache
+        | (uint64_t(PERF_COUNT_HW_CACHE_OP_READ) << 8)
+        | (uint64_t(PERF_COUNT_HW_CACHE_RESULT_MISS) << 16);
+    }
+  }
+
+  inline PerfCounters::PerfCounters() noexcept
+  {
+    struct EventConfig
+    {
+      uint32_t type;
+      uint64_t config;
+    };
+    //In the order of PerfEvent
+    const EventConfig configs[static_cast<size_t>(PerfEvent::EVENT_COUNT)] = {
+      { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+      { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+      { PERF_TYPE_HW_CACHE, details::cache_read_miss(PERF_COUNT_HW_CACHE_L1D) },
+      { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+      { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+      { PERF_TYPE_HW_CACHE, details::cache_read_miss(PERF_COUNT_HW_CACHE_DTLB) },
+    };
+    for (size_t i = 0; i < static_cast<size_t>(PerfEvent::EVENT_COUNT); i++)
+    {
+      //The first counter that can be opened becomes the leader
+      fds[i] = details::open_perf_event(configs[i].type, configs[i].config, leader);
+      if (fds[i] == -1)
+        continue;
+      if (leader == -1)
+        leader = fds[i];
+      ++open_count;
+    }
+  }
+
+  inline PerfCounters::~PerfCounters() noexcept
+  {
+    for (int fd : fds)
+    {
+      if (fd != -1)
+        close(fd);
+    }
+  }
+
+  inline void PerfCounters::start() noexcept
+  {
+    if (leader == -1)
+      return;
+    ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  }
+
+  inline void PerfCounters::stop() noexcept
+  {
+    if (leader == -1)
+      return;
+    ioctl(leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+  }
+
+  inline PerfValues PerfCounters::read() const noexcept
+  {
+    PerfValues result;
+    if (leader == -1)
+      return result;
+
+    //Layout of PERF_FORMAT_GROUP: count, time enabled, time running, then the values
+    uint64_t buffer[3 + static_cast<size_t>(PerfEvent::EVENT_COUNT)] = {};
+    const ssize_t expected = static_cast<ssize_t>((3 + open_count) * sizeof(uint64_t));
+    if (::read(leader, buffer, sizeof(buffer)) != expected)
+      return result;
+
+    //If the counters were multiplexed, extrapolate to the whole duration
+    const uint64_t time_enabled = buffer[1];
+    const uint64_t time_running = buffer[2];
+    //The counters never ran (not scheduled on the PMU): no value can be extrapolated
+    if (time_running == 0)
+      return result;
+    const double scale = static_cast<double>(time_enabled) / static_cast<double>(time_running);
+
+    //The values are in the order the counters were opened
+    size_t value_index = 3;
+    for (size_t i = 0; i < static_cast<size_t>(PerfEvent::EVENT_COUNT); i++)
+    {
+      if (fds[i] == -1)
+        continue;
+      result.values[i] = static_cast<double>(buffer[value_index++]) * scale;
+      result.is_valid[i] = true;
+    }
+    return result;
+  }
+#else
+  inline PerfCounters::PerfCounters() noexcept
+  {
+    for (int& fd : fds)
+      fd = -1;
+  }
+
+  inline PerfCounters::~PerfCounters() noexcept {}
+
+  inline void PerfCounters::start() noexcept {}
+
+  inline void PerfCounters::stop() noexcept {}
+
+  inline PerfValues PerfCounters::read() const noexcept { return {}; }
+#endif
+}
+
+#endif //!HG_COLT_PERF_COUNTERS
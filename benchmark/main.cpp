@@ -0,0 +1,81 @@
+#include <cstdlib>
+
+#include "Benchmark.h"
+
+using namespace colt::bench;
+
+/// @brief Prints the usage of colt_bench
+static void print_usage() noexcept
+{
+  std::fputs(
+    "Usage: colt_bench [options]\n"
+    "  --filter <str>       Only run benchmarks whose 'group/name' contains <str>\n"
+    "  --json <path>        Write the results as JSON to <path> ('-' for stdout)\n"
+    "  --repetitions <n>    Count of measured repetitions (default 15)\n"
+    "  --warmup <n>         Count of warmup repetitions (default 2)\n"
+    "  --min-time-ms <ms>   Minimum duration of a repetition (default 5)\n"
+    "  --max-threads <n>    Maximum count of threads of multi-threaded benchmarks (default: nproc)\n"
+    "  --perf               Report hardware performance counters per operation (Linux)\n"
+    "  --list               List the registered suites\n", stdout);
+}
+
+int main(int argc, char** argv)
+{
+  Options options;
+  const char* json_path = nullptr;
+
+  for (int i = 1; i < argc; i++)
+  {
+    const char* arg = argv[i];
+    const bool has_value = i + 1 < argc;
+    if (std::strcmp(arg, "--filter") == 0 && has_value)
+      options.filter = argv[++i];
+    else if (std::strcmp(arg, "--json") == 0 && has_value)
+      json_path = argv[++i];
+    else if (std::strcmp(arg, "--repetitions") == 0 && has_value)
+      options.repetitions = std::strtoull(argv[++i], nullptr, 10);
+    else if (std::strcmp(arg, "--warmup") == 0 && has_value)
+      options.warmup = std::strtoull(argv[++i], nullptr, 10);
+    else if (std::strcmp(arg, "--min-time-ms") == 0 && has_value)
+      options.min_time_ms = std::strtod(argv[++i], nullptr);
+    else if (std::strcmp(arg, "--max-threads") == 0 && has_value)
+      options.max_threads = std::strtoull(argv[++i], nullptr, 10);
+    else if (std::strcmp(arg, "--perf") == 0)
+      options.perf_counters = true;
+    else if (std::strcmp(arg, "--list") == 0)
+    {
+      for (auto& [name, fn] : get_suites())
+        std::printf("%s\n", name);
+      return EXIT_SUCCESS;
+    }
+    else
+    {
+      print_usage();
+      return std::strcmp(arg, "--help") == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+  }
+  if (options.repetitions == 0)
+    options.repetitions = 1;
+  if (options.max_threads == 0)
+    options.max_threads = 1;
+
+  Runner runner = Runner{ options };
+  for (auto& [name, fn] : get_suites())
+    fn(runner);
+
+  if (json_path != nullptr)
+  {
+    if (std::strcmp(json_path, "-") == 0)
+      runner.write_json(stdout);
+    else if (FILE* file = std::fopen(json_path, "w"))
+    {
+      runner.write_json(file);
+      std::fclose(file);
+    }
+    else
+    {
+      std::fprintf(stderr, "Could not open '%s'!\n", json_path);
+      return EXIT_FAILURE;
+    }
+  }
+}
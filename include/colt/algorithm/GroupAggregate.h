@@ -0,0 +1,325 @@
+/** @file GroupAggregate.h
+* Contains 'group_aggregate', which groups rows by key and aggregates a column
+* of values per group (sum, count, min, max...).
+* Each thread aggregates a range of the rows in its own table (a Map from the
+* keys to the states of the aggregators of their group). The keys of a batch of rows are hashed then
+* their slots prefetched before any of them is looked up, which overlaps the cache
+* misses of the table. The tables of the threads are then merged on multiple threads:
+* each thread merges the groups whose hash falls in its partition.
+* The results are returned as columns: the keys of the groups, and one Vector per aggregator.
+*/
+
+#ifndef HG_COLT_GROUP_AGGREGATE
+#define HG_COLT_GROUP_AGGREGATE
+
+#include <tuple>
+#include <utility>
+
+#include "../data_structs/Map.h"
+
+namespace colt::algo
+{
+  /// @brief Aggregator computing the sum of the values of a group.
+  /// Integers are summed as 64-bit integers, floating points as double.
+  struct Sum
+  {
+    template<typename T>
+    /// @brief The state of a group
+    using state_t = std::conditional_t<std::is_floating_point_v<T>, double,
+      std::conditional_t<std::is_signed_v<T>, i64, u64>>;
+
+    template<typename T>
+    /// @brief Returns the state of a group whose first value is 'value'
+    static constexpr state_t<T> init(T value) noexcept { return static_cast<state_t<T>>(value); }
+    template<typename T>
+    /// @brief Adds 'value' to the state of a group
+    static constexpr void update(state_t<T>& state, T value) noexcept { state += static_cast<state_t<T>>(value); }
+    template<typename T>
+    /// @brief Merges the state of the same group computed by another thread
+    static constexpr void merge(state_t<T>& state, state_t<T> other) noexcept { state += other; }
+  };
+
+  /// @brief Aggregator computing the count of rows of a group
+  struct Count
+  {
+    template<typename T>
+    /// @brief The state of a group
+    using state_t = u64;
+
+    template<typename T>
+    /// @brief Returns the state of a group whose first value is 'value'
+    static constexpr u64 init(T) noexcept { return 1; }
+    template<typename T>
+    /// @brief Adds 'value' to the state of a group
+    static constexpr void update(u64& state, T) noexcept { ++state; }
+    template<typename T>
+    /// @brief Merges the state of the same group computed by another thread
+    static constexpr void merge(u64& state, u64 other) noexcept { state += other; }
+  };
+
+  /// @brief Aggregator computing the minimum of the values of a group
+  struct Min
+  {
+    template<typename T>
+    /// @brief The state of a group
+    using state_t = T;
+
+    template<typename T>
+    /// @brief Returns the state of a group whose first value is 'value'
+    static constexpr T init(T value) noexcept { return value; }
+    template<typename T>
+    /// @brief Adds 'value' to the state of a group
+    static constexpr void update(T& state, T value) noexcept { state = value < state ? value : state; }
+    template<typename T>
+    /// @brief Merges the state of the same group computed by another thread
+    static constexpr void merge(T& state, T other) noexcept { update(state, other); }
+  };
+
+  /// @brief Aggregator computing the maximum of the values of a group
+  struct Max
+  {
+    template<typename T>
+    /// @brief The state of a group
+    using state_t = T;
+
+    template<typename T>
+    /// @brief Returns the state of a group whose first value is 'value'
+    static constexpr T init(T value) noexcept { return value; }
+    template<typename T>
+    /// @brief Adds 'value' to the state of a group
+    static constexpr void update(T& state, T value) noexcept { state = state < value ? value : state; }
+    template<typename T>
+    /// @brief Merges the state of the same group computed by another thread
+    static constexpr void merge(T& state, T other) noexcept { update(state, other); }
+  };
+
+  template<typename Key, typename Value, typename... Aggregators>
+  /// @brief The groups computed by 'group_aggregate', as columns.
+  /// Row 'i' of each column is the group of key 'keys[i]'.
+  /// @tparam Key The key type
+  /// @tparam Value The type of the aggregated values
+  /// @tparam ...Aggregators The aggregators
+  struct GroupAggregateResult
+  {
+    /// @brief The key of each group
+    Vector<Key> keys = {};
+    /// @brief The state of each group, for each aggregator
+    std::tuple<Vector<typename Aggregators::template state_t<Value>>...> columns = {};
+
+    template<size_t index>
+    /// @brief Returns the column of an aggregator
+    /// @tparam index The index of the aggregator
+    /// @return The state of each group
+    const auto& get_column() const noexcept { return std::get<index>(columns); }
+
+    /// @brief Returns the count of groups
+    /// @return The count of groups
+    size_t get_size() const noexcept { return keys.get_size(); }
+  };
+
+  namespace details
+  {
+    /// @brief The count of rows hashed and prefetched at once
+    static constexpr size_t GROUP_AGGREGATE_BATCH = 16;
+
+    /// @brief Returns the partition of a group during the merge.
+    /// The partition uses the high bits of the hash. The Map finds the slot of a key
+    /// from 'hash % capacity', which depends on all the bits of the hash, so the groups
+    /// of a partition are still spread over all the slots of its table.
+    /// @param key_hash The hash of the key of the group
+    /// @param partition_count The count of partitions
+    /// @return The partition in [0, partition_count)
+    constexpr size_t group_partition(size_t key_hash, size_t partition_count) noexcept
+    {
+      return (key_hash >> (sizeof(size_t) * 4)) % partition_count;
+    }
+
+    template<typename Value, typename... Aggregators>
+    /// @brief The states of the aggregators of a group, stored in the slot of its key
+    using GroupStates = std::tuple<typename Aggregators::template state_t<Value>...>;
+
+    /// @brief Returns the capacity of a table of groups that can contain 'group_count' groups without reallocating
+    /// @param group_count The expected count of groups (0 if unknown)
+    /// @return The capacity of the table
+    constexpr size_t group_table_capacity(size_t group_count) noexcept
+    {
+      return static_cast<size_t>(static_cast<double>(group_count) / 0.70) + 16;
+    }
+
+    template<typename Table>
+    /// @brief Grows a table of groups (by doubling) so that 'count' keys can be inserted without reallocating.
+    /// A Map only grows by 16 slots at a time on insertion, and the prefetched slots
+    /// of a batch must not move.
+    /// @param table The table
+    /// @param count The count of keys that will be inserted
+    void reserve_groups(Table& table, size_t count) noexcept
+    {
+      const size_t capacity = table.get_capacity();
+      if (static_cast<float>(table.get_size() + count) > table.get_load_factor() * capacity)
+        table.reserve(capacity * 2 + count);
+    }
+
+    template<typename... Aggregators, typename Key, typename Value, typename Table, size_t... I>
+    /// @brief Aggregates rows into a table from the keys to the states of their group
+    /// @param keys The keys of the rows
+    /// @param values The values of the rows
+    /// @param table The table of the groups
+    void aggregate_rows(ContiguousView<Key> keys, ContiguousView<Value> values, Table& table, std::index_sequence<I...>) noexcept
+    {
+      using States = GroupStates<Value, Aggregators...>;
+
+      const auto& hasher = table.get_hasher();
+      size_t hashes[GROUP_AGGREGATE_BATCH];
+      for (size_t batch = 0; batch < keys.get_size(); batch += GROUP_AGGREGATE_BATCH)
+      {
+        const size_t count = keys.get_size() - batch < GROUP_AGGREGATE_BATCH ? keys.get_size() - batch : GROUP_AGGREGATE_BATCH;
+        reserve_groups(table, count);
+        for (size_t i = 0; i < count; i++)
+        {
+          hashes[i] = hasher(keys[batch + i]);
+          table.prefetch(hashes[i]);
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+          //Most rows belong to an existing group: finding is cheaper than inserting
+          const Value value = values[batch + i];
+          if (auto slot = table.find_hashed(keys[batch + i], hashes[i]))
+            (Aggregators::update(std::get<I>(slot->second), value), ...);
+          else
+            table.insert_hashed(keys[batch + i], hashes[i], States{ Aggregators::init(value)... });
+        }
+      }
+    }
+
+    template<typename Value, typename... Aggregators, typename Table, size_t... I>
+    /// @brief Merges the groups of a partition of the tables of each thread
+    /// @param partials The tables of each thread
+    /// @param partition The partition to merge
+    /// @param partition_count The count of partitions
+    /// @param table The merged table of the partition
+    void merge_partition(const Vector<Table>& partials, size_t partition, size_t partition_count,
+      Table& table, std::index_sequence<I...>) noexcept
+    {
+      const auto& hasher = table.get_hasher();
+      for (auto& partial : partials)
+      {
+        for (auto& group : partial)
+        {
+          const size_t key_hash = hasher(group.first);
+          if (group_partition(key_hash, partition_count) != partition)
+            continue;
+          reserve_groups(table, 1);
+          auto [slot, result] = table.insert_hashed(group.first, key_hash, group.second);
+          if (result == InsertionResult::EXISTS)
+            (Aggregators::template merge<Value>(std::get<I>(slot->second), std::get<I>(group.second)), ...);
+        }
+      }
+    }
+
+    template<typename Key, typename Value, typename... Aggregators, typename Table, size_t... I>
+    /// @brief Appends the groups of a table to the columns of the result
+    /// @param result The result to append to
+    /// @param table The table of the groups
+    void append_groups(GroupAggregateResult<Key, Value, Aggregators...>& result, const Table& table,
+      std::index_sequence<I...>) noexcept
+    {
+      if (table.is_empty())
+        return;
+      result.keys.reserve(table.get_size());
+      (std::get<I>(result.columns).reserve(table.get_size()), ...);
+      for (auto& group : table)
+      {
+        result.keys.push_back(group.first);
+        (std::get<I>(result.columns).push_back(std::get<I>(group.second)), ...);
+      }
+    }
+  }
+
+  /// @brief The count of rows from which 'group_aggregate' uses multiple threads by default
+  static constexpr size_t GROUP_AGGREGATE_PARALLEL_THRESHOLD = 1 << 16;
+
+  /// @brief Options of 'group_aggregate'
+  struct GroupAggregateOptions
+  {
+    /// @brief The count of threads (0 for the default count)
+    size_t thread_count = 0;
+    /// @brief The expected count of groups, used to size the tables (0 if unknown).
+    /// Without it, the tables double in size as groups are found, which rehashes them.
+    size_t group_count_hint = 0;
+  };
+
+  template<typename Hasher, typename KeyEqual, typename Key, typename Value, typename... Aggregators>
+  /// @brief Groups rows by key and aggregates the values of each group, on multiple threads.
+  /// Example: 'group_aggregate<DefaultHash<u64>, DefaultEqual<u64>>({ 4 }, keys, values, Sum{}, Max{})'.
+  /// The groups are in no particular order.
+  /// @tparam Hasher The hash function of the keys
+  /// @tparam KeyEqual The equality comparison of the keys
+  /// @tparam ...Aggregators The aggregators (Sum, Count, Min, Max or any type providing the same functions)
+  /// @param options The count of threads and the expected count of groups
+  /// @param keys The key of each row
+  /// @param values The value of each row (of the same size as 'keys')
+  /// @param ... The aggregators, whose column is in the same order in the result
+  /// @return The key of each group and the state of each aggregator for that group
+  GroupAggregateResult<Key, Value, Aggregators...> group_aggregate(const GroupAggregateOptions& options,
+    ContiguousView<Key> keys, ContiguousView<Value> values, Aggregators...) noexcept
+  {
+    assert(keys.get_size() == values.get_size() && "The count of keys and values must be the same!");
+    using Table = Map<Key, details::GroupStates<Value, Aggregators...>, Hasher, KeyEqual>;
+    constexpr auto INDICES = std::index_sequence_for<Aggregators...>{};
+
+    size_t thread_count = options.thread_count == 0 ? get_default_thread_count() : options.thread_count;
+    //Each thread should aggregate at least a batch of rows
+    const size_t max_threads = (keys.get_size() + details::GROUP_AGGREGATE_BATCH - 1) / details::GROUP_AGGREGATE_BATCH;
+    thread_count = thread_count < max_threads ? thread_count : max_threads;
+
+    GroupAggregateResult<Key, Value, Aggregators...> result;
+    if (thread_count <= 1)
+    {
+      Table table = Table(details::group_table_capacity(options.group_count_hint));
+      details::aggregate_rows<Aggregators...>(keys, values, table, INDICES);
+      details::append_groups(result, table, INDICES);
+      return result;
+    }
+
+    //A thread cannot find more groups than it has rows
+    const size_t chunk_size = (keys.get_size() + thread_count - 1) / thread_count;
+    const size_t partial_groups = options.group_count_hint < chunk_size ? options.group_count_hint : chunk_size;
+    Vector<Table> partials = Vector<Table>(thread_count, InPlace, details::group_table_capacity(partial_groups));
+    parallel_for_threads(thread_count, [&](size_t thread)
+      {
+        const size_t begin = thread * chunk_size < keys.get_size() ? thread * chunk_size : keys.get_size();
+        const size_t end = begin + chunk_size < keys.get_size() ? begin + chunk_size : keys.get_size();
+        details::aggregate_rows<Aggregators...>(ContiguousView<Key>{ keys.get_data() + begin, end - begin },
+          ContiguousView<Value>{ values.get_data() + begin, end - begin }, partials[thread], INDICES);
+      });
+
+    Vector<Table> merged = Vector<Table>(thread_count, InPlace, details::group_table_capacity(options.group_count_hint / thread_count));
+    parallel_for_threads(thread_count, [&](size_t partition)
+      {
+        details::merge_partition<Value, Aggregators...>(partials, partition, thread_count, merged[partition], INDICES);
+      });
+    for (auto& table : merged)
+      details::append_groups(result, table, INDICES);
+    return result;
+  }
+
+  template<typename Key, typename Value, typename... Aggregators>
+  /// @brief Groups rows by key and aggregates the values of each group.
+  /// Example: 'group_aggregate(keys, values, Sum{}, Count{})'.
+  /// Multiple threads are used if there are at least GROUP_AGGREGATE_PARALLEL_THRESHOLD rows.
+  /// The groups are in no particular order.
+  /// @tparam ...Aggregators The aggregators (Sum, Count, Min, Max or any type providing the same functions)
+  /// @param keys The key of each row
+  /// @param values The value of each row (of the same size as 'keys')
+  /// @param ...aggregators The aggregators, whose column is in the same order in the result
+  /// @return The key of each group and the state of each aggregator for that group
+  GroupAggregateResult<Key, Value, Aggregators...> group_aggregate(ContiguousView<Key> keys,
+    ContiguousView<Value> values, Aggregators... aggregators) noexcept
+  {
+    GroupAggregateOptions options;
+    options.thread_count = keys.get_size() < GROUP_AGGREGATE_PARALLEL_THRESHOLD ? 1 : 0;
+    return group_aggregate<DefaultHash<Key>, DefaultEqual<Key>>(options, keys, values, aggregators...);
+  }
+}
+
+#endif //!HG_COLT_GROUP_AGGREGATE
@@ -0,0 +1,268 @@
+/** @file HashJoin.h
+* Contains 'hash_join', which finds the pairs of rows of two columns of integer
+* keys whose keys are equal.
+* A join through a single hash table larger than the cache misses the cache on
+* nearly every row. Instead, both columns are first partitioned by the high bits
+* of the hash of their keys (a radix partitioning), so that the keys of a partition
+* of the build column fit in the cache. Each partition is then joined through its
+* own IntMap, and the partitions are joined on multiple threads.
+* The partitioning writes the rows through a buffer of a cache line's worth of rows
+* per partition: the rows are copied to their partition a line's worth at a time,
+* which keeps the count of cache lines (and pages) written to at once small.
+* Neither the buffers nor the partitions are aligned to cache lines, so a copy
+* may span two lines.
+*/
+
+#ifndef HG_COLT_HASH_JOIN
+#define HG_COLT_HASH_JOIN
+
+#include <atomic>
+#include <utility>
+
+#include "../data_structs/IntMap.h"
+#include "../details/bits.h"
+#include "../utility/Parallel.h"
+
+namespace colt::algo
+{
+  namespace details
+  {
+    template<typename Key>
+    /// @brief A row of a partitioned column
+    /// @tparam Key The key type
+    struct JoinTuple
+    {
+      /// @brief The key of the row
+      Key key;
+      /// @brief The index of the row in the column
+      size_t index;
+    };
+
+    /// @brief The count of rows of the build column per partition (which, with their table, fit in the L2 cache)
+    static constexpr size_t JOIN_PARTITION_ROWS = 8192;
+    /// @brief The maximum count of bits used to partition: more partitions than pages in the TLB are slower to write
+    static constexpr unsigned JOIN_MAX_RADIX_BITS = 11;
+    /// @brief The count of rows of a column partitioned per thread
+    static constexpr size_t JOIN_ROWS_PER_THREAD = 1 << 16;
+    /// @brief Marks the end of the chain of rows of the same key
+    static constexpr size_t JOIN_NO_ROW = static_cast<size_t>(-1);
+
+    /// @brief Returns the count of bits of the hash used to partition a build column
+    /// @param build_size The count of rows of the build column
+    /// @return The count of bits (the count of partitions is '1 << bits')
+    inline unsigned join_radix_bits(size_t build_size) noexcept
+    {
+      const u64 partitions = colt::details::round_up_pow2((build_size + JOIN_PARTITION_ROWS - 1) / JOIN_PARTITION_ROWS);
+      const unsigned bits = colt::details::bit_width(partitions) - 1;
+      return bits < JOIN_MAX_RADIX_BITS ? bits : JOIN_MAX_RADIX_BITS;
+    }
+
+    /// @brief Returns the partition of a key from its hash.
+    /// The partition uses the high bits of the hash, while IntMap uses the low bits for its slots.
+    /// @param key_hash The hash of the key
+    /// @param radix_bits The count of bits used to partition
+    /// @return The partition in [0, 1 << radix_bits)
+    constexpr size_t join_partition(size_t key_hash, unsigned radix_bits) noexcept
+    {
+      return radix_bits == 0 ? 0 : static_cast<size_t>(static_cast<u64>(key_hash) >> (64 - radix_bits));
+    }
+
+    template<typename Key>
+    /// @brief A column whose rows are grouped by partition
+    /// @tparam Key The key type
+    class JoinPartitions
+    {
+      /// @brief The rows, grouped by partition (not initialized on allocation)
+      memory::TypedBlock<JoinTuple<Key>> tuples = {};
+      /// @brief The offset of the first row of each partition, followed by the count of rows
+      Vector<size_t> offsets = {};
+
+    public:
+      /// @brief Allocates the rows of a column
+      /// @param count The count of rows (not 0)
+      /// @param partition_count The count of partitions
+      JoinPartitions(size_t count, size_t partition_count) noexcept
+        : tuples(memory::allocate({ count * sizeof(JoinTuple<Key>) }))
+        , offsets(partition_count + 1, InPlace, static_cast<size_t>(0)) {}
+      /// @brief JoinPartitions cannot be copied
+      JoinPartitions(const JoinPartitions&) = delete;
+      /// @brief JoinPartitions cannot be copied
+      JoinPartitions& operator=(const JoinPartitions&) = delete;
+      /// @brief Frees the rows
+      ~JoinPartitions() noexcept { memory::deallocate(tuples); }
+
+      /// @brief Returns the rows
+      /// @return Pointer to the first row
+      JoinTuple<Key>* get_data() noexcept { return tuples.get_ptr(); }
+      /// @brief Returns the rows
+      /// @return Pointer to the first row
+      const JoinTuple<Key>* get_data() const noexcept { return tuples.get_ptr(); }
+      /// @brief Returns the offsets of the partitions
+      /// @return The offset of the first row of each partition, followed by the count of rows
+      Vector<size_t>& get_offsets() noexcept { return offsets; }
+      /// @brief Returns the offsets of the partitions
+      /// @return The offset of the first row of each partition, followed by the count of rows
+      const Vector<size_t>& get_offsets() const noexcept { return offsets; }
+    };
+
+    template<typename Key, typename Hasher>
+    /// @brief Groups the rows of a column by partition, on multiple threads.
+    /// Each thread counts the rows of each partition in its range of rows, then
+    /// writes them through a buffer of a cache line's worth of rows per partition.
+    /// @param keys The column (not empty)
+    /// @param radix_bits The count of bits used to partition
+    /// @param thread_count The count of threads
+    /// @param hasher The hash function of the keys
+    /// @param partitions The partitioned rows, constructed for 'keys.get_size()' rows and '1 << radix_bits' partitions
+    void radix_partition(ContiguousView<Key> keys, unsigned radix_bits, size_t thread_count,
+      const Hasher& hasher, JoinPartitions<Key>& partitions) noexcept
+    {
+      //The count of rows of a cache line
+      constexpr size_t LINE_TUPLES = 64 / sizeof(JoinTuple<Key>) == 0 ? 1 : 64 / sizeof(JoinTuple<Key>);
+
+      const size_t count = keys.get_size();
+      const size_t partition_count = size_t(1) << radix_bits;
+      const size_t max_threads = (count + JOIN_ROWS_PER_THREAD - 1) / JOIN_ROWS_PER_THREAD;
+      thread_count = thread_count < max_threads ? thread_count : max_threads;
+      const size_t chunk_size = (count + thread_count - 1) / thread_count;
+
+      //The count of rows of each (thread, partition), then the offset where the thread writes them
+      Vector<size_t> counts = Vector<size_t>(thread_count * partition_count, InPlace, static_cast<size_t>(0));
+      parallel_for_threads(thread_count, [&](size_t thread)
+        {
+          const size_t end = (thread + 1) * chunk_size < count ? (thread + 1) * chunk_size : count;
+          size_t* thread_counts = counts.get_data() + thread * partition_count;
+          for (size_t i = thread * chunk_size; i < end; i++)
+            ++thread_counts[join_partition(hasher(keys[i]), radix_bits)];
+        });
+
+      Vector<size_t>& offsets = partitions.get_offsets();
+      size_t total = 0;
+      for (size_t partition = 0; partition < partition_count; partition++)
+      {
+        offsets[partition] = total;
+        for (size_t thread = 0; thread < thread_count; thread++)
+          total += colt::exchange(counts[thread * partition_count + partition], total);
+      }
+      offsets[partition_count] = total;
+
+      parallel_for_threads(thread_count, [&](size_t thread)
+        {
+          const size_t end = (thread + 1) * chunk_size < count ? (thread + 1) * chunk_size : count;
+          size_t* cursors = counts.get_data() + thread * partition_count;
+          Vector<JoinTuple<Key>> buffers = Vector<JoinTuple<Key>>(partition_count * LINE_TUPLES, InPlace);
+          Vector<size_t> fills = Vector<size_t>(partition_count, InPlace, static_cast<size_t>(0));
+          JoinTuple<Key>* out = partitions.get_data();
+          for (size_t i = thread * chunk_size; i < end; i++)
+          {
+            const size_t partition = join_partition(hasher(keys[i]), radix_bits);
+            JoinTuple<Key>* buffer = buffers.get_data() + partition * LINE_TUPLES;
+            buffer[fills[partition]++] = JoinTuple<Key>{ keys[i], i };
+            if (fills[partition] == LINE_TUPLES)
+            {
+              std::memcpy(out + cursors[partition], buffer, LINE_TUPLES * sizeof(JoinTuple<Key>));
+              cursors[partition] += LINE_TUPLES;
+              fills[partition] = 0;
+            }
+          }
+          for (size_t partition = 0; partition < partition_count; partition++)
+            std::memcpy(out + cursors[partition], buffers.get_data() + partition * LINE_TUPLES,
+              fills[partition] * sizeof(JoinTuple<Key>));
+        });
+    }
+  }
+
+  template<typename Key, typename Hasher = FastIntHash>
+  /// @brief Finds the pairs of rows of two columns whose keys are equal (an inner equi-join).
+  /// Both columns are partitioned by the hash of their keys, then each partition of
+  /// 'probe_keys' is looked up in a table of the same partition of 'build_keys'.
+  /// The smaller column should be 'build_keys'.
+  /// The pairs are in no particular order.
+  /// @tparam Key The integer key type
+  /// @tparam Hasher The hash function of the keys (FastIntHash by default)
+  /// @param build_keys The keys of the rows of the build column
+  /// @param probe_keys The keys of the rows of the probe column
+  /// @param thread_count The count of threads (0 for the default count)
+  /// @param hasher The hash function of the keys
+  /// @return The pairs of (index in 'build_keys', index in 'probe_keys') whose keys are equal
+  Vector<std::pair<size_t, size_t>> hash_join(ContiguousView<Key> build_keys, ContiguousView<Key> probe_keys,
+    size_t thread_count = 0, const Hasher& hasher = Hasher{}) noexcept
+  {
+    static_assert(std::is_integral_v<Key>, "hash_join only supports integral keys!");
+    using Tuple = details::JoinTuple<Key>;
+
+    Vector<std::pair<size_t, size_t>> result;
+    if (build_keys.is_empty() || probe_keys.is_empty())
+      return result;
+    thread_count = thread_count == 0 ? get_default_thread_count() : thread_count;
+
+    const unsigned radix_bits = details::join_radix_bits(build_keys.get_size());
+    const size_t partition_count = size_t(1) << radix_bits;
+    details::JoinPartitions<Key> build = { build_keys.get_size(), partition_count };
+    details::JoinPartitions<Key> probe = { probe_keys.get_size(), partition_count };
+    details::radix_partition(build_keys, radix_bits, thread_count, hasher, build);
+    details::radix_partition(probe_keys, radix_bits, thread_count, hasher, probe);
+
+    //The threads take the partitions one at a time from a shared counter
+    thread_count = thread_count < partition_count ? thread_count : partition_count;
+    Vector<Vector<std::pair<size_t, size_t>>> outputs = Vector<Vector<std::pair<size_t, size_t>>>(thread_count, InPlace);
+    std::atomic<size_t> next_partition = 0;
+    parallel_for_threads(thread_count, [&](size_t thread)
+      {
+        //The table maps a key to its last row in the partition, whose rows are chained through 'previous_row'
+        IntMap<Key, size_t, Hasher> table = IntMap<Key, size_t, Hasher>{ details::JOIN_PARTITION_ROWS, 0.70f, hasher };
+        Vector<size_t> previous_row;
+        Vector<std::pair<size_t, size_t>>& output = outputs[thread];
+        for (;;)
+        {
+          const size_t partition = next_partition.fetch_add(1, std::memory_order_relaxed);
+          if (partition >= partition_count)
+            return;
+          const size_t build_begin = build.get_offsets()[partition];
+          const size_t build_size = build.get_offsets()[partition + 1] - build_begin;
+          const size_t probe_begin = probe.get_offsets()[partition];
+          const size_t probe_end = probe.get_offsets()[partition + 1];
+          if (build_size == 0 || probe_begin == probe_end)
+            continue;
+
+          const Tuple* build_rows = build.get_data() + build_begin;
+          table.clear();
+          table.reserve(build_size);
+          previous_row.clear();
+          for (size_t row = 0; row < build_size; row++)
+          {
+            auto [last_row, insertion] = table.insert(build_rows[row].key, row);
+            if (insertion == InsertionResult::EXISTS)
+              previous_row.push_back(colt::exchange(*last_row, row));
+            else
+              previous_row.push_back(details::JOIN_NO_ROW);
+          }
+
+          const Tuple* probe_rows = probe.get_data();
+          for (size_t i = probe_begin; i < probe_end; i++)
+          {
+            const size_t* last_row = table.find(probe_rows[i].key);
+            if (last_row == nullptr)
+              continue;
+            for (size_t row = *last_row; row != details::JOIN_NO_ROW; row = previous_row[row])
+              output.push_back({ build_rows[row].index, probe_rows[i].index });
+          }
+        }
+      });
+
+    if (thread_count == 1)
+      return std::move(outputs[0]);
+    size_t total = 0;
+    for (auto& output : outputs)
+      total += output.get_size();
+    if (total == 0)
+      return result;
+    result.reserve(total);
+    for (auto& output : outputs)
+      for (auto& pair : output)
+        result.push_back(pair);
+    return result;
+  }
+}
+
+#endif //!HG_COLT_HASH_JOIN
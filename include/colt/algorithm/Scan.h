@@ -0,0 +1,107 @@
+/** @file Scan.h
+* Contains 'inclusive_scan' and 'exclusive_scan' (prefix sums), used to compute
+* offsets from counts (CSR layouts, histogram buckets, partitions...).
+* A scalar scan is a chain of dependent additions, which compilers do not vectorize.
+* For 32 and 64-bit integers, the scans compute the prefix sums of a register of
+* values with shifted additions (log2(lanes) steps), then add the carry of the
+* previous register: see 'scan_sequential' in 'details/simd.h'.
+* On multiple threads, the scans run in two passes: each thread sums its range of
+* values, the sums are scanned to obtain the carry of each range, then each thread
+* scans its range starting from its carry.
+*/
+
+#ifndef HG_COLT_SCAN
+#define HG_COLT_SCAN
+
+#include "../details/simd.h"
+#include "../utility/Parallel.h"
+
+namespace colt::algo
+{
+  namespace details
+  {
+    /// @brief The count of values scanned per thread (at least)
+    static constexpr size_t SCAN_ROWS_PER_THREAD = 1 << 16;
+
+    template<bool INCLUSIVE, typename T>
+    /// @brief Scans values, on multiple threads if 'thread_count' is not 1
+    /// @tparam INCLUSIVE If true, 'out[i]' includes 'values[i]', else it does not
+    /// @tparam T The arithmetic type of the values
+    /// @param values The values to scan
+    /// @param out Where to write the scan (can be 'values.get_data()')
+    /// @param init The value added to all the sums
+    /// @param thread_count The count of threads (0 for the default count)
+    /// @return 'init' plus the sum of the values
+    T scan(ContiguousView<T> values, T* out, T init, size_t thread_count) noexcept
+    {
+      static_assert(std::is_arithmetic_v<T>, "Scans only support arithmetic types!");
+      const size_t count = values.get_size();
+      thread_count = thread_count == 0 ? get_default_thread_count() : thread_count;
+      const size_t max_threads = count / SCAN_ROWS_PER_THREAD + 1;
+      thread_count = thread_count < max_threads ? thread_count : max_threads;
+      if (thread_count == 1)
+        return colt::details::scan_sequential<INCLUSIVE>(values.get_data(), count, out, init);
+
+      const size_t chunk_size = (count + thread_count - 1) / thread_count;
+      //The sum of each range, then the carry of each range
+      Vector<T> carries = Vector<T>(thread_count, InPlace, T{});
+      parallel_for_threads(thread_count, [&](size_t thread)
+        {
+          const size_t begin = thread * chunk_size < count ? thread * chunk_size : count;
+          const size_t end = begin + chunk_size < count ? begin + chunk_size : count;
+          T sum = T{};
+          for (size_t i = begin; i < end; i++)
+            sum = static_cast<T>(sum + values[i]);
+          carries[thread] = sum;
+        });
+      const T total = colt::details::scan_sequential<false>(carries.get_data(), thread_count, carries.get_data(), init);
+      parallel_for_threads(thread_count, [&](size_t thread)
+        {
+          const size_t begin = thread * chunk_size < count ? thread * chunk_size : count;
+          const size_t end = begin + chunk_size < count ? begin + chunk_size : count;
+          colt::details::scan_sequential<INCLUSIVE>(values.get_data() + begin, end - begin, out + begin, carries[thread]);
+        });
+      return total;
+    }
+  }
+
+  /// @brief The minimum count of values for which the scans use multiple threads by default
+  static constexpr size_t SCAN_PARALLEL_THRESHOLD = 1 << 20;
+
+  template<typename T>
+  /// @brief Writes the inclusive prefix sums of 'values' to 'out': 'out[i] = init + values[0] + ... + values[i]'.
+  /// The sums of floating point values on multiple threads are not added in the same order
+  /// as on a single thread, and may differ by rounding.
+  /// @tparam T The arithmetic type of the values
+  /// @param values The values to scan
+  /// @param out Where to write the 'values.get_size()' sums (can be 'values.get_data()' to scan in place)
+  /// @param init The value added to all the sums
+  /// @param thread_count The count of threads (0 for the default count, or 1 if there are less than SCAN_PARALLEL_THRESHOLD values)
+  /// @return 'init' plus the sum of all the values
+  T inclusive_scan(ContiguousView<T> values, T* out, T init = T{}, size_t thread_count = 0) noexcept
+  {
+    if (thread_count == 0 && values.get_size() < SCAN_PARALLEL_THRESHOLD)
+      thread_count = 1;
+    return details::scan<true>(values, out, init, thread_count);
+  }
+
+  template<typename T>
+  /// @brief Writes the exclusive prefix sums of 'values' to 'out': 'out[i] = init + values[0] + ... + values[i - 1]'.
+  /// Computes the offsets from counts: the returned total is the offset past the last one.
+  /// The sums of floating point values on multiple threads are not added in the same order
+  /// as on a single thread, and may differ by rounding.
+  /// @tparam T The arithmetic type of the values
+  /// @param values The values to scan
+  /// @param out Where to write the 'values.get_size()' sums (can be 'values.get_data()' to scan in place)
+  /// @param init The value added to all the sums (the first sum)
+  /// @param thread_count The count of threads (0 for the default count, or 1 if there are less than SCAN_PARALLEL_THRESHOLD values)
+  /// @return 'init' plus the sum of all the values
+  T exclusive_scan(ContiguousView<T> values, T* out, T init = T{}, size_t thread_count = 0) noexcept
+  {
+    if (thread_count == 0 && values.get_size() < SCAN_PARALLEL_THRESHOLD)
+      thread_count = 1;
+    return details::scan<false>(values, out, init, thread_count);
+  }
+}
+
+#endif //!HG_COLT_SCAN
@@ -0,0 +1,447 @@
+/** @file Select.h
+* Contains selection algorithms: 'nth_element', 'partial_sort' and 'TopK'.
+* 'nth_element' is an introselect: a quickselect (median of 3 pivot) which falls
+* back to a heap selection if it partitions too many times, so that it runs in
+* linear time on average and in O(n.log(n)) at worst.
+* 'TopK' keeps the k first values of a stream in a bounded heap whose root is
+* the k-th value (the threshold). Once full, most values do not pass the threshold:
+* for arithmetic types, 'push_all' compares blocks of values to the threshold
+* without branches (which the compiler vectorizes), and only pushes the values of
+* the blocks containing a value that passes it.
+* 'top_k' computes a TopK per thread over a ContiguousView, then merges them.
+*/
+
+#ifndef HG_COLT_SELECT
+#define HG_COLT_SELECT
+
+#include "../details/bits.h"
+#include "../utility/Parallel.h"
+
+namespace colt::algo
+{
+  /// @brief 'nth' was greater or equal to the count of objects
+#define colt_select_nth_smaller_size nth < values.get_size()
+
+  template<typename T>
+  /// @brief Orders objects through operator<
+  /// @tparam T The type to compare
+  struct Less
+  {
+    /// @brief Comparison operator
+    /// @param a The first object
+    /// @param b The second object
+    /// @return True if 'a < b'
+    constexpr bool operator()(const T& a, const T& b) const noexcept { return a < b; }
+  };
+
+  template<typename T>
+  /// @brief Orders objects through operator> (the largest first)
+  /// @tparam T The type to compare
+  struct Greater
+  {
+    /// @brief Comparison operator
+    /// @param a The first object
+    /// @param b The second object
+    /// @return True if 'a > b'
+    constexpr bool operator()(const T& a, const T& b) const noexcept { return b < a; }
+  };
+
+  namespace details
+  {
+    /// @brief Ranges of at most this count of objects are sorted by insertion
+    static constexpr size_t SELECT_INSERTION_SIZE = 16;
+
+    template<typename T>
+    /// @brief Swaps two objects by moving them
+    /// @tparam T The type of the objects
+    /// @param a The first object
+    /// @param b The second object
+    void select_swap(T& a, T& b) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+      T tmp = std::move(a);
+      a = std::move(b);
+      b = std::move(tmp);
+    }
+
+    template<typename T, typename Compare>
+    /// @brief Sorts [begin, end) by insertion
+    /// @tparam T The type of the objects
+    /// @tparam Compare The comparison function
+    /// @param begin The beginning of the range
+    /// @param end The end of the range
+    /// @param comp The comparison function
+    void insertion_sort(T* begin, T* end, const Compare& comp) noexcept
+    {
+      if (end - begin < 2)
+        return;
+      for (T* i = begin + 1; i != end; ++i)
+      {
+        T value = std::move(*i);
+        T* j = i;
+        for (; j != begin && comp(value, j[-1]); --j)
+          *j = std::move(j[-1]);
+        *j = std::move(value);
+      }
+    }
+
+    template<typename T, typename Compare>
+    /// @brief Moves the object at 'index' down a heap until it is not before its children.
+    /// The root of the heap is its last object in the order of 'comp'.
+    /// @tparam T The type of the objects
+    /// @tparam Compare The comparison function
+    /// @param heap The heap
+    /// @param size The count of objects of the heap
+    /// @param index The index of the object to move down
+    /// @param comp The comparison function
+    void sift_down(T* heap, size_t size, size_t index, const Compare& comp) noexcept
+    {
+      T value = std::move(heap[index]);
+      for (;;)
+      {
+        size_t child = 2 * index + 1;
+        if (child >= size)
+          break;
+        child += static_cast<size_t>(child + 1 < size && comp(heap[child], heap[child + 1]));
+        if (!comp(value, heap[child]))
+          break;
+        heap[index] = std::move(heap[child]);
+        index = child;
+      }
+      heap[index] = std::move(value);
+    }
+
+    template<typename T, typename Compare>
+    /// @brief Moves the object at 'index' up a heap until it is not after its parent
+    /// @tparam T The type of the objects
+    /// @tparam Compare The comparison function
+    /// @param heap The heap
+    /// @param index The index of the object to move up
+    /// @param comp The comparison function
+    void sift_up(T* heap, size_t index, const Compare& comp) noexcept
+    {
+      T value = std::move(heap[index]);
+      while (index != 0)
+      {
+        const size_t parent = (index - 1) / 2;
+        if (!comp(heap[parent], value))
+          break;
+        heap[index] = std::move(heap[parent]);
+        index = parent;
+      }
+      heap[index] = std::move(value);
+    }
+
+    template<typename T, typename Compare>
+    /// @brief Reorders [heap, heap + size) into a heap
+    /// @tparam T The type of the objects
+    /// @tparam Compare The comparison function
+    /// @param heap The objects
+    /// @param size The count of objects
+    /// @param comp The comparison function
+    void make_heap(T* heap, size_t size, const Compare& comp) noexcept
+    {
+      for (size_t i = size / 2; i-- != 0;)
+        sift_down(heap, size, i, comp);
+    }
+
+    template<typename T, typename Compare>
+    /// @brief Sorts a heap in the order of 'comp'
+    /// @tparam T The type of the objects
+    /// @tparam Compare The comparison function
+    /// @param heap The heap
+    /// @param size The count of objects of the heap
+    /// @param comp The comparison function
+    void sort_heap(T* heap, size_t size, const Compare& comp) noexcept
+    {
+      for (; size > 1; --size)
+      {
+        select_swap(heap[0], heap[size - 1]);
+        sift_down(heap, size - 1, 0, comp);
+      }
+    }
+
+    template<typename T, typename Compare>
+    /// @brief Moves the object that would be at 'nth' if [begin, end) were sorted there, through a heap.
+    /// Used when the quickselect partitions too many times: runs in O(n.log(nth - begin)).
+    /// @tparam T The type of the objects
+    /// @tparam Compare The comparison function
+    /// @param begin The beginning of the range
+    /// @param nth The position of the object to select
+    /// @param end The end of the range
+    /// @param comp The comparison function
+    void heap_select(T* begin, T* nth, T* end, const Compare& comp) noexcept
+    {
+      const size_t size = static_cast<size_t>(nth - begin) + 1;
+      make_heap(begin, size, comp);
+      for (T* i = nth + 1; i != end; ++i)
+      {
+        if (comp(*i, *begin))
+        {
+          select_swap(*i, *begin);
+          sift_down(begin, size, 0, comp);
+        }
+      }
+      select_swap(*begin, *nth);
+    }
+
+    template<typename T, typename Compare>
+    /// @brief Moves the object that would be at 'nth' if [begin, end) were sorted there,
+    /// the objects before it not being after it, and the objects after it not being before it.
+    /// @tparam T The type of the objects
+    /// @tparam Compare The comparison function
+    /// @param begin The beginning of the range
+    /// @param nth The position of the object to select (in [begin, end))
+    /// @param end The end of the range
+    /// @param comp The comparison function
+    void introselect(T* begin, T* nth, T* end, const Compare& comp) noexcept
+    {
+      unsigned depth = 2 * colt::details::bit_width(static_cast<u64>(end - begin));
+      while (static_cast<size_t>(end - begin) > SELECT_INSERTION_SIZE)
+      {
+        if (depth-- == 0)
+          return heap_select(begin, nth, end, comp);
+
+        //Median of 3: the first and last objects then stop the scans of the partition
+        T* middle = begin + (end - begin) / 2;
+        T* last = end - 1;
+        if (comp(*middle, *begin))
+          select_swap(*middle, *begin);
+        if (comp(*last, *middle))
+        {
+          select_swap(*last, *middle);
+          if (comp(*middle, *begin))
+            select_swap(*middle, *begin);
+        }
+        const T pivot = *middle;
+
+        //Hoare partition: [begin, i) is not after 'pivot', [i, end) is not before it
+        T* i = begin;
+        T* j = last;
+        for (;;)
+        {
+          do ++i; while (comp(*i, pivot));
+          do --j; while (comp(pivot, *j));
+          if (i >= j)
+            break;
+          select_swap(*i, *j);
+        }
+        if (nth < i)
+          end = i;
+        else
+          begin = i;
+      }
+      insertion_sort(begin, end, comp);
+    }
+  }
+
+  template<typename T, typename Compare = Less<T>>
+  /// @brief Reorders 'values' so that the object at 'nth' is the one that would be there if 'values' were sorted.
+  /// The objects before 'nth' are not after it, and the objects after it are not before it
+  /// (in the order of 'comp'). Runs in linear time on average.
+  /// @tparam T The type of the objects
+  /// @tparam Compare The comparison function (Less by default)
+  /// @param values The objects to reorder
+  /// @param nth The index of the object to select
+  /// @param comp The comparison function
+  /// @pre nth < values.get_size() (colt_select_nth_smaller_size)
+  void nth_element(Vector<T>& values, size_t nth, const Compare& comp = Compare{}) noexcept
+  {
+    CHECK_REQUIREMENT(colt_select_nth_smaller_size);
+    details::introselect(values.get_data(), values.get_data() + nth, values.get_data() + values.get_size(), comp);
+  }
+
+  template<typename T, typename Compare = Less<T>>
+  /// @brief Reorders 'values' so that its first 'count' objects are the first 'count' objects
+  /// of 'values' sorted (in the order of 'comp'). The other objects are in no particular order.
+  /// Runs in O(n + count.log(count)).
+  /// @tparam T The type of the objects
+  /// @tparam Compare The comparison function (Less by default)
+  /// @param values The objects to reorder
+  /// @param count The count of objects to sort (all the objects if greater than their count)
+  /// @param comp The comparison function
+  void partial_sort(Vector<T>& values, size_t count, const Compare& comp = Compare{}) noexcept
+  {
+    count = count < values.get_size() ? count : values.get_size();
+    if (count == 0)
+      return;
+    T* data = values.get_data();
+    if (count < values.get_size())
+      details::introselect(data, data + count - 1, data + values.get_size(), comp);
+    details::make_heap(data, count, comp);
+    details::sort_heap(data, count, comp);
+  }
+
+  template<typename T, typename Compare = Greater<T>>
+  /// @brief Keeps the 'k' first values (in the order of 'Compare') pushed to it.
+  /// With the default 'Compare', keeps the 'k' largest values.
+  /// @tparam T The type of the values
+  /// @tparam Compare The comparison function (Greater by default)
+  class TopK
+  {
+    /// @brief The values kept, as a heap whose root is the last one (the threshold)
+    Vector<T> heap = {};
+    /// @brief The count of values to keep
+    size_t k;
+    /// @brief The comparison function
+    Compare comp;
+
+    /// @brief Replaces the threshold by 'value' if 'value' is before it
+    /// @param value The value to push
+    /// @pre is_full() && !heap.is_empty()
+    void push_full(traits::copy_if_trivial_t<const T&> value) noexcept
+    {
+      if (comp(value, heap[0]))
+      {
+        heap[0] = value;
+        details::sift_down(heap.get_data(), heap.get_size(), 0, comp);
+      }
+    }
+
+  public:
+    /// @brief Constructs an empty TopK
+    /// @param k The count of values to keep
+    /// @param comp The comparison function
+    explicit TopK(size_t k, const Compare& comp = Compare{}) noexcept
+      : k(k), comp(comp)
+    {
+      if (k != 0)
+        heap.reserve(k);
+    }
+
+    /// @brief Pushes a value, which is kept if it is before the threshold
+    /// @param value The value to push
+    void push(traits::copy_if_trivial_t<const T&> value) noexcept
+    {
+      if (heap.get_size() < k)
+      {
+        heap.push_back(value);
+        details::sift_up(heap.get_data(), heap.get_size() - 1, comp);
+      }
+      else if (k != 0)
+        push_full(value);
+    }
+
+    /// @brief Pushes all the values of a view
+    /// @param values The values to push
+    void push_all(ContiguousView<T> values) noexcept
+    {
+      size_t i = 0;
+      for (; i < values.get_size() && !is_full(); i++)
+        push(values[i]);
+      if constexpr (std::is_arithmetic_v<T>)
+      {
+        //Compares whole blocks to the threshold without branching
+        constexpr size_t BLOCK = 16;
+        for (; k != 0 && i + BLOCK <= values.get_size(); i += BLOCK)
+        {
+          const T* block = values.get_data() + i;
+          const T threshold = heap[0];
+          bool passes = false;
+          for (size_t j = 0; j < BLOCK; j++)
+            passes |= comp(block[j], threshold);
+          if (passes)
+          {
+            for (size_t j = 0; j < BLOCK; j++)
+              push_full(block[j]);
+          }
+        }
+      }
+      for (; i < values.get_size(); i++)
+        push(values[i]);
+    }
+
+    template<typename Iter, typename = std::enable_if_t<traits::is_colt_iter_v<Iter>>>
+    /// @brief Pushes all the values returned by a colt iterator
+    /// @tparam Iter The colt iterator type
+    /// @tparam  SFINAE helper
+    /// @param iter The iterator whose values to push
+    void push_all(Iter iter) noexcept
+    {
+      for (;;)
+      {
+        auto value = iter.next();
+        if (!value.is_value())
+          return;
+        push(value.get_value());
+      }
+    }
+
+    /// @brief Pushes the values kept by another TopK
+    /// @param other The TopK whose values to push
+    void merge(const TopK& other) noexcept
+    {
+      push_all(other.heap.to_view());
+    }
+
+    /// @brief Returns the count of values to keep
+    /// @return The 'k' of the TopK
+    size_t get_k() const noexcept { return k; }
+    /// @brief Returns the count of values kept
+    /// @return The count of values kept (at most 'get_k()')
+    size_t get_size() const noexcept { return heap.get_size(); }
+    /// @brief Check if 'k' values are kept (after which, a pushed value replaces the threshold)
+    /// @return True if 'k' values are kept
+    bool is_full() const noexcept { return heap.get_size() == k; }
+
+    /// @brief Returns the last value kept, which a pushed value must be before to be kept
+    /// @return The threshold
+    /// @pre get_size() != 0
+    traits::copy_if_trivial_t<const T&> get_threshold() const noexcept { return heap.get_front(); }
+
+    /// @brief Returns the values kept in no particular order
+    /// @return View over the values kept
+    ContiguousView<T> to_view() const noexcept { return heap.to_view(); }
+
+    /// @brief Returns the values kept, sorted in the order of 'Compare'
+    /// @return The sorted values
+    Vector<T> to_sorted() const noexcept
+    {
+      if (heap.is_empty())
+        return Vector<T>{};
+      Vector<T> sorted = heap;
+      details::sort_heap(sorted.get_data(), sorted.get_size(), comp);
+      return sorted;
+    }
+
+    /// @brief Clears the values kept
+    void clear() noexcept { heap.clear(); }
+  };
+
+  /// @brief The minimum count of values for which 'top_k' uses multiple threads by default
+  static constexpr size_t TOP_K_PARALLEL_THRESHOLD = 1 << 16;
+
+  template<typename T, typename Compare = Greater<T>>
+  /// @brief Returns the 'k' first values of a view (in the order of 'comp'), sorted.
+  /// Each thread computes the TopK of a range of the view, then the TopKs are merged.
+  /// @tparam T The type of the values
+  /// @tparam Compare The comparison function (Greater by default, which returns the 'k' largest values)
+  /// @param values The values
+  /// @param k The count of values to return
+  /// @param thread_count The count of threads (0 for the default count, or 1 if there are less than TOP_K_PARALLEL_THRESHOLD values)
+  /// @param comp The comparison function
+  /// @return The 'k' first values (or all the values if there are less), sorted in the order of 'comp'
+  Vector<T> top_k(ContiguousView<T> values, size_t k, size_t thread_count = 0, const Compare& comp = Compare{}) noexcept
+  {
+    if (thread_count == 0)
+      thread_count = values.get_size() < TOP_K_PARALLEL_THRESHOLD ? 1 : get_default_thread_count();
+    //Each thread should have more values than are kept
+    const size_t max_threads = values.get_size() / (k + TOP_K_PARALLEL_THRESHOLD / 16) + 1;
+    thread_count = thread_count < max_threads ? thread_count : max_threads;
+    const size_t chunk_size = (values.get_size() + thread_count - 1) / thread_count;
+
+    Vector<TopK<T, Compare>> tops = Vector<TopK<T, Compare>>{ thread_count };
+    for (size_t thread = 0; thread < thread_count; thread++)
+      tops.push_back(TopK<T, Compare>{ k, comp });
+    parallel_for_threads(thread_count, [&](size_t thread)
+      {
+        const size_t begin = thread * chunk_size < values.get_size() ? thread * chunk_size : values.get_size();
+        const size_t end = begin + chunk_size < values.get_size() ? begin + chunk_size : values.get_size();
+        tops[thread].push_all(ContiguousView<T>{ values.get_data() + begin, end - begin });
+      });
+    for (size_t thread = 1; thread < thread_count; thread++)
+      tops[0].merge(tops[thread]);
+    return tops[0].to_sorted();
+  }
+}
+
+#endif //!HG_COLT_SELECT
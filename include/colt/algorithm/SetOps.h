@@ -0,0 +1,368 @@
+/** @file SetOps.h
+* Contains the intersection, union and difference of sorted sets.
+* A set is a sorted ContiguousView without duplicates (such as a posting list).
+* The algorithm depends on the sizes of the sets:
+* - if one set is much smaller than the other, each of its values is searched
+*   in the larger set by galloping (an exponential search followed by a binary
+*   search starting at the position of the last value found), which skips most
+*   of the larger set.
+* - otherwise, the intersection and difference of integers compare blocks of 4
+*   values of each set at once (see 'equal_any_mask4'), and advance the block
+*   whose last value is the smallest; other sets are merged one value at a time.
+* The results are appended to a Vector, which is reserved for the largest possible
+* result at most once.
+*/
+
+#ifndef HG_COLT_SET_OPS
+#define HG_COLT_SET_OPS
+
+#include "../data_structs/Vector.h"
+#include "../details/bits.h"
+#include "../details/simd.h"
+
+namespace colt::algo
+{
+  namespace details
+  {
+    /// @brief If a set is this many times smaller than the other, its values are searched by galloping
+    static constexpr size_t SET_GALLOP_RATIO = 32;
+
+    template<typename T>
+    /// @brief True if the blocks of 4 values of sets of 'T' can be compared at once
+    static constexpr bool set_use_blocks_v = std::is_integral_v<T> && (sizeof(T) == 4 || sizeof(T) == 8);
+
+    template<typename T>
+    /// @brief Ensures that 'count' objects can be pushed to 'out' without reallocating
+    /// @tparam T The type of the objects
+    /// @param out The Vector to reserve
+    /// @param count The count of objects that will be pushed
+    void set_reserve(Vector<T>& out, size_t count) noexcept
+    {
+      const size_t available = out.get_capacity() - out.get_size();
+      if (available < count)
+        out.reserve(count - available);
+    }
+
+    template<typename T>
+    /// @brief Returns the first value not smaller than 'value' in [from, end), by galloping.
+    /// Steps of 1, 2, 4... are taken from 'from' until passing 'value', then the
+    /// last step is binary searched: this is faster than a binary search of the
+    /// whole range when 'value' is close to 'from'.
+    /// @tparam T The type of the values
+    /// @param from The beginning of the sorted range
+    /// @param end The end of the sorted range
+    /// @param value The value to search for
+    /// @return Pointer to the first value not smaller than 'value', or 'end'
+    const T* gallop(const T* from, const T* end, const T& value) noexcept
+    {
+      const size_t size = static_cast<size_t>(end - from);
+      if (size == 0 || !(from[0] < value))
+        return from;
+      //from[low] < value
+      size_t low = 0;
+      size_t step = 1;
+      while (low + step < size && from[low + step] < value)
+      {
+        low += step;
+        step *= 2;
+      }
+      return std::lower_bound(from + low + 1, from + (low + step < size ? low + step : size), value);
+    }
+
+    template<typename T, typename Emit>
+    /// @brief Emits the values of 'small' that are in 'large', by galloping in 'large'
+    /// @tparam T The type of the values
+    /// @tparam Emit The output functor
+    /// @param small The smaller set
+    /// @param large The larger set
+    /// @param emit The output functor, called with each value of the intersection
+    void intersect_gallop(ContiguousView<T> small, ContiguousView<T> large, Emit& emit) noexcept
+    {
+      const T* position = large.get_data();
+      const T* end = large.get_data() + large.get_size();
+      for (size_t i = 0; i < small.get_size() && position != end; i++)
+      {
+        position = gallop(position, end, small[i]);
+        if (position != end && !(small[i] < *position))
+          emit(small[i]);
+      }
+    }
+
+    template<bool KEEP_MATCHES, typename T, typename Emit>
+    /// @brief Merges two sets, emitting the values of 'a' that are (or are not) in 'b'
+    /// @tparam KEEP_MATCHES If true, emits the values in 'b', else the values not in 'b'
+    /// @tparam T The type of the values
+    /// @tparam Emit The output functor
+    /// @param a The set whose values are emitted
+    /// @param i The index of the first value of 'a' to merge
+    /// @param b The other set
+    /// @param j The index of the first value of 'b' to merge
+    /// @param emit The output functor
+    void filter_merge(ContiguousView<T> a, size_t i, ContiguousView<T> b, size_t j, Emit& emit) noexcept
+    {
+      while (i < a.get_size() && j < b.get_size())
+      {
+        if (a[i] < b[j])
+        {
+          if constexpr (!KEEP_MATCHES)
+            emit(a[i]);
+          ++i;
+        }
+        else if (b[j] < a[i])
+          ++j;
+        else
+        {
+          if constexpr (KEEP_MATCHES)
+            emit(a[i]);
+          ++i;
+          ++j;
+        }
+      }
+      if constexpr (!KEEP_MATCHES)
+      {
+        for (; i < a.get_size(); i++)
+          emit(a[i]);
+      }
+    }
+
+    template<bool KEEP_MATCHES, typename T, typename Emit>
+    /// @brief Emits the values of 'a' that are (or are not) in 'b', comparing blocks of 4 values at once.
+    /// The block of 'a' or 'b' whose last value is the smallest is advanced: the
+    /// values of a block of 'a' are emitted once all the blocks of 'b' that may
+    /// contain them were compared.
+    /// @tparam KEEP_MATCHES If true, emits the values in 'b', else the values not in 'b'
+    /// @tparam T The integer type of the values
+    /// @tparam Emit The output functor
+    /// @param a The set whose values are emitted
+    /// @param b The other set
+    /// @param emit The output functor
+    void filter_blocks(ContiguousView<T> a, ContiguousView<T> b, Emit& emit) noexcept
+    {
+      constexpr size_t BLOCK = colt::details::SIMD_GROUP_SIZE;
+      const T* a_data = a.get_data();
+      const T* b_data = b.get_data();
+      size_t i = 0;
+      size_t j = 0;
+      if (a.get_size() >= BLOCK && b.get_size() >= BLOCK)
+      {
+        //The values of the block of 'a' found in the blocks of 'b' compared so far
+        u32 mask = 0;
+        for (;;)
+        {
+          mask |= colt::details::equal_any_mask4(a_data + i, b_data + j);
+          const T a_max = a_data[i + BLOCK - 1];
+          const T b_max = b_data[j + BLOCK - 1];
+          if (a_max <= b_max)
+          {
+            u64 emitted = KEEP_MATCHES ? mask : ~mask & 0xF;
+            while (emitted != 0)
+            {
+              emit(a_data[i + colt::details::count_trailing_zeros(emitted)]);
+              emitted &= emitted - 1;
+            }
+            mask = 0;
+            i += BLOCK;
+            j += static_cast<size_t>(a_max == b_max) * BLOCK;
+            if (i + BLOCK > a.get_size() || j + BLOCK > b.get_size())
+              break;
+          }
+          else
+          {
+            j += BLOCK;
+            if (j + BLOCK > b.get_size())
+            {
+              //The block of 'a' is not done: its values not found yet may be in the rest of 'b'
+              for (size_t k = 0; k < BLOCK; k++)
+              {
+                bool found = (mask >> k) & 1;
+                if (!found)
+                {
+                  while (j < b.get_size() && b_data[j] < a_data[i + k])
+                    ++j;
+                  found = j < b.get_size() && b_data[j] == a_data[i + k];
+                }
+                if (found == KEEP_MATCHES)
+                  emit(a_data[i + k]);
+              }
+              i += BLOCK;
+              break;
+            }
+          }
+        }
+      }
+      filter_merge<KEEP_MATCHES>(a, i, b, j, emit);
+    }
+
+    template<typename T, typename Emit>
+    /// @brief Emits the intersection of two sets, choosing the algorithm from their sizes
+    /// @tparam T The type of the values
+    /// @tparam Emit The output functor
+    /// @param a The first set
+    /// @param b The second set
+    /// @param emit The output functor, called with each value of the intersection in order
+    void intersect(ContiguousView<T> a, ContiguousView<T> b, Emit&& emit) noexcept
+    {
+      if (a.get_size() * SET_GALLOP_RATIO < b.get_size())
+        intersect_gallop(a, b, emit);
+      else if (b.get_size() * SET_GALLOP_RATIO < a.get_size())
+        intersect_gallop(b, a, emit);
+      else if constexpr (set_use_blocks_v<T>)
+        filter_blocks<true>(a, b, emit);
+      else
+        filter_merge<true>(a, 0, b, 0, emit);
+    }
+  }
+
+  template<typename T>
+  /// @brief Appends the values that are in both 'a' and 'b' to 'out', in order.
+  /// @tparam T The type of the values, ordered by '<'
+  /// @param a The first sorted set
+  /// @param b The second sorted set
+  /// @param out The Vector to which to append the intersection
+  void set_intersection(ContiguousView<T> a, ContiguousView<T> b, Vector<T>& out) noexcept
+  {
+    details::set_reserve(out, a.get_size() < b.get_size() ? a.get_size() : b.get_size());
+    details::intersect(a, b, [&](const T& value) { out.push_back(value); });
+  }
+
+  template<typename T>
+  /// @brief Appends the values that are in all the 'sets' to 'out', in order.
+  /// The sets are intersected from the smallest to the largest: the intersection
+  /// of the first two is refined in place by the following ones, so that the
+  /// later (larger) sets are galloped through by fewer and fewer values.
+  /// @tparam T The type of the values, ordered by '<'
+  /// @param sets The sorted sets to intersect
+  /// @param out The Vector to which to append the intersection
+  void set_intersection(ContiguousView<ContiguousView<T>> sets, Vector<T>& out) noexcept
+  {
+    if (sets.is_empty())
+      return;
+    if (sets.get_size() == 1)
+    {
+      details::set_reserve(out, sets[0].get_size());
+      for (const T& value : sets[0])
+        out.push_back(value);
+      return;
+    }
+
+    //Insertion sort by size: there are few sets
+    Vector<ContiguousView<T>> by_size = Vector<ContiguousView<T>>(sets.get_size());
+    for (auto set : sets)
+    {
+      by_size.push_back(set);
+      for (size_t i = by_size.get_size() - 1; i != 0 && set.get_size() < by_size[i - 1].get_size(); i--)
+      {
+        by_size[i] = by_size[i - 1];
+        by_size[i - 1] = set;
+      }
+    }
+
+    const size_t start = out.get_size();
+    set_intersection(by_size[0], by_size[1], out);
+    for (size_t i = 2; i < by_size.get_size() && out.get_size() != start; i++)
+    {
+      //A value is only written over after having been read
+      T* candidates = out.get_data() + start;
+      const size_t count = out.get_size() - start;
+      size_t kept = 0;
+      details::intersect(ContiguousView<T>{ candidates, count }, by_size[i],
+        [&](const T& value) { candidates[kept++] = value; });
+      out.pop_back_n(count - kept);
+    }
+  }
+
+  template<typename T>
+  /// @brief Appends the values that are in 'a' or 'b' to 'out', in order.
+  /// @tparam T The type of the values, ordered by '<'
+  /// @param a The first sorted set
+  /// @param b The second sorted set
+  /// @param out The Vector to which to append the union
+  void set_union(ContiguousView<T> a, ContiguousView<T> b, Vector<T>& out) noexcept
+  {
+    details::set_reserve(out, a.get_size() + b.get_size());
+    if (a.get_size() * details::SET_GALLOP_RATIO < b.get_size() || b.get_size() * details::SET_GALLOP_RATIO < a.get_size())
+    {
+      //Copies the runs of the larger set between the values of the smaller set
+      const ContiguousView<T> small = a.get_size() < b.get_size() ? a : b;
+      const ContiguousView<T> large = a.get_size() < b.get_size() ? b : a;
+      const T* position = large.get_data();
+      const T* end = large.get_data() + large.get_size();
+      for (const T& value : small)
+      {
+        const T* next = details::gallop(position, end, value);
+        for (; position != next; ++position)
+          out.push_back(*position);
+        if (position != end && !(value < *position))
+          ++position;
+        out.push_back(value);
+      }
+      for (; position != end; ++position)
+        out.push_back(*position);
+      return;
+    }
+
+    size_t i = 0;
+    size_t j = 0;
+    while (i < a.get_size() && j < b.get_size())
+    {
+      if (a[i] < b[j])
+        out.push_back(a[i++]);
+      else if (b[j] < a[i])
+        out.push_back(b[j++]);
+      else
+      {
+        out.push_back(a[i++]);
+        ++j;
+      }
+    }
+    for (; i < a.get_size(); i++)
+      out.push_back(a[i]);
+    for (; j < b.get_size(); j++)
+      out.push_back(b[j]);
+  }
+
+  template<typename T>
+  /// @brief Appends the values that are in 'a' but not in 'b' to 'out', in order.
+  /// @tparam T The type of the values, ordered by '<'
+  /// @param a The sorted set whose values are appended
+  /// @param b The sorted set of values to remove
+  /// @param out The Vector to which to append the difference
+  void set_difference(ContiguousView<T> a, ContiguousView<T> b, Vector<T>& out) noexcept
+  {
+    details::set_reserve(out, a.get_size());
+    auto emit = [&](const T& value) { out.push_back(value); };
+    if (a.get_size() * details::SET_GALLOP_RATIO < b.get_size())
+    {
+      const T* position = b.get_data();
+      const T* end = b.get_data() + b.get_size();
+      for (const T& value : a)
+      {
+        position = details::gallop(position, end, value);
+        if (position == end || value < *position)
+          out.push_back(value);
+      }
+    }
+    else if (b.get_size() * details::SET_GALLOP_RATIO < a.get_size())
+    {
+      //Copies the runs of 'a' between the values of 'b'
+      const T* position = a.get_data();
+      const T* end = a.get_data() + a.get_size();
+      for (size_t j = 0; j < b.get_size() && position != end; j++)
+      {
+        const T* next = details::gallop(position, end, b[j]);
+        for (; position != next; ++position)
+          out.push_back(*position);
+        if (position != end && !(b[j] < *position))
+          ++position;
+      }
+      for (; position != end; ++position)
+        out.push_back(*position);
+    }
+    else if constexpr (details::set_use_blocks_v<T>)
+      details::filter_blocks<false>(a, b, emit);
+    else
+      details::filter_merge<false>(a, 0, b, 0, emit);
+  }
+}
+
+#endif //!HG_COLT_SET_OPS
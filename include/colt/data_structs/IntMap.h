@@ -0,0 +1,510 @@
+/** @file IntMap.h
+* Contains IntMap, a hash map specialized for integer keys.
+* Contrary to Map, IntMap has no separate array of sentinels: the greatest value
+* of the key type marks an EMPTY slot, and erasing shifts the following keys back
+* (so there are no DELETED slots). The slots are stored in groups of 4 keys followed
+* by their 4 values, so that a probe only reads a single stream of memory.
+* The home slot of a key is checked on its own, then the keys of the following
+* groups are compared 4 at once (see 'details/simd.h').
+* The key marking EMPTY slots can still be inserted: its value is stored aside.
+*/
+
+#ifndef HG_COLT_INT_MAP
+#define HG_COLT_INT_MAP
+
+#include <limits>
+#include <utility>
+
+#include "../details/allocator.h"
+#include "../details/linear_probing.h"
+#include "../details/simd.h"
+#include "../utility/Hash.h"
+
+namespace colt
+{
+  namespace details
+  {
+    template<typename Key, typename Value>
+    /// @brief Group of slots of an IntMap: the keys, followed by their values
+    /// @tparam Key The integer key type
+    /// @tparam Value The value type
+    struct IntMapGroup
+    {
+      /// @brief The keys (std::numeric_limits<Key>::max() for EMPTY slots)
+      Key keys[SIMD_GROUP_SIZE];
+      /// @brief The storage of the values (only constructed for non-EMPTY slots)
+      alignas(Value) char values[SIMD_GROUP_SIZE * sizeof(Value)];
+
+      /// @brief Returns the value of a slot of the group
+      /// @param lane The index of the slot in the group
+      /// @return Pointer to the value
+      Value* get_value(size_t lane) noexcept { return reinterpret_cast<Value*>(values) + lane; }
+      /// @brief Returns the value of a slot of the group
+      /// @param lane The index of the slot in the group
+      /// @return Pointer to the value
+      const Value* get_value(size_t lane) const noexcept { return reinterpret_cast<const Value*>(values) + lane; }
+    };
+  }
+
+  template<typename Key, typename Value, typename Hasher = FastIntHash>
+  /// @brief An unordered associative container from integer keys to values.
+  /// Pointers to values are invalidated by insertions (on reallocation) and by erasures
+  /// (which move the following values).
+  /// @tparam Key The integer key type
+  /// @tparam Value The value type
+  /// @tparam Hasher The hash function of the keys (FastIntHash by default)
+  class IntMap
+  {
+    static_assert(std::is_integral_v<Key>, "Key of an IntMap should be an integer!");
+    static_assert(!traits::is_tag_v<Value>, "Cannot use tag struct as typename!");
+    static_assert(std::is_invocable_r_v<size_t, const Hasher&, Key>, "Hasher of an IntMap should hash the Key!");
+
+  public:
+    /// @brief The key marking EMPTY slots
+    static constexpr Key EMPTY_KEY = std::numeric_limits<Key>::max();
+    /// @brief The count of slots of a group
+    static constexpr size_t GROUP_SIZE = details::SIMD_GROUP_SIZE;
+
+  private:
+    using Group = details::IntMapGroup<Key, Value>;
+
+    /// @brief The groups of slots (whose count is a power of 2)
+    memory::TypedBlock<Group> groups = {};
+    /// @brief The count of slots minus 1
+    size_t slot_mask = 0;
+    /// @brief The count of keys in the slots
+    size_t size = 0;
+    /// @brief The load factor before reallocation
+    float load_factor = 0.70f;
+    /// @brief The hash function of the keys
+    Hasher hasher = {};
+    /// @brief True if EMPTY_KEY was inserted
+    bool has_empty_key = false;
+    /// @brief The storage of the value of EMPTY_KEY, which cannot be stored in the slots
+    alignas(Value) char empty_key_value[sizeof(Value)];
+
+  public:
+    /// @brief Constructs an empty IntMap
+    /// @param load_factor The load factor (> 0.0f && < 1.0f)
+    /// @param hasher The hash function of the keys
+    IntMap(float load_factor = 0.70f, const Hasher& hasher = Hasher{}) noexcept
+      : load_factor(load_factor), hasher(hasher)
+    {
+      assert(0.0f < load_factor && load_factor < 1.0f && "Invalid load factor!");
+      allocate_groups(16);
+    }
+
+    /// @brief Constructs an empty IntMap that can contain 'reserve_size' keys without reallocating
+    /// @param reserve_size The count of keys to reserve for
+    /// @param load_factor The load factor (> 0.0f && < 1.0f)
+    /// @param hasher The hash function of the keys
+    IntMap(size_t reserve_size, float load_factor = 0.70f, const Hasher& hasher = Hasher{}) noexcept
+      : load_factor(load_factor), hasher(hasher)
+    {
+      assert(0.0f < load_factor && load_factor < 1.0f && "Invalid load factor!");
+      allocate_groups(capacity_for(reserve_size));
+    }
+
+    /// @brief IntMap cannot be copied
+    IntMap(const IntMap&) = delete;
+    /// @brief IntMap cannot be copied
+    IntMap& operator=(const IntMap&) = delete;
+
+    /// @brief Move constructor
+    /// @param to_move The IntMap whose slots to steal
+    IntMap(IntMap&& to_move) noexcept
+      : groups(colt::exchange(to_move.groups, {})), slot_mask(colt::exchange(to_move.slot_mask, 0))
+      , size(colt::exchange(to_move.size, 0)), load_factor(to_move.load_factor), hasher(to_move.hasher)
+    {
+      if (to_move.has_empty_key)
+      {
+        new(get_empty_key_value()) Value(std::move(*to_move.get_empty_key_value()));
+        to_move.erase(EMPTY_KEY);
+        has_empty_key = true;
+      }
+    }
+
+    /// @brief Move assignment operator
+    /// @param to_move The IntMap whose slots to swap with
+    /// @return Self
+    IntMap& operator=(IntMap&& to_move) noexcept
+    {
+      colt::swap(groups, to_move.groups);
+      colt::swap(slot_mask, to_move.slot_mask);
+      colt::swap(size, to_move.size);
+      colt::swap(load_factor, to_move.load_factor);
+      colt::swap(hasher, to_move.hasher);
+      if (has_empty_key && to_move.has_empty_key)
+      {
+        Value value = std::move(*get_empty_key_value());
+        get_empty_key_value()->~Value();
+        new(get_empty_key_value()) Value(std::move(*to_move.get_empty_key_value()));
+        to_move.get_empty_key_value()->~Value();
+        new(to_move.get_empty_key_value()) Value(std::move(value));
+      }
+      else if (has_empty_key || to_move.has_empty_key)
+      {
+        IntMap& from = has_empty_key ? *this : to_move;
+        IntMap& to = has_empty_key ? to_move : *this;
+        new(to.get_empty_key_value()) Value(std::move(*from.get_empty_key_value()));
+        from.erase(EMPTY_KEY);
+        to.has_empty_key = true;
+      }
+      return *this;
+    }
+
+    /// @brief Destructs the IntMap and its values
+    ~IntMap() noexcept
+    {
+      clear();
+      memory::deallocate(groups);
+    }
+
+    /// @brief Returns the count of keys in the IntMap
+    /// @return The count of keys
+    size_t get_size() const noexcept { return size + has_empty_key; }
+    /// @brief Returns the count of slots
+    /// @return The count of slots
+    size_t get_capacity() const noexcept { return groups.get_size() == 0 ? 0 : slot_mask + 1; }
+    /// @brief Check if the IntMap is empty
+    /// @return True if the IntMap is empty
+    bool is_empty() const noexcept { return get_size() == 0; }
+    /// @brief Check if the IntMap is not empty
+    /// @return True if the IntMap is not empty
+    bool is_not_empty() const noexcept { return get_size() != 0; }
+    /// @brief Returns the load factor of the IntMap
+    /// @return The load factor
+    float get_load_factor() const noexcept { return load_factor; }
+    /// @brief Returns the hash function of the keys
+    /// @return The Hasher
+    const Hasher& get_hasher() const noexcept { return hasher; }
+
+    /// @brief Finds the value of 'key'
+    /// @param key The key to search for
+    /// @return Pointer to the value, or nullptr if 'key' does not exist
+    const Value* find(Key key) const noexcept
+    {
+      if (key == EMPTY_KEY)
+        return has_empty_key ? get_empty_key_value() : nullptr;
+      size_t index;
+      if (size == 0 || !probe(key, hasher(key), index))
+        return nullptr;
+      return get_group(index).get_value(index % GROUP_SIZE);
+    }
+
+    /// @brief Finds the value of 'key'
+    /// @param key The key to search for
+    /// @return Pointer to the value, or nullptr if 'key' does not exist
+    Value* find(Key key) noexcept
+    {
+      //No UB as the map is not const
+      return const_cast<Value*>(static_cast<const IntMap*>(this)->find(key));
+    }
+
+    /// @brief Check if the IntMap contains 'key'
+    /// @param key The key to check for
+    /// @return True if 'key' exists
+    bool contains(Key key) const noexcept { return find(key) != nullptr; }
+
+    /// @brief Inserts 'value' if 'key' does not already exist
+    /// @param key The key of the value
+    /// @param value The value to insert
+    /// @return Pointer to the value of 'key', and SUCCESS on insertion or EXISTS if the key already exists
+    std::pair<Value*, InsertionResult> insert(Key key, traits::copy_if_trivial_t<const Value&> value) noexcept
+    {
+      return emplace<false>(key, value);
+    }
+
+    /// @brief Inserts 'value' if 'key' does not already exist, else assigns 'value' to the existing value
+    /// @param key The key of the value
+    /// @param value The value to insert or assign
+    /// @return Pointer to the value of 'key', and SUCCESS on insertion or ASSIGNED on assignment
+    std::pair<Value*, InsertionResult> insert_or_assign(Key key, traits::copy_if_trivial_t<const Value&> value) noexcept
+    {
+      return emplace<true>(key, value);
+    }
+
+    /// @brief Erases 'key' if it exists.
+    /// The keys following it in its cluster are shifted back, so no DELETED slot is left.
+    /// @param key The key to erase
+    /// @return True if 'key' existed and was erased
+    bool erase(Key key) noexcept
+    {
+      if (key == EMPTY_KEY)
+      {
+        if (!has_empty_key)
+          return false;
+        get_empty_key_value()->~Value();
+        has_empty_key = false;
+        return true;
+      }
+      size_t hole;
+      if (size == 0 || !probe(key, hasher(key), hole))
+        return false;
+      get_group(hole).get_value(hole % GROUP_SIZE)->~Value();
+
+      //Moves back each key whose home slot is not between the hole and its slot
+      for (size_t index = (hole + 1) & slot_mask;; index = (index + 1) & slot_mask)
+      {
+        Group& group = get_group(index);
+        const Key moved = group.keys[index % GROUP_SIZE];
+        if (moved == EMPTY_KEY)
+          break;
+        const size_t home = hasher(moved) & slot_mask;
+        //Distances are computed modulo the capacity: the key stays if its home is in (hole, index]
+        if (((index - home) & slot_mask) < ((index - hole) & slot_mask))
+          continue;
+        Group& hole_group = get_group(hole);
+        hole_group.keys[hole % GROUP_SIZE] = moved;
+        new(hole_group.get_value(hole % GROUP_SIZE)) Value(std::move(*group.get_value(index % GROUP_SIZE)));
+        group.get_value(index % GROUP_SIZE)->~Value();
+        hole = index;
+      }
+      get_group(hole).keys[hole % GROUP_SIZE] = EMPTY_KEY;
+      --size;
+      return true;
+    }
+
+    /// @brief Reallocates (if needed) so that 'count' keys can be contained without reallocating
+    /// @param count The count of keys
+    void reserve(size_t count) noexcept
+    {
+      if (const size_t capacity = capacity_for(count); capacity > get_capacity())
+        realloc_map(capacity);
+    }
+
+    /// @brief Removes all the keys
+    void clear() noexcept
+    {
+      for (size_t i = 0; i < groups.get_size(); i++)
+      {
+        Group& group = groups.get_ptr()[i];
+        for (size_t lane = 0; lane < GROUP_SIZE; lane++)
+        {
+          if (group.keys[lane] != EMPTY_KEY)
+            group.get_value(lane)->~Value();
+          group.keys[lane] = EMPTY_KEY;
+        }
+      }
+      size = 0;
+      erase(EMPTY_KEY);
+    }
+
+    template<typename Fn>
+    /// @brief Calls 'fn(key, value)' for each key of the IntMap, in an unspecified order
+    /// @tparam Fn The function type
+    /// @param fn The function to call with a Key and a 'Value&'
+    void for_each(Fn&& fn)
+    {
+      for (size_t i = 0; i < groups.get_size(); i++)
+      {
+        Group& group = groups.get_ptr()[i];
+        for (size_t lane = 0; lane < GROUP_SIZE; lane++)
+          if (group.keys[lane] != EMPTY_KEY)
+            fn(group.keys[lane], *group.get_value(lane));
+      }
+      if (has_empty_key)
+        fn(EMPTY_KEY, *get_empty_key_value());
+    }
+
+    template<typename Fn>
+    /// @brief Calls 'fn(key, value)' for each key of the IntMap, in an unspecified order
+    /// @tparam Fn The function type
+    /// @param fn The function to call with a Key and a 'const Value&'
+    void for_each(Fn&& fn) const
+    {
+      for (size_t i = 0; i < groups.get_size(); i++)
+      {
+        const Group& group = groups.get_ptr()[i];
+        for (size_t lane = 0; lane < GROUP_SIZE; lane++)
+          if (group.keys[lane] != EMPTY_KEY)
+            fn(group.keys[lane], *group.get_value(lane));
+      }
+      if (has_empty_key)
+        fn(EMPTY_KEY, *get_empty_key_value());
+    }
+
+  private:
+    /// @brief Returns the group containing a slot
+    /// @param index The index of the slot
+    /// @return The group of the slot
+    Group& get_group(size_t index) noexcept { return groups.get_ptr()[index / GROUP_SIZE]; }
+    /// @brief Returns the group containing a slot
+    /// @param index The index of the slot
+    /// @return The group of the slot
+    const Group& get_group(size_t index) const noexcept { return groups.get_ptr()[index / GROUP_SIZE]; }
+
+    /// @brief Returns the value of EMPTY_KEY
+    /// @return Pointer to the storage of the value
+    Value* get_empty_key_value() noexcept { return reinterpret_cast<Value*>(empty_key_value); }
+    /// @brief Returns the value of EMPTY_KEY
+    /// @return Pointer to the storage of the value
+    const Value* get_empty_key_value() const noexcept { return reinterpret_cast<const Value*>(empty_key_value); }
+
+    /// @brief Returns the count of slots needed to contain 'count' keys
+    /// @param count The count of keys
+    /// @return The count of slots (a power of 2, at least 16)
+    size_t capacity_for(size_t count) const noexcept
+    {
+      const size_t capacity = static_cast<size_t>(static_cast<double>(count) / load_factor) + 1;
+      return capacity < 16 ? 16 : static_cast<size_t>(details::round_up_pow2(capacity));
+    }
+
+    /// @brief Allocates 'capacity' EMPTY slots
+    /// @param capacity The count of slots (a power of 2, at least GROUP_SIZE)
+    void allocate_groups(size_t capacity) noexcept
+    {
+      groups = memory::allocate({ capacity / GROUP_SIZE * sizeof(Group) });
+      slot_mask = capacity - 1;
+      for (size_t i = 0; i < groups.get_size(); i++)
+        for (size_t lane = 0; lane < GROUP_SIZE; lane++)
+          groups.get_ptr()[i].keys[lane] = EMPTY_KEY;
+    }
+
+    /// @brief Searches for 'key' from its home slot.
+    /// The home slot is checked alone: most keys are found there, and a branch on the
+    /// key lets the processor start the next lookups before the slot is loaded.
+    /// The following slots are compared a group at a time.
+    /// Precondition: key != EMPTY_KEY.
+    /// @param key The key to search for
+    /// @param key_hash The hash of 'key'
+    /// @param index The index of the slot of 'key' if found, else of the EMPTY slot ending the probe
+    /// @return True if 'key' was found
+    bool probe(Key key, size_t key_hash, size_t& index) const noexcept
+    {
+      assert(key != EMPTY_KEY);
+      const size_t home = key_hash & slot_mask;
+      const Key home_key = groups.get_ptr()[home / GROUP_SIZE].keys[home % GROUP_SIZE];
+      if (home_key == key || home_key == EMPTY_KEY)
+      {
+        index = home;
+        return home_key == key;
+      }
+      return probe_groups(key, home, index);
+    }
+
+    /// @brief Searches for 'key' in the slots following its home slot, comparing the keys of a group at once.
+    /// Precondition: key != EMPTY_KEY.
+    /// @param key The key to search for
+    /// @param home The home slot of 'key', which does not contain 'key' and is not EMPTY
+    /// @param index The index of the slot of 'key' if found, else of the EMPTY slot ending the probe
+    /// @return True if 'key' was found
+    bool probe_groups(Key key, size_t home, size_t& index) const noexcept
+    {
+      const size_t group_mask = slot_mask / GROUP_SIZE;
+      size_t group = home / GROUP_SIZE;
+      //The slots of the first group up to the home slot are not part of the probe
+      u32 probe_mask = ~((u32(2) << (home % GROUP_SIZE)) - 1);
+      for (;;)
+      {
+        const Key* keys = groups.get_ptr()[group].keys;
+        const u32 found = details::equal_mask4(keys, key) & probe_mask;
+        const u32 empty = details::equal_mask4(keys, EMPTY_KEY) & probe_mask;
+        if ((found | empty) != 0)
+        {
+          const unsigned lane = details::count_trailing_zeros(found | empty);
+          index = group * GROUP_SIZE + lane;
+          return (found >> lane) & 1;
+        }
+        group = (group + 1) & group_mask;
+        probe_mask = ~u32(0);
+      }
+    }
+
+    template<bool assign>
+    /// @brief Inserts or assigns 'value' to 'key'
+    /// @tparam assign True to assign the value if 'key' exists
+    /// @param key The key of the value
+    /// @param value The value to insert or assign
+    /// @return Pointer to the value of 'key', and the result of the operation
+    std::pair<Value*, InsertionResult> emplace(Key key, traits::copy_if_trivial_t<const Value&> value) noexcept
+    {
+      if (key == EMPTY_KEY)
+      {
+        if (!has_empty_key)
+        {
+          has_empty_key = true;
+          return { new(get_empty_key_value()) Value(value), InsertionResult::SUCCESS };
+        }
+        if constexpr (!assign)
+          return { get_empty_key_value(), InsertionResult::EXISTS };
+        else
+        {
+          *get_empty_key_value() = value;
+          return { get_empty_key_value(), InsertionResult::ASSIGNED };
+        }
+      }
+
+      if (static_cast<float>(size + 1) > load_factor * static_cast<float>(get_capacity()))
+        realloc_map(get_capacity() == 0 ? 16 : get_capacity() * 2);
+
+      size_t index;
+      if (probe(key, hasher(key), index))
+      {
+        Value* ptr = get_group(index).get_value(index % GROUP_SIZE);
+        if constexpr (!assign)
+          return { ptr, InsertionResult::EXISTS };
+        else
+        {
+          *ptr = value;
+          return { ptr, InsertionResult::ASSIGNED };
+        }
+      }
+      Group& slot_group = get_group(index);
+      slot_group.keys[index % GROUP_SIZE] = key;
+      Value* ptr = new(slot_group.get_value(index % GROUP_SIZE)) Value(value);
+      ++size;
+      return { ptr, InsertionResult::SUCCESS };
+    }
+
+    /// @brief Reallocates the slots, rehashing all the keys
+    /// @param new_capacity The new count of slots (a power of 2)
+    void realloc_map(size_t new_capacity) noexcept
+    {
+      COLT_TRACE_BEGIN("IntMap::realloc_map");
+      memory::TypedBlock<Group> old_groups = groups;
+      allocate_groups(new_capacity);
+      for (size_t i = 0; i < old_groups.get_size(); i++)
+      {
+        Group& old_group = old_groups.get_ptr()[i];
+        for (size_t lane = 0; lane < GROUP_SIZE; lane++)
+        {
+          const Key key = old_group.keys[lane];
+          if (key == EMPTY_KEY)
+            continue;
+          //The keys are distinct: the probe always ends on an EMPTY slot
+          size_t index;
+          probe(key, hasher(key), index);
+          Group& group = get_group(index);
+          group.keys[index % GROUP_SIZE] = key;
+          new(group.get_value(index % GROUP_SIZE)) Value(std::move(*old_group.get_value(lane)));
+          old_group.get_value(lane)->~Value();
+        }
+      }
+      memory::deallocate(old_groups);
+      COLT_TRACE_END("IntMap::realloc_map");
+    }
+  };
+
+#ifdef COLT_USE_IOSTREAMS
+
+  template<typename Key, typename Value, typename Hasher>
+  static std::ostream& operator<<(std::ostream& os, const IntMap<Key, Value, Hasher>& var) noexcept
+  {
+    static_assert(traits::is_coutable_v<Value>, "Value of IntMap should implement operator<<(std::ostream&)!");
+
+    bool is_first = true;
+    os << '[';
+    var.for_each([&](Key key, const Value& value)
+      {
+        os << (is_first ? "{ " : ", { ") << key << ": " << value << " }";
+        is_first = false;
+      });
+    os << ']';
+    return os;
+  }
+
+#endif
+}
+
+#endif //!HG_COLT_INT_MAP
@@ -6,19 +6,81 @@
 
 #include "../details/linear_probing.h"
 #include "../utility/Hash.h"
+#include "../utility/Parallel.h"
 #include "Vector.h"
 
 namespace colt
 {
-  template<typename Key, typename Value>
+  namespace details
+  {
+    /// @brief Indices grouped by the region of a hash table containing their home slot.
+    /// The indices of region 'r' are 'order[offsets[r]]' to 'order[offsets[r + 1]]' (excluded),
+    /// in increasing order.
+    struct RegionPartition
+    {
+      /// @brief The indices, grouped by region
+      Vector<size_t> order;
+      /// @brief The offset of the first index of each region, followed by the count of indices
+      Vector<size_t> offsets;
+    };
+
+    template<typename RegionFn>
+    /// @brief Groups the indices in [0, count) by region, on multiple threads (a parallel counting sort).
+    /// @tparam RegionFn The function type
+    /// @param count The count of indices
+    /// @param region_count The count of regions
+    /// @param thread_count The count of threads
+    /// @param region_of Returns the region of the index it receives, or 'region_count' to skip the index
+    /// @return The indices grouped by region
+    RegionPartition partition_by_region(size_t count, size_t region_count, size_t thread_count, RegionFn&& region_of) noexcept
+    {
+      const size_t chunk_size = (count + thread_count - 1) / thread_count;
+      //The count of indices of each (thread, region), then the offset where the thread writes them
+      Vector<size_t> counts = Vector<size_t>(thread_count * region_count, InPlace, static_cast<size_t>(0));
+      parallel_for_threads(thread_count, [&](size_t thread)
+        {
+          const size_t end = (thread + 1) * chunk_size < count ? (thread + 1) * chunk_size : count;
+          size_t* thread_counts = counts.get_data() + thread * region_count;
+          for (size_t i = thread * chunk_size; i < end; i++)
+            if (const size_t region = region_of(i); region != region_count)
+              ++thread_counts[region];
+        });
+
+      RegionPartition partition;
+      partition.offsets = Vector<size_t>(region_count + 1);
+      size_t total = 0;
+      for (size_t region = 0; region < region_count; region++)
+      {
+        partition.offsets.push_back(total);
+        for (size_t thread = 0; thread < thread_count; thread++)
+          total += colt::exchange(counts[thread * region_count + region], total);
+      }
+      partition.offsets.push_back(total);
+
+      partition.order = Vector<size_t>(total, InPlace, static_cast<size_t>(0));
+      parallel_for_threads(thread_count, [&](size_t thread)
+        {
+          const size_t end = (thread + 1) * chunk_size < count ? (thread + 1) * chunk_size : count;
+          size_t* thread_offsets = counts.get_data() + thread * region_count;
+          for (size_t i = thread * chunk_size; i < end; i++)
+            if (const size_t region = region_of(i); region != region_count)
+              partition.order[thread_offsets[region]++] = i;
+        });
+      return partition;
+    }
+  }
+
+  template<typename Key, typename Value, typename Hasher = DefaultHash<Key>, typename KeyEqual = DefaultEqual<Key>>
   /// @brief A unordered associative container that contains key/value pairs with unique keys.
   /// @tparam Key The Key that can be hashed through colt::hash or std::hash
   /// @tparam Value The Value that is accessed through the Key
+  /// @tparam Hasher The hash function of the keys (GetHash by default)
+  /// @tparam KeyEqual The equality comparison of the keys (operator== by default)
   class Map
   {
     static_assert(!traits::is_tag_v<Key> && !traits::is_tag_v<Value>, "Cannot use tag struct as typename!");
-    static_assert(traits::is_hashable_v<Key>, "Key of a Map should be hashable!");
-    static_assert(traits::is_equal_comparable_v<Key>, "Key of a Map should implement operator==!");
+    static_assert(std::is_invocable_r_v<size_t, const Hasher&, const Key&>, "Hasher of a Map should hash the Key!");
+    static_assert(std::is_invocable_r_v<bool, const KeyEqual&, const Key&, const Key&>, "KeyEqual of a Map should compare the Key!");
 
   public:
     using Slot = typename std::pair<const Key, Value>;
@@ -30,8 +92,18 @@ namespace colt
     memory::TypedBlock<Slot> slots = {};
     /// @brief The count of active objects in the container
     size_t size = 0;
+    /// @brief The count of DELETED slots, which count toward the load factor as they lengthen probes
+    size_t tombstone_count = 0;
     /// @brief The load factor before reallocation
     float load_factor = 0.70f;
+    /// @brief The hash function of the keys
+    Hasher hasher = {};
+    /// @brief The equality comparison of the keys
+    KeyEqual key_equal = {};
+#ifdef COLT_HASH_TABLE_STATS
+    /// @brief The lookup and rehash counters
+    mutable details::ProbeCounters probe_counters = {};
+#endif
 
     template<typename SlotT>
     /// @brief Map Iterator
@@ -96,11 +168,17 @@ namespace colt
 
   public:
     /// @brief Constructs an empty Map, of load factor 0.7
-    constexpr Map(float load_factor = 0.70f) noexcept;
+    /// @param load_factor The load factor (> 0.0f && < 1.0f)
+    /// @param hasher The hash function of the keys
+    /// @param key_equal The equality comparison of the keys
+    constexpr Map(float load_factor = 0.70f, const Hasher& hasher = Hasher{}, const KeyEqual& key_equal = KeyEqual{}) noexcept;
 
     /// @brief Constructs a Map of load factor 0.7, reserving memory for 'reserve_size' objects
     /// @param reserve_size The count of object to reserve for
-    constexpr Map(size_t reserve_size, float load_factor = 0.70f) noexcept;
+    /// @param load_factor The load factor (> 0.0f && < 1.0f)
+    /// @param hasher The hash function of the keys
+    /// @param key_equal The equality comparison of the keys
+    constexpr Map(size_t reserve_size, float load_factor = 0.70f, const Hasher& hasher = Hasher{}, const KeyEqual& key_equal = KeyEqual{}) noexcept;
 
     constexpr Map(const Map&) = delete;
 
@@ -146,7 +224,9 @@ namespace colt
     /// @return True if the Map is not empty
     constexpr bool is_not_empty() const noexcept { return size != 0; }
 
-    /// @brief Check if the Map will reallocate on the next call of insert/insertOrAssign
+    /// @brief Check if the Map will reallocate on the next call of insert/insertOrAssign.
+    /// The DELETED slots count toward the load factor: if they make most of the load,
+    /// the Map is rehashed without growing, which removes them.
     /// @return True if the Map will reallocate
     constexpr bool will_reallocate() const noexcept;
 
@@ -159,6 +239,18 @@ namespace colt
     /// @param nload_factor The new load factor
     constexpr void set_load_factor(float nload_factor) noexcept;
 
+    /// @brief Returns the hash function of the keys
+    /// @return The Hasher
+    constexpr const Hasher& get_hasher() const noexcept { return hasher; }
+    /// @brief Returns the equality comparison of the keys
+    /// @return The KeyEqual
+    constexpr const KeyEqual& get_key_equal() const noexcept { return key_equal; }
+
+    /// @brief Computes the occupancy and probing statistics of the Map.
+    /// This function rehashes all the keys, and is O(capacity).
+    /// @return The statistics of the Map
+    HashTableStats get_stats() const noexcept;
+
     /// @brief Finds the key/value pair of key 'key'
     /// @param key The key to search for
     /// @return Pointer to the key/value pair if found, or null
@@ -169,6 +261,29 @@ namespace colt
     /// @return Pointer to the key/value pair if found, or null
     constexpr Slot* find(traits::copy_if_trivial_t<const Key&> key) noexcept;
 
+    /// @brief Finds the key/value pair of key 'key', whose hash was already computed
+    /// @param key The key to search for
+    /// @param key_hash The hash of 'key' (through 'get_hasher()')
+    /// @return Pointer to the key/value pair if found, or null
+    constexpr const Slot* find_hashed(traits::copy_if_trivial_t<const Key&> key, size_t key_hash) const noexcept;
+
+    /// @brief Finds the key/value pair of key 'key', whose hash was already computed
+    /// @param key The key to search for
+    /// @param key_hash The hash of 'key' (through 'get_hasher()')
+    /// @return Pointer to the key/value pair if found, or null
+    constexpr Slot* find_hashed(traits::copy_if_trivial_t<const Key&> key, size_t key_hash) noexcept;
+
+    /// @brief Hints the processor to load the first slot probed for a key of hash 'key_hash'.
+    /// Prefetching the slots of a batch of keys before looking them up hides the latency
+    /// of the cache misses of a Map larger than the cache.
+    /// @param key_hash The hash of the key (through 'get_hasher()')
+    void prefetch(size_t key_hash) const noexcept
+    {
+      const size_t index = key_hash % slots.get_size();
+      COLT_PREFETCH(sentinel_metadata.get_data() + index);
+      COLT_PREFETCH(slots.get_ptr() + index);
+    }
+
     /// @brief Check if the Map contains a key/value pair of key 'key'.
     /// Prefer using 'find' if the value which is being checked for will be used.
     /// @param key The key to check for
@@ -191,6 +306,20 @@ namespace colt
         && std::is_nothrow_copy_constructible_v<Key>
         && std::is_nothrow_copy_constructible_v<Value>);
 
+    /// @brief Inserts a new value if 'key', whose hash was already computed, does not already exist.
+    /// See 'insert' for the returned values.
+    /// @param key The key of the value 'value'
+    /// @param key_hash The hash of 'key' (through 'get_hasher()')
+    /// @param value The value to insert
+    /// @return Pair of pointer to the inserted slot or the existent one, and SUCESS on insertion or EXISTS if the key already exists
+    constexpr std::pair<Slot*, InsertionResult> insert_hashed(traits::copy_if_trivial_t<const Key&> key, size_t key_hash, traits::copy_if_trivial_t<const Value&> value)
+      noexcept(std::is_nothrow_destructible_v<Key>
+        && std::is_nothrow_destructible_v<Value>
+        && std::is_nothrow_move_constructible_v<Key>
+        && std::is_nothrow_move_constructible_v<Value>
+        && std::is_nothrow_copy_constructible_v<Key>
+        && std::is_nothrow_copy_constructible_v<Value>);
+
     /// @brief Insert a new value if 'key' does not already exist, else assigns 'value' to the existing value.
     /// Returns an InsertionResult SUCCESS (if the insertion was performed) or ASSIGNED (if the key already exists and was assigned).
     /// The returned pointer is to the newly inserted key/value on SUCCESS.
@@ -215,12 +344,26 @@ namespace colt
       noexcept(std::is_nothrow_destructible_v<Key>
         && std::is_nothrow_destructible_v<Value>);
 
+    /// @brief Sets the capacity of the Map, rehashing on multiple threads if it contains
+    /// at least PARALLEL_THRESHOLD elements
+    /// @param by_more The new capacity
     constexpr void reserve(size_t by_more)
       noexcept(std::is_nothrow_destructible_v<Key>
         && std::is_nothrow_destructible_v<Value>
         && std::is_nothrow_move_constructible_v<Key>
         && std::is_nothrow_move_constructible_v<Value>);
 
+    /// @brief Inserts all the key/value pairs whose key does not already exist, on multiple threads.
+    /// The table is reallocated at most once, to fit all the pairs, then each thread
+    /// inserts the pairs whose home slot is in a disjoint region of the table.
+    /// The pairs whose probe would cross the end of their region are inserted afterwards.
+    /// As for 'insert', the first pair of a key that appears multiple times is the one inserted.
+    /// Small inputs are inserted on the calling thread.
+    /// @param pairs The key/value pairs to insert
+    /// @param thread_count The count of threads (0 for the default count)
+    /// @return The count of pairs inserted
+    size_t bulk_build(ContiguousView<std::pair<Key, Value>> pairs, size_t thread_count = 0) noexcept;
+
     /// @brief Calls 'find' on 'key'
     /// @param key The key to search for
     /// @return Pointer to the found slot or null if not found
@@ -239,7 +382,7 @@ namespace colt
 
   private:
     /// @brief Finds a EMPTY/ACTIVE/DELETED slot matching 'key_hash'
-    /// @param key_hash The hash of 'key', obtained through 'GetHash'.
+    /// @param key_hash The hash of 'key', obtained through the Hasher.
     /// This function does not perform a hash of 'key' as usually the function
     /// that calls this function already possesses that hash.
     /// @param key The key to search for.
@@ -247,9 +390,16 @@ namespace colt
     /// @param prob The reference where to write the offset to the slot
     /// @param metadata The Vector of KeySentinel representing the state of 'blk'
     /// @param blk The array of slots
-    /// @return True if the slot found is empty/deleted, false if the slot is already occupied
-    static constexpr bool find_key(size_t key_hash, traits::copy_if_trivial_t<const Key&> key, size_t& prob,
-      const Vector<details::KeySentinel>& metadata, memory::TypedBlock<Slot> blk) noexcept;
+    /// @return True if the key was not found ('prob' is then the first DELETED or EMPTY slot), false if the slot is already occupied
+    constexpr bool find_key(size_t key_hash, traits::copy_if_trivial_t<const Key&> key, size_t& prob,
+      const Vector<details::KeySentinel>& metadata, memory::TypedBlock<Slot> blk) const noexcept;
+
+    /// @brief Returns the capacity of the rehash triggered by an insertion
+    /// @return The same capacity if the active slots fill at most half the load factor, else a greater one
+    constexpr size_t next_capacity() const noexcept
+    {
+      return float(get_size() + 1) > load_factor * get_capacity() / 2 ? get_capacity() + 16 : get_capacity();
+    }
 
     /// @brief Augments the capacity of the Map, rehashing in the process
     /// @param new_capacity The new capacity of the map
@@ -258,25 +408,65 @@ namespace colt
         && std::is_nothrow_destructible_v<Value>
         && std::is_nothrow_move_constructible_v<Key>
         && std::is_nothrow_move_constructible_v<Value>);
+
+    /// @brief Augments the capacity of the Map, rehashing on multiple threads
+    /// @param new_capacity The new capacity of the map
+    /// @param thread_count The count of threads
+    void realloc_map_parallel(size_t new_capacity, size_t thread_count) noexcept;
+
+    /// @brief Augments the capacity of the Map, rehashing on multiple threads if the Map is large.
+    /// Only used by 'reserve' and 'bulk_build': the threads are created on each call, which
+    /// would be too costly for the rehashes triggered by 'insert'.
+    /// @param new_capacity The new capacity of the map
+    /// @param thread_count The count of threads (0 for the default count)
+    void realloc_map_threads(size_t new_capacity, size_t thread_count) noexcept;
+
+    /// @brief Returns the count of regions of a table of 'capacity' slots built on 'thread_count' threads
+    /// @param capacity The capacity of the table
+    /// @param thread_count The count of threads
+    /// @return The count of regions (more regions than threads to balance the work)
+    static constexpr size_t region_count_for(size_t capacity, size_t thread_count) noexcept
+    {
+      const size_t count = thread_count * 8;
+      //Regions should be much bigger than clusters, else most probes would cross regions
+      return capacity / count < 4096 ? (capacity / 4096 == 0 ? 1 : capacity / 4096) : count;
+    }
+
+  public:
+    /// @brief The count of active elements from which 'reserve' and 'bulk_build' use multiple threads
+    static constexpr size_t PARALLEL_THRESHOLD = 1 << 16;
   };
 
-  template<typename Key, typename Value>
-  constexpr bool Map<Key, Value>::find_key(size_t key_hash, traits::copy_if_trivial_t<const Key&> key, size_t& prob, const Vector<details::KeySentinel>& metadata, memory::TypedBlock<Slot> blk) noexcept
+  template<typename Key, typename Value, typename Hasher, typename KeyEqual>
+  constexpr bool Map<Key, Value, Hasher, KeyEqual>::find_key(size_t key_hash, traits::copy_if_trivial_t<const Key&> key, size_t& prob, const Vector<details::KeySentinel>& metadata, memory::TypedBlock<Slot> blk) const noexcept
   {
-    assert(key_hash == GetHash(key));
+    assert(key_hash == hasher(key));
     assert(metadata.get_size() == blk.get_size());
     size_t prob_index = key_hash % blk.get_size();
-    for (;;)
+    //The first DELETED slot is reused if the key is not found
+    size_t first_deleted = blk.get_size();
+    //Each slot is inspected at most once, as the table may have no EMPTY slot left
+    for (size_t i = 0; i < blk.get_size(); i++)
     {
+#ifdef COLT_HASH_TABLE_STATS
+      //The rehashes probe a new table: only the lookups in this table are counted
+      if (&metadata == &sentinel_metadata)
+        ++probe_counters.probe_count;
+#endif
       if (auto sentinel = metadata[prob_index];
-        details::is_sentinel_empty(sentinel) || details::is_sentinel_deleted(sentinel))
+        details::is_sentinel_empty(sentinel))
       {
-        prob = prob_index;
+        prob = first_deleted != blk.get_size() ? first_deleted : prob_index;
         return true;
       }
+      else if (details::is_sentinel_deleted(sentinel))
+      {
+        if (first_deleted == blk.get_size())
+          first_deleted = prob_index;
+      }
       else if (details::is_sentinel_equal(sentinel, key_hash))
       {
-        if (blk.get_ptr()[prob_index].first == key)
+        if (key_equal(blk.get_ptr()[prob_index].first, key))
         {
           prob = prob_index;
           return false;
@@ -284,12 +474,19 @@ namespace colt
       }
       prob_index = details::advance_prob(prob_index, blk.get_size());
     }
+    assert(first_deleted != blk.get_size() && "The table has no free slot!");
+    prob = first_deleted;
+    return true;
   }
 
-  template<typename Key, typename Value>
-  constexpr void Map<Key, Value>::realloc_map(size_t new_capacity) noexcept(std::is_nothrow_destructible_v<Key>&& std::is_nothrow_destructible_v<Value>&& std::is_nothrow_move_constructible_v<Key>&& std::is_nothrow_move_constructible_v<Value>)
+  template<typename Key, typename Value, typename Hasher, typename KeyEqual>
+  constexpr void Map<Key, Value, Hasher, KeyEqual>::realloc_map(size_t new_capacity) noexcept(std::is_nothrow_destructible_v<Key>&& std::is_nothrow_destructible_v<Value>&& std::is_nothrow_move_constructible_v<Key>&& std::is_nothrow_move_constructible_v<Value>)
   {
+    COLT_TRACE_BEGIN("Map::realloc_map");
     memory::TypedBlock<Slot> new_slot = memory::allocate({ new_capacity * sizeof(Slot) });
+#ifdef COLT_HASH_TABLE_STATS
+    ++probe_counters.rehash_count;
+#endif
 
     Vector<details::KeySentinel> new_metadata = { new_capacity, InPlace, details::EMPTY };
     for (size_t i = 0; i < sentinel_metadata.get_size(); i++)
@@ -299,7 +496,7 @@ namespace colt
       {
         //find the key
         Slot* ptr = slots.get_ptr() + i;
-        const size_t key_hash = GetHash(ptr->first);
+        const size_t key_hash = hasher(ptr->first);
         size_t prob_index;
         //Rehash the key to get its new index in the new array
         if (find_key(key_hash, ptr->first, prob_index, new_metadata, new_slot))
@@ -316,42 +513,49 @@ namespace colt
     sentinel_metadata = std::move(new_metadata);
     memory::deallocate(slots);
     slots = new_slot;
+    tombstone_count = 0;
+    COLT_TRACE_END("Map::realloc_map");
   }
 
-  template<typename Key, typename Value>
-  constexpr Map<Key, Value>::Map(float load_factor) noexcept
+  template<typename Key, typename Value, typename Hasher, typename KeyEqual>
+  constexpr Map<Key, Value, Hasher, KeyEqual>::Map(float load_factor, const Hasher& hasher, const KeyEqual& key_equal) noexcept
     : sentinel_metadata(16, InPlace, details::EMPTY)
     , slots(memory::allocate({ 16 * sizeof(Slot) }))
     , load_factor(load_factor)
+    , hasher(hasher), key_equal(key_equal)
   {
     assert(0.0f < load_factor && load_factor < 1.0f && "Invalid load factor!");
   }
 
-  template<typename Key, typename Value>
-  constexpr Map<Key, Value>::Map(size_t reserve_size, float load_factor) noexcept
+  template<typename Key, typename Value, typename Hasher, typename KeyEqual>
+  constexpr Map<Key, Value, Hasher, KeyEqual>::Map(size_t reserve_size, float load_factor, const Hasher& hasher, const KeyEqual& key_equal) noexcept
     : sentinel_metadata(reserve_size, InPlace, details::EMPTY)
     , slots(memory::allocate({ reserve_size * sizeof(Slot) }))
     , load_factor(load_factor)
+    , hasher(hasher), key_equal(key_equal)
   {
     assert(0.0f < load_factor && load_factor < 1.0f && "Invalid load factor!");
   }
 
-  template<typename Key, typename Value>
-  constexpr Map<Key, Value>::Map(Map&& mp) noexcept
+  template<typename Key, typename Value, typename Hasher, typename KeyEqual>
+  constexpr Map<Key, Value, Hasher, KeyEqual>::Map(Map&& mp) noexcept
     : sentinel_metadata(std::move(mp.sentinel_metadata))
     , slots(colt::exchange(mp.slots, {}))
+    , size(colt::exchange(mp.size, 0))
+    , tombstone_count(colt::exchange(mp.tombstone_count, 0))
     , load_factor(mp.load_factor)
+    , hasher(mp.hasher), key_equal(mp.key_equal)
   {}
 
-  template<typename Key, typename Value>
-  Map<Key, Value>::~Map() noexcept(std::is_nothrow_destructible_v<Key>&& std::is_nothrow_destructible_v<Value>)
+  template<typename Key, typename Value, typename Hasher, typename KeyEqual>
+  Map<Key, Value, Hasher, KeyEqual>::~Map() noexcept(std::is_nothrow_destructible_v<Key>&& std::is_nothrow_destructible_v<Value>)
   {
     clear();
     memory::deallocate(slots);
   }
 
-  template<typename Key, typename Value>
-  constexpr void Map<Key, Value>::clear() noexcept(std::is_nothrow_destructible_v<Key>&& std::is_nothrow_destructible_v<Value>)
+  template<typename Key, typename Value, typename Hasher, typename KeyEqual>
+  constexpr void Map<Key, Value, Hasher, KeyEqual>::clear() noexcept(std::is_nothrow_destructible_v<Key>&& std::is_nothrow_destructible_v<Value>)
   {
     for (size_t i = 0; i < sentinel_metadata.get_size(); i++)
     {
@@ -362,10 +566,11 @@ namespace colt
       sentinel_metadata[i] = details::EMPTY;
     }
     size = 0;
+    tombstone_count = 0;
   }
 
-  template<typename Key, typename Value>
-  constexpr Map<Key, Value>::MapIterator<std::pair<const Key, Value>> Map<Key, Value>::begin() noexcept
+  template<typename Key, typename Value, typename Hasher, typename KeyEqual>
+  constexpr Map<Key, Value, Hasher, KeyEqual>::MapIterator<std::pair<const Key, Value>> Map<Key, Value, Hasher, KeyEqual>::begin() noexcept
   {
     for (size_t i = 0; i < sentinel_metadata.get_size(); i++)
     {
@@ -375,14 +580,14 @@ namespace colt
     return end();
   }
 
-  template<typename Key, typename Value>
-  constexpr Map<Key, Value>::MapIterator<std::pair<const Key, Value>> Map<Key, Value>::end() noexcept
+  template<typename Key, typename Value, typename Hasher, typename KeyEqual>
+  constexpr Map<Key, Value, Hasher, KeyEqual>::MapIterator<std::pair<const Key, Value>> Map<Key, Value, Hasher, KeyEqual>::end() noexcept
   {
     return { slots.get_ptr() + slots.get_size(), this };
   }
 
-  template<typename Key, typename Value>
-  constexpr Map<Key, Value>::MapIterator<const std::pair<const Key, Value>> Map<Key, Value>::begin() const noexcept
+  template<typename Key, typename Value, typename Hasher, typename KeyEqual>
+  constexpr Map<Key, Value, Hasher, KeyEqual>::MapIterator<const std::pair<const Key, Value>> Map<Key, Value, Hasher, KeyEqual>::begin() const noexcept
   {
     for (size_t i = 0; i < sentinel_metadata.get_size(); i++)
     {
@@ -392,39 +597,71 @@ namespace colt
     return end();
   }
 
-  template<typename Key, typename Value>
-  constexpr Map<Key, Value>::MapIterator<const std::pair<const Key, Value>> Map<Key, Value>::end() const noexcept
+  template<typename Key, typename Value, typename Hasher, typename KeyEqual>
+  constexpr Map<Key, Value, Hasher, KeyEqual>::MapIterator<const std::pair<const Key, Value>> Map<Key, Value, Hasher, KeyEqual>::end() const noexcept
   {
     return { slots.get_ptr() + slots.get_size(), this };
   }
 
-  template<typename Key, typename Value>
-  constexpr bool Map<Key, Value>::will_reallocate() const noexcept
+  template<typename Key, typename Value, typename Hasher, typename KeyEqual>
+  constexpr bool Map<Key, Value, Hasher, KeyEqual>::will_reallocate() const noexcept
   {
-    return float(get_size() + 1) > load_factor * get_capacity();
+    return float(get_size() + tombstone_count + 1) > load_factor * get_capacity();
   }
 
-  template<typename Key, typename Value>
-  constexpr void Map<Key, Value>::set_load_factor(float nload_factor) noexcept
+  template<typename Key, typename Value, typename Hasher, typename KeyEqual>
+  constexpr void Map<Key, Value, Hasher, KeyEqual>::set_load_factor(float nload_factor) noexcept
   {
     assert(nload_factor < 1.0f && nload_factor > 0.0f && "Invalid load factor!");
     load_factor = nload_factor;
   }
 
-  template<typename Key, typename Value>
-  constexpr typename Map<Key, Value>::Slot* Map<Key, Value>::find(traits::copy_if_trivial_t<const Key&> key) noexcept
+  template<typename Key, typename Value, typename Hasher, typename KeyEqual>
+  HashTableStats Map<Key, Value, Hasher, KeyEqual>::get_stats() const noexcept
+  {
+    HashTableStats stats = details::compute_hash_table_stats(sentinel_metadata.get_data(), slots.get_size(), sizeof(Slot),
+      [this](size_t index) { return hasher(slots.get_ptr()[index].first); });
+#ifdef COLT_HASH_TABLE_STATS
+    stats.lookup_count = probe_counters.lookup_count;
+    stats.probe_count = probe_counters.probe_count;
+    stats.rehash_count = probe_counters.rehash_count;
+#endif
+    return stats;
+  }
+
+  template<typename Key, typename Value, typename Hasher, typename KeyEqual>
+  constexpr typename Map<Key, Value, Hasher, KeyEqual>::Slot* Map<Key, Value, Hasher, KeyEqual>::find(traits::copy_if_trivial_t<const Key&> key) noexcept
   {
     //No UB as the map is not const
     return const_cast<Slot*>(static_cast<const Map*>(this)->find(key));
   }
 
-  template<typename Key, typename Value>
-  constexpr const std::pair<const Key, Value>* Map<Key, Value>::find(traits::copy_if_trivial_t<const Key&> key) const noexcept
+  template<typename Key, typename Value, typename Hasher, typename KeyEqual>
+  constexpr const std::pair<const Key, Value>* Map<Key, Value, Hasher, KeyEqual>::find(traits::copy_if_trivial_t<const Key&> key) const noexcept
+  {
+    return find_hashed(key, hasher(key));
+  }
+
+  template<typename Key, typename Value, typename Hasher, typename KeyEqual>
+  constexpr typename Map<Key, Value, Hasher, KeyEqual>::Slot* Map<Key, Value, Hasher, KeyEqual>::find_hashed(traits::copy_if_trivial_t<const Key&> key, size_t key_hash) noexcept
+  {
+    //No UB as the map is not const
+    return const_cast<Slot*>(static_cast<const Map*>(this)->find_hashed(key, key_hash));
+  }
+
+  template<typename Key, typename Value, typename Hasher, typename KeyEqual>
+  constexpr const std::pair<const Key, Value>* Map<Key, Value, Hasher, KeyEqual>::find_hashed(traits::copy_if_trivial_t<const Key&> key, size_t key_hash) const noexcept
   {
-    const size_t key_hash = GetHash(key);
     size_t prob_index = key_hash % slots.get_size();
-    for (;;)
+#ifdef COLT_HASH_TABLE_STATS
+    ++probe_counters.lookup_count;
+#endif
+    //Each slot is inspected at most once, as the table may have no EMPTY slot left
+    for (size_t i = 0; i < slots.get_size(); i++)
     {
+#ifdef COLT_HASH_TABLE_STATS
+      ++probe_counters.probe_count;
+#endif
       if (auto sentinel = sentinel_metadata[prob_index];
         details::is_sentinel_empty(sentinel))
       {
@@ -437,21 +674,22 @@ namespace colt
       }
       else if (details::is_sentinel_equal(sentinel, key_hash))
       {
-        if (slots.get_ptr()[prob_index].first == key)
+        if (key_equal(slots.get_ptr()[prob_index].first, key))
           return slots.get_ptr() + prob_index;
       }
       prob_index = details::advance_prob(prob_index, slots.get_size());
     }
+    return nullptr;
   }
 
-  template<typename Key, typename Value>
-  constexpr bool Map<Key, Value>::contains(traits::copy_if_trivial_t<const Key&> key) const noexcept
+  template<typename Key, typename Value, typename Hasher, typename KeyEqual>
+  constexpr bool Map<Key, Value, Hasher, KeyEqual>::contains(traits::copy_if_trivial_t<const Key&> key) const noexcept
   {
     return find(key) != nullptr;
   }
 
-  template<typename Key, typename Value>
-  constexpr std::pair<typename Map<Key, Value>::Slot*, InsertionResult> Map<Key, Value>::insert_or_assign(traits::copy_if_trivial_t<const Key&> key, traits::copy_if_trivial_t<const Value&> value)
+  template<typename Key, typename Value, typename Hasher, typename KeyEqual>
+  constexpr std::pair<typename Map<Key, Value, Hasher, KeyEqual>::Slot*, InsertionResult> Map<Key, Value, Hasher, KeyEqual>::insert_or_assign(traits::copy_if_trivial_t<const Key&> key, traits::copy_if_trivial_t<const Value&> value)
     noexcept(std::is_nothrow_destructible_v<Key>
       && std::is_nothrow_destructible_v<Value>
       && std::is_nothrow_move_constructible_v<Key>
@@ -461,12 +699,17 @@ namespace colt
       && std::is_nothrow_copy_assignable_v<Value>)
   {
     if (will_reallocate())
-      realloc_map(get_capacity() + 16);
+      realloc_map(next_capacity());
 
-    const size_t key_hash = GetHash(key);
+    const size_t key_hash = hasher(key);
     size_t prob_index;
-    if (find_key(key_hash, key, prob_index, sentinel_metadata, slots))
+    const bool is_free = find_key(key_hash, key, prob_index, sentinel_metadata, slots);
+#ifdef COLT_HASH_TABLE_STATS
+    ++probe_counters.lookup_count;
+#endif
+    if (is_free)
     {
+      tombstone_count -= details::is_sentinel_deleted(sentinel_metadata[prob_index]);
       new(slots.get_ptr() + prob_index) Slot(key, value);
       //Set the slot to ACTIVE
       sentinel_metadata[prob_index] = details::create_active_sentinel(key_hash);
@@ -481,30 +724,226 @@ namespace colt
     }
   }
 
-  template<typename Key, typename Value>
-  constexpr bool Map<Key, Value>::erase(traits::copy_if_trivial_t<const Key&> key) noexcept(std::is_nothrow_destructible_v<Key>&& std::is_nothrow_destructible_v<Value>)
+  template<typename Key, typename Value, typename Hasher, typename KeyEqual>
+  constexpr bool Map<Key, Value, Hasher, KeyEqual>::erase(traits::copy_if_trivial_t<const Key&> key) noexcept(std::is_nothrow_destructible_v<Key>&& std::is_nothrow_destructible_v<Value>)
   {
     if (Slot* ptr = find(key))
     {
-      size_t index = (slots.get_ptr() + slots.get_size()) - ptr;
+      size_t index = ptr - slots.get_ptr();
       sentinel_metadata[index] = details::DELETED; //set the sentinel to deleted
       ptr->~Slot(); //destroy the key/value pair
       //Update size
       --size;
+      ++tombstone_count;
       return true;
     }
     else
       return false;
   }
 
-  template<typename Key, typename Value>
-  constexpr void Map<Key, Value>::reserve(size_t by_more) noexcept(std::is_nothrow_destructible_v<Key>&& std::is_nothrow_destructible_v<Value>&& std::is_nothrow_move_constructible_v<Key>&& std::is_nothrow_move_constructible_v<Value>)
+  template<typename Key, typename Value, typename Hasher, typename KeyEqual>
+  constexpr void Map<Key, Value, Hasher, KeyEqual>::reserve(size_t by_more) noexcept(std::is_nothrow_destructible_v<Key>&& std::is_nothrow_destructible_v<Value>&& std::is_nothrow_move_constructible_v<Key>&& std::is_nothrow_move_constructible_v<Value>)
+  {
+    realloc_map_threads(by_more, 0);
+  }
+
+  template<typename Key, typename Value, typename Hasher, typename KeyEqual>
+  void Map<Key, Value, Hasher, KeyEqual>::realloc_map_threads(size_t new_capacity, size_t thread_count) noexcept
   {
-    realloc_map(by_more);
+    thread_count = thread_count == 0 ? get_default_thread_count() : thread_count;
+    if (size >= PARALLEL_THRESHOLD && thread_count > 1)
+      realloc_map_parallel(new_capacity, thread_count);
+    else
+      realloc_map(new_capacity);
   }
 
-  template<typename Key, typename Value>
-  constexpr std::pair<typename Map<Key, Value>::Slot*, InsertionResult> Map<Key, Value>::insert(traits::copy_if_trivial_t<const Key&> key, traits::copy_if_trivial_t<const Value&> value)
+  template<typename Key, typename Value, typename Hasher, typename KeyEqual>
+  void Map<Key, Value, Hasher, KeyEqual>::realloc_map_parallel(size_t new_capacity, size_t thread_count) noexcept
+  {
+    COLT_TRACE_BEGIN("Map::realloc_map_parallel");
+    memory::TypedBlock<Slot> new_slot = memory::allocate({ new_capacity * sizeof(Slot) });
+    Vector<details::KeySentinel> new_metadata = { new_capacity, InPlace, details::EMPTY };
+#ifdef COLT_HASH_TABLE_STATS
+    ++probe_counters.rehash_count;
+#endif
+
+    const size_t old_capacity = slots.get_size();
+    Vector<size_t> hashes = Vector<size_t>(old_capacity, InPlace, static_cast<size_t>(0));
+    parallel_for(old_capacity, [&](size_t i)
+      {
+        if (details::is_sentinel_active(sentinel_metadata[i]))
+          hashes[i] = hasher(slots.get_ptr()[i].first);
+      }, 4096, thread_count);
+
+    const size_t region_count = region_count_for(new_capacity, thread_count);
+    const size_t region_size = (new_capacity + region_count - 1) / region_count;
+    const details::RegionPartition partition = details::partition_by_region(old_capacity, region_count, thread_count,
+      [&](size_t i) { return details::is_sentinel_active(sentinel_metadata[i]) ? (hashes[i] % new_capacity) / region_size : region_count; });
+
+    //The keys are distinct: each key is moved to the first free slot of its probe.
+    //The regions are disjoint, so no two threads write to the same slot.
+    Vector<Vector<size_t>> overflows = Vector<Vector<size_t>>(region_count, InPlace);
+    parallel_for(region_count, [&](size_t region)
+      {
+        const size_t region_end = (region + 1) * region_size < new_capacity ? (region + 1) * region_size : new_capacity;
+        for (size_t i = partition.offsets[region]; i < partition.offsets[region + 1]; i++)
+        {
+          const size_t old_index = partition.order[i];
+          size_t prob_index = hashes[old_index] % new_capacity;
+          while (prob_index != region_end && details::is_sentinel_active(new_metadata[prob_index]))
+            ++prob_index;
+          if (prob_index == region_end)
+          {
+            overflows[region].push_back(old_index);
+            continue;
+          }
+          new(new_slot.get_ptr() + prob_index) Slot(std::move(slots.get_ptr()[old_index]));
+          slots.get_ptr()[old_index].~Slot();
+          new_metadata[prob_index] = details::create_active_sentinel(hashes[old_index]);
+        }
+      }, 1, thread_count);
+
+    //The keys whose probe crossed their region are placed after all the regions are filled
+    for (const auto& overflow : overflows)
+    {
+      for (auto old_index : overflow)
+      {
+        size_t prob_index = hashes[old_index] % new_capacity;
+        while (details::is_sentinel_active(new_metadata[prob_index]))
+          prob_index = details::advance_prob(prob_index, new_capacity);
+        new(new_slot.get_ptr() + prob_index) Slot(std::move(slots.get_ptr()[old_index]));
+        slots.get_ptr()[old_index].~Slot();
+        new_metadata[prob_index] = details::create_active_sentinel(hashes[old_index]);
+      }
+    }
+    sentinel_metadata = std::move(new_metadata);
+    memory::deallocate(slots);
+    slots = new_slot;
+    tombstone_count = 0;
+    COLT_TRACE_END("Map::realloc_map_parallel");
+  }
+
+  template<typename Key, typename Value, typename Hasher, typename KeyEqual>
+  size_t Map<Key, Value, Hasher, KeyEqual>::bulk_build(ContiguousView<std::pair<Key, Value>> pairs, size_t thread_count) noexcept
+  {
+    const size_t count = pairs.get_size();
+    thread_count = thread_count == 0 ? get_default_thread_count() : thread_count;
+
+    //Sizes the table once, so that no insertion reallocates
+    const size_t required = static_cast<size_t>(static_cast<double>(size + count) / load_factor) + 1;
+    if (required > get_capacity())
+      realloc_map_threads(required, thread_count);
+
+    if (count < PARALLEL_THRESHOLD || thread_count <= 1)
+    {
+      size_t inserted = 0;
+      for (const auto& pair : pairs)
+        inserted += insert(pair.first, pair.second).second == InsertionResult::SUCCESS;
+      return inserted;
+    }
+
+    COLT_TRACE_BEGIN("Map::bulk_build");
+    const size_t capacity = get_capacity();
+    Vector<size_t> hashes = Vector<size_t>(count, InPlace, static_cast<size_t>(0));
+    parallel_for(count, [&](size_t i) { hashes[i] = hasher(pairs[i].first); }, 4096, thread_count);
+
+    const size_t region_count = region_count_for(capacity, thread_count);
+    const size_t region_size = (capacity + region_count - 1) / region_count;
+    const details::RegionPartition partition = details::partition_by_region(count, region_count, thread_count,
+      [&](size_t i) { return (hashes[i] % capacity) / region_size; });
+
+    //The pairs of a region are inserted in the order of 'pairs' by a single thread,
+    //so the first pair of a key is inserted as by 'insert'.
+    Vector<Vector<size_t>> overflows = Vector<Vector<size_t>>(region_count, InPlace);
+    Vector<size_t> inserted = Vector<size_t>(region_count, InPlace, static_cast<size_t>(0));
+    Vector<size_t> reused = Vector<size_t>(region_count, InPlace, static_cast<size_t>(0));
+    parallel_for(region_count, [&](size_t region)
+      {
+        const size_t region_end = (region + 1) * region_size < capacity ? (region + 1) * region_size : capacity;
+        for (size_t i = partition.offsets[region]; i < partition.offsets[region + 1]; i++)
+        {
+          const size_t index = partition.order[i];
+          const size_t key_hash = hashes[index];
+          size_t prob_index = key_hash % capacity;
+          //The key may be stored after a DELETED slot: only an EMPTY slot ends the probe,
+          //then the key is inserted in the first DELETED slot of the probe if any.
+          size_t first_deleted = region_end;
+          bool exists = false;
+          for (; prob_index != region_end; ++prob_index)
+          {
+            const auto sentinel = sentinel_metadata[prob_index];
+            if (details::is_sentinel_empty(sentinel))
+              break;
+            if (details::is_sentinel_deleted(sentinel))
+            {
+              first_deleted = first_deleted == region_end ? prob_index : first_deleted;
+              continue;
+            }
+            if (details::is_sentinel_equal(sentinel, key_hash) && key_equal(slots.get_ptr()[prob_index].first, pairs[index].first))
+            {
+              exists = true;
+              break;
+            }
+          }
+          if (exists)
+            continue;
+          if (prob_index == region_end)
+          {
+            overflows[region].push_back(index);
+            continue;
+          }
+          reused[region] += first_deleted != region_end;
+          prob_index = first_deleted != region_end ? first_deleted : prob_index;
+          new(slots.get_ptr() + prob_index) Slot(pairs[index].first, pairs[index].second);
+          sentinel_metadata[prob_index] = details::create_active_sentinel(key_hash);
+          ++inserted[region];
+        }
+      }, 1, thread_count);
+
+    size_t total = 0;
+    for (size_t region = 0; region < region_count; region++)
+    {
+      total += inserted[region];
+      tombstone_count -= reused[region];
+    }
+    size += total;
+    //The pairs whose probe crossed their region, in the order of the regions
+    for (const auto& overflow : overflows)
+    {
+      for (auto index : overflow)
+      {
+        size_t prob_index;
+        if (find_key(hashes[index], pairs[index].first, prob_index, sentinel_metadata, slots))
+        {
+          tombstone_count -= details::is_sentinel_deleted(sentinel_metadata[prob_index]);
+          new(slots.get_ptr() + prob_index) Slot(pairs[index].first, pairs[index].second);
+          sentinel_metadata[prob_index] = details::create_active_sentinel(hashes[index]);
+          ++size;
+          ++total;
+        }
+      }
+    }
+#ifdef COLT_HASH_TABLE_STATS
+    probe_counters.lookup_count += count;
+#endif
+    COLT_TRACE_END("Map::bulk_build");
+    return total;
+  }
+
+  template<typename Key, typename Value, typename Hasher, typename KeyEqual>
+  constexpr std::pair<typename Map<Key, Value, Hasher, KeyEqual>::Slot*, InsertionResult> Map<Key, Value, Hasher, KeyEqual>::insert(traits::copy_if_trivial_t<const Key&> key, traits::copy_if_trivial_t<const Value&> value)
+    noexcept(std::is_nothrow_destructible_v<Key>
+      && std::is_nothrow_destructible_v<Value>
+      && std::is_nothrow_move_constructible_v<Key>
+      && std::is_nothrow_move_constructible_v<Value>
+      && std::is_nothrow_copy_constructible_v<Key>
+      && std::is_nothrow_copy_constructible_v<Value>)
+  {
+    return insert_hashed(key, hasher(key), value);
+  }
+
+  template<typename Key, typename Value, typename Hasher, typename KeyEqual>
+  constexpr std::pair<typename Map<Key, Value, Hasher, KeyEqual>::Slot*, InsertionResult> Map<Key, Value, Hasher, KeyEqual>::insert_hashed(traits::copy_if_trivial_t<const Key&> key, size_t key_hash, traits::copy_if_trivial_t<const Value&> value)
     noexcept(std::is_nothrow_destructible_v<Key>
       && std::is_nothrow_destructible_v<Value>
       && std::is_nothrow_move_constructible_v<Key>
@@ -513,12 +952,16 @@ namespace colt
       && std::is_nothrow_copy_constructible_v<Value>)
   {
     if (will_reallocate())
-      realloc_map(get_capacity() + 16);
+      realloc_map(next_capacity());
 
-    const size_t key_hash = GetHash(key);
     size_t prob_index;
-    if (find_key(key_hash, key, prob_index, sentinel_metadata, slots))
+    const bool is_free = find_key(key_hash, key, prob_index, sentinel_metadata, slots);
+#ifdef COLT_HASH_TABLE_STATS
+    ++probe_counters.lookup_count;
+#endif
+    if (is_free)
     {
+      tombstone_count -= details::is_sentinel_deleted(sentinel_metadata[prob_index]);
       new(slots.get_ptr() + prob_index) Slot(key, value);
       //Set the slot to ACTIVE
       sentinel_metadata[prob_index] = details::create_active_sentinel(key_hash);
@@ -530,9 +973,9 @@ namespace colt
       return { slots.get_ptr() + prob_index, InsertionResult::EXISTS };
   }
 
-  template<typename Key, typename Value>
+  template<typename Key, typename Value, typename Hasher, typename KeyEqual>
   template<typename SlotT>
-  constexpr Map<Key, Value>::MapIterator<SlotT>& Map<Key, Value>::MapIterator<SlotT>::operator++() noexcept
+  constexpr Map<Key, Value, Hasher, KeyEqual>::MapIterator<SlotT>& Map<Key, Value, Hasher, KeyEqual>::MapIterator<SlotT>::operator++() noexcept
   {
     size_t index = slot_ptr - map_ptr->slots.get_ptr() + 1;
     for (size_t i = index; i < map_ptr->sentinel_metadata.get_size(); i++)
@@ -548,9 +991,9 @@ namespace colt
     return *this;
   }
 
-  template<typename Key, typename Value>
+  template<typename Key, typename Value, typename Hasher, typename KeyEqual>
   template<typename SlotT>
-  constexpr Map<Key, Value>::MapIterator<SlotT> Map<Key, Value>::MapIterator<SlotT>::operator++(int) noexcept
+  constexpr Map<Key, Value, Hasher, KeyEqual>::MapIterator<SlotT> Map<Key, Value, Hasher, KeyEqual>::MapIterator<SlotT>::operator++(int) noexcept
   {
     MapIterator to_ret = *this; //copy
     ++(*this); //increment
@@ -559,8 +1002,8 @@ namespace colt
 
 #ifdef COLT_USE_IOSTREAMS
 
-  template<typename Key, typename Value>
-  static std::ostream& operator<<(std::ostream& os, const Map<Key, Value>& var) noexcept
+  template<typename Key, typename Value, typename Hasher, typename KeyEqual>
+  static std::ostream& operator<<(std::ostream& os, const Map<Key, Value, Hasher, KeyEqual>& var) noexcept
   {
     static_assert(traits::is_coutable_v<Key>, "Key of Map should implement operator<<(std::ostream&)!");
     static_assert(traits::is_coutable_v<Value>, "Value of Map should implement operator<<(std::ostream&)!");
@@ -584,4 +1027,4 @@ namespace colt
 #endif
 }
 
-#endif //!HG_COLT_MULTIMAP
\ No newline at end of file
+#endif //!HG_COLT_MAP
\ No newline at end of file
@@ -0,0 +1,337 @@
+/** @file MultiMap.h
+* Contains MultiMap, an associative container mapping each key to many values.
+* Contrary to a Map of Vector, MultiMap does not perform an allocation per key.
+* A MultiMap has two modes:
+* - incremental: the values of a key are appended to a list of chunks, which are
+*   all stored in a single Vector (and linked through their indices).
+* - frozen (through 'freeze' or 'build'): all the values are stored in a single
+*   Vector, grouped by key, and each key maps to the offset and count of its values
+*   (a CSR layout). Lookups then return a ContiguousView over the values.
+*/
+
+#ifndef HG_COLT_MULTIMAP
+#define HG_COLT_MULTIMAP
+
+#include <utility>
+
+#include "Map.h"
+
+namespace colt
+{
+  namespace details
+  {
+    template<typename Value, size_t chunk_size>
+    /// @brief Chunk of the values of a key of a MultiMap (in incremental mode)
+    /// @tparam Value The value type
+    /// @tparam chunk_size The count of values a chunk can contain
+    struct MultiMapChunk
+    {
+      /// @brief The index of the next chunk of the key (or NO_CHUNK)
+      size_t next = NO_CHUNK;
+      /// @brief The count of values in the chunk
+      size_t size = 0;
+      /// @brief The storage of the values (only the first 'size' are constructed)
+      alignas(Value) char values[chunk_size * sizeof(Value)];
+
+      /// @brief Index marking the end of the chunks of a key
+      static constexpr size_t NO_CHUNK = static_cast<size_t>(-1);
+
+      /// @brief Constructs an empty chunk
+      MultiMapChunk() noexcept = default;
+      /// @brief MultiMapChunk cannot be copied
+      MultiMapChunk(const MultiMapChunk&) = delete;
+      /// @brief MultiMapChunk cannot be copied
+      MultiMapChunk& operator=(const MultiMapChunk&) = delete;
+
+      /// @brief Move constructor, moves the values of 'to_move'
+      /// @param to_move The chunk whose values to move
+      MultiMapChunk(MultiMapChunk&& to_move) noexcept
+        : next(to_move.next), size(to_move.size)
+      {
+        for (size_t i = 0; i < size; i++)
+        {
+          new(get_data() + i) Value(std::move(to_move.get_data()[i]));
+          to_move.get_data()[i].~Value();
+        }
+        to_move.size = 0;
+      }
+
+      /// @brief Destructs the values of the chunk
+      ~MultiMapChunk() noexcept
+      {
+        for (size_t i = 0; i < size; i++)
+          get_data()[i].~Value();
+      }
+
+      /// @brief Returns the values of the chunk
+      /// @return Pointer to the first value
+      Value* get_data() noexcept { return reinterpret_cast<Value*>(values); }
+      /// @brief Returns the values of the chunk
+      /// @return Pointer to the first value
+      const Value* get_data() const noexcept { return reinterpret_cast<const Value*>(values); }
+    };
+
+    /// @brief The values of a key of a MultiMap
+    struct MultiMapEntry
+    {
+      /// @brief The first chunk (incremental mode) or the offset of the first value (frozen mode)
+      size_t begin;
+      /// @brief The count of values of the key
+      size_t count;
+      /// @brief The last chunk (incremental mode)
+      size_t last;
+    };
+  }
+
+  template<typename Key, typename Value, typename Hasher = DefaultHash<Key>, typename KeyEqual = DefaultEqual<Key>>
+  /// @brief An unordered associative container mapping each key to one or more values.
+  /// The values of a key are kept in insertion order.
+  /// Values are inserted in incremental mode: 'freeze' then groups the values of each key
+  /// contiguously, after which 'find' returns a view over them.
+  /// @tparam Key The Key that can be hashed through colt::hash or std::hash
+  /// @tparam Value The type of the values
+  /// @tparam Hasher The hash function of the keys (GetHash by default)
+  /// @tparam KeyEqual The equality comparison of the keys (operator== by default)
+  class MultiMap
+  {
+    static_assert(!traits::is_tag_v<Key> && !traits::is_tag_v<Value>, "Cannot use tag struct as typename!");
+
+  public:
+    /// @brief The count of values of a chunk (a cache line of values, at least 4)
+    static constexpr size_t CHUNK_SIZE = 64 / sizeof(Value) < 4 ? 4 : 64 / sizeof(Value);
+
+  private:
+    using Chunk = details::MultiMapChunk<Value, CHUNK_SIZE>;
+    using Entry = details::MultiMapEntry;
+
+    /// @brief The values of each key
+    Map<Key, Entry, Hasher, KeyEqual> keys;
+    /// @brief The chunks of values (empty if frozen)
+    Vector<Chunk> chunks = {};
+    /// @brief The values grouped by key (empty if not frozen)
+    Vector<Value> values = {};
+    /// @brief The count of values
+    size_t value_count = 0;
+    /// @brief True if the values are grouped in 'values'
+    bool is_frozen_v = false;
+
+  public:
+    /// @brief Constructs an empty MultiMap, in incremental mode
+    /// @param hasher The hash function of the keys
+    /// @param key_equal The equality comparison of the keys
+    MultiMap(const Hasher& hasher = Hasher{}, const KeyEqual& key_equal = KeyEqual{}) noexcept
+      : keys(0.70f, hasher, key_equal) {}
+
+    /// @brief MultiMap cannot be copied
+    MultiMap(const MultiMap&) = delete;
+    /// @brief MultiMap cannot be copied
+    MultiMap& operator=(const MultiMap&) = delete;
+
+    /// @brief Move constructor
+    /// @param to_move The MultiMap whose keys and values to steal
+    MultiMap(MultiMap&& to_move) noexcept
+      : keys(std::move(to_move.keys)), chunks(std::move(to_move.chunks)), values(std::move(to_move.values))
+      , value_count(colt::exchange(to_move.value_count, 0)), is_frozen_v(colt::exchange(to_move.is_frozen_v, false)) {}
+
+    /// @brief Builds a frozen MultiMap from key/value pairs.
+    /// The values of a key are stored in the order of 'pairs'.
+    /// @param pairs The key/value pairs (keys can be repeated)
+    /// @param hasher The hash function of the keys
+    /// @param key_equal The equality comparison of the keys
+    /// @return Frozen MultiMap
+    static MultiMap build(ContiguousView<std::pair<Key, Value>> pairs, const Hasher& hasher = Hasher{}, const KeyEqual& key_equal = KeyEqual{}) noexcept;
+
+    /// @brief Returns the count of distinct keys
+    /// @return The count of keys
+    size_t get_key_count() const noexcept { return keys.get_size(); }
+    /// @brief Returns the count of values of all the keys
+    /// @return The count of values
+    size_t get_value_count() const noexcept { return value_count; }
+    /// @brief Check if the MultiMap is empty
+    /// @return True if the MultiMap is empty
+    bool is_empty() const noexcept { return value_count == 0; }
+    /// @brief Check if the MultiMap is not empty
+    /// @return True if the MultiMap is not empty
+    bool is_not_empty() const noexcept { return value_count != 0; }
+    /// @brief Check if the values are grouped by key (no more values can be inserted)
+    /// @return True if frozen
+    bool is_frozen() const noexcept { return is_frozen_v; }
+
+    /// @brief Check if 'key' has any value
+    /// @param key The key to search for
+    /// @return True if 'key' has at least one value
+    bool contains(traits::copy_if_trivial_t<const Key&> key) const noexcept { return keys.contains(key); }
+
+    /// @brief Returns the count of values of 'key'
+    /// @param key The key to search for
+    /// @return The count of values (0 if 'key' does not exist)
+    size_t get_count(traits::copy_if_trivial_t<const Key&> key) const noexcept
+    {
+      auto slot = keys.find(key);
+      return slot == nullptr ? 0 : slot->second.count;
+    }
+
+    /// @brief Appends a value to the values of 'key'.
+    /// The MultiMap must not be frozen.
+    /// @param key The key
+    /// @param value The value to append (moved into the MultiMap)
+    void insert(traits::copy_if_trivial_t<const Key&> key, Value value) noexcept;
+
+    /// @brief Groups the values of each key contiguously, preserving their order.
+    /// No more values can be inserted afterwards, but 'find' can be used.
+    void freeze() noexcept;
+
+    /// @brief Returns the values of 'key'.
+    /// The MultiMap must be frozen.
+    /// @param key The key to search for
+    /// @return The values of 'key' (empty if 'key' does not exist)
+    ContiguousView<Value> find(traits::copy_if_trivial_t<const Key&> key) const noexcept
+    {
+      assert(is_frozen_v && "MultiMap must be frozen to return views!");
+      auto slot = keys.find(key);
+      if (slot == nullptr)
+        return { values.get_data(), static_cast<size_t>(0) };
+      return { values.get_data() + slot->second.begin, slot->second.count };
+    }
+
+    template<typename Fn>
+    /// @brief Calls 'fn' with each value of 'key', in insertion order (in any mode)
+    /// @tparam Fn The function type
+    /// @param key The key whose values to iterate over
+    /// @param fn The function to call with a 'const Value&'
+    void for_each_value(traits::copy_if_trivial_t<const Key&> key, Fn&& fn) const noexcept;
+
+    template<typename Fn>
+    /// @brief Calls 'fn' with each key and its values.
+    /// The MultiMap must be frozen.
+    /// @tparam Fn The function type
+    /// @param fn The function to call with a 'const Key&' and a 'ContiguousView<Value>'
+    void for_each(Fn&& fn) const noexcept
+    {
+      assert(is_frozen_v && "MultiMap must be frozen to return views!");
+      for (auto& slot : keys)
+        fn(slot.first, ContiguousView<Value>{ values.get_data() + slot.second.begin, slot.second.count });
+    }
+
+    /// @brief Removes all the keys and values, and returns to incremental mode
+    void clear() noexcept
+    {
+      keys.clear();
+      chunks.clear();
+      values.clear();
+      value_count = 0;
+      is_frozen_v = false;
+    }
+
+  private:
+    /// @brief Doubles the capacity of 'keys' before an insertion would reallocate it
+    /// (a Map only grows by 16 slots at a time, which is quadratic for many keys).
+    /// A moved-from MultiMap has no capacity, and grows to 16 slots.
+    void grow_keys() noexcept
+    {
+      if (keys.will_reallocate())
+        keys.reserve(keys.get_capacity() == 0 ? 16 : keys.get_capacity() * 2);
+    }
+  };
+
+  template<typename Key, typename Value, typename Hasher, typename KeyEqual>
+  void MultiMap<Key, Value, Hasher, KeyEqual>::insert(traits::copy_if_trivial_t<const Key&> key, Value value) noexcept
+  {
+    assert(!is_frozen_v && "Cannot insert in a frozen MultiMap!");
+    grow_keys();
+    //The slot is not modified by the insertions in 'chunks'
+    Entry& entry = keys.insert(key, Entry{ Chunk::NO_CHUNK, 0, Chunk::NO_CHUNK }).first->second;
+    if (entry.count == 0 || chunks[entry.last].size == CHUNK_SIZE)
+    {
+      const size_t new_chunk = chunks.get_size();
+      chunks.push_back(InPlace);
+      if (entry.count == 0)
+        entry.begin = new_chunk;
+      else
+        chunks[entry.last].next = new_chunk;
+      entry.last = new_chunk;
+    }
+    Chunk& chunk = chunks[entry.last];
+    new(chunk.get_data() + chunk.size) Value(std::move(value));
+    ++chunk.size;
+    ++entry.count;
+    ++value_count;
+  }
+
+  template<typename Key, typename Value, typename Hasher, typename KeyEqual>
+  void MultiMap<Key, Value, Hasher, KeyEqual>::freeze() noexcept
+  {
+    if (is_frozen_v)
+      return;
+    //The values of each key are written after the ones of the previous key
+    values = Vector<Value>(value_count);
+    for (auto& slot : keys)
+    {
+      Entry& entry = slot.second;
+      const size_t offset = values.get_size();
+      for (size_t index = entry.begin; index != Chunk::NO_CHUNK; index = chunks[index].next)
+      {
+        Chunk& chunk = chunks[index];
+        for (size_t i = 0; i < chunk.size; i++)
+          values.push_back(std::move(chunk.get_data()[i]));
+      }
+      entry.begin = offset;
+    }
+    chunks = Vector<Chunk>();
+    is_frozen_v = true;
+  }
+
+  template<typename Key, typename Value, typename Hasher, typename KeyEqual>
+  MultiMap<Key, Value, Hasher, KeyEqual> MultiMap<Key, Value, Hasher, KeyEqual>::build(ContiguousView<std::pair<Key, Value>> pairs, const Hasher& hasher, const KeyEqual& key_equal) noexcept
+  {
+    //Appending to the chunks then grouping them is faster than counting the values
+    //of each key first, which requires looking up each key twice
+    MultiMap map = MultiMap(hasher, key_equal);
+    for (auto& pair : pairs)
+      map.insert(pair.first, pair.second);
+    map.freeze();
+    return map;
+  }
+
+  template<typename Key, typename Value, typename Hasher, typename KeyEqual>
+  template<typename Fn>
+  void MultiMap<Key, Value, Hasher, KeyEqual>::for_each_value(traits::copy_if_trivial_t<const Key&> key, Fn&& fn) const noexcept
+  {
+    auto slot = keys.find(key);
+    if (slot == nullptr)
+      return;
+    if (is_frozen_v)
+    {
+      for (auto& value : find(key))
+        fn(static_cast<const Value&>(value));
+      return;
+    }
+    for (size_t index = slot->second.begin; index != Chunk::NO_CHUNK; index = chunks[index].next)
+    {
+      const Chunk& chunk = chunks[index];
+      for (size_t i = 0; i < chunk.size; i++)
+        fn(chunk.get_data()[i]);
+    }
+  }
+
+#ifdef COLT_USE_IOSTREAMS
+  template<typename Key, typename Value, typename Hasher, typename KeyEqual>
+  static std::ostream& operator<<(std::ostream& os, const MultiMap<Key, Value, Hasher, KeyEqual>& var) noexcept
+  {
+    static_assert(traits::is_coutable_v<Key>, "Key of MultiMap should implement operator<<(std::ostream&)!");
+    static_assert(traits::is_coutable_v<Value>, "Value of MultiMap should implement operator<<(std::ostream&)!");
+
+    bool is_first = true;
+    os << '[';
+    var.for_each([&](const Key& key, ContiguousView<Value> values)
+      {
+        os << (is_first ? "{ " : ", { ") << key << ": " << values << " }";
+        is_first = false;
+      });
+    os << ']';
+    return os;
+  }
+#endif
+}
+
+#endif //!HG_COLT_MULTIMAP
@@ -0,0 +1,550 @@
+/** @file PackedVector.h
+* Contains PackedVector<> and DeltaVector<>, compressed arrays of unsigned integers.
+* A PackedVector stores each integer using the same bit width: the
+* bit width of the greatest integer stored. Pushing a greater integer
+* repacks the whole array using the new bit width.
+* A DeltaVector stores integers in blocks of 128 integers. Each block
+* stores its first integer in a header, followed by the differences
+* between consecutive integers, packed using the bit width chosen for
+* the block (frame of reference). Differences that do not fit in that
+* bit width are stored as exceptions (patched frame of reference),
+* so that a few outliers do not inflate the bit width of a whole block.
+* DeltaVector works best on sorted integers (such as lists of ids).
+* Both containers decode whole blocks at once: decoding loops do not
+* branch on the data, which allows compilers to vectorize them.
+* The integers are unpacked by scalar code, as SSE2 cannot shift each
+* lane of a register by a different count, but the prefix sums of the
+* differences of DeltaVector blocks use the SSE2 scan of 'details/simd.h'.
+*/
+
+#ifndef HG_COLT_PACKED_VECTOR
+#define HG_COLT_PACKED_VECTOR
+
+#include "Vector.h"
+#include "../details/bits.h"
+#include "../details/simd.h"
+
+namespace colt
+{
+  namespace details
+  {
+    /// @brief Writes the 'width' lowest bits of 'value' at bit offset 'bit' of 'words'.
+    /// The word following the written bits must be addressable.
+    /// @param words The array of words in which to write
+    /// @param bit The bit offset at which to write
+    /// @param width The bit width of 'value'
+    /// @param value The value to write (whose bits above 'width' must be 0)
+    inline void write_packed(u64* words, size_t bit, unsigned width, u64 value) noexcept
+    {
+      const size_t word = bit / 64;
+      const unsigned shift = static_cast<unsigned>(bit % 64);
+      const u64 mask = low_bits_mask(width);
+      words[word] = (words[word] & ~(mask << shift)) | (value << shift);
+      if (shift + width > 64)
+      {
+        const unsigned high_shift = 64 - shift;
+        words[word + 1] = (words[word + 1] & ~(mask >> high_shift)) | (value >> high_shift);
+      }
+    }
+
+    /// @brief Reads 'width' bits at bit offset 'bit' of 'words'.
+    /// The word following the read bits must be addressable: the
+    /// read does not branch on the bit offset.
+    /// @param words The array of words from which to read
+    /// @param bit The bit offset from which to read
+    /// @param width The bit width of the value to read
+    /// @return The value read
+    inline u64 read_packed(const u64* words, size_t bit, unsigned width) noexcept
+    {
+      const size_t word = bit / 64;
+      const unsigned shift = static_cast<unsigned>(bit % 64);
+      //(x << 1) << (63 - shift) avoids shifting by 64 when shift == 0
+      return ((words[word] >> shift) | ((words[word + 1] << 1) << (63 - shift)))
+        & low_bits_mask(width);
+    }
+
+    template<typename T>
+    /// @brief Unpacks 'count' integers of 'width' bits starting at bit offset 'bit'.
+    /// Each iteration is independent of the others, which allows vectorization.
+    /// @tparam T The unsigned integer type to unpack to
+    /// @param words The packed words (followed by an addressable word)
+    /// @param bit The bit offset of the first integer
+    /// @param width The bit width of each integer
+    /// @param out Where to write the unpacked integers
+    /// @param count The count of integers to unpack
+    inline void unpack_integers(const u64* words, size_t bit, unsigned width, T* out, size_t count) noexcept
+    {
+      const u64 mask = low_bits_mask(width);
+      for (size_t i = 0; i < count; i++)
+      {
+        const size_t at = bit + i * width;
+        const size_t word = at / 64;
+        const unsigned shift = static_cast<unsigned>(at % 64);
+        out[i] = static_cast<T>(((words[word] >> shift) | ((words[word + 1] << 1) << (63 - shift))) & mask);
+      }
+    }
+  }
+
+  template<typename T>
+  /// @brief Array of unsigned integers, all stored using the same (minimal) bit width.
+  /// @tparam T The unsigned integer type to store
+  class PackedVector
+  {
+    static_assert(std::is_integral_v<T> && std::is_unsigned_v<T> && !std::is_same_v<T, bool>,
+      "PackedVector only supports unsigned integers!");
+
+    /// @brief The packed integers, followed by a padding word
+    Vector<u64> words = {};
+    /// @brief The count of integers stored
+    size_t size = 0;
+    /// @brief The bit width of each integer (in [1, sizeof(T) * 8])
+    unsigned width = 1;
+
+  public:
+    /// @brief Constructs an empty PackedVector of bit width 1
+    PackedVector() noexcept;
+
+    /// @brief Constructs a PackedVector from a view, choosing
+    /// the bit width of the greatest integer of the view.
+    /// @param view The integers to pack
+    explicit PackedVector(ContiguousView<T> view) noexcept;
+
+    /// @brief Returns the count of integers stored
+    /// @return The count of integers
+    constexpr size_t get_size() const noexcept { return size; }
+    /// @brief Check if the PackedVector is empty
+    /// @return True if empty
+    constexpr bool is_empty() const noexcept { return size == 0; }
+    /// @brief Check if the PackedVector is not empty
+    /// @return True if not empty
+    constexpr bool is_not_empty() const noexcept { return size != 0; }
+
+    /// @brief Returns the bit width used for each integer
+    /// @return The bit width
+    constexpr unsigned get_bit_width() const noexcept { return width; }
+
+    /// @brief Returns the byte size of the packed integers
+    /// @return ByteSize of the allocation
+    constexpr sizes::ByteSize get_byte_size() const noexcept { return words.get_byte_size(); }
+
+    /// @brief Returns the integer at index 'index'.
+    /// @param index The index of the integer
+    /// @return The integer at index 'index'
+    /// @pre index < get_size()
+    T operator[](size_t index) const noexcept;
+
+    /// @brief Replaces the integer at index 'index', repacking if it does not fit the current bit width.
+    /// @param index The index of the integer
+    /// @param value The new integer
+    /// @pre index < get_size()
+    void set(size_t index, T value) noexcept;
+
+    /// @brief Appends an integer, repacking if it does not fit the current bit width.
+    /// @param value The integer to append
+    void push_back(T value) noexcept;
+
+    /// @brief Removes all the integers, keeping the bit width
+    void clear() noexcept;
+
+    /// @brief Decodes 'count' integers starting at index 'offset' to 'out'.
+    /// @param offset The index of the first integer to decode
+    /// @param count The count of integers to decode
+    /// @param out Where to write the integers (of at least 'count' capacity)
+    /// @pre offset + count <= get_size()
+    void decode(size_t offset, size_t count, T* out) const noexcept;
+
+    /// @brief Decodes all the integers to 'out'.
+    /// @param out Where to write the integers (of at least 'get_size()' capacity)
+    void decode(T* out) const noexcept { decode(0, size, out); }
+
+    /// @brief Decodes the integers in 'range' to a Vector.
+    /// The range is clamped to the size: an empty Vector is returned if nothing remains.
+    /// @param range The range of integers to decode
+    /// @return Vector containing the decoded integers
+    Vector<T> to_vector(Range range = Range{ Begin, End }) const noexcept;
+
+  private:
+    /// @brief Ensures 'words' can contain 'count' integers and the padding word
+    /// @param count The count of integers
+    void ensure_capacity_for(size_t count) noexcept;
+
+    /// @brief Repacks all the integers using a new bit width
+    /// @param new_width The new bit width
+    void repack(unsigned new_width) noexcept;
+  };
+
+  template<typename T>
+  /// @brief Array of unsigned integers, compressed using blocks of differences.
+  /// Random accesses decode the block containing the integer.
+  /// Prefer iterating through 'for_each_block' or 'decode' for bulk accesses.
+  /// @tparam T The unsigned integer type to store
+  class DeltaVector
+  {
+    static_assert(std::is_integral_v<T> && std::is_unsigned_v<T> && !std::is_same_v<T, bool>,
+      "DeltaVector only supports unsigned integers!");
+
+  public:
+    /// @brief The count of integers per block
+    static constexpr size_t block_size = 128;
+
+  private:
+    /// @brief Header describing an encoded block
+    struct BlockHeader
+    {
+      /// @brief The first integer of the block
+      T base;
+      /// @brief The index of the first word of the block in 'words'
+      size_t word_offset;
+      /// @brief The index of the first exception of the block
+      size_t exception_offset;
+      /// @brief The bit width of the differences of the block
+      u8 bit_width;
+      /// @brief The count of exceptions of the block
+      u8 exception_count;
+    };
+
+    /// @brief The headers of the encoded blocks
+    Vector<BlockHeader> headers = {};
+    /// @brief The packed differences of all blocks, followed by a padding word
+    Vector<u64> words = {};
+    /// @brief The index in their block of the differences that did not fit the block's bit width
+    Vector<u8> exception_index = {};
+    /// @brief The high bits of the differences that did not fit the block's bit width
+    Vector<T> exception_high = {};
+    /// @brief The integers that do not form a complete block yet
+    StaticVector<T, block_size> tail = {};
+    /// @brief The count of integers stored
+    size_t size = 0;
+
+  public:
+    /// @brief Constructs an empty DeltaVector
+    DeltaVector() noexcept;
+
+    /// @brief Constructs a DeltaVector from a view
+    /// @param view The integers to compress
+    explicit DeltaVector(ContiguousView<T> view) noexcept;
+
+    /// @brief Returns the count of integers stored
+    /// @return The count of integers
+    constexpr size_t get_size() const noexcept { return size; }
+    /// @brief Check if the DeltaVector is empty
+    /// @return True if empty
+    constexpr bool is_empty() const noexcept { return size == 0; }
+    /// @brief Check if the DeltaVector is not empty
+    /// @return True if not empty
+    constexpr bool is_not_empty() const noexcept { return size != 0; }
+
+    /// @brief Returns the byte size used by the compressed integers (including headers)
+    /// @return ByteSize of the allocations
+    sizes::ByteSize get_byte_size() const noexcept;
+
+    /// @brief Returns the integer at index 'index'.
+    /// This decodes the integers of the block preceding 'index'.
+    /// @param index The index of the integer
+    /// @return The integer at index 'index'
+    /// @pre index < get_size()
+    T operator[](size_t index) const noexcept;
+
+    /// @brief Appends an integer
+    /// @param value The integer to append
+    void push_back(T value) noexcept;
+
+    /// @brief Decodes all the integers to 'out'.
+    /// @param out Where to write the integers (of at least 'get_size()' capacity)
+    void decode(T* out) const noexcept;
+
+    /// @brief Decodes all the integers to a Vector
+    /// @return Vector containing the decoded integers
+    Vector<T> to_vector() const noexcept;
+
+    template<typename Fn>
+    /// @brief Decodes the blocks one at a time, calling 'fn' with a view over each decoded block.
+    /// The view is only valid during the call to 'fn'.
+    /// @tparam Fn The function type, taking a ContiguousView<T>
+    /// @param fn The function to call
+    void for_each_block(Fn&& fn) const;
+
+  private:
+    /// @brief Encodes 'tail' as a new block
+    void encode_tail() noexcept;
+
+    /// @brief Decodes the 'count' first integers of the block 'block' to 'out'
+    /// @param block The index of the block
+    /// @param out Where to write the integers
+    /// @param count The count of integers to decode (<= block_size)
+    void decode_block(size_t block, T* out, size_t count) const noexcept;
+  };
+
+  /************* PACKED VECTOR *************/
+
+  template<typename T>
+  PackedVector<T>::PackedVector() noexcept
+    : words(1, InPlace, u64(0)) {}
+
+  template<typename T>
+  PackedVector<T>::PackedVector(ContiguousView<T> view) noexcept
+    : words(1, InPlace, u64(0))
+  {
+    T max = 0;
+    for (size_t i = 0; i < view.get_size(); i++)
+      max = view[i] > max ? view[i] : max;
+    width = max == 0 ? 1 : details::bit_width(max);
+
+    ensure_capacity_for(view.get_size());
+    for (size_t i = 0; i < view.get_size(); i++)
+      details::write_packed(words.get_data(), i * width, width, view[i]);
+    size = view.get_size();
+  }
+
+  template<typename T>
+  T PackedVector<T>::operator[](size_t index) const noexcept
+  {
+    assert(index < size && "Invalid index!");
+    return static_cast<T>(details::read_packed(words.get_data(), index * width, width));
+  }
+
+  template<typename T>
+  void PackedVector<T>::set(size_t index, T value) noexcept
+  {
+    assert(index < size && "Invalid index!");
+    if (details::bit_width(value) > width)
+      repack(details::bit_width(value));
+    details::write_packed(words.get_data(), index * width, width, value);
+  }
+
+  template<typename T>
+  void PackedVector<T>::push_back(T value) noexcept
+  {
+    if (details::bit_width(value) > width)
+      repack(details::bit_width(value));
+    ensure_capacity_for(size + 1);
+    details::write_packed(words.get_data(), size * width, width, value);
+    ++size;
+  }
+
+  template<typename T>
+  void PackedVector<T>::clear() noexcept
+  {
+    words.clear();
+    words.push_back(0);
+    size = 0;
+  }
+
+  template<typename T>
+  void PackedVector<T>::decode(size_t offset, size_t count, T* out) const noexcept
+  {
+    assert(offset + count <= size && "Invalid range!");
+    details::unpack_integers(words.get_data(), offset * width, width, out, count);
+  }
+
+  template<typename T>
+  Vector<T> PackedVector<T>::to_vector(Range range) const noexcept
+  {
+    const size_t begin = range.get_begin_offset();
+    size_t end = range.get_end_offset();
+    end = (end > size ? size : end);
+    //Also handles 'begin >= size' and empty ranges (Vector cannot be filled with 0 items)
+    if (end <= begin)
+      return {};
+
+    Vector<T> result = { end - begin, InPlace, T(0) };
+    decode(begin, end - begin, result.get_data());
+    return result;
+  }
+
+  template<typename T>
+  void PackedVector<T>::ensure_capacity_for(size_t count) noexcept
+  {
+    //+1 for the padding word, which makes reads branchless
+    const size_t needed = (count * width + 63) / 64 + 1;
+    if (needed > words.get_capacity())
+      words.reserve(needed > 2 * words.get_capacity() ? needed : words.get_capacity());
+    while (words.get_size() < needed)
+      words.push_back(0);
+  }
+
+  template<typename T>
+  void PackedVector<T>::repack(unsigned new_width) noexcept
+  {
+    assert(new_width > width && "Repacking should widen the integers!");
+    Vector<u64> new_words = { (size * new_width + 63) / 64 + 1, InPlace, u64(0) };
+    for (size_t i = 0; i < size; i++)
+    {
+      details::write_packed(new_words.get_data(), i * new_width, new_width,
+        details::read_packed(words.get_data(), i * width, width));
+    }
+    words = std::move(new_words);
+    width = new_width;
+  }
+
+  /************* DELTA VECTOR *************/
+
+  template<typename T>
+  DeltaVector<T>::DeltaVector() noexcept
+    : words(1, InPlace, u64(0)) {}
+
+  template<typename T>
+  DeltaVector<T>::DeltaVector(ContiguousView<T> view) noexcept
+    : words(1, InPlace, u64(0))
+  {
+    headers.reserve(view.get_size() / block_size + 1);
+    for (size_t i = 0; i < view.get_size(); i++)
+      push_back(view[i]);
+  }
+
+  template<typename T>
+  sizes::ByteSize DeltaVector<T>::get_byte_size() const noexcept
+  {
+    return { headers.get_size() * sizeof(BlockHeader)
+      + words.get_size() * sizeof(u64)
+      + exception_index.get_size() * sizeof(u8)
+      + exception_high.get_size() * sizeof(T)
+      + sizeof(tail) };
+  }
+
+  template<typename T>
+  T DeltaVector<T>::operator[](size_t index) const noexcept
+  {
+    assert(index < size && "Invalid index!");
+    const size_t block = index / block_size;
+    if (block == headers.get_size())
+      return tail[index % block_size];
+
+    T buffer[block_size];
+    decode_block(block, buffer, index % block_size + 1);
+    return buffer[index % block_size];
+  }
+
+  template<typename T>
+  void DeltaVector<T>::push_back(T value) noexcept
+  {
+    tail.push_back(value);
+    ++size;
+    if (tail.get_size() == block_size)
+      encode_tail();
+  }
+
+  template<typename T>
+  void DeltaVector<T>::decode(T* out) const noexcept
+  {
+    for (size_t i = 0; i < headers.get_size(); i++)
+      decode_block(i, out + i * block_size, block_size);
+
+    T* const tail_out = out + headers.get_size() * block_size;
+    for (size_t i = 0; i < tail.get_size(); i++)
+      tail_out[i] = tail[i];
+  }
+
+  template<typename T>
+  Vector<T> DeltaVector<T>::to_vector() const noexcept
+  {
+    if (size == 0)
+      return {};
+    Vector<T> result = { size, InPlace, T(0) };
+    decode(result.get_data());
+    return result;
+  }
+
+  template<typename T>
+  template<typename Fn>
+  void DeltaVector<T>::for_each_block(Fn&& fn) const
+  {
+    T buffer[block_size];
+    for (size_t i = 0; i < headers.get_size(); i++)
+    {
+      decode_block(i, buffer, block_size);
+      fn(ContiguousView<T>{ buffer, block_size });
+    }
+    if (tail.is_not_empty())
+      fn(tail.to_view());
+  }
+
+  template<typename T>
+  void DeltaVector<T>::encode_tail() noexcept
+  {
+    assert(tail.get_size() == block_size);
+
+    //Differences between consecutive integers (wrapping for unsorted integers)
+    T deltas[block_size];
+    deltas[0] = 0;
+    for (size_t i = 1; i < block_size; i++)
+      deltas[i] = static_cast<T>(tail[i] - tail[i - 1]);
+
+    //Count of differences requiring each bit width
+    size_t width_count[sizeof(T) * 8 + 1] = {};
+    for (size_t i = 0; i < block_size; i++)
+      ++width_count[details::bit_width(deltas[i])];
+
+    //Choose the bit width that minimizes the encoded size of the block,
+    //each exception costing its index and its high bits
+    unsigned best_width = sizeof(T) * 8;
+    size_t best_cost = block_size * best_width;
+    size_t exceptions = 0;
+    for (unsigned w = sizeof(T) * 8; w-- > 0;)
+    {
+      exceptions += width_count[w + 1];
+      const size_t cost = block_size * w + exceptions * (8 + sizeof(T) * 8);
+      if (cost <= best_cost)
+      {
+        best_cost = cost;
+        best_width = w;
+      }
+    }
+
+    BlockHeader header;
+    header.base = tail[0];
+    header.bit_width = static_cast<u8>(best_width);
+    header.exception_offset = exception_index.get_size();
+    header.exception_count = 0;
+    //Remove the padding word, which is re-added after the block
+    words.pop_back();
+    header.word_offset = words.get_size();
+
+    //128 integers of 'best_width' bits always span 2 * 'best_width' words
+    for (size_t i = 0; i < 2 * best_width + 1; i++)
+      words.push_back(0);
+    const u64 mask = details::low_bits_mask(best_width);
+    for (size_t i = 0; i < block_size; i++)
+    {
+      if (details::bit_width(deltas[i]) > best_width)
+      {
+        exception_index.push_back(static_cast<u8>(i));
+        exception_high.push_back(static_cast<T>(static_cast<u64>(deltas[i]) >> best_width));
+        ++header.exception_count;
+      }
+      if (best_width != 0)
+        details::write_packed(words.get_data() + header.word_offset, i * best_width, best_width, deltas[i] & mask);
+    }
+    headers.push_back(header);
+    tail.clear();
+  }
+
+  template<typename T>
+  void DeltaVector<T>::decode_block(size_t block, T* out, size_t count) const noexcept
+  {
+    assert(count <= block_size && block < headers.get_size());
+    const BlockHeader& header = headers.get_data()[block];
+
+    if (header.bit_width == 0)
+    {
+      for (size_t i = 0; i < count; i++)
+        out[i] = 0;
+    }
+    else
+      details::unpack_integers(words.get_data() + header.word_offset, 0, header.bit_width, out, count);
+
+    //Patch the exceptions
+    for (size_t i = 0; i < header.exception_count; i++)
+    {
+      const size_t index = exception_index[header.exception_offset + i];
+      if (index < count)
+        out[index] |= static_cast<T>(static_cast<u64>(exception_high[header.exception_offset + i]) << header.bit_width);
+    }
+
+    //Prefix sum of the differences
+    out[0] = header.base;
+    details::scan_sequential<true>(out + 1, count - 1, out + 1, header.base);
+  }
+}
+
+#endif //!HG_COLT_PACKED_VECTOR
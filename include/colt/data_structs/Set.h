@@ -1,22 +1,26 @@
 #ifndef HG_COLT_SET
 #define HG_COLT_SET
 
+#include <iterator>
+
 #include "../details/linear_probing.h"
 #include "../utility/Hash.h"
 #include "../data_structs/List.h"
 
 namespace colt
 {
-  template<typename T, size_t obj_per_node = 256>
+  template<typename T, size_t obj_per_node = 256, typename Hasher = DefaultHash<T>, typename KeyEqual = DefaultEqual<T>>
   /// @brief An ordered container without duplicates that guarantees iterator validity for its lifetime.
   /// This StableSet is implemented using an internal hash table and a doubly linked list.
   /// The doubly linked list is a 'FlatList', of 'obj_per_node' equal to 'obj_per_node', which
   /// preserves the insertion order, and iterator validity.
   /// @tparam T The type to store
+  /// @tparam Hasher The hash function of the values (GetHash by default)
+  /// @tparam KeyEqual The equality comparison of the values (operator== by default)
   class StableSet
   {
-    static_assert(traits::is_hashable_v<T>, "'T' should be hashable!");
-    static_assert(traits::is_equal_comparable_v<T>, "'T' should implement operator==!");
+    static_assert(std::is_invocable_r_v<size_t, const Hasher&, const T&>, "Hasher of a StableSet should hash 'T'!");
+    static_assert(std::is_invocable_r_v<bool, const KeyEqual&, const T&, const T&>, "KeyEqual of a StableSet should compare 'T'!");
     
     using Slot = std::pair<size_t, T*>;
 
@@ -28,17 +32,29 @@ namespace colt
     FlatList<T, obj_per_node> list = {};
     /// @brief The load factor before reallocation
     float load_factor = 0.70f;
+    /// @brief The hash function of the values
+    Hasher hasher = {};
+    /// @brief The equality comparison of the values
+    KeyEqual key_equal = {};
+#ifdef COLT_HASH_TABLE_STATS
+    /// @brief The lookup and rehash counters
+    mutable details::ProbeCounters probe_counters = {};
+#endif
 
   public:
 
     /// @brief Constructor
     /// @param load_factor The load factor (> 0.0f && < 1.0f)
-    constexpr StableSet(float load_factor = 0.70f) noexcept;
+    /// @param hasher The hash function of the values
+    /// @param key_equal The equality comparison of the values
+    constexpr StableSet(float load_factor = 0.70f, const Hasher& hasher = Hasher{}, const KeyEqual& key_equal = KeyEqual{}) noexcept;
 
     /// @brief Constructor, which reserves 'reserve_size' capacity for objects
     /// @param reserve_size The capacity to reserve
     /// @param load_factor The load factor (> 0.0f && < 1.0f)
-    constexpr StableSet(size_t reserve_size, float load_factor = 0.70f) noexcept;      
+    /// @param hasher The hash function of the values
+    /// @param key_equal The equality comparison of the values
+    constexpr StableSet(size_t reserve_size, float load_factor = 0.70f, const Hasher& hasher = Hasher{}, const KeyEqual& key_equal = KeyEqual{}) noexcept;
 
     constexpr StableSet(const StableSet&) = delete;
 
@@ -89,10 +105,32 @@ namespace colt
     /// @param nload_factor The new load factor
     constexpr void set_load_factor(float nload_factor) noexcept;    
 
+    /// @brief Returns the hash function of the values
+    /// @return The Hasher
+    constexpr const Hasher& get_hasher() const noexcept { return hasher; }
+    /// @brief Returns the equality comparison of the values
+    /// @return The KeyEqual
+    constexpr const KeyEqual& get_key_equal() const noexcept { return key_equal; }
+
+    /// @brief Computes the occupancy and probing statistics of the internal hash map.
+    /// The hashes are stored in the slots: this function is O(capacity).
+    /// @return The statistics of the internal hash map
+    HashTableStats get_stats() const noexcept;
+
     /// @brief Returns a const reference to the internal list used by the StableSet
     /// @return Const reference to the list
     constexpr const FlatList<T, obj_per_node>& get_internal_list() const noexcept { return list; }
 
+    /// @brief Finds a value equal to 'key'
+    /// @param key The value to search for
+    /// @return Pointer to the value if found, or null
+    constexpr const T* find(traits::copy_if_trivial_t<const T&> key) const noexcept;
+
+    /// @brief Check if the StableSet contains a value equal to 'key'
+    /// @param key The value to check for
+    /// @return True if the StableSet contains 'key'
+    constexpr bool contains(traits::copy_if_trivial_t<const T&> key) const noexcept { return find(key) != nullptr; }
+
     /// @brief Inserts a new value if it does not already exist.
     /// Returns an InsertionResult SUCCESS (if the insertion was performed) or EXISTS (if the key already exists).
     /// The returned pointer is to the newly inserted value on SUCCESS.
@@ -118,7 +156,7 @@ namespace colt
     
   private:
     /// @brief Finds a EMPTY/ACTIVE/DELETED slot matching 'key_hash'
-    /// @param key_hash The hash of 'key', obtained through 'GetHash'.
+    /// @param key_hash The hash of 'key', obtained through the Hasher.
     /// This function does not perform a hash of 'key' as usually the function
     /// that calls this function already possesses that hash.
     /// @param key The key to search for.
@@ -126,45 +164,48 @@ namespace colt
     /// @param prob The reference where to write the offset to the slot
     /// @param metadata The Vector of KeySentinel representing the state of 'blk'
     /// @param blk The array of slots
-    /// @return True if the slot found is empty/deleted, false if the slot is already occupied
-    static constexpr bool find_key(size_t key_hash, traits::copy_if_trivial_t<const T&> key, size_t& prob,
-      const Vector<details::KeySentinel>& metadata, memory::TypedBlock<Slot> blk) noexcept;    
+    /// @return True if the key was not found ('prob' is then the first DELETED or EMPTY slot), false if the slot is already occupied
+    constexpr bool find_key(size_t key_hash, traits::copy_if_trivial_t<const T&> key, size_t& prob,
+      const Vector<details::KeySentinel>& metadata, memory::TypedBlock<Slot> blk) const noexcept;    
 
     /// @brief Augments the capacity of the internal hash map, rehashing in the process
     /// @param new_capacity The new capacity of the map
     constexpr void realloc_map(size_t new_capacity) noexcept;    
   };
   
-  template<typename T, size_t obj_per_node>
-  constexpr StableSet<T, obj_per_node>::StableSet(float load_factor) noexcept
+  template<typename T, size_t obj_per_node, typename Hasher, typename KeyEqual>
+  constexpr StableSet<T, obj_per_node, Hasher, KeyEqual>::StableSet(float load_factor, const Hasher& hasher, const KeyEqual& key_equal) noexcept
     : sentinel_metadata(16, InPlace, details::EMPTY)
     , slots(memory::allocate({ 16 * sizeof(Slot) }))
     , list(16 / obj_per_node)
     , load_factor(load_factor)
+    , hasher(hasher), key_equal(key_equal)
   {
     assert(0.0f < load_factor && load_factor < 1.0f && "Invalid load factor!");
   }
 
-  template<typename T, size_t obj_per_node>
-  constexpr StableSet<T, obj_per_node>::StableSet(size_t reserve_size, float load_factor) noexcept
+  template<typename T, size_t obj_per_node, typename Hasher, typename KeyEqual>
+  constexpr StableSet<T, obj_per_node, Hasher, KeyEqual>::StableSet(size_t reserve_size, float load_factor, const Hasher& hasher, const KeyEqual& key_equal) noexcept
     : sentinel_metadata(reserve_size, InPlace, details::EMPTY)
     , slots(memory::allocate({ reserve_size * sizeof(Slot) }))
     , list(reserve_size / obj_per_node)
     , load_factor(load_factor)
+    , hasher(hasher), key_equal(key_equal)
   {
     assert(0.0f < load_factor && load_factor < 1.0f && "Invalid load factor!");
   }
 
-  template<typename T, size_t obj_per_node>
-  constexpr StableSet<T, obj_per_node>::StableSet(StableSet&& set) noexcept
+  template<typename T, size_t obj_per_node, typename Hasher, typename KeyEqual>
+  constexpr StableSet<T, obj_per_node, Hasher, KeyEqual>::StableSet(StableSet&& set) noexcept
     : sentinel_metadata(std::move(set.sentinel_metadata))
     , slots(colt::exchange(set.slots, {}))
     , list(std::move(set.list))
     , load_factor(set.load_factor)
+    , hasher(set.hasher), key_equal(set.key_equal)
   {}
 
-  template<typename T, size_t obj_per_node>
-  StableSet<T, obj_per_node>::~StableSet()
+  template<typename T, size_t obj_per_node, typename Hasher, typename KeyEqual>
+  StableSet<T, obj_per_node, Hasher, KeyEqual>::~StableSet()
     noexcept(std::is_nothrow_destructible_v<T>)
   {
     for (size_t i = 0; i < sentinel_metadata.get_size(); i++)
@@ -175,35 +216,82 @@ namespace colt
     memory::deallocate(slots);
   }
   
-  template<typename T, size_t obj_per_node>
-  constexpr traits::copy_if_trivial_t<const T&> StableSet<T, obj_per_node>::operator[](size_t index) const noexcept
+  template<typename T, size_t obj_per_node, typename Hasher, typename KeyEqual>
+  constexpr traits::copy_if_trivial_t<const T&> StableSet<T, obj_per_node, Hasher, KeyEqual>::operator[](size_t index) const noexcept
   {
     assert(index < list.get_size() && "Invalid index!");
     return list[index];
   }
 
-  template<typename T, size_t obj_per_node>
-  constexpr bool StableSet<T, obj_per_node>::will_reallocate() const noexcept
+  template<typename T, size_t obj_per_node, typename Hasher, typename KeyEqual>
+  constexpr bool StableSet<T, obj_per_node, Hasher, KeyEqual>::will_reallocate() const noexcept
   {
     return float(get_size() + 1) > load_factor * get_capacity();
   }
   
-  template<typename T, size_t obj_per_node>
-  constexpr void StableSet<T, obj_per_node>::set_load_factor(float nload_factor) noexcept
+  template<typename T, size_t obj_per_node, typename Hasher, typename KeyEqual>
+  constexpr void StableSet<T, obj_per_node, Hasher, KeyEqual>::set_load_factor(float nload_factor) noexcept
   {
     assert(nload_factor < 1.0f && nload_factor > 0.0f && "Invalid load factor!");
     load_factor = nload_factor;
   }
   
-  template<typename T, size_t obj_per_node>
-  constexpr std::pair<T*, InsertionResult> StableSet<T, obj_per_node>::insert(traits::copy_if_trivial_t<const T&> key) noexcept(std::is_nothrow_copy_constructible_v<T>)
+  template<typename T, size_t obj_per_node, typename Hasher, typename KeyEqual>
+  HashTableStats StableSet<T, obj_per_node, Hasher, KeyEqual>::get_stats() const noexcept
+  {
+    HashTableStats stats = details::compute_hash_table_stats(sentinel_metadata.get_data(), slots.get_size(), sizeof(Slot),
+      [this](size_t index) { return slots.get_ptr()[index].first; });
+#ifdef COLT_HASH_TABLE_STATS
+    stats.lookup_count = probe_counters.lookup_count;
+    stats.probe_count = probe_counters.probe_count;
+    stats.rehash_count = probe_counters.rehash_count;
+#endif
+    return stats;
+  }
+
+  template<typename T, size_t obj_per_node, typename Hasher, typename KeyEqual>
+  constexpr const T* StableSet<T, obj_per_node, Hasher, KeyEqual>::find(traits::copy_if_trivial_t<const T&> key) const noexcept
+  {
+    const size_t key_hash = hasher(key);
+    size_t prob_index = key_hash % slots.get_size();
+#ifdef COLT_HASH_TABLE_STATS
+    ++probe_counters.lookup_count;
+#endif
+    //Each slot is inspected at most once, as the table may have no EMPTY slot left
+    for (size_t i = 0; i < slots.get_size(); i++)
+    {
+#ifdef COLT_HASH_TABLE_STATS
+      ++probe_counters.probe_count;
+#endif
+      if (auto sentinel = sentinel_metadata[prob_index];
+        details::is_sentinel_empty(sentinel))
+      {
+        return nullptr; //not found
+      }
+      else if (details::is_sentinel_active(sentinel) && details::is_sentinel_equal(sentinel, key_hash))
+      {
+        const Slot& slot = slots.get_ptr()[prob_index];
+        if (slot.first == key_hash && key_equal(*slot.second, key))
+          return slot.second;
+      }
+      prob_index = details::advance_prob(prob_index, slots.get_size());
+    }
+    return nullptr;
+  }
+
+  template<typename T, size_t obj_per_node, typename Hasher, typename KeyEqual>
+  constexpr std::pair<T*, InsertionResult> StableSet<T, obj_per_node, Hasher, KeyEqual>::insert(traits::copy_if_trivial_t<const T&> key) noexcept(std::is_nothrow_copy_constructible_v<T>)
   {
     if (will_reallocate())
       realloc_map(get_capacity() + 16);
 
-    const size_t key_hash = GetHash(key);
+    const size_t key_hash = hasher(key);
     size_t prob_index;
-    if (find_key(key_hash, key, prob_index, sentinel_metadata, slots))
+    const bool is_free = find_key(key_hash, key, prob_index, sentinel_metadata, slots);
+#ifdef COLT_HASH_TABLE_STATS
+    ++probe_counters.lookup_count;
+#endif
+    if (is_free)
     {
       list.push_back(key);
       T* to_ret = &list[list.get_size() - 1]; // always safe as push_backed the value
@@ -216,16 +304,20 @@ namespace colt
       return { slots.get_ptr()[prob_index].second, InsertionResult::EXISTS };
   }
 
-  template<typename T, size_t obj_per_node>
+  template<typename T, size_t obj_per_node, typename Hasher, typename KeyEqual>
   template<typename T_, typename>
-  constexpr std::pair<T*, InsertionResult> StableSet<T, obj_per_node>::insert(T&& key) noexcept(std::is_nothrow_move_constructible_v<T>)
+  constexpr std::pair<T*, InsertionResult> StableSet<T, obj_per_node, Hasher, KeyEqual>::insert(T&& key) noexcept(std::is_nothrow_move_constructible_v<T>)
   {
     if (will_reallocate())
       realloc_map(get_capacity() + 16);
 
-    const size_t key_hash = GetHash(key);
+    const size_t key_hash = hasher(key);
     size_t prob_index;
-    if (find_key(key_hash, key, prob_index, sentinel_metadata, slots))
+    const bool is_free = find_key(key_hash, key, prob_index, sentinel_metadata, slots);
+#ifdef COLT_HASH_TABLE_STATS
+    ++probe_counters.lookup_count;
+#endif
+    if (is_free)
     {
       list.push_back(std::move(key));
       T* to_ret = &list[list.get_size() - 1]; // always safe as push_backed the value
@@ -238,23 +330,36 @@ namespace colt
       return { slots.get_ptr()[prob_index].second, InsertionResult::EXISTS };
   }
   
-  template<typename T, size_t obj_per_node>
-  constexpr bool StableSet<T, obj_per_node>::find_key(size_t key_hash, traits::copy_if_trivial_t<const T&> key, size_t& prob, const Vector<details::KeySentinel>& metadata, memory::TypedBlock<Slot> blk) noexcept
+  template<typename T, size_t obj_per_node, typename Hasher, typename KeyEqual>
+  constexpr bool StableSet<T, obj_per_node, Hasher, KeyEqual>::find_key(size_t key_hash, traits::copy_if_trivial_t<const T&> key, size_t& prob, const Vector<details::KeySentinel>& metadata, memory::TypedBlock<Slot> blk) const noexcept
   {
-    assert(key_hash == GetHash(key));
+    assert(key_hash == hasher(key));
     assert(metadata.get_size() == blk.get_size());
     size_t prob_index = key_hash % blk.get_size();
-    for (;;)
+    //The first DELETED slot is reused if the key is not found
+    size_t first_deleted = blk.get_size();
+    //Each slot is inspected at most once, as the table may have no EMPTY slot left
+    for (size_t i = 0; i < blk.get_size(); i++)
     {
+#ifdef COLT_HASH_TABLE_STATS
+      //The rehashes probe a new table: only the lookups in this table are counted
+      if (&metadata == &sentinel_metadata)
+        ++probe_counters.probe_count;
+#endif
       if (auto sentinel = metadata[prob_index];
-        details::is_sentinel_empty(sentinel) || details::is_sentinel_deleted(sentinel))
+        details::is_sentinel_empty(sentinel))
       {
-        prob = prob_index;
+        prob = first_deleted != blk.get_size() ? first_deleted : prob_index;
         return true;
       }
+      else if (details::is_sentinel_deleted(sentinel))
+      {
+        if (first_deleted == blk.get_size())
+          first_deleted = prob_index;
+      }
       else if (details::is_sentinel_equal(sentinel, key_hash))
       {
-        if (*(blk.get_ptr()[prob_index].second) == key)
+        if (key_equal(*(blk.get_ptr()[prob_index].second), key))
         {
           prob = prob_index;
           return false;
@@ -262,12 +367,19 @@ namespace colt
       }
       prob_index = details::advance_prob(prob_index, blk.get_size());
     }
+    assert(first_deleted != blk.get_size() && "The table has no free slot!");
+    prob = first_deleted;
+    return true;
   }
   
-  template<typename T, size_t obj_per_node>
-  constexpr void StableSet<T, obj_per_node>::realloc_map(size_t new_capacity) noexcept
+  template<typename T, size_t obj_per_node, typename Hasher, typename KeyEqual>
+  constexpr void StableSet<T, obj_per_node, Hasher, KeyEqual>::realloc_map(size_t new_capacity) noexcept
   {
+    COLT_TRACE_BEGIN("StableSet::realloc_map");
     memory::TypedBlock<Slot> new_slot = memory::allocate({ new_capacity * sizeof(Slot) });
+#ifdef COLT_HASH_TABLE_STATS
+    ++probe_counters.rehash_count;
+#endif
 
     Vector<details::KeySentinel> new_metadata = { new_capacity, InPlace, details::EMPTY };
     for (size_t i = 0; i < sentinel_metadata.get_size(); i++)
@@ -293,17 +405,560 @@ namespace colt
     sentinel_metadata = std::move(new_metadata);
     memory::deallocate(slots);
     slots = new_slot;
+    COLT_TRACE_END("StableSet::realloc_map");
+  }
+
+  template<typename T, typename Hasher = DefaultHash<T>, typename KeyEqual = DefaultEqual<T>>
+  /// @brief An unordered container without duplicates, whose values are stored in the slots of the hash table.
+  /// Contrary to StableSet, comparing a value that matches the hash does not dereference a pointer,
+  /// but inserting or erasing can move the values: pointers and iterators are invalidated on reallocation.
+  /// @tparam T The type to store
+  /// @tparam Hasher The hash function of the values (GetHash by default)
+  /// @tparam KeyEqual The equality comparison of the values (operator== by default)
+  class HashSet
+  {
+    static_assert(!traits::is_tag_v<T>, "Cannot use tag struct as typename!");
+    static_assert(std::is_invocable_r_v<size_t, const Hasher&, const T&>, "Hasher of a HashSet should hash 'T'!");
+    static_assert(std::is_invocable_r_v<bool, const KeyEqual&, const T&, const T&>, "KeyEqual of a HashSet should compare 'T'!");
+
+    /// @brief Contains meta-data information about the slots of the set
+    Vector<details::KeySentinel> sentinel_metadata = {};
+    /// @brief Memory block of the values
+    memory::TypedBlock<T> slots = {};
+    /// @brief The count of active values in the set
+    size_t size = 0;
+    /// @brief The count of DELETED slots, which count toward the load factor as they lengthen probes
+    size_t tombstone_count = 0;
+    /// @brief The load factor before reallocation
+    float load_factor = 0.70f;
+    /// @brief The hash function of the values
+    Hasher hasher = {};
+    /// @brief The equality comparison of the values
+    KeyEqual key_equal = {};
+#ifdef COLT_HASH_TABLE_STATS
+    /// @brief The lookup and rehash counters
+    mutable details::ProbeCounters probe_counters = {};
+#endif
+
+    /// @brief HashSet Iterator, which iterates over the active values
+    struct HashSetIterator
+    {
+      /// @brief Forward Iterator
+      using iterator_category = std::forward_iterator_tag;
+      /// @brief Value type of the iterator
+      using value_type = const T;
+      /// @brief Pointer type of the iterator
+      using pointer = const T*;
+      /// @brief Reference type of the iterator
+      using reference = const T&;
+
+    private:
+      /// @brief Pointer to the current active slot or end()
+      const T* slot_ptr;
+      /// @brief Pointer to the set from which the iterator was constructed
+      const HashSet* set_ptr;
+
+    public:
+      /// @brief Constructor of HashSetIterator
+      /// @param slot The active slot or end()
+      /// @param set_ptr The pointer to the set
+      constexpr HashSetIterator(const T* slot, const HashSet* set_ptr) noexcept
+        : slot_ptr(slot), set_ptr(set_ptr) {}
+
+      /// @brief Returns a pointer to the current value
+      /// @return Current value or end()
+      constexpr const T* operator->() const noexcept { return slot_ptr; }
+      /// @brief Returns a reference to the current value
+      /// @return Current value
+      constexpr const T& operator*() const noexcept { return *slot_ptr; }
+
+      /// @brief Increments the current iterator to the next active slot or end()
+      /// @return Self
+      constexpr HashSetIterator& operator++() noexcept
+      {
+        const size_t index = slot_ptr - set_ptr->slots.get_ptr() + 1;
+        slot_ptr = set_ptr->slots.get_ptr() + set_ptr->next_active(index);
+        return *this;
+      }
+
+      /// @brief Post increment operator
+      /// @param  Post increment
+      /// @return Current iterator
+      constexpr HashSetIterator operator++(int) noexcept
+      {
+        HashSetIterator to_ret = *this;
+        ++(*this);
+        return to_ret;
+      }
+
+      /// @brief Check if two HashSetIterator are equal
+      /// @param a First HashSetIterator
+      /// @param b Second HashSetIterator
+      /// @return True if equal
+      friend constexpr bool operator==(const HashSetIterator& a, const HashSetIterator& b) noexcept { return a.slot_ptr == b.slot_ptr; }
+      /// @brief Check if two HashSetIterator are not equal
+      /// @param a First HashSetIterator
+      /// @param b Second HashSetIterator
+      /// @return True if not equal
+      friend constexpr bool operator!=(const HashSetIterator& a, const HashSetIterator& b) noexcept { return a.slot_ptr != b.slot_ptr; }
+    };
+
+  public:
+    /// @brief Constructs an empty HashSet
+    /// @param load_factor The load factor (> 0.0f && < 1.0f)
+    /// @param hasher The hash function of the values
+    /// @param key_equal The equality comparison of the values
+    constexpr HashSet(float load_factor = 0.70f, const Hasher& hasher = Hasher{}, const KeyEqual& key_equal = KeyEqual{}) noexcept;
+
+    /// @brief Constructs an empty HashSet, reserving 'reserve_size' slots
+    /// @param reserve_size The count of slots to reserve
+    /// @param load_factor The load factor (> 0.0f && < 1.0f)
+    /// @param hasher The hash function of the values
+    /// @param key_equal The equality comparison of the values
+    constexpr HashSet(size_t reserve_size, float load_factor = 0.70f, const Hasher& hasher = Hasher{}, const KeyEqual& key_equal = KeyEqual{}) noexcept;
+
+    constexpr HashSet(const HashSet&) = delete;
+
+    /// @brief Move constructor
+    /// @param set The set to move
+    constexpr HashSet(HashSet&& set) noexcept;
+
+    /// @brief Destructs the HashSet and its active values
+    ~HashSet()
+      noexcept(std::is_nothrow_destructible_v<T>);
+
+    /// @brief Destroys all the active values
+    constexpr void clear()
+      noexcept(std::is_nothrow_destructible_v<T>);
+
+    /// @brief Returns the number of active values in the HashSet
+    /// @return The count of active values
+    constexpr size_t get_size() const noexcept { return size; }
+    /// @brief Returns the count of slots of the HashSet
+    /// @return The capacity of the HashSet
+    constexpr size_t get_capacity() const noexcept { return slots.get_size(); }
+
+    /// @brief Check if the HashSet is empty
+    /// @return True if empty
+    constexpr bool is_empty() const noexcept { return size == 0; }
+    /// @brief Check if the HashSet is not empty
+    /// @return True if not empty
+    constexpr bool is_not_empty() const noexcept { return size != 0; }
+
+    /// @brief Returns an iterator to the first active value, or end() if the HashSet is empty
+    /// @return Iterator to the first active value or end()
+    constexpr HashSetIterator begin() const noexcept { return { slots.get_ptr() + next_active(0), this }; }
+    /// @brief Returns an iterator past the last slot
+    /// @return Iterator that should not be dereferenced
+    constexpr HashSetIterator end() const noexcept { return { slots.get_ptr() + slots.get_size(), this }; }
+
+    /// @brief Check if the HashSet will reallocate on the next insertion.
+    /// The DELETED slots count toward the load factor: if they make most of the load,
+    /// the HashSet is rehashed without growing, which removes them.
+    /// @return True if the HashSet will reallocate
+    constexpr bool will_reallocate() const noexcept;
+
+    /// @brief Returns the load factor of the HashSet
+    /// @return The load factor
+    constexpr float get_load_factor() const noexcept { return load_factor; }
+    /// @brief Sets the load factor to 'nload_factor'.
+    /// Precondition: nload_factor < 1.0f && nload_factor > 0.0f.
+    /// @param nload_factor The new load factor
+    constexpr void set_load_factor(float nload_factor) noexcept;
+
+    /// @brief Returns the hash function of the values
+    /// @return The Hasher
+    constexpr const Hasher& get_hasher() const noexcept { return hasher; }
+    /// @brief Returns the equality comparison of the values
+    /// @return The KeyEqual
+    constexpr const KeyEqual& get_key_equal() const noexcept { return key_equal; }
+
+    /// @brief Computes the occupancy and probing statistics of the HashSet.
+    /// This function rehashes all the values, and is O(capacity).
+    /// @return The statistics of the HashSet
+    HashTableStats get_stats() const noexcept;
+
+    /// @brief Finds a value equal to 'key'
+    /// @param key The value to search for
+    /// @return Pointer to the value if found, or null
+    constexpr const T* find(traits::copy_if_trivial_t<const T&> key) const noexcept;
+
+    /// @brief Check if the HashSet contains a value equal to 'key'
+    /// @param key The value to check for
+    /// @return True if the HashSet contains 'key'
+    constexpr bool contains(traits::copy_if_trivial_t<const T&> key) const noexcept { return find(key) != nullptr; }
+
+    /// @brief Inserts a new value if it does not already exist.
+    /// Returns an InsertionResult SUCCESS (if the insertion was performed) or EXISTS (if the value already exists).
+    /// The returned pointer is to the newly inserted value on SUCCESS.
+    /// The returned pointer is to the existing value on EXISTS.
+    /// The returned pointer is never null.
+    /// @param key The value to insert
+    /// @return Pair of pointer to the inserted value or the existent one, and SUCCESS on insertion or EXISTS if the value already exists
+    constexpr std::pair<const T*, InsertionResult> insert(traits::copy_if_trivial_t<const T&> key)
+      noexcept(std::is_nothrow_copy_constructible_v<T>
+        && std::is_nothrow_move_constructible_v<T>
+        && std::is_nothrow_destructible_v<T>);
+
+    template<typename T_ = T, typename = std::enable_if_t<!std::is_trivial_v<T_>>>
+    /// @brief Inserts a new value if it does not already exist.
+    /// Returns an InsertionResult SUCCESS (if the insertion was performed) or EXISTS (if the value already exists).
+    /// The returned pointer is to the newly inserted value on SUCCESS.
+    /// The returned pointer is to the existing value on EXISTS.
+    /// The returned pointer is never null.
+    /// @tparam T_ SFINAE helper
+    /// @tparam  SFINAE helper
+    /// @param key The value to insert
+    /// @return Pair of pointer to the inserted value or the existent one, and SUCCESS on insertion or EXISTS if the value already exists
+    constexpr std::pair<const T*, InsertionResult> insert(T&& key)
+      noexcept(std::is_nothrow_move_constructible_v<T>
+        && std::is_nothrow_destructible_v<T>);
+
+    /// @brief Erases a value if it exists
+    /// @param key The value to erase
+    /// @return True if the value existed and was erased, else false
+    constexpr bool erase(traits::copy_if_trivial_t<const T&> key)
+      noexcept(std::is_nothrow_destructible_v<T>);
+
+    /// @brief Reallocates the HashSet to contain 'new_capacity' slots, rehashing in the process.
+    /// Precondition: new_capacity > get_size().
+    /// @param new_capacity The new count of slots
+    constexpr void reserve(size_t new_capacity)
+      noexcept(std::is_nothrow_move_constructible_v<T>
+        && std::is_nothrow_destructible_v<T>);
+
+  private:
+    /// @brief Returns the index of the first active slot starting from 'index'
+    /// @param index The index from which to search
+    /// @return The index of the active slot, or the capacity if there are none
+    constexpr size_t next_active(size_t index) const noexcept
+    {
+      for (; index < sentinel_metadata.get_size(); index++)
+        if (details::is_sentinel_active(sentinel_metadata[index]))
+          return index;
+      return slots.get_size();
+    }
+
+    /// @brief Finds a EMPTY/ACTIVE/DELETED slot matching 'key_hash'
+    /// @param key_hash The hash of 'key', obtained through the Hasher.
+    /// This function does not perform a hash of 'key' as usually the function
+    /// that calls this function already possesses that hash.
+    /// @param key The key to search for.
+    /// This key will not be hashed by the function.
+    /// @param prob The reference where to write the offset to the slot
+    /// @param metadata The Vector of KeySentinel representing the state of 'blk'
+    /// @param blk The array of slots
+    /// @return True if the key was not found ('prob' is then the first DELETED or EMPTY slot), false if the slot is already occupied
+    constexpr bool find_key(size_t key_hash, traits::copy_if_trivial_t<const T&> key, size_t& prob,
+      const Vector<details::KeySentinel>& metadata, memory::TypedBlock<T> blk) const noexcept;
+
+    /// @brief Returns the capacity of the rehash triggered by an insertion
+    /// @return The same capacity if the active slots fill at most half the load factor, else twice the capacity
+    constexpr size_t next_capacity() const noexcept
+    {
+      //A moved-from HashSet has no capacity
+      if (get_capacity() == 0)
+        return 16;
+      return float(get_size() + 1) > load_factor * get_capacity() / 2 ? get_capacity() * 2 : get_capacity();
+    }
+
+    /// @brief Augments the capacity of the HashSet, rehashing in the process
+    /// @param new_capacity The new capacity of the set
+    constexpr void realloc_map(size_t new_capacity)
+      noexcept(std::is_nothrow_move_constructible_v<T>
+        && std::is_nothrow_destructible_v<T>);
+  };
+
+  template<typename T, typename Hasher, typename KeyEqual>
+  constexpr HashSet<T, Hasher, KeyEqual>::HashSet(float load_factor, const Hasher& hasher, const KeyEqual& key_equal) noexcept
+    : sentinel_metadata(16, InPlace, details::EMPTY)
+    , slots(memory::allocate({ 16 * sizeof(T) }))
+    , load_factor(load_factor)
+    , hasher(hasher), key_equal(key_equal)
+  {
+    assert(0.0f < load_factor && load_factor < 1.0f && "Invalid load factor!");
+  }
+
+  template<typename T, typename Hasher, typename KeyEqual>
+  constexpr HashSet<T, Hasher, KeyEqual>::HashSet(size_t reserve_size, float load_factor, const Hasher& hasher, const KeyEqual& key_equal) noexcept
+    : sentinel_metadata(reserve_size, InPlace, details::EMPTY)
+    , slots(memory::allocate({ reserve_size * sizeof(T) }))
+    , load_factor(load_factor)
+    , hasher(hasher), key_equal(key_equal)
+  {
+    assert(0.0f < load_factor && load_factor < 1.0f && "Invalid load factor!");
+  }
+
+  template<typename T, typename Hasher, typename KeyEqual>
+  constexpr HashSet<T, Hasher, KeyEqual>::HashSet(HashSet&& set) noexcept
+    : sentinel_metadata(std::move(set.sentinel_metadata))
+    , slots(colt::exchange(set.slots, {}))
+    , size(colt::exchange(set.size, 0))
+    , tombstone_count(colt::exchange(set.tombstone_count, 0))
+    , load_factor(set.load_factor)
+    , hasher(set.hasher), key_equal(set.key_equal)
+  {}
+
+  template<typename T, typename Hasher, typename KeyEqual>
+  HashSet<T, Hasher, KeyEqual>::~HashSet() noexcept(std::is_nothrow_destructible_v<T>)
+  {
+    clear();
+    memory::deallocate(slots);
+  }
+
+  template<typename T, typename Hasher, typename KeyEqual>
+  constexpr void HashSet<T, Hasher, KeyEqual>::clear() noexcept(std::is_nothrow_destructible_v<T>)
+  {
+    for (size_t i = 0; i < sentinel_metadata.get_size(); i++)
+    {
+      if (details::is_sentinel_active(sentinel_metadata[i]))
+        slots.get_ptr()[i].~T(); //destroy active slots
+      sentinel_metadata[i] = details::EMPTY;
+    }
+    size = 0;
+    tombstone_count = 0;
+  }
+
+  template<typename T, typename Hasher, typename KeyEqual>
+  constexpr bool HashSet<T, Hasher, KeyEqual>::will_reallocate() const noexcept
+  {
+    return float(get_size() + tombstone_count + 1) > load_factor * get_capacity();
+  }
+
+  template<typename T, typename Hasher, typename KeyEqual>
+  constexpr void HashSet<T, Hasher, KeyEqual>::set_load_factor(float nload_factor) noexcept
+  {
+    assert(nload_factor < 1.0f && nload_factor > 0.0f && "Invalid load factor!");
+    load_factor = nload_factor;
+  }
+
+  template<typename T, typename Hasher, typename KeyEqual>
+  HashTableStats HashSet<T, Hasher, KeyEqual>::get_stats() const noexcept
+  {
+    HashTableStats stats = details::compute_hash_table_stats(sentinel_metadata.get_data(), slots.get_size(), sizeof(T),
+      [this](size_t index) { return hasher(slots.get_ptr()[index]); });
+#ifdef COLT_HASH_TABLE_STATS
+    stats.lookup_count = probe_counters.lookup_count;
+    stats.probe_count = probe_counters.probe_count;
+    stats.rehash_count = probe_counters.rehash_count;
+#endif
+    return stats;
+  }
+
+  template<typename T, typename Hasher, typename KeyEqual>
+  constexpr const T* HashSet<T, Hasher, KeyEqual>::find(traits::copy_if_trivial_t<const T&> key) const noexcept
+  {
+    if (slots.get_size() == 0)
+      return nullptr;
+    const size_t key_hash = hasher(key);
+    size_t prob_index = key_hash % slots.get_size();
+#ifdef COLT_HASH_TABLE_STATS
+    ++probe_counters.lookup_count;
+#endif
+    //Each slot is inspected at most once, as the table may have no EMPTY slot left
+    for (size_t i = 0; i < slots.get_size(); i++)
+    {
+#ifdef COLT_HASH_TABLE_STATS
+      ++probe_counters.probe_count;
+#endif
+      if (auto sentinel = sentinel_metadata[prob_index];
+        details::is_sentinel_empty(sentinel))
+      {
+        return nullptr; //not found
+      }
+      else if (details::is_sentinel_active(sentinel) && details::is_sentinel_equal(sentinel, key_hash))
+      {
+        if (key_equal(slots.get_ptr()[prob_index], key))
+          return slots.get_ptr() + prob_index;
+      }
+      prob_index = details::advance_prob(prob_index, slots.get_size());
+    }
+    return nullptr;
+  }
+
+  template<typename T, typename Hasher, typename KeyEqual>
+  constexpr std::pair<const T*, InsertionResult> HashSet<T, Hasher, KeyEqual>::insert(traits::copy_if_trivial_t<const T&> key)
+    noexcept(std::is_nothrow_copy_constructible_v<T>
+      && std::is_nothrow_move_constructible_v<T>
+      && std::is_nothrow_destructible_v<T>)
+  {
+    if (will_reallocate())
+      realloc_map(next_capacity());
+
+    const size_t key_hash = hasher(key);
+    size_t prob_index;
+    const bool is_free = find_key(key_hash, key, prob_index, sentinel_metadata, slots);
+#ifdef COLT_HASH_TABLE_STATS
+    ++probe_counters.lookup_count;
+#endif
+    if (is_free)
+    {
+      tombstone_count -= details::is_sentinel_deleted(sentinel_metadata[prob_index]);
+      new(slots.get_ptr() + prob_index) T(key);
+      //Set the slot to ACTIVE
+      sentinel_metadata[prob_index] = details::create_active_sentinel(key_hash);
+      ++size;
+      return { slots.get_ptr() + prob_index, InsertionResult::SUCCESS };
+    }
+    else
+      return { slots.get_ptr() + prob_index, InsertionResult::EXISTS };
+  }
+
+  template<typename T, typename Hasher, typename KeyEqual>
+  template<typename T_, typename>
+  constexpr std::pair<const T*, InsertionResult> HashSet<T, Hasher, KeyEqual>::insert(T&& key)
+    noexcept(std::is_nothrow_move_constructible_v<T>
+      && std::is_nothrow_destructible_v<T>)
+  {
+    if (will_reallocate())
+      realloc_map(next_capacity());
+
+    const size_t key_hash = hasher(key);
+    size_t prob_index;
+    const bool is_free = find_key(key_hash, key, prob_index, sentinel_metadata, slots);
+#ifdef COLT_HASH_TABLE_STATS
+    ++probe_counters.lookup_count;
+#endif
+    if (is_free)
+    {
+      tombstone_count -= details::is_sentinel_deleted(sentinel_metadata[prob_index]);
+      new(slots.get_ptr() + prob_index) T(std::move(key));
+      //Set the slot to ACTIVE
+      sentinel_metadata[prob_index] = details::create_active_sentinel(key_hash);
+      ++size;
+      return { slots.get_ptr() + prob_index, InsertionResult::SUCCESS };
+    }
+    else
+      return { slots.get_ptr() + prob_index, InsertionResult::EXISTS };
+  }
+
+  template<typename T, typename Hasher, typename KeyEqual>
+  constexpr bool HashSet<T, Hasher, KeyEqual>::erase(traits::copy_if_trivial_t<const T&> key) noexcept(std::is_nothrow_destructible_v<T>)
+  {
+    if (const T* ptr = find(key))
+    {
+      const size_t index = ptr - slots.get_ptr();
+      sentinel_metadata[index] = details::DELETED; //set the sentinel to deleted
+      slots.get_ptr()[index].~T();
+      --size;
+      ++tombstone_count;
+      return true;
+    }
+    return false;
+  }
+
+  template<typename T, typename Hasher, typename KeyEqual>
+  constexpr void HashSet<T, Hasher, KeyEqual>::reserve(size_t new_capacity)
+    noexcept(std::is_nothrow_move_constructible_v<T>
+      && std::is_nothrow_destructible_v<T>)
+  {
+    assert(new_capacity > get_size() && "Capacity must be greater than the size!");
+    realloc_map(new_capacity);
+  }
+
+  template<typename T, typename Hasher, typename KeyEqual>
+  constexpr bool HashSet<T, Hasher, KeyEqual>::find_key(size_t key_hash, traits::copy_if_trivial_t<const T&> key, size_t& prob, const Vector<details::KeySentinel>& metadata, memory::TypedBlock<T> blk) const noexcept
+  {
+    assert(key_hash == hasher(key));
+    assert(metadata.get_size() == blk.get_size());
+    size_t prob_index = key_hash % blk.get_size();
+    //The first DELETED slot is reused if the key is not found
+    size_t first_deleted = blk.get_size();
+    //Each slot is inspected at most once, as the table may have no EMPTY slot left
+    for (size_t i = 0; i < blk.get_size(); i++)
+    {
+#ifdef COLT_HASH_TABLE_STATS
+      //The rehashes probe a new table: only the lookups in this table are counted
+      if (&metadata == &sentinel_metadata)
+        ++probe_counters.probe_count;
+#endif
+      if (auto sentinel = metadata[prob_index];
+        details::is_sentinel_empty(sentinel))
+      {
+        prob = first_deleted != blk.get_size() ? first_deleted : prob_index;
+        return true;
+      }
+      else if (details::is_sentinel_deleted(sentinel))
+      {
+        if (first_deleted == blk.get_size())
+          first_deleted = prob_index;
+      }
+      else if (details::is_sentinel_equal(sentinel, key_hash))
+      {
+        if (key_equal(blk.get_ptr()[prob_index], key))
+        {
+          prob = prob_index;
+          return false;
+        }
+      }
+      prob_index = details::advance_prob(prob_index, blk.get_size());
+    }
+    assert(first_deleted != blk.get_size() && "The table has no free slot!");
+    prob = first_deleted;
+    return true;
+  }
+
+  template<typename T, typename Hasher, typename KeyEqual>
+  constexpr void HashSet<T, Hasher, KeyEqual>::realloc_map(size_t new_capacity)
+    noexcept(std::is_nothrow_move_constructible_v<T>
+      && std::is_nothrow_destructible_v<T>)
+  {
+    COLT_TRACE_BEGIN("HashSet::realloc_map");
+    memory::TypedBlock<T> new_slot = memory::allocate({ new_capacity * sizeof(T) });
+#ifdef COLT_HASH_TABLE_STATS
+    ++probe_counters.rehash_count;
+#endif
+
+    Vector<details::KeySentinel> new_metadata = { new_capacity, InPlace, details::EMPTY };
+    for (size_t i = 0; i < sentinel_metadata.get_size(); i++)
+    {
+      if (details::is_sentinel_active(sentinel_metadata[i]))
+      {
+        T* ptr = slots.get_ptr() + i;
+        const size_t key_hash = hasher(*ptr);
+        //The new table has no DELETED slots and no duplicates: the first EMPTY slot is the one
+        size_t prob_index = key_hash % new_capacity;
+        while (!details::is_sentinel_empty(new_metadata[prob_index]))
+          prob_index = details::advance_prob(prob_index, new_capacity);
+
+        //Move destruct
+        new(new_slot.get_ptr() + prob_index) T(std::move(*ptr));
+        ptr->~T();
+        new_metadata[prob_index] = details::create_active_sentinel(key_hash);
+      }
+    }
+    sentinel_metadata = std::move(new_metadata);
+    memory::deallocate(slots);
+    slots = new_slot;
+    tombstone_count = 0;
+    COLT_TRACE_END("HashSet::realloc_map");
   }
 
 #ifdef COLT_USE_IOSTREAMS
 
-  template<typename T, size_t size>
-  static std::ostream& operator<<(std::ostream& os, const StableSet<T, size>& var)
+  template<typename T, size_t size, typename Hasher, typename KeyEqual>
+  static std::ostream& operator<<(std::ostream& os, const StableSet<T, size, Hasher, KeyEqual>& var)
   {
     os << var.get_internal_list();
     return os;
   }
 
+  template<typename T, typename Hasher, typename KeyEqual>
+  static std::ostream& operator<<(std::ostream& os, const HashSet<T, Hasher, KeyEqual>& var)
+  {
+    static_assert(traits::is_coutable_v<T>, "T of HashSet should implement operator<<(std::ostream&)!");
+
+    os << '{';
+    bool is_first = true;
+    for (const auto& value : var)
+    {
+      os << (is_first ? " " : ", ") << value;
+      is_first = false;
+    }
+    os << (is_first ? "}" : " }");
+    return os;
+  }
+
 #endif
 }
 
@@ -0,0 +1,385 @@
+/** @file SharedPtr.h
+* Contains a reference counted SharedPtr class that uses the allocators in 'memory/allocator.h'.
+* make_shared allocates the reference count with the object (a single allocation through 'memory::new_t').
+* The count can be atomic (default) or not, which avoids the cost of atomic operations
+* for objects that are only shared by a single thread.
+* Types deriving from RefCounted store their count themselves (intrusive counting):
+* the count of such objects starts at 0 and is incremented by each SharedPtr,
+* so a SharedPtr can be created from a raw pointer to a new object or from 'this'.
+*/
+
+#ifndef HG_COLT_SHARED_PTR
+#define HG_COLT_SHARED_PTR
+
+#include "../details/allocator.h"
+#include "../utility/Hash.h"
+#include "../utility/Assert.h"
+
+namespace colt
+{
+  namespace details
+  {
+    template<bool is_atomic>
+    /// @brief Reference count, atomic or not
+    /// @tparam is_atomic True if the count can be modified by multiple threads
+    class RefCount
+    {
+      /// @brief The count
+      std::conditional_t<is_atomic, std::atomic<u32>, u32> count;
+
+    public:
+      /// @brief Constructs a count of 1
+      constexpr RefCount() noexcept
+        : count(1) {}
+
+      /// @brief Constructs a count
+      /// @param initial The initial count
+      constexpr explicit RefCount(u32 initial) noexcept
+        : count(initial) {}
+
+      /// @brief Increments the count
+      void increment() noexcept
+      {
+        if constexpr (is_atomic)
+          count.fetch_add(1, std::memory_order_relaxed);
+        else
+          ++count;
+      }
+
+      /// @brief Decrements the count
+      /// @return True if the count reached 0
+      bool decrement() noexcept
+      {
+        if constexpr (is_atomic)
+          //Acquire-release: the destruction must happen after all the other accesses
+          return count.fetch_sub(1, std::memory_order_acq_rel) == 1;
+        else
+          return --count == 0;
+      }
+
+      /// @brief Returns the count
+      /// @return The count
+      u32 get() const noexcept
+      {
+        if constexpr (is_atomic)
+          return count.load(std::memory_order_relaxed);
+        else
+          return count;
+      }
+    };
+
+    template<bool is_atomic>
+    /// @brief The header of the block allocated by make_shared
+    /// @tparam is_atomic True if the count is atomic
+    struct SharedControl
+    {
+      /// @brief The reference count
+      RefCount<is_atomic> count;
+      /// @brief Destroys and frees the block containing this header
+      void(*destroy)(SharedControl*) noexcept;
+    };
+
+    template<typename T, bool is_atomic>
+    /// @brief The block allocated by make_shared: the count followed by the object
+    /// @tparam T The type of the object
+    /// @tparam is_atomic True if the count is atomic
+    struct SharedBlock
+      : public SharedControl<is_atomic>
+    {
+      /// @brief The shared object
+      T value;
+
+      template<typename... Args>
+      /// @brief Constructs the object with a count of 1
+      /// @tparam ...Args The parameter pack
+      /// @param ...args The argument pack to forward to the constructor
+      SharedBlock(Args&&... args) noexcept(std::is_nothrow_constructible_v<T, Args...>)
+        : SharedControl<is_atomic>{ {}, &destroy_block }, value(std::forward<Args>(args)...) {}
+
+      /// @brief Destroys and frees a SharedBlock
+      /// @param control The header of the SharedBlock
+      static void destroy_block(SharedControl<is_atomic>* control) noexcept
+      {
+        memory::delete_t<SharedBlock>(memory::MemBlock{ static_cast<SharedBlock*>(control), sizeof(SharedBlock) });
+      }
+    };
+  }
+
+  template<bool is_atomic = true>
+  /// @brief Base class of types that store their own reference count (intrusive counting).
+  /// The count starts at 0 and each SharedPtr owning the object increments it: a SharedPtr
+  /// to a type deriving from RefCounted can be created from a raw pointer to an object
+  /// allocated through 'memory::new_t', either freshly allocated or already shared (as 'this').
+  /// SharedPtr always destroys such objects as their static type: SharedPtr of
+  /// a base class of the allocated type should not be created.
+  /// @tparam is_atomic True if the count can be modified by multiple threads
+  class RefCounted
+  {
+    template<typename T, bool>
+    friend class SharedPtr;
+
+    /// @brief The reference count
+    mutable details::RefCount<is_atomic> ref_count = details::RefCount<is_atomic>{ 0 };
+
+  protected:
+    /// @brief Constructs a count of 0 (not owned by any SharedPtr)
+    constexpr RefCounted() noexcept = default;
+    /// @brief Copying an object does not copy its count
+    constexpr RefCounted(const RefCounted&) noexcept {}
+    /// @brief Copying an object does not copy its count
+    /// @return Self
+    constexpr RefCounted& operator=(const RefCounted&) noexcept { return *this; }
+    /// @brief Destructor
+    ~RefCounted() noexcept = default;
+
+  public:
+    /// @brief Returns the count of SharedPtr owning the object
+    /// @return The reference count
+    u32 get_ref_count() const noexcept { return ref_count.get(); }
+  };
+
+  namespace traits
+  {
+    template<typename T>
+    /// @brief Check if a type derives from RefCounted
+    /// @tparam T The type to check
+    static constexpr bool is_ref_counted_v = std::is_base_of_v<RefCounted<true>, T> || std::is_base_of_v<RefCounted<false>, T>;
+
+    template<typename T>
+    /// @brief The atomicity of the count of SharedPtr<T>: the one of RefCounted, or atomic by default
+    /// @tparam T The type pointed to by the SharedPtr
+    static constexpr bool default_ref_count_atomicity_v = !std::is_base_of_v<RefCounted<false>, T>;
+  }
+
+  template<typename T, bool is_atomic = traits::default_ref_count_atomicity_v<T>>
+  /// @brief Reference counted pointer that frees its resource when the last owner is destroyed.
+  /// For types deriving from RefCounted, the count is stored in the object; else make_shared
+  /// allocates the count with the object, and the SharedPtr holds a pointer to both.
+  /// @tparam T The type pointed to by the SharedPtr
+  /// @tparam is_atomic True if the count can be modified by multiple threads
+  class SharedPtr
+  {
+    template<typename Ty, bool>
+    friend class SharedPtr;
+
+    template<typename Ty, bool atomic, typename... Args>
+    friend SharedPtr<Ty, atomic> make_shared(Args&&... args) noexcept(std::is_nothrow_constructible_v<Ty, Args...>);
+
+    /// @brief True if the count is stored in the object
+    static constexpr bool is_intrusive = traits::is_ref_counted_v<T>;
+    static_assert(!is_intrusive || traits::default_ref_count_atomicity_v<T> == is_atomic,
+      "Atomicity of SharedPtr must match the one of RefCounted!");
+
+    /// @brief The control type (unused for intrusive counting)
+    using control_t = details::SharedControl<is_atomic>;
+
+    /// @brief Pointer to the object
+    T* ptr = nullptr;
+    /// @brief Pointer to the count (nullptr for intrusive counting)
+    control_t* control = nullptr;
+
+    /// @brief Constructs a SharedPtr from an object and its count, without incrementing it
+    /// @param ptr The object
+    /// @param control The count
+    constexpr SharedPtr(T* ptr, control_t* control) noexcept
+      : ptr(ptr), control(control) {}
+
+    /// @brief Increments the count of the owned object if there is one
+    void increment() noexcept
+    {
+      if constexpr (is_intrusive)
+      {
+        if (ptr)
+          ptr->ref_count.increment();
+      }
+      else if (control)
+        control->count.increment();
+    }
+
+    /// @brief Decrements the count of the owned object, destroying it if it reached 0
+    void decrement() noexcept
+    {
+      if constexpr (is_intrusive)
+      {
+        if (ptr && ptr->ref_count.decrement())
+          memory::delete_t<std::remove_cv_t<T>>(memory::MemBlock{ const_cast<std::remove_cv_t<T>*>(ptr), sizeof(T) });
+      }
+      else if (control && control->count.decrement())
+        control->destroy(control);
+    }
+
+  public:
+    /// @brief Default constructs an empty SharedPtr
+    constexpr SharedPtr() noexcept = default;
+    /// @brief Default constructs an empty SharedPtr
+    /// @param  nullptr_t
+    constexpr SharedPtr(std::nullptr_t) noexcept {}
+
+    template<typename Ty = T, typename = std::enable_if_t<traits::is_ref_counted_v<Ty>>>
+    /// @brief Shares an object that stores its own count (incrementing it).
+    /// The object must have been allocated through 'memory::new_t': a new object
+    /// (whose count is 0) is then owned by this SharedPtr alone.
+    /// @param ptr The object to share (or nullptr)
+    explicit SharedPtr(T* ptr) noexcept
+      : ptr(ptr)
+    {
+      increment();
+    }
+
+    /// @brief Copy constructor, shares the object
+    /// @param to_copy The SharedPtr whose object to share
+    SharedPtr(const SharedPtr& to_copy) noexcept
+      : ptr(to_copy.ptr), control(to_copy.control)
+    {
+      increment();
+    }
+
+    /// @brief Move constructor
+    /// @param to_move The SharedPtr whose object to steal
+    constexpr SharedPtr(SharedPtr&& to_move) noexcept
+      : ptr(colt::exchange(to_move.ptr, nullptr)), control(colt::exchange(to_move.control, nullptr)) {}
+
+    template<typename T2, typename = std::enable_if_t<std::is_convertible_v<T2*, T*> && !traits::is_ref_counted_v<T>>>
+    /// @brief Copy constructor for inheritances (and const conversion)
+    /// @tparam T2 The type of the SharedPtr whose object to share
+    /// @param to_copy The SharedPtr whose object to share
+    SharedPtr(const SharedPtr<T2, is_atomic>& to_copy) noexcept
+      : ptr(to_copy.ptr), control(to_copy.control)
+    {
+      increment();
+    }
+
+    template<typename T2, typename = std::enable_if_t<std::is_convertible_v<T2*, T*> && !traits::is_ref_counted_v<T>>>
+    /// @brief Move constructor for inheritances (and const conversion)
+    /// @tparam T2 The type of the SharedPtr whose object to steal
+    /// @param to_move The SharedPtr whose object to steal
+    SharedPtr(SharedPtr<T2, is_atomic>&& to_move) noexcept
+      : ptr(colt::exchange(to_move.ptr, nullptr)), control(colt::exchange(to_move.control, nullptr)) {}
+
+    /// @brief Copy assignment operator
+    /// @param to_copy The SharedPtr whose object to share
+    /// @return Self
+    SharedPtr& operator=(const SharedPtr& to_copy) noexcept
+    {
+      SharedPtr copy = to_copy;
+      swap(copy);
+      return *this;
+    }
+
+    /// @brief Move assignment operator
+    /// @param to_move The SharedPtr whose object to steal
+    /// @return Self
+    SharedPtr& operator=(SharedPtr&& to_move) noexcept
+    {
+      swap(to_move);
+      return *this;
+    }
+
+    /// @brief Destructor, releases the shared object
+    ~SharedPtr() noexcept
+    {
+      decrement();
+    }
+
+    /// @brief Swaps the objects of two SharedPtr
+    /// @param other The SharedPtr with which to swap
+    void swap(SharedPtr& other) noexcept
+    {
+      colt::swap(ptr, other.ptr);
+      colt::swap(control, other.control);
+    }
+
+    /// @brief Releases the shared object, making the SharedPtr empty
+    void reset() noexcept
+    {
+      decrement();
+      ptr = nullptr;
+      control = nullptr;
+    }
+
+    /// @brief Implicitly converts to a boolean, like a pointer
+    /// @return True if the SharedPtr is not empty
+    constexpr explicit operator bool() const noexcept { return ptr != nullptr; }
+    /// @brief Implicitly converts to a boolean, like a pointer
+    /// @return True if the SharedPtr is empty
+    constexpr bool operator!() const noexcept { return ptr == nullptr; }
+
+    /// @brief Dereferences the pointer to the object
+    /// @return Reference to the object
+    constexpr T& operator*() const noexcept { return *ptr; }
+    /// @brief Dereferences the pointer to the object
+    /// @return Pointer to the object
+    constexpr T* operator->() const noexcept { return ptr; }
+
+    /// @brief Check if the SharedPtr is empty
+    /// @return True if the SharedPtr is empty
+    constexpr bool is_null() const noexcept { return ptr == nullptr; }
+    /// @brief Check if the SharedPtr is not empty
+    /// @return True if the SharedPtr is not empty
+    constexpr bool is_not_null() const noexcept { return ptr != nullptr; }
+
+    /// @brief Get the pointer to the object
+    /// @return Pointer to the object
+    constexpr T* get_ptr() const noexcept { return ptr; }
+
+    /// @brief Returns the count of SharedPtr owning the object
+    /// @return The count, or 0 if the SharedPtr is empty
+    u32 get_use_count() const noexcept
+    {
+      if constexpr (is_intrusive)
+        return ptr ? ptr->ref_count.get() : 0;
+      else
+        return control ? control->count.get() : 0;
+    }
+  };
+
+  template<typename T, bool is_atomic = traits::default_ref_count_atomicity_v<T>, typename... Args>
+  /// @brief Creates a SharedPtr of type T pointing to a T constructed with 'args'.
+  /// The object and its count are allocated at once through 'memory::new_t'.
+  /// @tparam T The type to construct
+  /// @tparam is_atomic True if the count can be modified by multiple threads
+  /// @tparam ...Args The parameter pack
+  /// @param ...args The argument pack
+  /// @return SharedPtr of type T
+  SharedPtr<T, is_atomic> make_shared(Args&&... args) noexcept(std::is_nothrow_constructible_v<T, Args...>)
+  {
+    if constexpr (traits::is_ref_counted_v<T>)
+    {
+      //The count is part of the object, which starts at 0
+      return SharedPtr<T, is_atomic>(memory::new_t<T>(std::forward<Args>(args)...).get_ptr());
+    }
+    else
+    {
+      auto blk = memory::new_t<details::SharedBlock<T, is_atomic>>(std::forward<Args>(args)...);
+      return SharedPtr<T, is_atomic>(&blk.get_ptr()->value, blk.get_ptr());
+    }
+  }
+
+  template<typename T, bool is_atomic>
+  /// @brief Hash overload for SharedPtr
+  /// @tparam T The type of the SharedPtr
+  struct hash<SharedPtr<T, is_atomic>>
+  {
+    /// @brief Hashing operator
+    /// @param ptr The ptr to hash
+    /// @return Hash
+    constexpr size_t operator()(const SharedPtr<T, is_atomic>& ptr) const noexcept
+    {
+      static_assert(traits::is_hashable_v<T>, "Type of SharedPtr should be hashable!");
+      if (ptr)
+        return GetHash(*ptr);
+      return 18446744073709548283ULL;
+    }
+  };
+
+#ifdef COLT_USE_IOSTREAMS
+  template<typename T, bool is_atomic>
+  static std::ostream& operator<<(std::ostream& os, const SharedPtr<T, is_atomic>& var)
+  {
+    os << var.get_ptr();
+    return os;
+  }
+#endif
+}
+
+#endif //!HG_COLT_SHARED_PTR
@@ -0,0 +1,214 @@
+/** @file SharedString.h
+* Contains SharedString, an immutable reference counted string.
+* A SharedString is a single pointer to a single allocation containing
+* the reference count, the size, the hash and the characters (NUL terminated).
+* Copying a SharedString only increments the count, and hashing it returns
+* the hash computed on construction, which makes it a cheap key for Map and StableSet.
+* The hash of a SharedString is the same as the one of the StringView of its characters.
+*/
+
+#ifndef HG_COLT_SHARED_STRING
+#define HG_COLT_SHARED_STRING
+
+#include "String.h"
+#include "SharedPtr.h"
+
+namespace colt
+{
+  namespace details
+  {
+    /// @brief The header of the allocation of a SharedString, followed by its characters
+    struct SharedStringHeader
+    {
+      /// @brief The reference count
+      RefCount<true> count;
+      /// @brief The count of characters (without the NUL terminator)
+      size_t size;
+      /// @brief The hash of the characters
+      size_t hash;
+
+      /// @brief Returns the characters following the header
+      /// @return Pointer to the characters
+      char* get_data() noexcept { return reinterpret_cast<char*>(this + 1); }
+    };
+  }
+
+  /// @brief Immutable reference counted string.
+  /// Copies cost an atomic increment, and the hash is cached.
+  class SharedString
+  {
+    /// @brief The header of the allocation (or nullptr for an empty string)
+    details::SharedStringHeader* header = nullptr;
+
+    /// @brief Releases the owned string
+    void release() noexcept
+    {
+      if (header && header->count.decrement())
+        memory::deallocate({ header, sizeof(details::SharedStringHeader) + header->size + 1 });
+    }
+
+  public:
+    /// @brief Constructs an empty SharedString (which does not allocate)
+    constexpr SharedString() noexcept = default;
+
+    /// @brief Constructs a SharedString by copying the characters of a StringView
+    /// @param strv The characters to copy
+    explicit SharedString(StringView strv) noexcept
+    {
+      if (strv.is_empty())
+        return;
+      auto blk = memory::allocate({ sizeof(details::SharedStringHeader) + strv.get_size() + 1 });
+      header = new(blk.get_ptr()) details::SharedStringHeader{ {}, strv.get_size(), GetHash(strv) };
+      std::memcpy(header->get_data(), strv.get_data(), strv.get_size());
+      header->get_data()[strv.get_size()] = '\0';
+    }
+
+    /// @brief Constructs a SharedString by copying a NUL terminated string
+    /// @param cstr The NUL terminated string to copy
+    explicit SharedString(const char* cstr) noexcept
+      : SharedString(StringView{ cstr }) {}
+
+    /// @brief Copy constructor, shares the characters
+    /// @param to_copy The SharedString to share
+    SharedString(const SharedString& to_copy) noexcept
+      : header(to_copy.header)
+    {
+      if (header)
+        header->count.increment();
+    }
+
+    /// @brief Move constructor
+    /// @param to_move The SharedString whose characters to steal
+    constexpr SharedString(SharedString&& to_move) noexcept
+      : header(colt::exchange(to_move.header, nullptr)) {}
+
+    /// @brief Copy assignment operator, shares the characters
+    /// @param to_copy The SharedString to share
+    /// @return Self
+    SharedString& operator=(const SharedString& to_copy) noexcept
+    {
+      SharedString copy = to_copy;
+      colt::swap(header, copy.header);
+      return *this;
+    }
+
+    /// @brief Move assignment operator
+    /// @param to_move The SharedString whose characters to steal
+    /// @return Self
+    SharedString& operator=(SharedString&& to_move) noexcept
+    {
+      colt::swap(header, to_move.header);
+      return *this;
+    }
+
+    /// @brief Destructor, releases the characters
+    ~SharedString() noexcept
+    {
+      release();
+    }
+
+    /// @brief Returns the count of characters
+    /// @return The size of the string
+    size_t get_size() const noexcept { return header ? header->size : 0; }
+    /// @brief Check if the string is empty
+    /// @return True if the string is empty
+    bool is_empty() const noexcept { return header == nullptr; }
+    /// @brief Check if the string is not empty
+    /// @return True if the string is not empty
+    bool is_not_empty() const noexcept { return header != nullptr; }
+
+    /// @brief Returns the characters (NUL terminated)
+    /// @return Pointer to the characters
+    const char* get_data() const noexcept { return header ? header->get_data() : ""; }
+    /// @brief Returns the characters as a NUL terminated string
+    /// @return Pointer to the characters
+    const char* c_str() const noexcept { return get_data(); }
+
+    /// @brief Returns the hash of the string, computed on construction
+    /// @return The hash of the characters
+    size_t get_hash() const noexcept { return header ? header->hash : GetHash(StringView{}); }
+
+    /// @brief Returns the count of SharedString sharing the characters
+    /// @return The reference count, or 0 for an empty string
+    u32 get_use_count() const noexcept { return header ? header->count.get() : 0; }
+
+    /// @brief Returns a StringView over the characters
+    /// @return StringView over the characters
+    StringView to_view() const noexcept { return { get_data(), get_data() + get_size() }; }
+    /// @brief Converts to a StringView over the characters
+    /// @return StringView over the characters
+    operator StringView() const noexcept { return to_view(); }
+
+    /// @brief Check if two strings are equal (comparing sizes and hashes before the characters)
+    /// @param a The first string
+    /// @param b The second string
+    /// @return True if both strings have the same characters
+    friend bool operator==(const SharedString& a, const SharedString& b) noexcept
+    {
+      if (a.header == b.header)
+        return true;
+      if (a.get_size() != b.get_size() || a.get_hash() != b.get_hash())
+        return false;
+      return std::memcmp(a.get_data(), b.get_data(), a.get_size()) == 0;
+    }
+
+    /// @brief Check if two strings are different
+    /// @param a The first string
+    /// @param b The second string
+    /// @return True if both strings have different characters
+    friend bool operator!=(const SharedString& a, const SharedString& b) noexcept { return !(a == b); }
+
+    /// @brief Check if a string is equal to a StringView
+    /// @param a The string
+    /// @param b The StringView
+    /// @return True if both have the same characters
+    friend bool operator==(const SharedString& a, StringView b) noexcept { return a.to_view() == b; }
+    /// @brief Check if a string is different from a StringView
+    /// @param a The string
+    /// @param b The StringView
+    /// @return True if both have different characters
+    friend bool operator!=(const SharedString& a, StringView b) noexcept { return a.to_view() != b; }
+  };
+
+  template<>
+  /// @brief Hash overload for SharedString, which returns the cached hash
+  struct hash<SharedString>
+  {
+    /// @brief Hashing operator
+    /// @param str The string to hash
+    /// @return Hash
+    size_t operator()(const SharedString& str) const noexcept
+    {
+      return str.get_hash();
+    }
+  };
+
+#ifdef COLT_USE_IOSTREAMS
+
+  static std::ostream& operator<<(std::ostream& os, const SharedString& var)
+  {
+    os.write(var.get_data(), var.get_size());
+    return os;
+  }
+
+#endif
+}
+
+#ifdef COLT_USE_FMT
+
+template<>
+struct fmt::formatter<colt::SharedString>
+{
+  template<typename ParseContext>
+  constexpr auto parse(ParseContext& ctx) { return ctx.begin(); }
+
+  template<typename FormatContext>
+  auto format(const colt::SharedString& str, FormatContext& ctx)
+  {
+    return fmt::format_to(ctx.out(), "{:.{}}", str.get_data(), str.get_size());
+  }
+};
+
+#endif
+
+#endif //!HG_COLT_SHARED_STRING
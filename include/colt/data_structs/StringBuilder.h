@@ -0,0 +1,322 @@
+/** @file StringBuilder.h
+* Contains StringBuilder, a string made of a list of chunks.
+* Appending to a StringBuilder never copies the characters already appended:
+* when the last chunk is full, a new chunk (whose capacity doubles up to
+* MAX_CHUNK_SIZE) is linked after it. This makes building large outputs linear,
+* while appending to a StringOf copies all its characters on each reallocation.
+* The chunks can be written as is to a file descriptor (through 'writev' on POSIX)
+* or to a FILE, and are only copied into a single StringOf through 'to_string'.
+*/
+
+#ifndef HG_COLT_STRING_BUILDER
+#define HG_COLT_STRING_BUILDER
+
+#include <cstdio>
+#include <cerrno>
+
+#include "String.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+  #include <sys/uio.h>
+  #include <unistd.h>
+  #include <climits>
+  /// @brief StringBuilder can write its chunks through 'writev'
+  #define COLT_DETAILS_STRING_BUILDER_WRITEV
+#endif
+
+namespace colt
+{
+  namespace details
+  {
+    /// @brief The header of a chunk of a StringBuilder, followed by its characters
+    struct StringChunk
+    {
+      /// @brief The next chunk (or nullptr for the last chunk)
+      StringChunk* next;
+      /// @brief The count of characters written in the chunk
+      size_t size;
+      /// @brief The count of characters the chunk can contain
+      size_t capacity;
+
+      /// @brief Returns the characters following the header
+      /// @return Pointer to the characters
+      char* get_data() noexcept { return reinterpret_cast<char*>(this + 1); }
+      /// @brief Returns the characters following the header
+      /// @return Pointer to the characters
+      const char* get_data() const noexcept { return reinterpret_cast<const char*>(this + 1); }
+    };
+  }
+
+  /// @brief String built by appending to a list of chunks, which never copies
+  /// the characters already appended.
+  /// Use 'to_string' to obtain a contiguous String, or 'write_to' to output
+  /// the chunks without copying them.
+  class StringBuilder
+  {
+  public:
+    /// @brief The capacity of the first chunk
+    static constexpr size_t MIN_CHUNK_SIZE = 256;
+    /// @brief The maximum capacity of chunks (bigger appends still fit in a single chunk)
+    static constexpr size_t MAX_CHUNK_SIZE = 1024 * 1024;
+
+  private:
+    /// @brief The first chunk (or nullptr if nothing was ever appended)
+    details::StringChunk* head = nullptr;
+    /// @brief The last chunk, to which characters are appended
+    details::StringChunk* tail = nullptr;
+    /// @brief The count of characters in all the chunks
+    size_t size = 0;
+    /// @brief The count of chunks
+    size_t chunk_count = 0;
+
+    /// @brief Links a new chunk able to contain at least 'min_capacity' characters
+    /// @param min_capacity The minimum capacity of the chunk
+    void add_chunk(size_t min_capacity) noexcept
+    {
+      size_t capacity = tail == nullptr ? MIN_CHUNK_SIZE : tail->capacity * 2;
+      capacity = capacity > MAX_CHUNK_SIZE ? MAX_CHUNK_SIZE : capacity;
+      capacity = capacity < min_capacity ? min_capacity : capacity;
+
+      auto blk = memory::allocate({ sizeof(details::StringChunk) + capacity });
+      auto chunk = new(blk.get_ptr()) details::StringChunk{ nullptr, 0, capacity };
+      if (tail == nullptr)
+        head = chunk;
+      else
+        tail->next = chunk;
+      tail = chunk;
+      ++chunk_count;
+    }
+
+    /// @brief Frees all the chunks
+    void release() noexcept
+    {
+      while (head != nullptr)
+      {
+        auto next = head->next;
+        memory::deallocate({ head, sizeof(details::StringChunk) + head->capacity });
+        head = next;
+      }
+    }
+
+  public:
+    /// @brief Constructs an empty StringBuilder (which does not allocate)
+    constexpr StringBuilder() noexcept = default;
+
+    /// @brief Constructs an empty StringBuilder whose first chunk can contain 'capacity' characters
+    /// @param capacity The capacity of the first chunk
+    explicit StringBuilder(size_t capacity) noexcept
+    {
+      add_chunk(capacity);
+    }
+
+    /// @brief StringBuilder cannot be copied
+    StringBuilder(const StringBuilder&) = delete;
+    /// @brief StringBuilder cannot be copied
+    StringBuilder& operator=(const StringBuilder&) = delete;
+
+    /// @brief Move constructor
+    /// @param to_move The StringBuilder whose chunks to steal
+    constexpr StringBuilder(StringBuilder&& to_move) noexcept
+      : head(colt::exchange(to_move.head, nullptr)), tail(colt::exchange(to_move.tail, nullptr))
+      , size(colt::exchange(to_move.size, 0)), chunk_count(colt::exchange(to_move.chunk_count, 0)) {}
+
+    /// @brief Move assignment operator
+    /// @param to_move The StringBuilder whose chunks to steal
+    /// @return Self
+    StringBuilder& operator=(StringBuilder&& to_move) noexcept
+    {
+      colt::swap(head, to_move.head);
+      colt::swap(tail, to_move.tail);
+      colt::swap(size, to_move.size);
+      colt::swap(chunk_count, to_move.chunk_count);
+      return *this;
+    }
+
+    /// @brief Destructor, frees all the chunks
+    ~StringBuilder() noexcept
+    {
+      release();
+    }
+
+    /// @brief Appends a character
+    /// @param chr The character to append
+    void append(char chr) noexcept
+    {
+      if (tail == nullptr || tail->size == tail->capacity)
+        add_chunk(1);
+      tail->get_data()[tail->size++] = chr;
+      ++size;
+    }
+
+    /// @brief Appends the characters of a StringView.
+    /// The characters fill the last chunk, and the remaining ones are copied to a new chunk.
+    /// @param strv The characters to append
+    void append(StringView strv) noexcept
+    {
+      const char* data = strv.get_data();
+      size_t remaining = strv.get_size();
+      size += remaining;
+      if (tail != nullptr)
+      {
+        const size_t available = tail->capacity - tail->size;
+        const size_t to_copy = available < remaining ? available : remaining;
+        if (to_copy != 0)
+          std::memcpy(tail->get_data() + tail->size, data, to_copy);
+        tail->size += to_copy;
+        data += to_copy;
+        remaining -= to_copy;
+      }
+      if (remaining == 0)
+        return;
+      add_chunk(remaining);
+      std::memcpy(tail->get_data(), data, remaining);
+      tail->size = remaining;
+    }
+
+    /// @brief Appends a character
+    /// @param chr The character to append
+    /// @return Self
+    StringBuilder& operator+=(char chr) noexcept
+    {
+      append(chr);
+      return *this;
+    }
+
+    /// @brief Appends the characters of a StringView
+    /// @param strv The characters to append
+    /// @return Self
+    StringBuilder& operator+=(StringView strv) noexcept
+    {
+      append(strv);
+      return *this;
+    }
+
+    /// @brief Returns the count of characters appended
+    /// @return The size of the string
+    size_t get_size() const noexcept { return size; }
+    /// @brief Returns the count of chunks
+    /// @return The count of chunks
+    size_t get_chunk_count() const noexcept { return chunk_count; }
+    /// @brief Check if the string is empty
+    /// @return True if the string is empty
+    bool is_empty() const noexcept { return size == 0; }
+    /// @brief Check if the string is not empty
+    /// @return True if the string is not empty
+    bool is_not_empty() const noexcept { return size != 0; }
+
+    /// @brief Removes all the characters, keeping only the first chunk
+    void clear() noexcept
+    {
+      if (head == nullptr)
+        return;
+      auto first = head;
+      head = head->next;
+      release();
+      head = tail = first;
+      first->next = nullptr;
+      first->size = 0;
+      size = 0;
+      chunk_count = 1;
+    }
+
+    /// @brief Calls 'fn' with a StringView over each non-empty chunk, in order
+    /// @tparam Fn The function type
+    /// @param fn The function to call
+    template<typename Fn>
+    void for_each_chunk(Fn&& fn) const
+    {
+      for (auto chunk = head; chunk != nullptr; chunk = chunk->next)
+        if (chunk->size != 0)
+          fn(StringView{ chunk->get_data(), chunk->get_data() + chunk->size });
+    }
+
+    /// @brief Copies all the characters to a single String
+    /// @return String containing all the characters
+    StringOf<char> to_string() const noexcept
+    {
+      StringOf<char> str;
+      if (size > str.get_capacity())
+        str.reserve(size - str.get_capacity());
+      for_each_chunk([&](StringView strv) { str.append(strv); });
+      return str;
+    }
+
+    /// @brief Writes all the characters to a FILE
+    /// @param file The file to which to write
+    /// @return True if all the characters were written
+    bool write_to(FILE* file) const noexcept
+    {
+      for (auto chunk = head; chunk != nullptr; chunk = chunk->next)
+        if (std::fwrite(chunk->get_data(), 1, chunk->size, file) != chunk->size)
+          return false;
+      return true;
+    }
+
+#ifdef COLT_DETAILS_STRING_BUILDER_WRITEV
+    /// @brief Writes all the characters to a file descriptor, through 'writev'.
+    /// The chunks are written without being copied, up to IOV_MAX chunks per call.
+    /// Partial writes and interrupted calls are retried, but a call writing nothing is a failure.
+    /// @param fd The file descriptor to which to write
+    /// @return True if all the characters were written
+    bool write_to(int fd) const noexcept
+    {
+#ifdef IOV_MAX
+      constexpr size_t BATCH_SIZE = IOV_MAX < 64 ? IOV_MAX : 64;
+#else
+      constexpr size_t BATCH_SIZE = 16;
+#endif
+      iovec iov[BATCH_SIZE];
+      auto chunk = head;
+      //The offset in 'chunk' of the first character not yet written
+      size_t offset = 0;
+      while (chunk != nullptr)
+      {
+        //Fills the batch, starting from the first character not written
+        int iov_count = 0;
+        for (auto it = chunk; it != nullptr && static_cast<size_t>(iov_count) < BATCH_SIZE; it = it->next)
+        {
+          const size_t start = it == chunk ? offset : 0;
+          if (it->size == start)
+            continue;
+          iov[iov_count].iov_base = const_cast<char*>(it->get_data() + start);
+          iov[iov_count].iov_len = it->size - start;
+          ++iov_count;
+        }
+        if (iov_count == 0)
+          return true;
+
+        const ssize_t written = ::writev(fd, iov, iov_count);
+        //Writing nothing while characters remain would loop forever
+        if (written <= 0)
+        {
+          if (written < 0 && errno == EINTR)
+            continue;
+          return false;
+        }
+        //Skips the chunks that were fully written
+        size_t to_skip = static_cast<size_t>(written);
+        while (chunk != nullptr && to_skip >= chunk->size - offset)
+        {
+          to_skip -= chunk->size - offset;
+          chunk = chunk->next;
+          offset = 0;
+        }
+        offset += to_skip;
+      }
+      return true;
+    }
+#endif
+  };
+
+#ifdef COLT_USE_IOSTREAMS
+
+  static std::ostream& operator<<(std::ostream& os, const StringBuilder& var)
+  {
+    var.for_each_chunk([&](StringView strv) { os.write(strv.get_data(), strv.get_size()); });
+    return os;
+  }
+
+#endif
+}
+
+#endif //!HG_COLT_STRING_BUILDER
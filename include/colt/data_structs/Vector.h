@@ -49,6 +49,13 @@ namespace colt
     /// @param reserve The count of object to reserve
     constexpr explicit Vector(size_t reserve) noexcept;
 
+    /// @brief Constructs a Vector with 'reserve' object reserved in the scratch allocator.
+    /// The Vector grows through the scratch allocator, and must be destroyed
+    /// before the innermost memory::ScratchScope (see memory::scratch_allocate).
+    /// @param reserve The count of object to reserve (not 0)
+    /// @param  InScratchT tag
+    constexpr Vector(size_t reserve, traits::InScratchT) noexcept;
+
     template<typename... Args>
     /// @brief Constructs and fills a Vector of 'fill_size' by forwarding 'args' to the constructor
     /// @tparam ...Args The parameter pack
@@ -180,6 +187,12 @@ namespace colt
     constexpr void push_back(traits::InPlaceT, Args&&... args)
       noexcept(std::is_nothrow_constructible_v<T, Args...>);
 
+    /// @brief Pushes N copies of an object at the end of the Vector, reallocating at most once.
+    /// @param N The number of copies to push
+    /// @param to_copy The object to copy
+    constexpr void push_back_n(size_t N, traits::copy_if_trivial_t<const T&> to_copy)
+      noexcept(std::is_nothrow_copy_constructible_v<T>);
+
     /// @brief Pops an item from the back of the Vector.
     /// @pre !is_empty() (colt_vector_is_not_empty).
     constexpr void pop_back()
@@ -424,6 +437,12 @@ namespace colt
     constexpr void push_back(traits::InPlaceT, Args&&... args)
       noexcept(std::is_nothrow_constructible_v<T, Args...>);    
 
+    /// @brief Pushes N copies of an object at the end of the Vector, reallocating at most once.
+    /// @param N The number of copies to push
+    /// @param to_copy The object to copy
+    constexpr void push_back_n(size_t N, traits::copy_if_trivial_t<const T&> to_copy)
+      noexcept(std::is_nothrow_copy_constructible_v<T>);
+
     /// @brief Pops an item from the back of the Vector.
     /// @pre is_not_empty() (colt_vector_is_not_empty).
     constexpr void pop_back()
@@ -709,6 +728,10 @@ namespace colt
   constexpr Vector<T>::Vector(size_t reserve) noexcept
     : blk(memory::allocate({ reserve * sizeof(T) })) {}
 
+  template<typename T>
+  constexpr Vector<T>::Vector(size_t reserve, traits::InScratchT) noexcept
+    : blk(memory::scratch_allocate({ reserve * sizeof(T) })) {}
+
   template<typename T>
   template<typename ...Args>
   constexpr Vector<T>::Vector(size_t fill_size, traits::InPlaceT, Args&&... args)
@@ -800,12 +823,15 @@ namespace colt
     noexcept(std::is_nothrow_move_constructible_v<T>
       && std::is_nothrow_destructible_v<T>)
   {
-    memory::TypedBlock<T> new_blk = memory::allocate({ blk.get_byte_size().size + by_more * sizeof(T) });
+    COLT_TRACE_BEGIN("Vector::reserve");
+    //Grows in the scratch allocator if the Vector was constructed with InScratch
+    memory::TypedBlock<T> new_blk = memory::allocate_like(blk, { blk.get_byte_size().size + by_more * sizeof(T) });
     
     algo::contiguous_destructive_move(blk.get_ptr(), new_blk.get_ptr(), size);
 
     memory::deallocate(blk);
     blk = new_blk;
+    COLT_TRACE_END("Vector::reserve");
   }
 
   template<typename T>
@@ -827,6 +853,18 @@ namespace colt
     blk.get_ptr()[size].~T();
   }
 
+  template<typename T>
+  constexpr void Vector<T>::push_back_n(size_t N, traits::copy_if_trivial_t<const T&> to_copy)
+    noexcept(std::is_nothrow_copy_constructible_v<T>)
+  {
+    //Grows geometrically so that repeated calls are amortized
+    if (size + N > blk.get_size())
+      reserve((size + N > blk.get_size() * 2 ? size + N : blk.get_size() * 2) - blk.get_size());
+    for (size_t i = 0; i < N; i++)
+      new(blk.get_ptr() + size + i) T(to_copy);
+    size += N;
+  }
+
   template<typename T>
   constexpr void Vector<T>::pop_back_n(size_t N)
     noexcept(std::is_nothrow_destructible_v<T>)
@@ -1056,6 +1094,19 @@ namespace colt
     get_current_ptr()[size].~T();
   }
 
+  template<typename T, size_t buff_count>
+  constexpr void SmallVector<T, buff_count>::push_back_n(size_t N, traits::copy_if_trivial_t<const T&> to_copy)
+    noexcept(std::is_nothrow_copy_constructible_v<T>)
+  {
+    //Grows geometrically so that repeated calls are amortized
+    if (size + N > capacity)
+      reserve((size + N > capacity * 2 ? size + N : capacity * 2) - capacity);
+    T* const ptr_d = get_current_ptr();
+    for (size_t i = 0; i < N; i++)
+      new(ptr_d + size + i) T(to_copy);
+    size += N;
+  }
+
   template<typename T, size_t buff_count>
   constexpr void SmallVector<T, buff_count>::pop_back_n(size_t N)
     noexcept(std::is_nothrow_destructible_v<T>)
@@ -1107,6 +1158,7 @@ namespace colt
     noexcept(std::is_nothrow_move_constructible_v<T>
       && std::is_nothrow_destructible_v<T>)
   {
+    COLT_TRACE_BEGIN("SmallVector::reserve");
     memory::TypedBlock<T> blk = memory::allocate({ sizeof(T) * (capacity + by_more) });
     T* const ptr_d = get_current_ptr();
     
@@ -1116,6 +1168,7 @@ namespace colt
       memory::deallocate({ ptr_d, capacity * sizeof(T) });
     capacity += by_more;
     ptr = blk.get_ptr();
+    COLT_TRACE_END("SmallVector::reserve");
   }
 
   template<typename T, size_t buff_count>
@@ -0,0 +1,180 @@
+/** @file alloc_profiler.h
+* Contains the sampling allocation profiler hooked in 'memory::allocate'.
+* The profiler is only compiled in if COLT_ALLOC_PROFILER is defined: else
+* COLT_ALLOC_PROFILER_RECORD expands to nothing.
+* Each thread counts down the bytes it allocates: when the count goes below 0,
+* the allocation is sampled (its size and its stack trace are recorded) and a new
+* count is drawn from an exponential distribution whose mean is the sample rate.
+* This is the sampling used by tcmalloc, which means the profiles can be unsampled
+* by pprof. The fast path is a thread local decrement, and sampling does not lock:
+* samples are written in a fixed array, and are dropped once it is full.
+* Only allocations are recorded (frees are not tracked), which makes the profile
+* an allocation profile (pprof's 'alloc_space') rather than a live heap profile.
+* To write the recorded samples, see 'utility/AllocProfiler.h'.
+*/
+
+#ifndef HG_COLT_ALLOC_PROFILER
+#define HG_COLT_ALLOC_PROFILER
+
+#include <atomic>
+#include <cmath>
+#include <chrono>
+
+#include "common.h"
+
+#if defined(__GLIBC__) || defined(__APPLE__)
+  #include <execinfo.h>
+  /// @brief Stack traces are captured through backtrace()
+  #define COLT_DETAILS_BACKTRACE_EXECINFO
+#elif defined(_WIN32)
+  extern "C" __declspec(dllimport) unsigned short __stdcall RtlCaptureStackBackTrace(
+    unsigned long, unsigned long, void**, unsigned long*);
+  /// @brief Stack traces are captured through RtlCaptureStackBackTrace()
+  #define COLT_DETAILS_BACKTRACE_WIN32
+#endif
+
+namespace colt
+{
+  namespace details
+  {
+    /// @brief A sampled allocation
+    struct AllocSample
+    {
+      /// @brief The maximum count of frames of a stack trace
+      static constexpr size_t MAX_DEPTH = 32;
+
+      /// @brief True once the sample was fully written
+      std::atomic<bool> is_ready;
+      /// @brief The count of frames in 'frames'
+      uint32_t depth;
+      /// @brief The size of the allocation
+      uint64_t size;
+      /// @brief The return addresses, from the innermost frame
+      void* frames[MAX_DEPTH];
+    };
+
+    /// @brief The samples recorded by all the threads
+    struct AllocProfile
+    {
+      /// @brief The maximum count of samples (power of 2)
+      static constexpr size_t CAPACITY = 1 << 13;
+
+      /// @brief The mean count of bytes between two samples
+      std::atomic<uint64_t> sample_rate;
+      /// @brief The count of samples ever reserved (can exceed CAPACITY)
+      std::atomic<uint64_t> reserve_index;
+      /// @brief The samples
+      AllocSample samples[CAPACITY];
+    };
+
+    /// @brief The state of the profiler of a single thread
+    struct ThreadAllocProfiler
+    {
+      /// @brief The bytes to allocate before the next sample
+      int64_t bytes_until_sample;
+      /// @brief The state of the random generator (xorshift64)
+      uint64_t random_state;
+      /// @brief True once the state was initialized
+      bool is_initialized;
+      /// @brief True while sampling (to avoid recursive sampling)
+      bool is_sampling;
+    };
+
+    /// @brief Returns the profile shared by all the threads
+    /// @return The profile
+    inline AllocProfile& get_alloc_profile() noexcept
+    {
+      //Constant initialized: no guard and no allocation
+      static AllocProfile profile = { { 512 * 1024 }, { 0 }, {} };
+      return profile;
+    }
+
+    /// @brief Returns the count of bytes between two samples drawn from an exponential distribution
+    /// @param state The state of the thread
+    /// @param rate The mean count of bytes between two samples
+    /// @return The count of bytes before the next sample
+    inline int64_t next_sample_interval(ThreadAllocProfiler& state, uint64_t rate) noexcept
+    {
+      state.random_state ^= state.random_state << 13;
+      state.random_state ^= state.random_state >> 7;
+      state.random_state ^= state.random_state << 17;
+      //Uniform in (0, 1]
+      const double uniform = static_cast<double>((state.random_state >> 11) + 1) * (1.0 / 9007199254740992.0);
+      return static_cast<int64_t>(-std::log(uniform) * static_cast<double>(rate)) + 1;
+    }
+
+#if defined(__GNUC__) || defined(__clang__)
+    __attribute__((noinline))
+#elif defined(_MSC_VER)
+    __declspec(noinline)
+#endif
+    /// @brief Records a sample of an allocation (slow path of 'profile_allocation')
+    /// @param state The state of the thread
+    /// @param size The size of the allocation
+    inline void sample_allocation(ThreadAllocProfiler& state, size_t size) noexcept
+    {
+      AllocProfile& profile = get_alloc_profile();
+      const uint64_t rate = profile.sample_rate.load(std::memory_order_relaxed);
+      if (!state.is_initialized)
+      {
+        //The first interval is drawn without sampling the first allocation
+        state.is_initialized = true;
+        state.random_state = reinterpret_cast<uintptr_t>(&state)
+          ^ static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+        state.random_state = state.random_state == 0 ? 88172645463325252ULL : state.random_state;
+        state.bytes_until_sample = next_sample_interval(state, rate) - static_cast<int64_t>(size);
+        if (state.bytes_until_sample >= 0)
+          return;
+      }
+      state.bytes_until_sample = next_sample_interval(state, rate);
+      //backtrace() can allocate through malloc, but never through the global allocator:
+      //this flag is only a safety net.
+      if (state.is_sampling)
+        return;
+      state.is_sampling = true;
+
+      const uint64_t index = profile.reserve_index.fetch_add(1, std::memory_order_relaxed);
+      if (index < AllocProfile::CAPACITY)
+      {
+        AllocSample& sample = profile.samples[index];
+        sample.size = size;
+        //The stack trace is captured directly in this (never inlined) function
+        //so that exactly one frame, the one of this function, is skipped.
+#if defined(COLT_DETAILS_BACKTRACE_EXECINFO)
+        void* frames[AllocSample::MAX_DEPTH + 1];
+        const int depth = backtrace(frames, static_cast<int>(AllocSample::MAX_DEPTH + 1));
+        sample.depth = depth <= 1 ? 0 : static_cast<uint32_t>(depth - 1);
+        for (uint32_t i = 0; i < sample.depth; i++)
+          sample.frames[i] = frames[i + 1];
+#elif defined(COLT_DETAILS_BACKTRACE_WIN32)
+        sample.depth = RtlCaptureStackBackTrace(1, AllocSample::MAX_DEPTH, sample.frames, nullptr);
+#else
+        sample.depth = 0;
+#endif
+        //Publishes the sample
+        sample.is_ready.store(true, std::memory_order_release);
+      }
+      state.is_sampling = false;
+    }
+
+    /// @brief Counts an allocation, sampling it if the thread allocated enough bytes
+    /// @param size The size of the allocation
+    inline void profile_allocation(size_t size) noexcept
+    {
+      thread_local ThreadAllocProfiler state = { 0, 0, false, false };
+      state.bytes_until_sample -= static_cast<int64_t>(size);
+      if (state.bytes_until_sample < 0)
+        sample_allocation(state, size);
+    }
+  }
+}
+
+#ifdef COLT_ALLOC_PROFILER
+  /// @brief Counts an allocation of 'SIZE' bytes in the allocation profiler
+  #define COLT_ALLOC_PROFILER_RECORD(SIZE) ::colt::details::profile_allocation(SIZE)
+#else
+  /// @brief Counts an allocation of 'SIZE' bytes in the allocation profiler
+  #define COLT_ALLOC_PROFILER_RECORD(SIZE) do { } while (0)
+#endif
+
+#endif //!HG_COLT_ALLOC_PROFILER
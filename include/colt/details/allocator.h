@@ -6,6 +6,9 @@
 * The allocate/deallocate and new_t/delete_t functions interact with the global allocator.
 * The global allocator is under a global lock, which means that allocate/deallocate are
 * thread safe.
+* While a ScratchScope is alive, scratch_allocate (used by the containers
+* constructed with the InScratch tag) allocates through a thread local
+* scratch allocator instead, which is freed at once when the scope ends.
 * Most allocators are taken from Andrei Alexandrescu's Memory Allocation talk:
 * https://www.youtube.com/watch?v=LIb3L4vKZ7U
 */
@@ -14,6 +17,13 @@
 #define HG_ALLOCATOR
 
 #include "common.h"
+#include "trace.h"
+#include "alloc_profiler.h"
+
+#ifndef COLT_SCRATCH_STACK_SIZE
+  /// @brief The size of the stack of the thread local scratch allocator (see ScratchScope)
+  #define COLT_SCRATCH_STACK_SIZE 16384
+#endif
 
 namespace colt
 {
@@ -199,7 +209,7 @@ namespace colt
     class StackAllocator
     {
       /// @brief Stack Buffer used for allocation
-      char buffer[size];
+      alignas(std::max_align_t) char buffer[size];
       /// @brief Pointer to where to allocate next
       char* top = buffer;
 
@@ -218,6 +228,18 @@ namespace colt
       /// @return True if 'blk' was allocated through the current allocator
       bool owns(MemBlock blk) noexcept;
 
+      /// @brief Returns the current top of the stack, to pass to 'rewind'
+      /// @return The top of the stack
+      char* get_top() const noexcept { return top; }
+
+      /// @brief Frees all the blocks allocated after 'get_top' returned 'marker'
+      /// @param marker The top to restore
+      void rewind(char* marker) noexcept
+      {
+        assert(buffer <= marker && marker <= top && "Invalid marker!");
+        top = marker;
+      }
+
     private:
       /// @brief Round a size to the nearest aligned memory address
       /// @param sz The size to align
@@ -262,17 +284,17 @@ namespace colt
       /// @return Allocated MemBlock or an empty MemBlock on failure
       MemBlock allocate(sizes::ByteSize n) noexcept
       {
+        if (!is_in_range(n.size))
+          return allocator::allocate(n);
         if (root != nullptr)
         {
-          if (is_in_range(n.size))
-          {
-            //Return the currently stored node
-            MemBlock blk = { root, n.size };
-            root = root->next;
-            return blk;
-          }
+          //Return the currently stored node
+          MemBlock blk = { root, n.size };
+          root = root->next;
+          return blk;
         }
-        return allocator::allocate(n);
+        //Nodes are reused for any size in range: allocate the upper bound
+        return { allocator::allocate({ range_upper }).get_ptr(), n.size };
       }
 
       /// @brief Deallocates a MemBlock that was allocated using the current allocator
@@ -303,6 +325,248 @@ namespace colt
       }
     };
 
+    template<typename allocator, size_t range_lower, size_t range_upper, size_t max_count = 1024>
+    /// @brief Thread safe FreeList that does not lock (Treiber stack).
+    /// The head of the list is a pointer tagged with a counter incremented on each
+    /// update, which protects the compare-and-swap against the ABA problem.
+    /// The tag uses the 16 high bits of the pointer, which must be 0 (true of
+    /// user space addresses on x86-64 and AArch64 without 5-level paging).
+    /// At most 'max_count' blocks are kept: the others are freed through 'allocator',
+    /// which must itself be thread safe (as Mallocator).
+    /// A popping thread can read the next pointer of a block that was just popped by another:
+    /// 'allocator' must not unmap memory freed through it (sizes handled by malloc without mmap).
+    /// Batch allocations take the whole list at once: other threads see an empty list
+    /// (and allocate through 'allocator') until the unused blocks are pushed back.
+    class AtomicFreeList
+      : private allocator
+    {
+      static_assert(traits::is_allocator_v<allocator>, "'allocator' should be an allocator!");
+      static_assert(range_lower >= 8, "Lower bound of range should be greater or equal to 8!");
+      static_assert(sizeof(void*) == 8, "AtomicFreeList requires 64-bit pointers!");
+
+      /// @brief A Node contains a pointer to the next Node
+      struct Node
+      {
+        /// @brief The next node (atomic as it can be read while popped by another thread)
+        std::atomic<Node*> next;
+      };
+
+      /// @brief The count of bits of the pointer of a tagged head
+      static constexpr unsigned POINTER_BITS = 48;
+      /// @brief The mask of the pointer of a tagged head
+      static constexpr uint64_t POINTER_MASK = (uint64_t(1) << POINTER_BITS) - 1;
+
+      /// @brief The tagged head of the list
+      std::atomic<uint64_t> head = 0;
+      /// @brief The count of blocks in the list (can be briefly greater than the real count)
+      std::atomic<size_t> count = 0;
+
+      /// @brief Check if a size is in range
+      /// @param n The size to check
+      /// @return True if range_lower <= n && n <= range_upper
+      static bool is_in_range(size_t n) noexcept { return range_lower <= n && n <= range_upper; }
+
+      /// @brief Returns the node of a tagged head
+      /// @param tagged The tagged head
+      /// @return The node (or nullptr)
+      static Node* get_node(uint64_t tagged) noexcept { return reinterpret_cast<Node*>(static_cast<uintptr_t>(tagged & POINTER_MASK)); }
+
+      /// @brief Returns the new tagged head pointing to 'node'
+      /// @param node The new first node
+      /// @param old The tagged head being replaced
+      /// @return The tagged head
+      static uint64_t make_tagged(Node* node, uint64_t old) noexcept
+      {
+        assert((reinterpret_cast<uintptr_t>(node) & ~POINTER_MASK) == 0 && "Pointer does not fit in 48 bits!");
+        return reinterpret_cast<uintptr_t>(node) | ((old & ~POINTER_MASK) + (uint64_t(1) << POINTER_BITS));
+      }
+
+      /// @brief Reserves places for up to 'n' blocks in the list
+      /// @param n The count of places to reserve
+      /// @return The count of places reserved
+      size_t reserve_places(size_t n) noexcept
+      {
+        const size_t old = count.fetch_add(n, std::memory_order_relaxed);
+        const size_t accepted = old >= max_count ? 0 : (max_count - old < n ? max_count - old : n);
+        if (accepted != n)
+          count.fetch_sub(n - accepted, std::memory_order_relaxed);
+        return accepted;
+      }
+
+      /// @brief Pushes the chain of nodes 'first' -> ... -> 'last'
+      /// @param first The first node of the chain
+      /// @param last The last node of the chain
+      void push_chain(Node* first, Node* last) noexcept
+      {
+        uint64_t old = head.load(std::memory_order_relaxed);
+        do
+          last->next.store(get_node(old), std::memory_order_relaxed);
+        while (!head.compare_exchange_weak(old, make_tagged(first, old),
+          std::memory_order_release, std::memory_order_relaxed));
+      }
+
+      /// @brief Pops the first node.
+      /// The next pointer of the first node is read before the compare-and-swap:
+      /// the node may have been popped and overwritten by another thread, in which
+      /// case the tag changed and the value read is discarded (it is never dereferenced).
+      /// @return The node popped (or nullptr if the list is empty)
+      Node* pop_one() noexcept
+      {
+        uint64_t old = head.load(std::memory_order_acquire);
+        for (;;)
+        {
+          Node* node = get_node(old);
+          if (node == nullptr)
+            return nullptr;
+          Node* next = node->next.load(std::memory_order_relaxed);
+          if (head.compare_exchange_weak(old, make_tagged(next, old),
+            std::memory_order_acquire, std::memory_order_acquire))
+          {
+            count.fetch_sub(1, std::memory_order_relaxed);
+            return node;
+          }
+        }
+      }
+
+      /// @brief Pops up to 'n' nodes, written to 'out'.
+      /// Walking several nodes of the shared list is not safe: a node popped by another
+      /// thread may be overwritten, and following its next pointer reads a garbage address.
+      /// The whole list is taken instead (the head is swapped with an empty list), walked
+      /// while no other thread can access it, then its unused nodes are pushed back.
+      /// @param out The array to which to write the nodes
+      /// @param n The maximum count of nodes to pop
+      /// @return The count of nodes popped
+      size_t pop_chain(Node** out, size_t n) noexcept
+      {
+        uint64_t old = head.load(std::memory_order_acquire);
+        do
+        {
+          if (get_node(old) == nullptr)
+            return 0;
+        } while (!head.compare_exchange_weak(old, make_tagged(nullptr, old),
+          std::memory_order_acquire, std::memory_order_acquire));
+
+        size_t popped = 0;
+        Node* node = get_node(old);
+        while (node != nullptr && popped != n)
+        {
+          out[popped++] = node;
+          node = node->next.load(std::memory_order_relaxed);
+        }
+        count.fetch_sub(popped, std::memory_order_relaxed);
+        if (node != nullptr)
+        {
+          Node* last = node;
+          for (Node* next = last->next.load(std::memory_order_relaxed); next != nullptr;
+            next = next->next.load(std::memory_order_relaxed))
+            last = next;
+          push_chain(node, last);
+        }
+        return popped;
+      }
+
+    public:
+      /// @brief Constructs an empty AtomicFreeList
+      AtomicFreeList() noexcept = default;
+      AtomicFreeList(const AtomicFreeList&) = delete;
+      AtomicFreeList& operator=(const AtomicFreeList&) = delete;
+
+      /// @brief Allocates a MemBlock
+      /// @param n The size of the allocation
+      /// @return Allocated MemBlock or an empty MemBlock on failure
+      MemBlock allocate(sizes::ByteSize n) noexcept
+      {
+        if (!is_in_range(n.size))
+          return allocator::allocate(n);
+        if (Node* node = pop_one())
+          return { node, n.size };
+        //Nodes are reused for any size in range: allocate the upper bound
+        return { allocator::allocate({ range_upper }).get_ptr(), n.size };
+      }
+
+      /// @brief Allocates 'n' MemBlock of the same size, popping them from the list at once
+      /// @param size The size of each allocation (in range)
+      /// @param out The array of size 'n' to which to write the blocks
+      /// @param n The count of blocks to allocate
+      /// @return The count of blocks allocated (less than 'n' only on failure)
+      size_t allocate_batch(sizes::ByteSize size, MemBlock* out, size_t n) noexcept
+      {
+        assert(is_in_range(size.size) && "Size is not in range!");
+        size_t allocated = 0;
+        Node* nodes[64];
+        while (allocated != n)
+        {
+          const size_t popped = pop_chain(nodes, n - allocated < 64 ? n - allocated : 64);
+          if (popped == 0)
+            break;
+          for (size_t i = 0; i < popped; i++)
+            out[allocated++] = { nodes[i], size.size };
+        }
+        for (; allocated != n; allocated++)
+        {
+          MemBlock blk = allocator::allocate({ range_upper });
+          if (!blk)
+            break;
+          out[allocated] = { blk.get_ptr(), size.size };
+        }
+        return allocated;
+      }
+
+      /// @brief Deallocates a MemBlock that was allocated using the current allocator
+      /// @param blk The block whose resources to free
+      void deallocate(MemBlock blk) noexcept
+      {
+        if (!is_in_range(blk.get_byte_size().size) || reserve_places(1) == 0)
+        {
+          allocator::deallocate({ blk.get_ptr(),
+            is_in_range(blk.get_byte_size().size) ? range_upper : blk.get_byte_size().size });
+          return;
+        }
+        auto node = reinterpret_cast<Node*>(blk.get_ptr());
+        push_chain(node, node);
+      }
+
+      /// @brief Deallocates 'n' MemBlock (in range), pushing them on the list at once
+      /// @param blocks The blocks to deallocate
+      /// @param n The count of blocks
+      void deallocate_batch(MemBlock* blocks, size_t n) noexcept
+      {
+        const size_t accepted = reserve_places(n);
+        for (size_t i = accepted; i < n; i++)
+          allocator::deallocate({ blocks[i].get_ptr(), range_upper });
+        if (accepted == 0)
+          return;
+
+        //Link the nodes, then publish them with a single compare-and-swap
+        auto first = reinterpret_cast<Node*>(blocks[0].get_ptr());
+        Node* last = first;
+        for (size_t i = 1; i < accepted; i++)
+        {
+          assert(is_in_range(blocks[i].get_byte_size().size) && "Size is not in range!");
+          auto node = reinterpret_cast<Node*>(blocks[i].get_ptr());
+          last->next.store(node, std::memory_order_relaxed);
+          last = node;
+        }
+        push_chain(first, last);
+      }
+
+      /// @brief Returns the count of blocks in the list
+      /// @return The approximate count of blocks
+      size_t get_count() const noexcept { return count.load(std::memory_order_relaxed); }
+
+      /// @brief Returns all the block owned by the AtomicFreeList to the underlying allocator
+      ~AtomicFreeList() noexcept
+      {
+        Node* node = get_node(head.load(std::memory_order_acquire));
+        while (node != nullptr)
+        {
+          Node* next = node->next.load(std::memory_order_relaxed);
+          allocator::deallocate({ node, range_upper });
+          node = next;
+        }
+      }
+    };
+
     template<typename allocator>
     /// @brief Adds thread safety to any allocator using a mutex
     class ThreadSafeAllocator
@@ -356,11 +620,18 @@ namespace colt
     template<size_t size, typename Primary, typename Secondary>
     /// @brief For all allocation sizes <= size, allocates through Primary, else through Secondary
     class Segregator
-      : private Primary, private Secondary
     {
       static_assert(traits::is_allocator_v<Primary>, "'Primary' should be an owning allocator!");
       static_assert(traits::is_allocator_v<Secondary>, "'Secondary' should be an allocator!");
 
+      //Members rather than bases: Primary can itself derive from Secondary
+      //(as FallbackAllocator<..., Mallocator> and Mallocator), which would make it ambiguous.
+
+      /// @brief The allocator used for sizes <= size
+      Primary primary;
+      /// @brief The allocator used for sizes > size
+      Secondary secondary;
+
     public:
       /// @brief Allocates a MemBlock
       /// @param size The size of the allocation
@@ -377,6 +648,111 @@ namespace colt
       bool owns(MemBlock blk) noexcept;
     };
 
+    template<typename allocator, size_t... classes>
+    /// @brief Allocator that rounds sizes up to a size class, and keeps a free list per class.
+    /// The class of a size is found through a lookup table, without branching on each class.
+    /// Empty free lists are refilled by batches of blocks carved from slabs allocated
+    /// through 'allocator', which are only returned to it on destruction.
+    /// The slabs are kept sorted by address, so that 'owns' is a binary search.
+    /// Sizes greater than the greatest class are allocated through 'allocator' directly.
+    /// Classes that are multiples of 16 keep the alignment of std::max_align_t.
+    /// @tparam allocator The allocator of the slabs and of the bigger sizes
+    /// @tparam classes The size classes (increasing, multiples of 8)
+    class BucketAllocator
+      : private allocator
+    {
+      static_assert(traits::is_allocator_v<allocator>, "'allocator' should be an allocator!");
+      static_assert(sizeof...(classes) != 0 && sizeof...(classes) <= 255, "Invalid count of size classes!");
+
+      /// @brief The count of size classes
+      static constexpr size_t CLASS_COUNT = sizeof...(classes);
+      /// @brief The size classes
+      static constexpr size_t CLASS_SIZES[CLASS_COUNT] = { classes... };
+      /// @brief The greatest size class
+      static constexpr size_t MAX_CLASS = CLASS_SIZES[CLASS_COUNT - 1];
+      /// @brief The granularity of the lookup table
+      static constexpr size_t GRANULE = 8;
+      /// @brief The size of each slab
+      static constexpr size_t SLAB_SIZE = MAX_CLASS * 64 > 65536 ? MAX_CLASS * 64 : 65536;
+      /// @brief The count of bytes carved from a slab to refill a free list
+      static constexpr size_t REFILL_BYTES = 4096;
+
+      /// @brief Check if the size classes are increasing multiples of GRANULE
+      /// @return True if the size classes are valid
+      static constexpr bool are_classes_valid() noexcept;
+      static_assert(are_classes_valid(), "Size classes should be increasing multiples of 8!");
+
+      /// @brief Creates the table mapping (size + 7) / 8 to the index of its class
+      /// @return The lookup table
+      static constexpr std::array<uint8_t, MAX_CLASS / GRANULE + 1> make_class_table() noexcept;
+
+      /// @brief A Node contains a pointer to the next Node
+      struct Node
+      {
+        Node* next;
+      };
+
+      /// @brief The free list of each class
+      Node* free_lists[CLASS_COUNT] = {};
+      /// @brief The slabs, sorted by address
+      char** slabs = nullptr;
+      /// @brief The count of slabs
+      size_t slab_count = 0;
+      /// @brief The capacity of 'slabs'
+      size_t slab_capacity = 0;
+      /// @brief Where to carve blocks next in the current slab
+      char* slab_top = nullptr;
+      /// @brief The end of the current slab
+      char* slab_end = nullptr;
+
+      /// @brief Refills the free list of a class from the current slab
+      /// @param index The index of the class
+      /// @return False if a slab could not be allocated
+      bool refill(size_t index) noexcept;
+
+      /// @brief Returns the index of the first slab that begins after 'ptr'
+      /// @param ptr The pointer to search for
+      /// @return The index of the first slab greater than 'ptr' (or 'slab_count')
+      size_t upper_bound_slab(const char* ptr) const noexcept;
+
+      /// @brief Allocates a new slab and inserts it in 'slabs'
+      /// @return The new slab or nullptr on failure
+      char* new_slab() noexcept;
+
+    public:
+      /// @brief Returns the index of the class of a size
+      /// @param size The size (<= the greatest class)
+      /// @return The index of the class
+      static size_t get_class_index(size_t size) noexcept
+      {
+        static constexpr auto CLASS_TABLE = make_class_table();
+        assert(size <= MAX_CLASS && "Size is not handled by a class!");
+        return CLASS_TABLE[(size + GRANULE - 1) / GRANULE];
+      }
+
+      /// @brief Constructs a BucketAllocator without any slab
+      BucketAllocator() noexcept = default;
+      BucketAllocator(const BucketAllocator&) = delete;
+      BucketAllocator& operator=(const BucketAllocator&) = delete;
+      /// @brief Returns all the slabs to the underlying allocator
+      ~BucketAllocator() noexcept;
+
+      /// @brief Allocates a MemBlock
+      /// @param size The size of the allocation
+      /// @return Allocated MemBlock or an empty MemBlock on failure
+      MemBlock allocate(sizes::ByteSize size) noexcept;
+
+      /// @brief Deallocates a MemBlock that was allocated using the current allocator
+      /// @param to_free The block whose resources to free
+      void deallocate(MemBlock to_free) noexcept;
+
+      /// @brief Check if a slab of the current allocator contains 'blk'.
+      /// Blocks greater than the greatest class are not owned.
+      /// @param blk The MemBlock to check
+      /// @return True if 'blk' was allocated in a slab
+      bool owns(MemBlock blk) noexcept;
+    };
+
     template<typename allocator, size_t register_size = 5>
     class AbortOnNULLAllocator
       : private allocator
@@ -430,13 +806,107 @@ namespace colt
       bool owns(MemBlock blk) noexcept { return allocator::owns(blk); };
     };
 
+    template<size_t stack_size, typename allocator = Mallocator>
+    /// @brief Allocator that bumps a pointer through a StackAllocator, then through
+    /// chunks obtained from 'allocator' when the stack is full.
+    /// Blocks are only freed in LIFO order or all at once through 'rewind'.
+    /// The last chunk freed by 'rewind' is kept to avoid reallocating it.
+    class ScratchAllocator
+      : private allocator
+    {
+      static_assert(traits::is_allocator_v<allocator>, "'allocator' should be an allocator!");
+
+      /// @brief Header of a chunk, followed by its memory
+      struct alignas(std::max_align_t) Chunk
+      {
+        /// @brief The previously allocated chunk
+        Chunk* previous;
+        /// @brief Pointer to where to allocate next
+        char* top;
+        /// @brief The end of the memory of the chunk
+        char* end;
+        /// @brief The size of the chunk (header included)
+        size_t chunk_size;
+
+        /// @brief Returns the beginning of the memory of the chunk
+        /// @return Pointer to the first byte after the header
+        char* begin() noexcept { return reinterpret_cast<char*>(this + 1); }
+      };
+
+      /// @brief The minimum size of a chunk
+      static constexpr size_t MIN_CHUNK_SIZE = 64 * 1024;
+
+      /// @brief The stack, used before any chunk
+      StackAllocator<stack_size> stack;
+      /// @brief The chunk in which to allocate (or nullptr)
+      Chunk* current = nullptr;
+      /// @brief The last chunk freed by 'rewind' (or nullptr)
+      Chunk* spare = nullptr;
+
+    public:
+      /// @brief The state of the allocator, to which it can be rewound
+      struct Marker
+      {
+        /// @brief The top of the stack
+        char* stack_top;
+        /// @brief The current chunk
+        Chunk* chunk;
+        /// @brief The top of the current chunk
+        char* chunk_top;
+      };
+
+      /// @brief Constructs an empty ScratchAllocator
+      ScratchAllocator() noexcept = default;
+      ScratchAllocator(const ScratchAllocator&) = delete;
+      ScratchAllocator& operator=(const ScratchAllocator&) = delete;
+      /// @brief Frees all the chunks
+      ~ScratchAllocator() noexcept;
+
+      /// @brief Allocates a MemBlock
+      /// @param size The size of the allocation
+      /// @return Allocated MemBlock or an empty MemBlock on failure
+      MemBlock allocate(sizes::ByteSize size) noexcept;
+
+      /// @brief Deallocates a MemBlock, which only frees memory if it is the last allocated block
+      /// @param to_free The block whose resources to free
+      void deallocate(MemBlock to_free) noexcept;
+
+      /// @brief Check if the current allocator owns 'blk'
+      /// @param blk The MemBlock to check
+      /// @return True if 'blk' was allocated through the current allocator
+      bool owns(MemBlock blk) noexcept;
+
+      /// @brief Check if 'blk' was allocated through the current allocator after 'marker'
+      /// @param marker The marker returned by 'get_marker'
+      /// @param blk The MemBlock to check
+      /// @return True if 'blk' is owned and would be freed by 'rewind(marker)'
+      bool owns_since(const Marker& marker, MemBlock blk) noexcept;
+
+      /// @brief Returns the current state, to pass to 'rewind'
+      /// @return The marker
+      Marker get_marker() const noexcept { return { stack.get_top(), current, current ? current->top : nullptr }; }
+
+      /// @brief Frees all the blocks allocated after 'get_marker' returned 'marker'
+      /// @param marker The marker to restore
+      void rewind(const Marker& marker) noexcept;
+
+    private:
+      /// @brief Round a size to the nearest aligned memory address
+      /// @param sz The size to align
+      /// @return Aligned size
+      static size_t align_up(size_t sz) noexcept
+      {
+        return (sz + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+      }
+    };
+
     /************* PREDEFINED ALLOCATORS *************/
 
-    /// @brief Allocator best suited for object of size smaller then 512
+    /// @brief Allocator best suited for object of size smaller then 512.
+    /// Sizes up to 512 are rounded to a size class, bigger sizes use malloc.
     using SmallAllocator_t =
-      Segregator<256,
-        FallbackAllocator<StackAllocator<8192>, Mallocator>,
-        Mallocator
+      BucketAllocator<Mallocator,
+        16, 32, 48, 64, 96, 128, 192, 256, 384, 512
       >;
 
     /// @brief Global allocator type.
@@ -452,10 +922,41 @@ namespace colt
     
     /************* GLOBAL ALLOCATOR *************/
     
+    /// @brief Thread local scratch allocator type, used in ScratchScope.
+    /// Its stack size can be changed by defining COLT_SCRATCH_STACK_SIZE.
+    using ScratchAllocator_t = ScratchAllocator<COLT_SCRATCH_STACK_SIZE>;
+
     namespace details
     {
       /// @brief Global allocator
       inline GlobalAllocator_t global_allocator;
+
+      /// @brief Returns the marker of the innermost ScratchScope of the current thread
+      /// @return Reference to the marker (or nullptr if there is no active scope)
+      inline const ScratchAllocator_t::Marker*& get_scratch_marker() noexcept
+      {
+        //Constant initialized: no guard on the hot path of 'deallocate'
+        thread_local const ScratchAllocator_t::Marker* marker = nullptr;
+        return marker;
+      }
+
+      /// @brief Returns the scratch allocator of the current thread if it was ever used
+      /// @return Reference to the scratch allocator (or nullptr)
+      inline ScratchAllocator_t*& get_thread_scratch_if_used() noexcept
+      {
+        //Constant initialized: no guard on the hot path of 'deallocate'
+        thread_local ScratchAllocator_t* scratch = nullptr;
+        return scratch;
+      }
+
+      /// @brief Returns the scratch allocator of the current thread
+      /// @return The scratch allocator
+      inline ScratchAllocator_t& get_thread_scratch() noexcept
+      {
+        thread_local ScratchAllocator_t scratch;
+        get_thread_scratch_if_used() = &scratch;
+        return scratch;
+      }
     }
 
     [[nodiscard]]
@@ -464,17 +965,93 @@ namespace colt
     /// @return The non-null memory block    
     inline MemBlock allocate(sizes::ByteSize size) noexcept
     {
+      COLT_TRACE_SCOPE("memory::allocate");
       assert(size.size != 0 && "Cannot allocate 0 bytes!");
+      COLT_ALLOC_PROFILER_RECORD(size.size);
       return details::global_allocator.allocate(size);
     }
 
-    /// @brief Deallocates a block of memory that was obtained through the global allocator
+    [[nodiscard]]
+    /// @brief Allocates a block of memory through the scratch allocator of the
+    /// current thread, which is freed when the innermost ScratchScope ends.
+    /// If no ScratchScope is active, allocates through the global allocator.
+    /// @param size The size of the block
+    /// @return The non-null memory block
+    inline MemBlock scratch_allocate(sizes::ByteSize size) noexcept
+    {
+      assert(size.size != 0 && "Cannot allocate 0 bytes!");
+      if (details::get_scratch_marker() != nullptr)
+      {
+        if (MemBlock blk = details::get_thread_scratch().allocate(size))
+          return blk;
+      }
+      return allocate(size);
+    }
+
+    [[nodiscard]]
+    /// @brief Allocates a block of memory to replace 'blk' (to grow a container).
+    /// The block is allocated through the scratch allocator if 'blk' was allocated
+    /// in the innermost ScratchScope, and through the global allocator else:
+    /// a container never grows into a scope that ends before it is destroyed.
+    /// @param blk The block to replace (can be empty)
+    /// @param size The size of the new block
+    /// @return The non-null memory block
+    inline MemBlock allocate_like(MemBlock blk, sizes::ByteSize size) noexcept
+    {
+      const auto marker = details::get_scratch_marker();
+      if (marker != nullptr && details::get_thread_scratch().owns_since(*marker, blk))
+        return scratch_allocate(size);
+      return allocate(size);
+    }
+
+    /// @brief Deallocates a block of memory that was obtained through 'allocate',
+    /// 'scratch_allocate' or 'allocate_like' on the current thread
     /// @param blk The block to deallocate
     inline void deallocate(MemBlock blk) noexcept
     {
+      COLT_TRACE_SCOPE("memory::deallocate");
+      if (auto scratch = details::get_thread_scratch_if_used(); scratch != nullptr && scratch->owns(blk))
+        return scratch->deallocate(blk);
       if (blk.get_ptr())
         details::global_allocator.deallocate(blk);
     }
+
+    /// @brief RAII helper providing the memory of 'scratch_allocate' on the current thread.
+    /// The containers constructed with the InScratch tag while the scope is alive
+    /// allocate (and grow) through the scratch allocator of the thread, which costs
+    /// a pointer bump, and all their memory is freed when the scope is destroyed.
+    /// Other containers are not affected: a container created before the scope
+    /// (or in an enclosing scope) that grows in it keeps using the memory of its
+    /// own scope or of the global allocator. Scopes can be nested.
+    /// As the memory is released by the destructor, the containers constructed in
+    /// the scope with InScratch must be destroyed before it and on the same thread.
+    class ScratchScope
+    {
+      /// @brief The state of the scratch allocator on construction
+      ScratchAllocator_t::Marker marker;
+      /// @brief The marker of the enclosing scope (or nullptr)
+      const ScratchAllocator_t::Marker* previous;
+
+    public:
+      /// @brief Records the state of the scratch allocator and makes the scope the innermost one
+      ScratchScope() noexcept
+        : marker(details::get_thread_scratch().get_marker()),
+        previous(details::get_scratch_marker())
+      {
+        details::get_scratch_marker() = &marker;
+      }
+
+      ScratchScope(const ScratchScope&) = delete;
+      ScratchScope& operator=(const ScratchScope&) = delete;
+
+      /// @brief Frees all the blocks allocated in the scope
+      ~ScratchScope() noexcept
+      {
+        assert(details::get_scratch_marker() == &marker && "ScratchScope must be destroyed in LIFO order!");
+        details::get_scratch_marker() = previous;
+        details::get_thread_scratch().rewind(marker);
+      }
+    };
     
     /// @brief Register a null callback for the global allocator.
     /// As the global allocator will exit instead of returning a nullptr,
@@ -673,29 +1250,292 @@ namespace colt
       return top == buffer;
     }
 
+    /************* SCRATCH ALLOCATOR *************/
+
+    template<size_t stack_size, typename allocator>
+    ScratchAllocator<stack_size, allocator>::~ScratchAllocator() noexcept
+    {
+      rewind({ stack.get_top(), nullptr, nullptr });
+      if (spare)
+        allocator::deallocate({ spare, spare->chunk_size });
+    }
+
+    template<size_t stack_size, typename allocator>
+    MemBlock ScratchAllocator<stack_size, allocator>::allocate(sizes::ByteSize size) noexcept
+    {
+      if (current == nullptr)
+      {
+        if (MemBlock blk = stack.allocate(size))
+          return blk;
+      }
+      
+      const size_t aligned_size = align_up(size.size);
+      if (current == nullptr || static_cast<size_t>(current->end - current->top) < aligned_size)
+      {
+        //Grow geometrically, so that the count of chunks stays small
+        size_t chunk_size = current ? current->chunk_size * 2 : MIN_CHUNK_SIZE;
+        if (chunk_size < aligned_size + sizeof(Chunk))
+          chunk_size = aligned_size + sizeof(Chunk);
+
+        Chunk* chunk;
+        if (spare != nullptr && spare->chunk_size >= chunk_size)
+        {
+          chunk = spare;
+          spare = nullptr;
+        }
+        else
+        {
+          MemBlock blk = allocator::allocate({ chunk_size });
+          if (!blk)
+            return { nullptr, size.size };
+          chunk = static_cast<Chunk*>(blk.get_ptr());
+          chunk->chunk_size = chunk_size;
+          chunk->end = reinterpret_cast<char*>(chunk) + chunk_size;
+        }
+        chunk->previous = current;
+        chunk->top = chunk->begin();
+        current = chunk;
+      }
+      char* ptr = current->top;
+      current->top += aligned_size;
+      return { ptr, size.size };
+    }
+
+    template<size_t stack_size, typename allocator>
+    void ScratchAllocator<stack_size, allocator>::deallocate(MemBlock to_free) noexcept
+    {
+      assert(owns(to_free) && "Block was not owned by the allocator!");
+      if (stack.owns(to_free))
+      {
+        stack.deallocate(to_free);
+        return;
+      }
+      const size_t aligned_size = align_up(to_free.get_byte_size().size);
+      if (current != nullptr && static_cast<char*>(to_free.get_ptr()) + aligned_size == current->top)
+        current->top -= aligned_size;
+    }
+
+    template<size_t stack_size, typename allocator>
+    bool ScratchAllocator<stack_size, allocator>::owns(MemBlock blk) noexcept
+    {
+      if (stack.owns(blk))
+        return true;
+      char* ptr = static_cast<char*>(blk.get_ptr());
+      for (Chunk* chunk = current; chunk != nullptr; chunk = chunk->previous)
+        if (chunk->begin() <= ptr && ptr < chunk->top)
+          return true;
+      return false;
+    }
+
+    template<size_t stack_size, typename allocator>
+    bool ScratchAllocator<stack_size, allocator>::owns_since(const Marker& marker, MemBlock blk) noexcept
+    {
+      char* ptr = static_cast<char*>(blk.get_ptr());
+      //The stack is only used while there are no chunks
+      if (stack.owns(blk))
+        return ptr >= marker.stack_top;
+      for (Chunk* chunk = current; chunk != nullptr; chunk = chunk->previous)
+      {
+        if (chunk->begin() <= ptr && ptr < chunk->top)
+          return chunk != marker.chunk || ptr >= marker.chunk_top;
+        if (chunk == marker.chunk)
+          return false;
+      }
+      return false;
+    }
+
+    template<size_t stack_size, typename allocator>
+    void ScratchAllocator<stack_size, allocator>::rewind(const Marker& marker) noexcept
+    {
+      while (current != marker.chunk)
+      {
+        assert(current != nullptr && "Invalid marker!");
+        Chunk* previous = current->previous;
+        //Keep the biggest chunk as spare
+        if (spare == nullptr)
+          spare = current;
+        else if (spare->chunk_size < current->chunk_size)
+        {
+          allocator::deallocate({ spare, spare->chunk_size });
+          spare = current;
+        }
+        else
+          allocator::deallocate({ current, current->chunk_size });
+        current = previous;
+      }
+      if (current != nullptr)
+        current->top = marker.chunk_top;
+      stack.rewind(marker.stack_top);
+    }
+
     /************* SEGREGATOR ALLOCATOR *************/
 
     template<size_t size, typename Primary, typename Secondary>
     MemBlock Segregator<size, Primary, Secondary>::allocate(sizes::ByteSize sze) noexcept
     {
       if (sze.size <= size)
-        return Primary::allocate(sze);
-      return Secondary::allocate(sze);
+        return primary.allocate(sze);
+      return secondary.allocate(sze);
     }
 
     template<size_t size, typename Primary, typename Secondary>
     void Segregator<size, Primary, Secondary>::deallocate(MemBlock to_free) noexcept
     {
       if (to_free.get_byte_size().size <= size)
-        Primary::deallocate(to_free);
+        primary.deallocate(to_free);
       else
-        Secondary::deallocate(to_free);
+        secondary.deallocate(to_free);
     }
 
     template<size_t size, typename Primary, typename Secondary>
     bool Segregator<size, Primary, Secondary>::owns(MemBlock blk) noexcept
     {
-      return Primary::owns(blk) || Secondary::owns(blk);
+      return primary.owns(blk) || secondary.owns(blk);
+    }
+
+    /************* BUCKET ALLOCATOR *************/
+
+    template<typename allocator, size_t... classes>
+    constexpr bool BucketAllocator<allocator, classes...>::are_classes_valid() noexcept
+    {
+      size_t previous = 0;
+      for (size_t i = 0; i < CLASS_COUNT; i++)
+      {
+        if (CLASS_SIZES[i] <= previous || CLASS_SIZES[i] % GRANULE != 0)
+          return false;
+        previous = CLASS_SIZES[i];
+      }
+      return true;
+    }
+
+    template<typename allocator, size_t... classes>
+    constexpr std::array<uint8_t, BucketAllocator<allocator, classes...>::MAX_CLASS / BucketAllocator<allocator, classes...>::GRANULE + 1>
+      BucketAllocator<allocator, classes...>::make_class_table() noexcept
+    {
+      std::array<uint8_t, MAX_CLASS / GRANULE + 1> table = {};
+      size_t class_index = 0;
+      for (size_t i = 0; i < table.size(); i++)
+      {
+        //Smallest class that can hold 'i * GRANULE' bytes
+        while (CLASS_SIZES[class_index] < i * GRANULE)
+          ++class_index;
+        table[i] = static_cast<uint8_t>(class_index);
+      }
+      return table;
+    }
+
+    template<typename allocator, size_t... classes>
+    MemBlock BucketAllocator<allocator, classes...>::allocate(sizes::ByteSize size) noexcept
+    {
+      if (size.size > MAX_CLASS)
+        return allocator::allocate(size);
+      const size_t index = get_class_index(size.size);
+      if (free_lists[index] == nullptr && !refill(index))
+        return { nullptr, size.size };
+      Node* node = free_lists[index];
+      free_lists[index] = node->next;
+      return { node, size.size };
+    }
+
+    template<typename allocator, size_t... classes>
+    void BucketAllocator<allocator, classes...>::deallocate(MemBlock to_free) noexcept
+    {
+      if (to_free.get_byte_size().size > MAX_CLASS)
+        return allocator::deallocate(to_free);
+      assert(owns(to_free) && "Block was not owned by the allocator!");
+      const size_t index = get_class_index(to_free.get_byte_size().size);
+      auto node = reinterpret_cast<Node*>(to_free.get_ptr());
+      node->next = free_lists[index];
+      free_lists[index] = node;
+    }
+
+    template<typename allocator, size_t... classes>
+    bool BucketAllocator<allocator, classes...>::owns(MemBlock blk) noexcept
+    {
+      auto ptr = static_cast<const char*>(blk.get_ptr());
+      //The only slab that can contain 'ptr' is the last one that begins before it
+      const size_t index = upper_bound_slab(ptr);
+      return index != 0 && ptr < slabs[index - 1] + SLAB_SIZE;
+    }
+
+    template<typename allocator, size_t... classes>
+    size_t BucketAllocator<allocator, classes...>::upper_bound_slab(const char* ptr) const noexcept
+    {
+      size_t low = 0;
+      size_t high = slab_count;
+      while (low < high)
+      {
+        const size_t middle = low + (high - low) / 2;
+        if (slabs[middle] <= ptr)
+          low = middle + 1;
+        else
+          high = middle;
+      }
+      return low;
+    }
+
+    template<typename allocator, size_t... classes>
+    char* BucketAllocator<allocator, classes...>::new_slab() noexcept
+    {
+      if (slab_count == slab_capacity)
+      {
+        const size_t new_capacity = slab_capacity == 0 ? 16 : slab_capacity * 2;
+        MemBlock table = allocator::allocate({ new_capacity * sizeof(char*) });
+        if (!table)
+          return nullptr;
+        if (slabs != nullptr)
+        {
+          std::memcpy(table.get_ptr(), slabs, slab_count * sizeof(char*));
+          allocator::deallocate({ slabs, slab_capacity * sizeof(char*) });
+        }
+        slabs = static_cast<char**>(table.get_ptr());
+        slab_capacity = new_capacity;
+      }
+      MemBlock blk = allocator::allocate({ SLAB_SIZE });
+      if (!blk)
+        return nullptr;
+      auto slab = static_cast<char*>(blk.get_ptr());
+      const size_t index = upper_bound_slab(slab);
+      std::memmove(slabs + index + 1, slabs + index, (slab_count - index) * sizeof(char*));
+      slabs[index] = slab;
+      ++slab_count;
+      return slab;
+    }
+
+    template<typename allocator, size_t... classes>
+    bool BucketAllocator<allocator, classes...>::refill(size_t index) noexcept
+    {
+      const size_t class_size = CLASS_SIZES[index];
+      if (static_cast<size_t>(slab_end - slab_top) < class_size)
+      {
+        //The tail of the current slab is lost
+        char* slab = new_slab();
+        if (slab == nullptr)
+          return false;
+        slab_top = slab;
+        slab_end = slab + SLAB_SIZE;
+      }
+
+      //Carve a batch of blocks, linked in address order
+      size_t count = static_cast<size_t>(slab_end - slab_top) / class_size;
+      const size_t batch = REFILL_BYTES / class_size == 0 ? 1 : REFILL_BYTES / class_size;
+      count = count < batch ? count : batch;
+      Node* first = reinterpret_cast<Node*>(slab_top);
+      for (size_t i = 0; i + 1 < count; i++)
+        reinterpret_cast<Node*>(slab_top + i * class_size)->next = reinterpret_cast<Node*>(slab_top + (i + 1) * class_size);
+      reinterpret_cast<Node*>(slab_top + (count - 1) * class_size)->next = free_lists[index];
+      free_lists[index] = first;
+      slab_top += count * class_size;
+      return true;
+    }
+
+    template<typename allocator, size_t... classes>
+    BucketAllocator<allocator, classes...>::~BucketAllocator() noexcept
+    {
+      for (size_t i = 0; i < slab_count; i++)
+        allocator::deallocate({ slabs[i], SLAB_SIZE });
+      if (slabs != nullptr)
+        allocator::deallocate({ slabs, slab_capacity * sizeof(char*) });
     }
   }
 }
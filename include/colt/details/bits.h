@@ -0,0 +1,101 @@
+/** @file bits.h
+* Contains bit manipulation helpers used throughout the library.
+* The helpers map to a single instruction on compilers that provide
+* intrinsics (MSVC, GCC, Clang), and fall back to loops otherwise.
+*/
+
+#ifndef HG_COLT_BITS
+#define HG_COLT_BITS
+
+#include "common.h"
+#include "../utility/Typedefs.h"
+
+#ifdef _MSC_VER
+  #include <intrin.h>
+#endif
+
+namespace colt
+{
+  namespace details
+  {
+    /// @brief Counts the number of leading 0 bits of a 64-bit integer.
+    /// @param value The value whose leading zeros to count
+    /// @return The count of leading zeros (64 if 'value' is 0)
+    inline unsigned count_leading_zeros(u64 value) noexcept
+    {
+      if (value == 0)
+        return 64;
+#if defined(__GNUC__) || defined(__clang__)
+      return static_cast<unsigned>(__builtin_clzll(value));
+#elif defined(_MSC_VER) && defined(_WIN64)
+      unsigned long index;
+      _BitScanReverse64(&index, value);
+      return 63 - static_cast<unsigned>(index);
+#else
+      unsigned count = 0;
+      while ((value & (u64(1) << 63)) == 0)
+      {
+        value <<= 1;
+        ++count;
+      }
+      return count;
+#endif
+    }
+
+    /// @brief Counts the number of trailing 0 bits of a 64-bit integer.
+    /// @param value The value whose trailing zeros to count
+    /// @return The count of trailing zeros (64 if 'value' is 0)
+    inline unsigned count_trailing_zeros(u64 value) noexcept
+    {
+      if (value == 0)
+        return 64;
+#if defined(__GNUC__) || defined(__clang__)
+      return static_cast<unsigned>(__builtin_ctzll(value));
+#elif defined(_MSC_VER) && defined(_WIN64)
+      unsigned long index;
+      _BitScanForward64(&index, value);
+      return static_cast<unsigned>(index);
+#else
+      unsigned count = 0;
+      while ((value & 1) == 0)
+      {
+        value >>= 1;
+        ++count;
+      }
+      return count;
+#endif
+    }
+
+    /// @brief Returns the number of bits needed to represent 'value'.
+    /// bit_width(0) == 0, bit_width(1) == 1, bit_width(255) == 8.
+    /// @param value The value whose bit width to compute
+    /// @return The bit width of 'value' (in [0, 64])
+    inline unsigned bit_width(u64 value) noexcept
+    {
+      return 64 - count_leading_zeros(value);
+    }
+
+    /// @brief Returns a mask whose 'width' lowest bits are set.
+    /// Precondition: width <= 64.
+    /// @param width The count of bits to set
+    /// @return The mask
+    constexpr u64 low_bits_mask(unsigned width) noexcept
+    {
+      assert(width <= 64 && "Invalid bit width!");
+      return width == 64 ? ~u64(0) : (u64(1) << width) - 1;
+    }
+
+    /// @brief Rounds 'value' to the next power of 2 (or returns 'value' if it already is).
+    /// round_up_pow2(0) == 1.
+    /// @param value The value to round
+    /// @return Power of 2 greater or equal to 'value'
+    inline u64 round_up_pow2(u64 value) noexcept
+    {
+      if (value <= 1)
+        return 1;
+      return u64(1) << bit_width(value - 1);
+    }
+  }
+}
+
+#endif //!HG_COLT_BITS
@@ -7,6 +7,7 @@
 
 #include <cassert>
 #include <cstring>
+#include <cstddef>
 #include <utility>
 #include <array>
 #include <cstdlib>
@@ -41,6 +42,18 @@
   #define COLT_ON_DEBUG(expr) do { } while (0)
 #endif
 
+#if defined(__GNUC__) || defined(__clang__)
+  /// @brief Hints the processor to load the cache line containing 'ptr'
+  #define COLT_PREFETCH(ptr) __builtin_prefetch(ptr)
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  #include <xmmintrin.h>
+  /// @brief Hints the processor to load the cache line containing 'ptr'
+  #define COLT_PREFETCH(ptr) _mm_prefetch(reinterpret_cast<const char*>(ptr), _MM_HINT_T0)
+#else
+  /// @brief Hints the processor to load the cache line containing 'ptr'
+  #define COLT_PREFETCH(ptr) do { } while (0)
+#endif
+
 #ifdef COLT_USE_IOSTREAMS
   #include <iostream>
 #endif
@@ -518,6 +531,9 @@ namespace colt {
     /// @brief Tag for NUL terminator in StringView
     struct WithNULT {};
 
+    /// @brief Tag for allocating in the scratch allocator (see memory::ScratchScope)
+    struct InScratchT {};
+
     /// @brief Represents O(1)
     struct ConstantComplexityT {};
     /// @brief Represents amortized O(1)
@@ -558,6 +574,10 @@ namespace colt {
     /// @brief NoneT is a tag
     struct is_tag<WithNULT> { static constexpr bool value = true; };
 
+    template<>
+    /// @brief InScratchT is a tag
+    struct is_tag<InScratchT> { static constexpr bool value = true; };
+
     template<>
     /// @brief ConstantComplexityT is a tag
     struct is_tag<ConstantComplexityT> { static constexpr bool value = true; };
@@ -633,6 +653,9 @@ namespace colt {
   /// @brief Tag object for NUL in StringView
   constexpr inline const traits::WithNULT WithNUL;
 
+  /// @brief Tag object for allocating in the scratch allocator
+  constexpr inline const traits::InScratchT InScratch;
+
   /*********************************
   * FUNCTIONS HELPERS
   *********************************/
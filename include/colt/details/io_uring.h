@@ -0,0 +1,221 @@
+/** @file io_uring.h
+* Contains a minimal io_uring ring, set up through the raw system calls
+* (liburing is not required).
+* The ring is only compiled in on Linux when the kernel headers define
+* io_uring: COLT_DETAILS_IO_URING is then defined.
+* Whether the running kernel supports io_uring (and the needed operations)
+* is only known at run time, through 'IoUring::init'.
+*/
+
+#ifndef HG_COLT_IO_URING
+#define HG_COLT_IO_URING
+
+#include "common.h"
+
+#if defined(__linux__) && defined(__has_include)
+  #if __has_include(<linux/io_uring.h>)
+    #include <linux/io_uring.h>
+    #include <sys/syscall.h>
+    #include <sys/mman.h>
+    #include <unistd.h>
+    #include <cerrno>
+    #include <cstring>
+    #if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter) && defined(__NR_io_uring_register)
+      /// @brief io_uring can be used
+      #define COLT_DETAILS_IO_URING
+    #endif
+  #endif
+#endif
+
+#ifdef COLT_DETAILS_IO_URING
+
+namespace colt
+{
+  namespace details
+  {
+    /// @brief Submission and completion rings of io_uring, mapped from the kernel
+    class IoUring
+    {
+      /// @brief The file descriptor of the ring
+      int ring_fd = -1;
+
+      /// @brief The mapping of the submission ring
+      void* sq_map = nullptr;
+      /// @brief The size of the mapping of the submission ring
+      size_t sq_map_size = 0;
+      /// @brief The mapping of the completion ring (can be 'sq_map')
+      void* cq_map = nullptr;
+      /// @brief The size of the mapping of the completion ring
+      size_t cq_map_size = 0;
+      /// @brief The mapping of the submission entries
+      io_uring_sqe* sqes = nullptr;
+      /// @brief The count of submission entries
+      unsigned sq_entries = 0;
+
+      /// @brief The head of the submission ring (written by the kernel)
+      unsigned* sq_head = nullptr;
+      /// @brief The tail of the submission ring
+      unsigned* sq_tail = nullptr;
+      /// @brief The mask of the submission ring
+      unsigned sq_mask = 0;
+      /// @brief The indices of the submission entries
+      unsigned* sq_array = nullptr;
+      /// @brief The head of the completion ring
+      unsigned* cq_head = nullptr;
+      /// @brief The tail of the completion ring (written by the kernel)
+      unsigned* cq_tail = nullptr;
+      /// @brief The mask of the completion ring
+      unsigned cq_mask = 0;
+      /// @brief The completion entries
+      io_uring_cqe* cqes = nullptr;
+
+      /// @brief The tail of the submission ring including the entries not yet published
+      unsigned local_tail = 0;
+      /// @brief The count of entries published but not yet consumed by the kernel
+      unsigned to_submit = 0;
+
+    public:
+      /// @brief Constructs an uninitialized ring
+      constexpr IoUring() noexcept = default;
+      /// @brief IoUring cannot be copied
+      IoUring(const IoUring&) = delete;
+      /// @brief IoUring cannot be copied
+      IoUring& operator=(const IoUring&) = delete;
+
+      /// @brief Destructor, unmaps and closes the ring
+      ~IoUring() noexcept
+      {
+        if (sqes != nullptr)
+          munmap(sqes, sq_entries * sizeof(io_uring_sqe));
+        if (cq_map != nullptr && cq_map != sq_map)
+          munmap(cq_map, cq_map_size);
+        if (sq_map != nullptr)
+          munmap(sq_map, sq_map_size);
+        if (ring_fd >= 0)
+          close(ring_fd);
+      }
+
+      /// @brief Sets up the ring, and checks that 'opcodes' are supported
+      /// @param entries The count of submission entries
+      /// @param opcodes The operations that must be supported
+      /// @param opcode_count The count of operations in 'opcodes'
+      /// @return False if io_uring or any of 'opcodes' is not supported
+      bool init(unsigned entries, const uint8_t* opcodes, size_t opcode_count) noexcept
+      {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        const long fd = syscall(__NR_io_uring_setup, entries, &params);
+        if (fd < 0)
+          return false;
+        ring_fd = static_cast<int>(fd);
+
+        //Checks the opcodes through a probe (supported since the opcodes we use)
+        constexpr size_t PROBE_OPS = 256;
+        alignas(io_uring_probe) char probe_buffer[sizeof(io_uring_probe) + PROBE_OPS * sizeof(io_uring_probe_op)] = {};
+        auto probe = reinterpret_cast<io_uring_probe*>(probe_buffer);
+        if (syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_PROBE, probe, PROBE_OPS) < 0)
+          return false;
+        for (size_t i = 0; i < opcode_count; i++)
+          if (opcodes[i] > probe->last_op || (probe->ops[opcodes[i]].flags & IO_URING_OP_SUPPORTED) == 0)
+            return false;
+
+        sq_map_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_map_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        //Both rings can be mapped at once
+        if (params.features & IORING_FEAT_SINGLE_MMAP)
+          sq_map_size = cq_map_size = (sq_map_size > cq_map_size ? sq_map_size : cq_map_size);
+
+        sq_map = mmap(nullptr, sq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+        if (sq_map == MAP_FAILED)
+          return (sq_map = nullptr), false;
+        if (params.features & IORING_FEAT_SINGLE_MMAP)
+          cq_map = sq_map;
+        else
+        {
+          cq_map = mmap(nullptr, cq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+          if (cq_map == MAP_FAILED)
+            return (cq_map = nullptr), false;
+        }
+        sq_entries = params.sq_entries;
+        void* sqes_map = mmap(nullptr, sq_entries * sizeof(io_uring_sqe), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+        if (sqes_map == MAP_FAILED)
+          return false;
+        sqes = static_cast<io_uring_sqe*>(sqes_map);
+
+        char* sq = static_cast<char*>(sq_map);
+        sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        char* cq = static_cast<char*>(cq_map);
+        cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        local_tail = *sq_tail;
+        return true;
+      }
+
+      /// @brief Returns the count of submission entries of the ring
+      /// @return The count of submission entries
+      unsigned get_entry_count() const noexcept { return sq_entries; }
+
+      /// @brief Returns a zeroed submission entry, which is submitted on the next 'submit_and_wait'
+      /// @return The submission entry, or nullptr if the submission ring is full
+      io_uring_sqe* get_sqe() noexcept
+      {
+        const unsigned head = __atomic_load_n(sq_head, __ATOMIC_ACQUIRE);
+        if (local_tail - head >= sq_entries)
+          return nullptr;
+        const unsigned index = local_tail & sq_mask;
+        sq_array[index] = index;
+        ++local_tail;
+        io_uring_sqe* sqe = &sqes[index];
+        std::memset(sqe, 0, sizeof(io_uring_sqe));
+        return sqe;
+      }
+
+      /// @brief Submits the entries obtained through 'get_sqe', and waits for 'wait_count' completions
+      /// @param wait_count The count of completions to wait for
+      /// @return The count of entries submitted, or -errno on failure
+      int submit_and_wait(unsigned wait_count) noexcept
+      {
+        //Publishes the entries to the kernel
+        to_submit += local_tail - *sq_tail;
+        __atomic_store_n(sq_tail, local_tail, __ATOMIC_RELEASE);
+        for (;;)
+        {
+          const long result = syscall(__NR_io_uring_enter, ring_fd, to_submit, wait_count,
+            wait_count != 0 ? IORING_ENTER_GETEVENTS : 0u, nullptr, 0);
+          if (result >= 0)
+          {
+            to_submit -= static_cast<unsigned>(result);
+            return static_cast<int>(result);
+          }
+          if (errno != EINTR)
+            return -errno;
+        }
+      }
+
+      /// @brief Calls 'fn(cqe)' for each available completion, and marks them as seen
+      /// @tparam Fn The function type
+      /// @param fn The function to call with a 'const io_uring_cqe&'
+      /// @return The count of completions
+      template<typename Fn>
+      unsigned for_each_cqe(Fn&& fn) noexcept
+      {
+        unsigned head = *cq_head;
+        const unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+        const unsigned count = tail - head;
+        for (; head != tail; ++head)
+          fn(static_cast<const io_uring_cqe&>(cqes[head & cq_mask]));
+        __atomic_store_n(cq_head, tail, __ATOMIC_RELEASE);
+        return count;
+      }
+    };
+  }
+}
+
+#endif //COLT_DETAILS_IO_URING
+
+#endif //!HG_COLT_IO_URING
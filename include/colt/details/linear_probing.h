@@ -1,7 +1,15 @@
+/** @file linear_probing.h
+* Contains the helpers shared by the linear probing hash tables (Map, StableSet, HashSet).
+* Each slot of a table has a KeySentinel describing its state.
+* Defining COLT_HASH_TABLE_STATS makes the tables count their lookups,
+* probes and rehashes, which are then reported by their 'get_stats()'.
+*/
+
 #ifndef HG_COLT_LINEAR_PROBING
 #define HG_COLT_LINEAR_PROBING
 
 #include "common.h"
+#include "bits.h"
 
 namespace colt
 {
@@ -83,8 +91,180 @@ namespace colt
       assert((prob + 1) % mod == ((prob + 1) * (prob + 1 != mod)));
       return  (prob + 1) * (prob + 1 != mod);
     }
+
+    /// @brief Returns the count of slots inspected to reach 'index' from the home slot of 'hash'
+    /// @param index The index of the slot reached
+    /// @param hash The hash whose home slot is 'hash % capacity'
+    /// @param capacity The count of slots
+    /// @return The probe length (at least 1)
+    constexpr size_t probe_length(size_t index, size_t hash, size_t capacity) noexcept
+    {
+      return (index + capacity - hash % capacity) % capacity + 1;
+    }
   }
 
+  /// @brief Occupancy and probing statistics of a linear probing hash table.
+  /// Returned by 'get_stats()' of Map, StableSet and HashSet, which computes them in O(capacity).
+  /// The probe length of a lookup is the count of slots inspected (at least 1).
+  struct HashTableStats
+  {
+    /// @brief The count of buckets of 'cluster_histogram'
+    static constexpr size_t CLUSTER_HISTOGRAM_SIZE = 16;
+
+    /// @brief The count of active slots
+    size_t size = 0;
+    /// @brief The count of slots
+    size_t capacity = 0;
+    /// @brief The count of DELETED slots (tombstones), which lengthen probes until a rehash
+    size_t tombstone_count = 0;
+    /// @brief The average probe length of a successful lookup
+    double avg_hit_probe = 0.0;
+    /// @brief The maximum probe length of a successful lookup
+    size_t max_hit_probe = 0;
+    /// @brief The average probe length of an unsuccessful lookup (over all the home slots)
+    double avg_miss_probe = 0.0;
+    /// @brief The maximum probe length of an unsuccessful lookup
+    size_t max_miss_probe = 0;
+    /// @brief The length of the longest run of ACTIVE or DELETED slots
+    size_t max_cluster_length = 0;
+    /// @brief Bucket 'i' is the count of clusters whose length is in [2^i, 2^(i+1)).
+    /// The last bucket also counts all the longer clusters.
+    size_t cluster_histogram[CLUSTER_HISTOGRAM_SIZE] = {};
+    /// @brief The bytes used by the sentinels
+    size_t metadata_bytes = 0;
+    /// @brief The bytes used by the slots
+    size_t slot_bytes = 0;
+    /// @brief The count of lookups (find, insert...) since construction.
+    /// Always 0 if COLT_HASH_TABLE_STATS is not defined.
+    size_t lookup_count = 0;
+    /// @brief The count of slots inspected by all the lookups since construction.
+    /// Always 0 if COLT_HASH_TABLE_STATS is not defined.
+    size_t probe_count = 0;
+    /// @brief The count of rehashes since construction.
+    /// Always 0 if COLT_HASH_TABLE_STATS is not defined.
+    size_t rehash_count = 0;
+  };
+
+  namespace details
+  {
+    /// @brief Counters updated by the lookups and rehashes of a hash table.
+    /// Only updated if COLT_HASH_TABLE_STATS is defined.
+    struct ProbeCounters
+    {
+      /// @brief The count of lookups
+      size_t lookup_count = 0;
+      /// @brief The count of slots inspected by all the lookups
+      size_t probe_count = 0;
+      /// @brief The count of rehashes
+      size_t rehash_count = 0;
+    };
+
+    template<typename HashFn>
+    /// @brief Computes the statistics of a linear probing hash table.
+    /// @tparam HashFn The function type
+    /// @param metadata The sentinels of the table
+    /// @param capacity The count of slots of the table
+    /// @param slot_size The size of a slot
+    /// @param hash_of Returns the hash of the key of the ACTIVE slot at the index it receives
+    /// @return The statistics (without the run-time counters)
+    HashTableStats compute_hash_table_stats(const KeySentinel* metadata, size_t capacity, size_t slot_size, HashFn&& hash_of) noexcept
+    {
+      HashTableStats stats;
+      stats.capacity = capacity;
+      stats.metadata_bytes = capacity * sizeof(KeySentinel);
+      stats.slot_bytes = capacity * slot_size;
+      if (capacity == 0)
+        return stats;
+
+      size_t hit_probe_sum = 0;
+      size_t first_empty = capacity;
+      for (size_t i = 0; i < capacity; i++)
+      {
+        if (is_sentinel_active(metadata[i]))
+        {
+          const size_t probe = probe_length(i, hash_of(i), capacity);
+          hit_probe_sum += probe;
+          stats.max_hit_probe = probe > stats.max_hit_probe ? probe : stats.max_hit_probe;
+          ++stats.size;
+        }
+        else if (is_sentinel_deleted(metadata[i]))
+          ++stats.tombstone_count;
+        else if (first_empty == capacity)
+          first_empty = i;
+      }
+      if (stats.size != 0)
+        stats.avg_hit_probe = static_cast<double>(hit_probe_sum) / static_cast<double>(stats.size);
+
+      if (first_empty == capacity)
+      {
+        //No EMPTY slot: the whole table is a single cluster, and misses never stop
+        stats.max_cluster_length = capacity;
+        stats.cluster_histogram[HashTableStats::CLUSTER_HISTOGRAM_SIZE - 1] = 1;
+        stats.avg_miss_probe = static_cast<double>(capacity);
+        stats.max_miss_probe = capacity;
+        return stats;
+      }
+
+      //Starting after an EMPTY slot, no cluster wraps around the scan.
+      //A miss whose home is at offset 'k' of a cluster of length 'L' inspects
+      //'L - k' slots of the cluster then the EMPTY slot that ends it.
+      size_t miss_probe_sum = 0;
+      size_t cluster_length = 0;
+      for (size_t n = 1; n <= capacity; n++)
+      {
+        const size_t i = (first_empty + n) % capacity;
+        if (!is_sentinel_empty(metadata[i]))
+        {
+          ++cluster_length;
+          continue;
+        }
+        miss_probe_sum += cluster_length * (cluster_length + 1) / 2 + cluster_length + 1;
+        if (cluster_length + 1 > stats.max_miss_probe)
+          stats.max_miss_probe = cluster_length + 1;
+        if (cluster_length != 0)
+        {
+          const size_t bucket = bit_width(cluster_length) - 1;
+          ++stats.cluster_histogram[bucket < HashTableStats::CLUSTER_HISTOGRAM_SIZE ? bucket : HashTableStats::CLUSTER_HISTOGRAM_SIZE - 1];
+          if (cluster_length > stats.max_cluster_length)
+            stats.max_cluster_length = cluster_length;
+        }
+        cluster_length = 0;
+      }
+      stats.avg_miss_probe = static_cast<double>(miss_probe_sum) / static_cast<double>(capacity);
+      return stats;
+    }
+  }
+
+#ifdef COLT_USE_IOSTREAMS
+
+  static std::ostream& operator<<(std::ostream& os, const HashTableStats& stats) noexcept
+  {
+    os << "{ size: " << stats.size << ", capacity: " << stats.capacity
+      << ", tombstones: " << stats.tombstone_count
+      << ", hit probe: " << stats.avg_hit_probe << " (max " << stats.max_hit_probe << ')'
+      << ", miss probe: " << stats.avg_miss_probe << " (max " << stats.max_miss_probe << ')'
+      << ", clusters: [";
+    //Only print the buckets up to the last non-empty one
+    size_t last = 0;
+    for (size_t i = 0; i < HashTableStats::CLUSTER_HISTOGRAM_SIZE; i++)
+    {
+      if (stats.cluster_histogram[i] != 0)
+        last = i + 1;
+    }
+    for (size_t i = 0; i < last; i++)
+      os << (i == 0 ? "" : ", ") << stats.cluster_histogram[i];
+    os << "] (max " << stats.max_cluster_length << ')'
+      << ", bytes: " << stats.metadata_bytes + stats.slot_bytes;
+#ifdef COLT_HASH_TABLE_STATS
+    os << ", lookups: " << stats.lookup_count << ", probes: " << stats.probe_count
+      << ", rehashes: " << stats.rehash_count;
+#endif
+    os << " }";
+    return os;
+  }
+
+#endif
+
   /// @brief Represents the result of an insert/insert_or_assign operation
   enum class InsertionResult
     : uint8_t
@@ -0,0 +1,161 @@
+/** @file simd.h
+* Contains helpers comparing multiple integers at once, and the prefix sums
+* ('scan_sequential') used by the scans and the decoding of DeltaVector blocks.
+* The helpers use SSE2 (available on all x86-64 processors) when the compiler
+* targets it, and fall back to scalar comparisons otherwise: the results are
+* the same in both cases.
+*/
+
+#ifndef HG_COLT_SIMD
+#define HG_COLT_SIMD
+
+#include <cstring>
+
+#include "common.h"
+#include "../utility/Typedefs.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #include <emmintrin.h>
+  /// @brief SSE2 intrinsics can be used
+  #define COLT_DETAILS_SSE2
+#endif
+
+namespace colt
+{
+  namespace details
+  {
+    /// @brief The count of integers compared at once by 'equal_mask4'
+    static constexpr size_t SIMD_GROUP_SIZE = 4;
+
+    template<typename T>
+    /// @brief Compares 4 consecutive integers to 'value'.
+    /// 'values' does not need to be aligned.
+    /// @tparam T The integer type
+    /// @param values Pointer to the 4 integers to compare
+    /// @param value The value to compare with
+    /// @return Mask whose bit 'i' is set if 'values[i] == value'
+    inline u32 equal_mask4(const T* values, T value) noexcept
+    {
+      static_assert(std::is_integral_v<T>, "'T' should be an integer!");
+#ifdef COLT_DETAILS_SSE2
+      if constexpr (sizeof(T) == 4)
+      {
+        u32 bits;
+        std::memcpy(&bits, &value, sizeof(T));
+        const __m128i cmp = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(values)),
+          _mm_set1_epi32(static_cast<int>(bits)));
+        return static_cast<u32>(_mm_movemask_ps(_mm_castsi128_ps(cmp)));
+      }
+      else if constexpr (sizeof(T) == 8)
+      {
+        //SSE2 cannot compare 64-bit integers: both 32-bit halves must be equal
+        u64 bits;
+        std::memcpy(&bits, &value, sizeof(T));
+        const __m128i needle = _mm_set_epi32(static_cast<int>(bits >> 32), static_cast<int>(bits),
+          static_cast<int>(bits >> 32), static_cast<int>(bits));
+        __m128i low = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(values)), needle);
+        __m128i high = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(values + 2)), needle);
+        low = _mm_and_si128(low, _mm_shuffle_epi32(low, _MM_SHUFFLE(2, 3, 0, 1)));
+        high = _mm_and_si128(high, _mm_shuffle_epi32(high, _MM_SHUFFLE(2, 3, 0, 1)));
+        return static_cast<u32>(_mm_movemask_pd(_mm_castsi128_pd(low)))
+          | (static_cast<u32>(_mm_movemask_pd(_mm_castsi128_pd(high))) << 2);
+      }
+      else
+#endif
+      {
+        u32 mask = 0;
+        for (size_t i = 0; i < SIMD_GROUP_SIZE; i++)
+          mask |= static_cast<u32>(values[i] == value) << i;
+        return mask;
+      }
+    }
+
+    template<typename T>
+    /// @brief Compares 4 consecutive integers to 4 other consecutive integers (all the pairs).
+    /// Neither 'values' nor 'others' need to be aligned.
+    /// @tparam T The integer type
+    /// @param values Pointer to the 4 integers whose equality is reported
+    /// @param others Pointer to the 4 integers to compare with
+    /// @return Mask whose bit 'i' is set if 'values[i]' is equal to any of 'others[0..4)'
+    inline u32 equal_any_mask4(const T* values, const T* others) noexcept
+    {
+      static_assert(std::is_integral_v<T>, "'T' should be an integer!");
+#ifdef COLT_DETAILS_SSE2
+      if constexpr (sizeof(T) == 4)
+      {
+        //Compares with the 4 rotations of 'others'
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(others));
+        __m128i cmp = _mm_cmpeq_epi32(a, b);
+        cmp = _mm_or_si128(cmp, _mm_cmpeq_epi32(a, _mm_shuffle_epi32(b, _MM_SHUFFLE(0, 3, 2, 1))));
+        cmp = _mm_or_si128(cmp, _mm_cmpeq_epi32(a, _mm_shuffle_epi32(b, _MM_SHUFFLE(1, 0, 3, 2))));
+        cmp = _mm_or_si128(cmp, _mm_cmpeq_epi32(a, _mm_shuffle_epi32(b, _MM_SHUFFLE(2, 1, 0, 3))));
+        return static_cast<u32>(_mm_movemask_ps(_mm_castsi128_ps(cmp)));
+      }
+      else
+#endif
+      {
+        u32 mask = 0;
+        for (size_t i = 0; i < SIMD_GROUP_SIZE; i++)
+          mask |= equal_mask4(values, others[i]);
+        return mask;
+      }
+    }
+
+    template<bool INCLUSIVE, typename T>
+    /// @brief Writes the prefix sums of 'count' values.
+    /// For 32 and 64-bit integers, the sums of a register of values are computed with
+    /// shifted additions, to which the carry of the previous register is added.
+    /// @tparam INCLUSIVE If true, 'out[i]' includes 'values[i]', else it does not
+    /// @tparam T The arithmetic type of the values
+    /// @param values The values to scan
+    /// @param count The count of values
+    /// @param out Where to write the scan (can be 'values')
+    /// @param carry The value added to all the sums
+    /// @return 'carry' plus the sum of the values
+    inline T scan_sequential(const T* values, size_t count, T* out, T carry) noexcept
+    {
+      size_t i = 0;
+#ifdef COLT_DETAILS_SSE2
+      if constexpr (std::is_integral_v<T> && sizeof(T) == 4)
+      {
+        __m128i carries = _mm_set1_epi32(static_cast<int>(carry));
+        for (; i + 4 <= count; i += 4)
+        {
+          const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+          __m128i sum = _mm_add_epi32(value, _mm_slli_si128(value, 4));
+          sum = _mm_add_epi32(sum, _mm_slli_si128(sum, 8));
+          sum = _mm_add_epi32(sum, carries);
+          _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), INCLUSIVE ? sum : _mm_sub_epi32(sum, value));
+          carries = _mm_shuffle_epi32(sum, _MM_SHUFFLE(3, 3, 3, 3));
+        }
+        carry = static_cast<T>(_mm_cvtsi128_si32(carries));
+      }
+      else if constexpr (std::is_integral_v<T> && sizeof(T) == 8)
+      {
+        __m128i carries = _mm_set1_epi64x(static_cast<long long>(carry));
+        for (; i + 2 <= count; i += 2)
+        {
+          const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+          const __m128i sum = _mm_add_epi64(_mm_add_epi64(value, _mm_slli_si128(value, 8)), carries);
+          _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), INCLUSIVE ? sum : _mm_sub_epi64(sum, value));
+          carries = _mm_shuffle_epi32(sum, _MM_SHUFFLE(3, 2, 3, 2));
+        }
+        std::memcpy(&carry, &carries, sizeof(T));
+      }
+#endif
+      for (; i < count; i++)
+      {
+        const T value = values[i];
+        if constexpr (!INCLUSIVE)
+          out[i] = carry;
+        carry = static_cast<T>(carry + value);
+        if constexpr (INCLUSIVE)
+          out[i] = carry;
+      }
+      return carry;
+    }
+  }
+}
+
+#endif //!HG_COLT_SIMD
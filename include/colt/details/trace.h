@@ -0,0 +1,209 @@
+/** @file trace.h
+* Contains the low-overhead scoped tracing used by COLT_TRACE_SCOPE.
+* Tracing is only compiled in if COLT_ENABLE_TRACING is defined: else
+* COLT_TRACE_SCOPE, COLT_TRACE_BEGIN and COLT_TRACE_END expand to nothing.
+* Each thread records begin/end events in its own ring buffer, without any lock:
+* when a ring buffer is full, the oldest events are overwritten.
+* The ring buffers are allocated through malloc (and not through the global
+* allocator, which is itself traced) and are registered in a lock-free list.
+* When a thread exits, its buffer is released (but stays in the list): the
+* next thread to record an event reuses it instead of allocating a new one.
+* The events of a finished thread can be flushed until its buffer is reused,
+* and the memory used is bounded by the count of threads alive at once.
+* To write the recorded events, see 'utility/Trace.h'.
+*/
+
+#ifndef HG_COLT_TRACE
+#define HG_COLT_TRACE
+
+#include <chrono>
+
+#include "common.h"
+
+namespace colt
+{
+  namespace details
+  {
+    /// @brief The phase of a trace event
+    enum class TracePhase
+      : uint8_t
+    {
+      /// @brief Beginning of a scope
+      BEGIN,
+      /// @brief End of a scope
+      END
+    };
+
+    /// @brief A trace event
+    struct TraceEvent
+    {
+      /// @brief The name of the scope (must have static storage duration)
+      const char* name;
+      /// @brief The timestamp in nanoseconds (of std::chrono::steady_clock)
+      uint64_t timestamp;
+      /// @brief The identifier of the thread that recorded the event
+      /// (a buffer contains the events of the threads that successively owned it)
+      uint32_t thread_id;
+      /// @brief The phase of the event
+      TracePhase phase;
+    };
+
+    /// @brief Ring buffer of events of a single thread.
+    /// Only its thread writes events, and readers use 'write_index'
+    /// to detect events that were overwritten while reading.
+    struct TraceBuffer
+    {
+      /// @brief The count of events of a buffer (power of 2)
+      static constexpr size_t CAPACITY = 1 << 14;
+
+      /// @brief The next buffer in the list of all buffers
+      TraceBuffer* next;
+      /// @brief The identifier of the thread owning the buffer
+      uint32_t thread_id;
+      /// @brief True while a thread owns the buffer, false once it exited
+      std::atomic<bool> is_owned;
+      /// @brief The count of events ever written
+      std::atomic<uint64_t> write_index;
+      /// @brief The events
+      TraceEvent events[CAPACITY];
+    };
+
+    /// @brief Returns the head of the list of all the TraceBuffer
+    /// @return The head of the list
+    inline std::atomic<TraceBuffer*>& get_trace_buffers() noexcept
+    {
+      static std::atomic<TraceBuffer*> head = nullptr;
+      return head;
+    }
+
+    /// @brief Owns the TraceBuffer of a thread, which is released when the thread exits
+    struct TraceBufferOwner
+    {
+      /// @brief The buffer of the thread (or nullptr)
+      TraceBuffer* buffer = nullptr;
+      /// @brief True once the thread released its buffer (the thread is exiting)
+      bool is_released = false;
+
+      /// @brief Releases the buffer, which can then be reused by another thread
+      ~TraceBufferOwner() noexcept
+      {
+        is_released = true;
+        if (buffer != nullptr)
+          buffer->is_owned.store(false, std::memory_order_release);
+      }
+    };
+
+    /// @brief Returns the TraceBuffer of the current thread, reusing the buffer
+    /// of an exited thread or creating one if needed
+    /// @return The TraceBuffer or nullptr if it could not be allocated (or the thread is exiting)
+    inline TraceBuffer* get_thread_trace_buffer() noexcept
+    {
+      static std::atomic<uint32_t> thread_count = 0;
+      thread_local TraceBufferOwner owner;
+      if (owner.buffer != nullptr || owner.is_released)
+        return owner.buffer;
+
+      auto& head = get_trace_buffers();
+      const uint32_t thread_id = thread_count.fetch_add(1, std::memory_order_relaxed) + 1;
+      //The buffers are never removed from the list: it can be walked without lock
+      for (TraceBuffer* buffer = head.load(std::memory_order_acquire); buffer != nullptr; buffer = buffer->next)
+      {
+        bool is_owned = false;
+        if (buffer->is_owned.load(std::memory_order_relaxed)
+          || !buffer->is_owned.compare_exchange_strong(is_owned, true, std::memory_order_acquire, std::memory_order_relaxed))
+          continue;
+        buffer->thread_id = thread_id;
+        owner.buffer = buffer;
+        return buffer;
+      }
+
+      TraceBuffer* buffer = static_cast<TraceBuffer*>(std::malloc(sizeof(TraceBuffer)));
+      if (buffer == nullptr)
+        return nullptr;
+      buffer->thread_id = thread_id;
+      new(&buffer->is_owned) std::atomic<bool>(true);
+      new(&buffer->write_index) std::atomic<uint64_t>(0);
+
+      //Push the buffer on the lock-free list
+      buffer->next = head.load(std::memory_order_relaxed);
+      while (!head.compare_exchange_weak(buffer->next, buffer,
+        std::memory_order_release, std::memory_order_relaxed));
+      owner.buffer = buffer;
+      return buffer;
+    }
+
+    /// @brief Returns the current timestamp used by trace events
+    /// @return The timestamp in nanoseconds
+    inline uint64_t get_trace_timestamp() noexcept
+    {
+      return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    /// @brief Records an event in the TraceBuffer of the current thread
+    /// @param name The name of the scope (must have static storage duration)
+    /// @param phase The phase of the event
+    inline void record_trace_event(const char* name, TracePhase phase) noexcept
+    {
+      TraceBuffer* buffer = get_thread_trace_buffer();
+      if (buffer == nullptr)
+        return;
+      const uint64_t index = buffer->write_index.load(std::memory_order_relaxed);
+      buffer->events[index & (TraceBuffer::CAPACITY - 1)] = { name, get_trace_timestamp(), buffer->thread_id, phase };
+      //Publishes the event
+      buffer->write_index.store(index + 1, std::memory_order_release);
+    }
+
+    /// @brief Records a BEGIN event on construction and an END event on destruction
+    class TraceScope
+    {
+      /// @brief The name of the scope
+      const char* name;
+
+    public:
+      /// @brief Records a BEGIN event
+      /// @param name The name of the scope (must have static storage duration)
+      explicit TraceScope(const char* name) noexcept
+        : name(name)
+      {
+        record_trace_event(name, TracePhase::BEGIN);
+      }
+
+      TraceScope(const TraceScope&) = delete;
+      TraceScope& operator=(const TraceScope&) = delete;
+
+      /// @brief Records an END event
+      ~TraceScope() noexcept
+      {
+        record_trace_event(name, TracePhase::END);
+      }
+    };
+  }
+}
+
+/// @brief Concatenates two tokens after expanding them
+#define COLT_DETAILS_TRACE_CONCAT_IMPL(a, b) a##b
+/// @brief Concatenates two tokens after expanding them
+#define COLT_DETAILS_TRACE_CONCAT(a, b) COLT_DETAILS_TRACE_CONCAT_IMPL(a, b)
+
+#ifdef COLT_ENABLE_TRACING
+  /// @brief Traces the current scope under 'NAME' (a string literal).
+  /// Cannot be used in constexpr functions: use COLT_TRACE_BEGIN/END instead.
+  #define COLT_TRACE_SCOPE(NAME) const ::colt::details::TraceScope COLT_DETAILS_TRACE_CONCAT(colt_trace_scope_, __LINE__) { NAME }
+  /// @brief Records the beginning of a scope named 'NAME' (a string literal).
+  /// Each COLT_TRACE_BEGIN must be matched by a COLT_TRACE_END on every path.
+  #define COLT_TRACE_BEGIN(NAME) ::colt::details::record_trace_event(NAME, ::colt::details::TracePhase::BEGIN)
+  /// @brief Records the end of a scope named 'NAME' (a string literal)
+  #define COLT_TRACE_END(NAME) ::colt::details::record_trace_event(NAME, ::colt::details::TracePhase::END)
+#else
+  /// @brief Traces the current scope under 'NAME' (a string literal).
+  /// Cannot be used in constexpr functions: use COLT_TRACE_BEGIN/END instead.
+  #define COLT_TRACE_SCOPE(NAME) do { } while (0)
+  /// @brief Records the beginning of a scope named 'NAME' (a string literal).
+  /// Each COLT_TRACE_BEGIN must be matched by a COLT_TRACE_END on every path.
+  #define COLT_TRACE_BEGIN(NAME) do { } while (0)
+  /// @brief Records the end of a scope named 'NAME' (a string literal)
+  #define COLT_TRACE_END(NAME) do { } while (0)
+#endif
+
+#endif //!HG_COLT_TRACE
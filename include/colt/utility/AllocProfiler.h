@@ -0,0 +1,265 @@
+/** @file AllocProfiler.h
+* Contains the functions configuring the sampling allocation profiler
+* (see 'details/alloc_profiler.h') and writing its samples, either in
+* the legacy pprof heap profile text format (readable by 'pprof' and
+* 'go tool pprof') or as folded stacks (readable by flamegraph.pl,
+* speedscope or inferno).
+* Samples are only recorded if COLT_ALLOC_PROFILER is defined.
+* Writing does not stop the allocating threads: samples that are
+* being written while the profile is dumped are skipped.
+*/
+
+#ifndef HG_COLT_ALLOC_PROFILER_WRITER
+#define HG_COLT_ALLOC_PROFILER_WRITER
+
+#include <cstdio>
+#include <algorithm>
+
+#include "../details/alloc_profiler.h"
+#include "../data_structs/Vector.h"
+
+#if defined(COLT_DETAILS_BACKTRACE_EXECINFO)
+  #include <cxxabi.h>
+#endif
+
+namespace colt
+{
+  /// @brief Contains the helpers to configure the allocation profiler and write its samples
+  namespace profiler
+  {
+    namespace details
+    {
+      /// @brief The sampled allocations sharing the same stack trace
+      struct SampleGroup
+      {
+        /// @brief A sample of the group (whose frames are the stack trace)
+        const colt::details::AllocSample* sample;
+        /// @brief The count of samples
+        uint64_t count;
+        /// @brief The sum of the sizes of the samples
+        uint64_t bytes;
+        /// @brief The estimated count of bytes allocated (unsampled)
+        double estimated_bytes;
+      };
+
+      /// @brief Compares the stack traces of two samples
+      /// @param a The first sample
+      /// @param b The second sample
+      /// @return True if the stack of 'a' is ordered before the one of 'b'
+      inline bool is_stack_less(const colt::details::AllocSample* a, const colt::details::AllocSample* b) noexcept
+      {
+        return std::lexicographical_compare(a->frames, a->frames + a->depth, b->frames, b->frames + b->depth);
+      }
+
+      /// @brief Groups the published samples by stack trace
+      /// @return The groups, sorted by decreasing estimated bytes
+      inline Vector<SampleGroup> group_samples() noexcept
+      {
+        using colt::details::AllocProfile;
+        using colt::details::AllocSample;
+
+        AllocProfile& profile = colt::details::get_alloc_profile();
+        const uint64_t rate = profile.sample_rate.load(std::memory_order_relaxed);
+        const uint64_t reserved = profile.reserve_index.load(std::memory_order_acquire);
+        const size_t count = static_cast<size_t>(reserved < AllocProfile::CAPACITY ? reserved : AllocProfile::CAPACITY);
+
+        Vector<const AllocSample*> samples = Vector<const AllocSample*>{ count };
+        for (size_t i = 0; i < count; i++)
+          if (profile.samples[i].is_ready.load(std::memory_order_acquire))
+            samples.push_back(&profile.samples[i]);
+        std::sort(samples.begin(), samples.end(), &is_stack_less);
+
+        Vector<SampleGroup> groups;
+        for (const AllocSample* sample : samples)
+        {
+          //Probability that an allocation of 'size' bytes is sampled: 1 - e^(-size/rate)
+          const double probability = 1.0 - std::exp(-static_cast<double>(sample->size) / static_cast<double>(rate));
+          const double estimated = static_cast<double>(sample->size) / probability;
+          if (groups.is_not_empty() && !is_stack_less(groups.get_back().sample, sample))
+          {
+            auto& group = groups.get_back();
+            group.count++;
+            group.bytes += sample->size;
+            group.estimated_bytes += estimated;
+          }
+          else
+            groups.push_back(SampleGroup{ sample, 1, sample->size, estimated });
+        }
+        std::sort(groups.begin(), groups.end(), [](const SampleGroup& a, const SampleGroup& b)
+          {
+            return a.estimated_bytes > b.estimated_bytes;
+          });
+        return groups;
+      }
+
+      /// @brief Writes the name of the function containing 'address' (or the address)
+      /// @param file The file to which to write
+      /// @param symbol The symbol returned by backtrace_symbols (can be null)
+      /// @param address The return address
+      inline void write_frame_name(FILE* file, const char* symbol, void* address) noexcept
+      {
+#if defined(COLT_DETAILS_BACKTRACE_EXECINFO)
+        //glibc: 'binary(mangled+0x12) [0x...]', macOS: 'index binary 0x... mangled + 18'
+        if (symbol != nullptr)
+        {
+          const char* begin = std::strchr(symbol, '(');
+          const char* end = begin == nullptr ? nullptr : std::strchr(begin, '+');
+          if (begin != nullptr && end != nullptr && end != begin + 1)
+          {
+            char mangled[512];
+            const size_t length = std::min(static_cast<size_t>(end - begin - 1), sizeof(mangled) - 1);
+            std::memcpy(mangled, begin + 1, length);
+            mangled[length] = '\0';
+
+            int status = 0;
+            char* demangled = abi::__cxa_demangle(mangled, nullptr, nullptr, &status);
+            const char* name = (status == 0 && demangled != nullptr) ? demangled : mangled;
+            //';' separates the frames of folded stacks
+            for (; *name != '\0'; ++name)
+              std::fputc(*name == ';' ? ':' : *name, file);
+            std::free(demangled);
+            return;
+          }
+        }
+#else
+        (void)symbol;
+#endif
+        std::fprintf(file, "%p", address);
+      }
+    }
+
+    /// @brief Sets the mean count of bytes allocated between two samples.
+    /// Should be set before profiling, as the interval of each thread is only
+    /// redrawn at its next sample.
+    /// @param bytes The sample rate in bytes (non-zero)
+    inline void set_sample_rate(uint64_t bytes) noexcept
+    {
+      assert(bytes != 0 && "Sample rate cannot be 0!");
+      colt::details::get_alloc_profile().sample_rate.store(bytes, std::memory_order_relaxed);
+    }
+
+    /// @brief Returns the mean count of bytes allocated between two samples
+    /// @return The sample rate in bytes
+    inline uint64_t get_sample_rate() noexcept
+    {
+      return colt::details::get_alloc_profile().sample_rate.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Returns the count of samples recorded
+    /// @return The count of samples
+    inline uint64_t get_sample_count() noexcept
+    {
+      const uint64_t reserved = colt::details::get_alloc_profile().reserve_index.load(std::memory_order_relaxed);
+      return reserved < colt::details::AllocProfile::CAPACITY ? reserved : colt::details::AllocProfile::CAPACITY;
+    }
+
+    /// @brief Returns the count of samples dropped as the profile was full
+    /// @return The count of dropped samples
+    inline uint64_t get_dropped_count() noexcept
+    {
+      const uint64_t reserved = colt::details::get_alloc_profile().reserve_index.load(std::memory_order_relaxed);
+      return reserved > colt::details::AllocProfile::CAPACITY ? reserved - colt::details::AllocProfile::CAPACITY : 0;
+    }
+
+    /// @brief Writes the samples in the legacy pprof heap profile text format.
+    /// Only the allocation counters are filled (use '-sample_index=alloc_space'),
+    /// and pprof unsamples them using the sample rate written in the header.
+    /// On Linux, the mappings of the process are appended for symbolization.
+    /// @param file The file to which to write
+    /// @return True if the file was written successfully
+    inline bool write_pprof_heap(FILE* file) noexcept
+    {
+      auto groups = details::group_samples();
+      uint64_t total_count = 0;
+      uint64_t total_bytes = 0;
+      for (const auto& group : groups)
+      {
+        total_count += group.count;
+        total_bytes += group.bytes;
+      }
+
+      bool success = std::fprintf(file, "heap profile: 0: 0 [%llu: %llu] @ heap_v2/%llu\n",
+        static_cast<unsigned long long>(total_count), static_cast<unsigned long long>(total_bytes),
+        static_cast<unsigned long long>(get_sample_rate())) > 0;
+      for (const auto& group : groups)
+      {
+        std::fprintf(file, "0: 0 [%llu: %llu] @",
+          static_cast<unsigned long long>(group.count), static_cast<unsigned long long>(group.bytes));
+        for (uint32_t i = 0; i < group.sample->depth; i++)
+          std::fprintf(file, " %p", group.sample->frames[i]);
+        std::fputc('\n', file);
+      }
+
+#if defined(__linux__)
+      if (FILE* maps = std::fopen("/proc/self/maps", "rb"))
+      {
+        std::fputs("\nMAPPED_LIBRARIES:\n", file);
+        char buffer[4096];
+        size_t size;
+        while ((size = std::fread(buffer, 1, sizeof(buffer), maps)) != 0)
+          success &= std::fwrite(buffer, 1, size, file) == size;
+        std::fclose(maps);
+      }
+#endif
+      return success && !std::ferror(file) && std::fflush(file) == 0;
+    }
+
+    /// @brief Writes the samples as folded stacks: one line per stack trace,
+    /// the frames from the outermost separated by ';', followed by the estimated
+    /// count of bytes allocated through that stack trace.
+    /// Frames are named through the dynamic symbol table (link with '-rdynamic'):
+    /// frames that cannot be named are written as addresses.
+    /// @param file The file to which to write
+    /// @return True if the file was written successfully
+    inline bool write_folded_stacks(FILE* file) noexcept
+    {
+      auto groups = details::group_samples();
+      for (const auto& group : groups)
+      {
+        const auto* sample = group.sample;
+        char** symbols = nullptr;
+#if defined(COLT_DETAILS_BACKTRACE_EXECINFO)
+        if (sample->depth != 0)
+          symbols = backtrace_symbols(sample->frames, static_cast<int>(sample->depth));
+#endif
+        if (sample->depth == 0)
+          std::fputs("[unknown]", file);
+        for (uint32_t i = sample->depth; i != 0; i--)
+        {
+          details::write_frame_name(file, symbols == nullptr ? nullptr : symbols[i - 1], sample->frames[i - 1]);
+          if (i != 1)
+            std::fputc(';', file);
+        }
+        std::fprintf(file, " %llu\n", static_cast<unsigned long long>(group.estimated_bytes + 0.5));
+        std::free(symbols);
+      }
+      return !std::ferror(file) && std::fflush(file) == 0;
+    }
+
+    /// @brief Writes the samples in the legacy pprof heap profile text format to a file
+    /// @param path The path of the file to create or overwrite
+    /// @return True if the file was written successfully
+    inline bool write_pprof_heap(const char* path) noexcept
+    {
+      FILE* file = std::fopen(path, "wb");
+      if (file == nullptr)
+        return false;
+      const bool success = write_pprof_heap(file);
+      return (std::fclose(file) == 0) && success;
+    }
+
+    /// @brief Writes the samples as folded stacks to a file
+    /// @param path The path of the file to create or overwrite
+    /// @return True if the file was written successfully
+    inline bool write_folded_stacks(const char* path) noexcept
+    {
+      FILE* file = std::fopen(path, "wb");
+      if (file == nullptr)
+        return false;
+      const bool success = write_folded_stacks(file);
+      return (std::fclose(file) == 0) && success;
+    }
+  }
+}
+
+#endif //!HG_COLT_ALLOC_PROFILER_WRITER
@@ -0,0 +1,324 @@
+/** @file FileLoader.h
+* Contains 'load_files', which loads the content of many files at once.
+* On Linux, the opens, statx, reads and closes of all the files are submitted
+* through io_uring (see 'details/io_uring.h'): a fixed count of files are in
+* flight at any time, which keeps the disk queue full while amortizing the cost
+* of system calls over many operations.
+* If io_uring (or one of the operations used) is not supported, the files are
+* loaded through blocking reads on multiple threads (see 'Parallel.h').
+*/
+
+#ifndef HG_COLT_FILE_LOADER
+#define HG_COLT_FILE_LOADER
+
+#include <cstdio>
+#include <iterator>
+
+#include "../data_structs/String.h"
+#include "../details/io_uring.h"
+#include "Parallel.h"
+
+#ifdef COLT_DETAILS_IO_URING
+  #include <fcntl.h>
+  #include <sys/stat.h>
+  #ifdef STATX_SIZE
+    /// @brief load_files can use io_uring
+    #define COLT_DETAILS_FILE_LOADER_IO_URING
+  #endif
+#endif
+
+namespace colt
+{
+  namespace details
+  {
+    /// @brief Loads the content of a file through blocking reads.
+    /// Returns StringError::INVALID_PATH if the file could not be opened.
+    /// Returns StringError::CANNOT_READ_ALL if a read failed.
+    /// Returns StringError::EOF_HIT if the file is empty.
+    /// @param path The NUL terminated path of the file
+    /// @return String containing the content of the file or StringError
+    inline Expected<String, StringError> load_file_blocking(const char* path) noexcept
+    {
+      FILE* file = std::fopen(path, "rb");
+      if (file == nullptr)
+        return { Error, StringError::INVALID_PATH };
+
+      String content;
+      char buffer[16384];
+      size_t read;
+      while ((read = std::fread(buffer, 1, sizeof(buffer), file)) != 0)
+      {
+        const size_t old_size = content.get_size();
+        content.push_back_n(read, '\0');
+        std::memcpy(content.get_data() + old_size, buffer, read);
+      }
+      const bool is_error = std::ferror(file) != 0;
+      std::fclose(file);
+
+      if (is_error)
+        return { Error, StringError::CANNOT_READ_ALL };
+      if (content.is_empty())
+        return { Error, StringError::EOF_HIT };
+      return content;
+    }
+
+    /// @brief Loads the content of files through blocking reads on multiple threads
+    /// @param paths The paths of the files
+    /// @param results The results, of the same size as 'paths'
+    /// @param thread_count The count of threads
+    inline void load_files_threaded(ContiguousView<StringView> paths,
+      Vector<Expected<String, StringError>>& results, size_t thread_count) noexcept
+    {
+      parallel_for(paths.get_size(), [&](size_t i)
+        {
+          String path = String{ paths[i] };
+          results[i] = load_file_blocking(path.c_str());
+        }, 1, thread_count);
+    }
+
+#ifdef COLT_DETAILS_FILE_LOADER_IO_URING
+    /// @brief A file being loaded through io_uring
+    struct FileLoadSlot
+    {
+      /// @brief The operation in flight for the file
+      enum Stage : u8
+      {
+        OPEN, STATX, READ, CLOSE
+      };
+
+      /// @brief The index of the file in the paths
+      size_t index;
+      /// @brief The NUL terminated path of the file
+      String path;
+      /// @brief The content of the file
+      String content;
+      /// @brief The count of bytes read
+      size_t offset;
+      /// @brief The result of the statx operation
+      struct statx stat;
+      /// @brief The file descriptor of the file
+      int fd;
+      /// @brief The operation in flight
+      Stage stage;
+      /// @brief True if the error must be returned instead of the content
+      bool is_error;
+      /// @brief True if the file must be loaded through blocking reads (its size is unknown)
+      bool is_deferred;
+      /// @brief The error to return if 'is_error'
+      StringError error;
+    };
+
+    /// @brief Fills the submission entry of the operation of 'slot' in flight
+    /// @param sqe The submission entry
+    /// @param slot The file
+    /// @param slot_index The index of the slot (used as user data)
+    inline void prepare_file_load(io_uring_sqe* sqe, FileLoadSlot& slot, size_t slot_index) noexcept
+    {
+      //A single read cannot exceed 2GB
+      constexpr size_t MAX_READ = 1 << 30;
+
+      sqe->user_data = slot_index;
+      switch (slot.stage)
+      {
+      case FileLoadSlot::OPEN:
+        sqe->opcode = IORING_OP_OPENAT;
+        sqe->fd = AT_FDCWD;
+        sqe->addr = reinterpret_cast<uintptr_t>(slot.path.c_str());
+        sqe->open_flags = O_RDONLY | O_CLOEXEC;
+        break;
+      case FileLoadSlot::STATX:
+        sqe->opcode = IORING_OP_STATX;
+        sqe->fd = slot.fd;
+        sqe->addr = reinterpret_cast<uintptr_t>("");
+        sqe->len = STATX_SIZE;
+        sqe->statx_flags = AT_EMPTY_PATH;
+        sqe->off = reinterpret_cast<uintptr_t>(&slot.stat);
+        break;
+      case FileLoadSlot::READ:
+      {
+        const size_t remaining = slot.content.get_size() - slot.offset;
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = slot.fd;
+        sqe->addr = reinterpret_cast<uintptr_t>(slot.content.get_data() + slot.offset);
+        sqe->len = static_cast<u32>(remaining < MAX_READ ? remaining : MAX_READ);
+        sqe->off = slot.offset;
+        break;
+      }
+      case FileLoadSlot::CLOSE:
+        sqe->opcode = IORING_OP_CLOSE;
+        sqe->fd = slot.fd;
+        break;
+      }
+    }
+
+    /// @brief Advances a file to its next operation using the result of the completed one
+    /// @param slot The file
+    /// @param result The result of the completed operation
+    /// @return False if the file was fully loaded (the slot can be reused)
+    inline bool advance_file_load(FileLoadSlot& slot, int result) noexcept
+    {
+      switch (slot.stage)
+      {
+      case FileLoadSlot::OPEN:
+        if (result < 0)
+        {
+          slot.is_error = true;
+          slot.error = StringError::INVALID_PATH;
+          return false;
+        }
+        slot.fd = result;
+        slot.stage = FileLoadSlot::STATX;
+        return true;
+      case FileLoadSlot::STATX:
+        slot.stage = FileLoadSlot::CLOSE;
+        if (result < 0)
+        {
+          slot.is_error = true;
+          slot.error = StringError::CANNOT_READ_ALL;
+        }
+        //Empty files and special files (procfs...) report a size of 0
+        else if (slot.stat.stx_size == 0)
+          slot.is_deferred = true;
+        else
+        {
+          slot.content.push_back_n(static_cast<size_t>(slot.stat.stx_size), '\0');
+          slot.stage = FileLoadSlot::READ;
+        }
+        return true;
+      case FileLoadSlot::READ:
+        if (result == -EINTR || result == -EAGAIN)
+          return true;
+        if (result < 0)
+        {
+          slot.is_error = true;
+          slot.error = StringError::CANNOT_READ_ALL;
+          slot.stage = FileLoadSlot::CLOSE;
+          return true;
+        }
+        slot.offset += static_cast<size_t>(result);
+        //The file was truncated since statx
+        if (result == 0)
+          slot.content.pop_back_n(slot.content.get_size() - slot.offset);
+        if (slot.offset == slot.content.get_size())
+          slot.stage = FileLoadSlot::CLOSE;
+        return true;
+      case FileLoadSlot::CLOSE:
+        return false;
+      }
+      return false;
+    }
+
+    /// @brief Loads the content of files through io_uring.
+    /// Files whose size is reported as 0 are loaded through blocking reads afterwards.
+    /// @param paths The paths of the files
+    /// @param results The results, of the same size as 'paths'
+    /// @param queue_depth The count of files in flight
+    /// @return False if io_uring cannot be used (the results must then be loaded again)
+    inline bool load_files_io_uring(ContiguousView<StringView> paths,
+      Vector<Expected<String, StringError>>& results, size_t queue_depth) noexcept
+    {
+      static constexpr uint8_t OPCODES[] = { IORING_OP_OPENAT, IORING_OP_STATX, IORING_OP_READ, IORING_OP_CLOSE };
+      queue_depth = queue_depth == 0 ? 1 : (queue_depth > 4096 ? 4096 : queue_depth);
+
+      IoUring ring;
+      if (!ring.init(static_cast<unsigned>(queue_depth), OPCODES, std::size(OPCODES)))
+        return false;
+
+      //Each file in flight has exactly one operation in flight: the submission
+      //ring can never be full, and the completion ring (twice as big) cannot overflow.
+      //The slots are not freed if the ring fails, as the kernel may still write to them.
+      const size_t slot_count = ring.get_entry_count();
+      memory::TypedBlock<FileLoadSlot> slots = memory::allocate({ slot_count * sizeof(FileLoadSlot) });
+      Vector<size_t> free_slots = Vector<size_t>(slot_count);
+      for (size_t i = slot_count; i != 0; i--)
+      {
+        new(slots.get_ptr() + (i - 1)) FileLoadSlot();
+        free_slots.push_back(i - 1);
+      }
+      Vector<size_t> deferred;
+
+      size_t next_file = 0;
+      while (next_file < paths.get_size() || free_slots.get_size() != slot_count)
+      {
+        for (; next_file < paths.get_size() && free_slots.is_not_empty(); ++next_file)
+        {
+          const size_t slot_index = free_slots.get_back();
+          free_slots.pop_back();
+          FileLoadSlot& slot = slots.get_ptr()[slot_index];
+          slot.index = next_file;
+          slot.path.clear();
+          slot.path.append(paths[next_file]);
+          slot.content.clear();
+          slot.offset = 0;
+          slot.fd = -1;
+          slot.stage = FileLoadSlot::OPEN;
+          slot.is_error = false;
+          slot.is_deferred = false;
+          prepare_file_load(ring.get_sqe(), slot, slot_index);
+        }
+
+        const int submitted = ring.submit_and_wait(1);
+        if (submitted == -EAGAIN || submitted == -EBUSY)
+          continue;
+        if (submitted < 0)
+          return false;
+
+        ring.for_each_cqe([&](const io_uring_cqe& cqe)
+          {
+            const size_t slot_index = static_cast<size_t>(cqe.user_data);
+            FileLoadSlot& slot = slots.get_ptr()[slot_index];
+            if (advance_file_load(slot, cqe.res))
+            {
+              prepare_file_load(ring.get_sqe(), slot, slot_index);
+              return;
+            }
+            if (slot.is_deferred)
+              deferred.push_back(slot.index);
+            else if (slot.is_error)
+              results[slot.index] = { Error, slot.error };
+            else
+              results[slot.index] = std::move(slot.content);
+            free_slots.push_back(slot_index);
+          });
+      }
+
+      for (size_t i = 0; i < slot_count; i++)
+        slots.get_ptr()[i].~FileLoadSlot();
+      memory::deallocate(slots);
+
+      for (auto index : deferred)
+      {
+        String path = String{ paths[index] };
+        results[index] = load_file_blocking(path.c_str());
+      }
+      return true;
+    }
+#endif
+  }
+
+  /// @brief Loads the content of multiple files.
+  /// The result of each file is the same as the one of String::getFileContent:
+  /// StringError::INVALID_PATH if the file could not be opened, StringError::CANNOT_READ_ALL
+  /// if a read failed, StringError::EOF_HIT if the file is empty.
+  /// On Linux, all the operations are submitted through io_uring, else (or if io_uring
+  /// is not supported by the kernel) the files are read on multiple threads.
+  /// @param paths The paths of the files
+  /// @param queue_depth The count of files loaded concurrently
+  /// @return The content of each file (or the error), in the order of 'paths'
+  inline Vector<Expected<String, StringError>> load_files(ContiguousView<StringView> paths, size_t queue_depth = 64) noexcept
+  {
+    if (paths.is_empty())
+      return {};
+    Vector<Expected<String, StringError>> results = Vector<Expected<String, StringError>>(paths.get_size(), InPlace);
+#ifdef COLT_DETAILS_FILE_LOADER_IO_URING
+    if (details::load_files_io_uring(paths, results, queue_depth))
+      return results;
+#endif
+    //Blocking reads: the threads mostly wait for the disk
+    const size_t thread_count = get_default_thread_count() * 4;
+    details::load_files_threaded(paths, results, thread_count < queue_depth ? thread_count : queue_depth);
+    return results;
+  }
+}
+
+#endif //!HG_COLT_FILE_LOADER
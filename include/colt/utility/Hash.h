@@ -21,6 +21,8 @@
 #include <cstdint>
 #include <type_traits>
 #include <utility>
+#include <random>
+#include <atomic>
 
 #include "../details/common.h"
 #include "../utility/Typedefs.h"
@@ -390,6 +392,264 @@ namespace colt
       return seed;
     }
   };
+
+  template<typename T>
+  /// @brief The default Hasher of the hash tables, which hashes through GetHash
+  /// @tparam T The type to hash
+  struct DefaultHash
+  {
+    /// @brief Hashing operator
+    /// @param obj The object to hash
+    /// @return Hash
+    size_t operator()(const T& obj) const noexcept { return GetHash(obj); }
+  };
+
+  template<typename T>
+  /// @brief The default KeyEqual of the hash tables, which compares through operator==
+  /// @tparam T The type to compare
+  struct DefaultEqual
+  {
+    /// @brief Comparison operator
+    /// @param a The first object
+    /// @param b The second object
+    /// @return True if 'a == b'
+    bool operator()(const T& a, const T& b) const noexcept { return a == b; }
+  };
+
+  /// @brief Hasher returning integer keys as is.
+  /// Only use for keys that already are hashes: the hash tables use the
+  /// lowest bits of the hash to pick the slots.
+  struct IdentityHash
+  {
+    template<typename T>
+    /// @brief Hashing operator
+    /// @tparam T The integral type
+    /// @param value The value to return
+    /// @return The value converted to size_t
+    constexpr size_t operator()(T value) const noexcept
+    {
+      static_assert(std::is_integral_v<T> || std::is_enum_v<T>, "IdentityHash only supports integral keys!");
+      return static_cast<size_t>(value);
+    }
+  };
+
+  /// @brief Cheap Hasher for trusted integer keys (a single multiplication).
+  /// Every bit of the key affects the lowest bits of the hash, which the
+  /// hash tables use, so keys differing only in their high bits do not collide.
+  /// Keys controlled by an attacker can easily collide: use SeededHash for these.
+  struct FastIntHash
+  {
+    template<typename T>
+    /// @brief Hashing operator
+    /// @tparam T The integral type
+    /// @param value The value to hash
+    /// @return Hash
+    constexpr size_t operator()(T value) const noexcept
+    {
+      static_assert(std::is_integral_v<T> || std::is_enum_v<T>, "FastIntHash only supports integral keys!");
+      //A multiplication only propagates bits upward: the high bits of the key are
+      //folded first (else multiples of 2^40 would share their lowest 8 bits),
+      //then the high bits of the product are folded as the tables use the lowest bits.
+      uint64_t x = static_cast<uint64_t>(value);
+      x = (x ^ (x >> 32)) * 0x9E3779B97F4A7C15ULL;
+      return static_cast<size_t>(x ^ (x >> 32));
+    }
+  };
+
+  namespace traits
+  {
+    template<typename T, typename = std::void_t<>>
+    /// @brief Check if a type is a contiguous range of characters (through 'get_data' and 'get_size')
+    /// @tparam T The type to check for
+    /// @tparam  SFINAE helper
+    struct is_char_range
+    {
+      static constexpr bool value = false;
+    };
+
+    template<typename T>
+    /// @brief Check if a type is a contiguous range of characters (through 'get_data' and 'get_size')
+    /// @tparam T The type to check for
+    /// @tparam  SFINAE helper
+    struct is_char_range<T, std::void_t<decltype(std::declval<const T&>().get_data()), decltype(std::declval<const T&>().get_size())>>
+    {
+      static constexpr bool value = std::is_convertible_v<decltype(std::declval<const T&>().get_data()), const char*>;
+    };
+
+    template<typename T>
+    /// @brief Short hand for is_char_range<T>::value
+    /// @tparam T The type to check for
+    constexpr bool is_char_range_v = is_char_range<T>::value;
+  }
+
+  namespace details
+  {
+    /// @brief Applies a SipRound to the state of SipHash
+    /// @param v The state
+    constexpr void sip_round(uint64_t (&v)[4]) noexcept
+    {
+      v[0] += v[1]; v[1] = rotl(v[1], 13); v[1] ^= v[0]; v[0] = rotl(v[0], 32);
+      v[2] += v[3]; v[3] = rotl(v[3], 16); v[3] ^= v[2];
+      v[0] += v[3]; v[3] = rotl(v[3], 21); v[3] ^= v[0];
+      v[2] += v[1]; v[1] = rotl(v[1], 17); v[1] ^= v[2]; v[2] = rotl(v[2], 32);
+    }
+
+    template<unsigned c_rounds = 1, unsigned d_rounds = 3>
+    /// @brief Computes the SipHash-c-d of bytes (SipHash-1-3 by default)
+    /// @tparam c_rounds The count of rounds per message block
+    /// @tparam d_rounds The count of finalization rounds
+    /// @param data The bytes to hash
+    /// @param size The count of bytes
+    /// @param k0 The first half of the key
+    /// @param k1 The second half of the key
+    /// @return The hash
+    inline uint64_t siphash(const void* data, size_t size, uint64_t k0, uint64_t k1) noexcept
+    {
+      uint64_t v[4] = { 0x736f6d6570736575ULL ^ k0, 0x646f72616e646f6dULL ^ k1, 0x6c7967656e657261ULL ^ k0, 0x7465646279746573ULL ^ k1 };
+      const auto bytes = static_cast<const uint8_t*>(data);
+      const size_t end = size - size % 8;
+      for (size_t i = 0; i < end; i += 8)
+      {
+        uint64_t m = 0;
+        for (size_t j = 0; j < 8; j++)
+          m |= static_cast<uint64_t>(bytes[i + j]) << (8 * j);
+        v[3] ^= m;
+        for (unsigned r = 0; r < c_rounds; r++)
+          sip_round(v);
+        v[0] ^= m;
+      }
+      uint64_t last = static_cast<uint64_t>(size) << 56;
+      for (size_t j = 0; j < size % 8; j++)
+        last |= static_cast<uint64_t>(bytes[end + j]) << (8 * j);
+      v[3] ^= last;
+      for (unsigned r = 0; r < c_rounds; r++)
+        sip_round(v);
+      v[0] ^= last;
+      v[2] ^= 0xff;
+      for (unsigned r = 0; r < d_rounds; r++)
+        sip_round(v);
+      return v[0] ^ v[1] ^ v[2] ^ v[3];
+    }
+
+    /// @brief Returns a new random key for SeededHash
+    /// @return Pair of the two halves of the key
+    inline std::pair<uint64_t, uint64_t> new_hash_seed() noexcept
+    {
+      //The random device is only read once: each key differs through a counter
+      static const std::pair<uint64_t, uint64_t> process_seed = []()
+        {
+          std::random_device device;
+          const uint64_t a = (static_cast<uint64_t>(device()) << 32) | device();
+          const uint64_t b = (static_cast<uint64_t>(device()) << 32) | device();
+          return std::pair<uint64_t, uint64_t>{ a, b };
+        }();
+      static std::atomic<uint64_t> counter = 0;
+      const uint64_t count = counter.fetch_add(1, std::memory_order_relaxed);
+      return { process_seed.first ^ distribute(count), process_seed.second + count };
+    }
+  }
+
+  /// @brief Keyed Hasher (SipHash-1-3) resisting collision floods from untrusted keys.
+  /// Each default constructed SeededHash draws a different random key, so that collisions
+  /// cannot be precomputed. Integral keys and ranges of characters (String, StringView...)
+  /// hash their bytes; other keys hash the result of GetHash, which is only as resistant
+  /// as GetHash is injective for these keys.
+  struct SeededHash
+  {
+    /// @brief The first half of the key
+    uint64_t k0;
+    /// @brief The second half of the key
+    uint64_t k1;
+
+    /// @brief Constructs a SeededHash with a random key
+    SeededHash() noexcept
+    {
+      auto seed = details::new_hash_seed();
+      k0 = seed.first;
+      k1 = seed.second;
+    }
+
+    /// @brief Constructs a SeededHash with a known key (for reproducibility)
+    /// @param k0 The first half of the key
+    /// @param k1 The second half of the key
+    constexpr SeededHash(uint64_t k0, uint64_t k1) noexcept
+      : k0(k0), k1(k1) {}
+
+    template<typename T>
+    /// @brief Hashing operator
+    /// @tparam T The type to hash
+    /// @param obj The object to hash
+    /// @return Hash
+    size_t operator()(const T& obj) const noexcept
+    {
+      if constexpr (traits::is_char_range_v<T>)
+        return static_cast<size_t>(details::siphash(obj.get_data(), obj.get_size(), k0, k1));
+      else
+      {
+        uint64_t value;
+        if constexpr (std::is_integral_v<T> || std::is_enum_v<T>)
+          value = static_cast<uint64_t>(obj);
+        else
+          value = static_cast<uint64_t>(GetHash(obj));
+        return static_cast<size_t>(details::siphash(&value, sizeof(value), k0, k1));
+      }
+    }
+  };
+
+  namespace details
+  {
+    /// @brief Converts an ASCII character to lower case
+    /// @param chr The character to convert
+    /// @return The lower case character
+    constexpr char ascii_to_lower(char chr) noexcept
+    {
+      return (chr >= 'A' && chr <= 'Z') ? static_cast<char>(chr - 'A' + 'a') : chr;
+    }
+  }
+
+  /// @brief Hasher of ranges of characters ignoring the case of ASCII letters.
+  /// Use with CaseInsensitiveEqual.
+  struct CaseInsensitiveHash
+  {
+    template<typename T>
+    /// @brief Hashing operator
+    /// @tparam T The range of characters
+    /// @param str The characters to hash
+    /// @return Hash
+    constexpr size_t operator()(const T& str) const noexcept
+    {
+      static_assert(traits::is_char_range_v<T>, "CaseInsensitiveHash only supports ranges of characters!");
+      const char* data = str.get_data();
+      uint64_t hash = 0xCBF29CE484222325;
+      for (size_t i = 0; i < str.get_size(); i++)
+      {
+        hash ^= static_cast<uint8_t>(details::ascii_to_lower(data[i]));
+        hash *= 0x100000001B3; //FNV prime
+      }
+      return static_cast<size_t>(details::distribute(hash));
+    }
+  };
+
+  /// @brief KeyEqual of ranges of characters ignoring the case of ASCII letters
+  struct CaseInsensitiveEqual
+  {
+    template<typename T>
+    /// @brief Comparison operator
+    /// @tparam T The range of characters
+    /// @param a The first characters
+    /// @param b The second characters
+    /// @return True if both are equal ignoring the case of ASCII letters
+    constexpr bool operator()(const T& a, const T& b) const noexcept
+    {
+      static_assert(traits::is_char_range_v<T>, "CaseInsensitiveEqual only supports ranges of characters!");
+      if (a.get_size() != b.get_size())
+        return false;
+      for (size_t i = 0; i < a.get_size(); i++)
+        if (details::ascii_to_lower(a.get_data()[i]) != details::ascii_to_lower(b.get_data()[i]))
+          return false;
+      return true;
+    }
+  };
 }
 
-#endif //!HG_COLT_HASH
\ No newline at end of file
+#endif //!HG_COLT_HASH
@@ -0,0 +1,342 @@
+/** @file Histogram.h
+* Contains LatencyHistogram, a fixed-memory histogram of 64-bit values
+* (usually latencies in nanoseconds) inspired by HdrHistogram.
+* Values are recorded in log-linear buckets: each power of 2 is divided in
+* 2^sub_bucket_bits linear buckets, which bounds the relative error of
+* the reported values by 1 / 2^sub_bucket_bits (3.1% by default).
+* Recording is O(1) and does not allocate, which makes the histogram usable
+* on hot paths: use one histogram per thread and merge them afterwards.
+*/
+
+#ifndef HG_COLT_HISTOGRAM
+#define HG_COLT_HISTOGRAM
+
+#include "../details/bits.h"
+#include "../data_structs/Vector.h"
+#include "../data_structs/Expected.h"
+
+namespace colt
+{
+  /// @brief The errors that can happen while deserializing a LatencyHistogram
+  enum class HistogramError
+    : uint8_t
+  {
+    /// @brief The serialized data ended unexpectedly
+    TRUNCATED,
+    /// @brief The serialized histogram has a different precision
+    INVALID_PRECISION,
+    /// @brief The serialized data is not a valid histogram
+    INVALID_DATA
+  };
+
+  template<unsigned sub_bucket_bits = 5>
+  /// @brief Fixed-memory log-linear histogram of 64-bit values.
+  /// The memory used is (65 - sub_bucket_bits) * 2^sub_bucket_bits counters.
+  /// @tparam sub_bucket_bits The log2 of the count of linear buckets per power of 2
+  class LatencyHistogram
+  {
+    static_assert(sub_bucket_bits >= 1 && sub_bucket_bits <= 12, "Invalid precision!");
+
+  public:
+    /// @brief The count of linear buckets per power of 2
+    static constexpr size_t SUB_BUCKET_COUNT = size_t(1) << sub_bucket_bits;
+    /// @brief The total count of buckets
+    static constexpr size_t BUCKET_COUNT = (65 - sub_bucket_bits) * SUB_BUCKET_COUNT;
+
+  private:
+    /// @brief The count of values in each bucket
+    u64 counts[BUCKET_COUNT] = {};
+    /// @brief The count of values recorded
+    u64 total_count = 0;
+    /// @brief The smallest value recorded
+    u64 min_value = std::numeric_limits<u64>::max();
+    /// @brief The greatest value recorded
+    u64 max_value = 0;
+    /// @brief The sum of the values recorded (wraps on overflow)
+    u64 value_sum = 0;
+
+  public:
+    /// @brief Constructs an empty histogram
+    constexpr LatencyHistogram() noexcept = default;
+
+    /// @brief Returns the index of the bucket containing 'value'
+    /// @param value The value whose bucket to return
+    /// @return The index of the bucket
+    static size_t get_bucket_index(u64 value) noexcept;
+
+    /// @brief Returns the smallest value of the bucket at index 'index'
+    /// @param index The index of the bucket
+    /// @return The smallest value that is recorded in that bucket
+    static u64 get_bucket_lower_bound(size_t index) noexcept;
+
+    /// @brief Returns the greatest value of the bucket at index 'index'
+    /// @param index The index of the bucket
+    /// @return The greatest value that is recorded in that bucket
+    static u64 get_bucket_upper_bound(size_t index) noexcept;
+
+    /// @brief Records a value
+    /// @param value The value to record
+    void record(u64 value) noexcept { record(value, 1); }
+
+    /// @brief Records a value 'count' times
+    /// @param value The value to record
+    /// @param count The count of times to record 'value'
+    void record(u64 value, u64 count) noexcept;
+
+    /// @brief Adds all the values recorded by another histogram
+    /// @param other The histogram to merge
+    void merge(const LatencyHistogram& other) noexcept;
+
+    /// @brief Removes all the recorded values
+    void clear() noexcept;
+
+    /// @brief Returns the count of values recorded
+    /// @return The count of values
+    u64 get_count() const noexcept { return total_count; }
+    /// @brief Check if no values were recorded
+    /// @return True if the histogram is empty
+    bool is_empty() const noexcept { return total_count == 0; }
+    /// @brief Returns the smallest value recorded (exact)
+    /// @return The smallest value or 0 if empty
+    u64 get_min() const noexcept { return total_count == 0 ? 0 : min_value; }
+    /// @brief Returns the greatest value recorded (exact)
+    /// @return The greatest value or 0 if empty
+    u64 get_max() const noexcept { return max_value; }
+    /// @brief Returns the mean of the values recorded (exact unless the sum overflowed)
+    /// @return The mean or 0 if empty
+    double get_mean() const noexcept;
+
+    /// @brief Returns the count of values recorded in a bucket
+    /// @param index The index of the bucket
+    /// @return The count of values in that bucket
+    u64 get_bucket_count(size_t index) const noexcept { assert(index < BUCKET_COUNT); return counts[index]; }
+
+    /// @brief Returns the value below or at which 'percentile' percent of the values are.
+    /// The returned value is the greatest value of the bucket containing the
+    /// percentile, clamped to the recorded range.
+    /// @param percentile The percentile (in [0, 100])
+    /// @return The value at the percentile, or 0 if empty
+    u64 get_percentile(double percentile) const noexcept;
+
+    /// @brief Serializes the histogram in a compact format appended to 'out'.
+    /// Only the non-empty buckets are written, as varints.
+    /// @param out The Vector to which to append the serialized histogram
+    void serialize(Vector<u8>& out) const noexcept;
+
+    /// @brief Deserializes a histogram serialized through 'serialize'
+    /// @param data The serialized histogram
+    /// @return The histogram or an error
+    static Expected<LatencyHistogram, HistogramError> deserialize(ContiguousView<u8> data) noexcept;
+  };
+
+  namespace details
+  {
+    /// @brief Appends 'value' as a LEB128 varint
+    /// @param out The Vector to which to append
+    /// @param value The value to write
+    inline void write_varint(Vector<u8>& out, u64 value) noexcept
+    {
+      while (value >= 0x80)
+      {
+        out.push_back(static_cast<u8>(value | 0x80));
+        value >>= 7;
+      }
+      out.push_back(static_cast<u8>(value));
+    }
+
+    /// @brief Reads a LEB128 varint
+    /// @param data The data from which to read
+    /// @param offset The offset of the varint, which is advanced past it
+    /// @param value Where to write the value read
+    /// @return False if the data is truncated or the varint is invalid
+    inline bool read_varint(ContiguousView<u8> data, size_t& offset, u64& value) noexcept
+    {
+      value = 0;
+      for (unsigned shift = 0; shift < 64; shift += 7)
+      {
+        if (offset == data.get_size())
+          return false;
+        const u8 byte = data[offset++];
+        value |= static_cast<u64>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+          return true;
+      }
+      return false;
+    }
+  }
+
+  template<unsigned sub_bucket_bits>
+  size_t LatencyHistogram<sub_bucket_bits>::get_bucket_index(u64 value) noexcept
+  {
+    //Values smaller than 2 * SUB_BUCKET_COUNT have their own bucket
+    if (value < 2 * SUB_BUCKET_COUNT)
+      return static_cast<size_t>(value);
+    //Shifting by 'exponent' keeps the 'sub_bucket_bits + 1' highest bits of value
+    const unsigned exponent = details::bit_width(value) - sub_bucket_bits - 1;
+    return static_cast<size_t>(exponent) * SUB_BUCKET_COUNT + static_cast<size_t>(value >> exponent);
+  }
+
+  template<unsigned sub_bucket_bits>
+  u64 LatencyHistogram<sub_bucket_bits>::get_bucket_lower_bound(size_t index) noexcept
+  {
+    assert(index < BUCKET_COUNT && "Invalid bucket index!");
+    if (index < 2 * SUB_BUCKET_COUNT)
+      return index;
+    const size_t exponent = index / SUB_BUCKET_COUNT - 1;
+    const u64 mantissa = index % SUB_BUCKET_COUNT + SUB_BUCKET_COUNT;
+    return mantissa << exponent;
+  }
+
+  template<unsigned sub_bucket_bits>
+  u64 LatencyHistogram<sub_bucket_bits>::get_bucket_upper_bound(size_t index) noexcept
+  {
+    assert(index < BUCKET_COUNT && "Invalid bucket index!");
+    if (index < 2 * SUB_BUCKET_COUNT)
+      return index;
+    const size_t exponent = index / SUB_BUCKET_COUNT - 1;
+    return get_bucket_lower_bound(index) + (u64(1) << exponent) - 1;
+  }
+
+  template<unsigned sub_bucket_bits>
+  void LatencyHistogram<sub_bucket_bits>::record(u64 value, u64 count) noexcept
+  {
+    counts[get_bucket_index(value)] += count;
+    total_count += count;
+    value_sum += value * count;
+    min_value = value < min_value ? value : min_value;
+    max_value = value > max_value ? value : max_value;
+  }
+
+  template<unsigned sub_bucket_bits>
+  void LatencyHistogram<sub_bucket_bits>::merge(const LatencyHistogram& other) noexcept
+  {
+    for (size_t i = 0; i < BUCKET_COUNT; i++)
+      counts[i] += other.counts[i];
+    total_count += other.total_count;
+    value_sum += other.value_sum;
+    min_value = other.min_value < min_value ? other.min_value : min_value;
+    max_value = other.max_value > max_value ? other.max_value : max_value;
+  }
+
+  template<unsigned sub_bucket_bits>
+  void LatencyHistogram<sub_bucket_bits>::clear() noexcept
+  {
+    std::memset(counts, 0, sizeof(counts));
+    total_count = 0;
+    min_value = std::numeric_limits<u64>::max();
+    max_value = 0;
+    value_sum = 0;
+  }
+
+  template<unsigned sub_bucket_bits>
+  double LatencyHistogram<sub_bucket_bits>::get_mean() const noexcept
+  {
+    if (total_count == 0)
+      return 0.0;
+    return static_cast<double>(value_sum) / static_cast<double>(total_count);
+  }
+
+  template<unsigned sub_bucket_bits>
+  u64 LatencyHistogram<sub_bucket_bits>::get_percentile(double percentile) const noexcept
+  {
+    assert(0.0 <= percentile && percentile <= 100.0 && "Invalid percentile!");
+    if (total_count == 0)
+      return 0;
+
+    //Nearest-rank: the smallest value such that at least 'percentile' percent are below or at it
+    u64 rank = static_cast<u64>(percentile / 100.0 * static_cast<double>(total_count) + 0.5);
+    rank = rank == 0 ? 1 : (rank > total_count ? total_count : rank);
+
+    u64 seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; i++)
+    {
+      seen += counts[i];
+      if (seen >= rank)
+      {
+        const u64 value = get_bucket_upper_bound(i);
+        if (value > max_value)
+          return max_value;
+        return value < min_value ? min_value : value;
+      }
+    }
+    return max_value;
+  }
+
+  template<unsigned sub_bucket_bits>
+  void LatencyHistogram<sub_bucket_bits>::serialize(Vector<u8>& out) const noexcept
+  {
+    //Header: precision, min, max, sum and count of non-empty buckets
+    size_t non_empty = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; i++)
+      non_empty += counts[i] != 0;
+    details::write_varint(out, sub_bucket_bits);
+    details::write_varint(out, get_min());
+    details::write_varint(out, max_value);
+    details::write_varint(out, value_sum);
+    details::write_varint(out, non_empty);
+
+    //Each non-empty bucket: the gap since the previous one, then its count
+    size_t previous = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; i++)
+    {
+      if (counts[i] == 0)
+        continue;
+      details::write_varint(out, i - previous);
+      details::write_varint(out, counts[i]);
+      previous = i;
+    }
+  }
+
+  template<unsigned sub_bucket_bits>
+  Expected<LatencyHistogram<sub_bucket_bits>, HistogramError> LatencyHistogram<sub_bucket_bits>::deserialize(ContiguousView<u8> data) noexcept
+  {
+    size_t offset = 0;
+    u64 precision, min, max, sum, non_empty;
+    if (!details::read_varint(data, offset, precision))
+      return { Error, HistogramError::TRUNCATED };
+    if (precision != sub_bucket_bits)
+      return { Error, HistogramError::INVALID_PRECISION };
+    if (!details::read_varint(data, offset, min)
+      || !details::read_varint(data, offset, max)
+      || !details::read_varint(data, offset, sum)
+      || !details::read_varint(data, offset, non_empty))
+      return { Error, HistogramError::TRUNCATED };
+    if (non_empty > BUCKET_COUNT)
+      return { Error, HistogramError::INVALID_DATA };
+
+    LatencyHistogram histogram;
+    size_t index = 0;
+    for (u64 i = 0; i < non_empty; i++)
+    {
+      u64 gap, count;
+      if (!details::read_varint(data, offset, gap) || !details::read_varint(data, offset, count))
+        return { Error, HistogramError::TRUNCATED };
+      if (gap >= BUCKET_COUNT - index || (i != 0 && gap == 0) || count == 0)
+        return { Error, HistogramError::INVALID_DATA };
+      index += static_cast<size_t>(gap);
+      histogram.counts[index] = count;
+      histogram.total_count += count;
+    }
+    if (histogram.total_count != 0)
+      histogram.min_value = min;
+    histogram.max_value = max;
+    histogram.value_sum = sum;
+    return histogram;
+  }
+
+#ifdef COLT_USE_IOSTREAMS
+
+  template<unsigned sub_bucket_bits>
+  static std::ostream& operator<<(std::ostream& os, const LatencyHistogram<sub_bucket_bits>& var) noexcept
+  {
+    os << "{ count: " << var.get_count() << ", min: " << var.get_min()
+      << ", p50: " << var.get_percentile(50.0) << ", p90: " << var.get_percentile(90.0)
+      << ", p99: " << var.get_percentile(99.0) << ", p99.9: " << var.get_percentile(99.9)
+      << ", max: " << var.get_max() << " }";
+    return os;
+  }
+
+#endif
+}
+
+#endif //!HG_COLT_HISTOGRAM
@@ -0,0 +1,82 @@
+/** @file Parallel.h
+* Contains helpers to run work on multiple threads.
+* Threads are created on each call (there is no persistent pool): the helpers
+* are meant for coarse work (loading files, building or scanning large tables)
+* for which the cost of creating a thread is negligible.
+* The calling thread always takes part in the work.
+*/
+
+#ifndef HG_COLT_PARALLEL
+#define HG_COLT_PARALLEL
+
+#include <atomic>
+#include <thread>
+
+#include "../data_structs/Vector.h"
+
+namespace colt
+{
+  /// @brief Returns the count of threads to use by default (the count of hardware threads)
+  /// @return The count of hardware threads, or 1 if unknown
+  inline size_t get_default_thread_count() noexcept
+  {
+    const unsigned count = std::thread::hardware_concurrency();
+    return count == 0 ? 1 : count;
+  }
+
+  /// @brief Calls 'fn(thread_index)' on 'thread_count' threads (including the calling thread),
+  /// and waits for all the calls to return.
+  /// Useful to compute per-thread partial results that are merged afterwards.
+  /// @tparam Fn The function type
+  /// @param thread_count The count of threads (0 is treated as 1)
+  /// @param fn The function to call, taking the index of the thread in [0, thread_count)
+  template<typename Fn>
+  void parallel_for_threads(size_t thread_count, Fn&& fn)
+  {
+    if (thread_count <= 1)
+    {
+      fn(static_cast<size_t>(0));
+      return;
+    }
+    Vector<std::thread> threads = Vector<std::thread>{ thread_count - 1 };
+    for (size_t i = 1; i < thread_count; i++)
+      threads.push_back(std::thread([&fn, i]() { fn(i); }));
+    fn(static_cast<size_t>(0));
+    for (auto& thread : threads)
+      thread.join();
+  }
+
+  /// @brief Calls 'fn(index)' for each index in [0, count) on multiple threads.
+  /// The threads take 'grain' consecutive indices at a time from a shared counter,
+  /// which balances the work when the cost of each index varies.
+  /// @tparam Fn The function type
+  /// @param count The count of indices
+  /// @param fn The function to call, taking the index
+  /// @param grain The count of consecutive indices taken at a time (0 is treated as 1)
+  /// @param thread_count The count of threads (0 for the default count)
+  template<typename Fn>
+  void parallel_for(size_t count, Fn&& fn, size_t grain = 1, size_t thread_count = 0)
+  {
+    grain = grain == 0 ? 1 : grain;
+    thread_count = thread_count == 0 ? get_default_thread_count() : thread_count;
+    //No more threads than chunks of work
+    const size_t chunk_count = (count + grain - 1) / grain;
+    thread_count = thread_count < chunk_count ? thread_count : chunk_count;
+
+    std::atomic<size_t> next = 0;
+    parallel_for_threads(thread_count, [&](size_t)
+      {
+        for (;;)
+        {
+          const size_t begin = next.fetch_add(grain, std::memory_order_relaxed);
+          if (begin >= count)
+            return;
+          const size_t end = count - begin < grain ? count : begin + grain;
+          for (size_t i = begin; i < end; i++)
+            fn(i);
+        }
+      });
+  }
+}
+
+#endif //!HG_COLT_PARALLEL
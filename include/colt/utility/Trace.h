@@ -0,0 +1,148 @@
+/** @file Trace.h
+* Contains the functions writing the events recorded by COLT_TRACE_SCOPE
+* (see 'details/trace.h') in the Chrome trace event JSON format, which can
+* be opened by 'chrome://tracing' or Perfetto (https://ui.perfetto.dev).
+* Events are only recorded if COLT_ENABLE_TRACING is defined.
+* Writing does not stop the traced threads: events that are overwritten
+* while they are being copied are discarded.
+*/
+
+#ifndef HG_COLT_TRACE_WRITER
+#define HG_COLT_TRACE_WRITER
+
+#include <cstdio>
+
+#include "../details/trace.h"
+#include "../data_structs/String.h"
+
+namespace colt
+{
+  /// @brief Contains the helpers to write recorded trace events
+  namespace trace
+  {
+    namespace details
+    {
+      /// @brief The size after which the JSON buffer is written to the file
+      inline constexpr size_t TRACE_FLUSH_SIZE = 64 * 1024;
+
+      /// @brief Writes the content of 'out' to 'file' and clears 'out'
+      /// @param out The buffer to write
+      /// @param file The file to which to write
+      /// @return True if all the content was written
+      inline bool flush_trace_buffer(StringOf<char>& out, FILE* file) noexcept
+      {
+        const size_t size = out.get_size();
+        const bool success = std::fwrite(out.get_data(), 1, size, file) == size;
+        out.clear();
+        return success;
+      }
+
+      /// @brief Appends a JSON string (escaping quotes and backslashes) to 'out'
+      /// @param out The buffer to which to append
+      /// @param str The NUL terminated string to append
+      inline void append_json_string(StringOf<char>& out, const char* str) noexcept
+      {
+        out.append('"');
+        for (; *str != '\0'; ++str)
+        {
+          if (*str == '"' || *str == '\\')
+            out.append('\\');
+          out.append(*str);
+        }
+        out.append('"');
+      }
+
+      /// @brief Copies the events that are still in a TraceBuffer
+      /// @param buffer The buffer whose events to copy
+      /// @return The events, from the oldest to the newest
+      inline Vector<colt::details::TraceEvent> copy_trace_events(const colt::details::TraceBuffer& buffer) noexcept
+      {
+        using colt::details::TraceBuffer;
+
+        Vector<colt::details::TraceEvent> events = Vector<colt::details::TraceEvent>{ TraceBuffer::CAPACITY };
+        const uint64_t end = buffer.write_index.load(std::memory_order_acquire);
+        const uint64_t begin = end > TraceBuffer::CAPACITY ? end - TraceBuffer::CAPACITY : 0;
+        for (uint64_t i = begin; i < end; i++)
+          events.push_back(buffer.events[i & (TraceBuffer::CAPACITY - 1)]);
+
+        //The events written while copying may have overwritten the oldest copied ones.
+        //The event 'after' may also be being written, in the slot of the event 'after - CAPACITY'.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint64_t after = buffer.write_index.load(std::memory_order_relaxed);
+        const uint64_t first_valid = after + 1 > TraceBuffer::CAPACITY ? after + 1 - TraceBuffer::CAPACITY : 0;
+        if (first_valid > begin)
+        {
+          Vector<colt::details::TraceEvent> valid = Vector<colt::details::TraceEvent>{ TraceBuffer::CAPACITY };
+          for (size_t i = static_cast<size_t>(first_valid - begin); i < events.get_size(); i++)
+            valid.push_back(events[i]);
+          return valid;
+        }
+        return events;
+      }
+    }
+
+    /// @brief Writes all the recorded events in the Chrome trace event JSON format.
+    /// Timestamps are in microseconds, relative to the oldest recorded event.
+    /// @param file The file to which to write
+    /// @return True if the file was written successfully
+    inline bool write_chrome_trace(FILE* file) noexcept
+    {
+      using colt::details::TraceBuffer;
+      using colt::details::TracePhase;
+
+      const TraceBuffer* head = colt::details::get_trace_buffers().load(std::memory_order_acquire);
+
+      //Copy the events first, to compute the oldest timestamp
+      Vector<Vector<colt::details::TraceEvent>> buffers;
+      uint64_t origin = std::numeric_limits<uint64_t>::max();
+      for (const TraceBuffer* buffer = head; buffer != nullptr; buffer = buffer->next)
+      {
+        auto events = details::copy_trace_events(*buffer);
+        if (events.is_not_empty() && events[0].timestamp < origin)
+          origin = events[0].timestamp;
+        buffers.push_back(std::move(events));
+      }
+
+      StringOf<char> out;
+      out.reserve(details::TRACE_FLUSH_SIZE + 256);
+      out.append(StringView{ "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[" });
+
+      bool success = true;
+      bool is_first = true;
+      char number[96];
+      for (auto& events : buffers)
+      {
+        for (const auto& event : events)
+        {
+          out.append(StringView{ is_first ? "\n{\"name\":" : ",\n{\"name\":" });
+          is_first = false;
+          details::append_json_string(out, event.name);
+          const double timestamp_us = static_cast<double>(event.timestamp - origin) / 1000.0;
+          const int length = std::snprintf(number, sizeof(number), ",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%u}",
+            event.phase == TracePhase::BEGIN ? 'B' : 'E', timestamp_us, event.thread_id);
+          out.append(StringView{ number, number + length });
+
+          if (out.get_size() >= details::TRACE_FLUSH_SIZE)
+            success &= details::flush_trace_buffer(out, file);
+        }
+      }
+      out.append(StringView{ "\n]}\n" });
+      success &= details::flush_trace_buffer(out, file);
+      return success && std::fflush(file) == 0;
+    }
+
+    /// @brief Writes all the recorded events in the Chrome trace event JSON format to a file
+    /// @param path The path of the file to create or overwrite
+    /// @return True if the file was written successfully
+    inline bool write_chrome_trace(const char* path) noexcept
+    {
+      FILE* file = std::fopen(path, "wb");
+      if (file == nullptr)
+        return false;
+      const bool success = write_chrome_trace(file);
+      return (std::fclose(file) == 0) && success;
+    }
+  }
+}
+
+#endif //!HG_COLT_TRACE_WRITER
@@ -0,0 +1,63 @@
+//truetrue
+#include <cstdlib>
+#include <thread>
+
+#define COLT_USE_IOSTREAMS
+#include "colt/details/allocator.h"
+
+using namespace colt;
+using namespace colt::memory;
+
+/// @brief The free list shared by all the threads
+using SharedFreeList = AtomicFreeList<Mallocator, 8, 64, 256>;
+
+/// @brief Allocates and frees blocks (in batches and one at a time), overwriting
+/// each block while it is held: a block given to two threads at once is detected.
+/// @param list The shared free list
+/// @param thread The index of the thread
+/// @param is_valid Set to false if a block was overwritten by another thread
+void stress(SharedFreeList& list, size_t thread, std::atomic<bool>& is_valid) noexcept
+{
+  MemBlock blocks[48];
+  u64 state = thread + 1;
+  for (size_t round = 0; round < 20000; round++)
+  {
+    state = state * 6364136223846793005 + 1442695040888963407;
+    const size_t count = 1 + static_cast<size_t>(state >> 33) % 48;
+    const bool is_batch = (state >> 20) & 1;
+    size_t allocated = 0;
+    if (is_batch)
+      allocated = list.allocate_batch({ 64 }, blocks, count);
+    else
+      for (; allocated < count; allocated++)
+        blocks[allocated] = list.allocate({ 64 });
+
+    //Overwrites the whole block, including where the next pointer of the list was stored
+    for (size_t i = 0; i < allocated; i++)
+      for (size_t j = 0; j < 8; j++)
+        static_cast<u64*>(blocks[i].get_ptr())[j] = (thread << 32) | i;
+    for (size_t i = 0; i < allocated; i++)
+      for (size_t j = 0; j < 8; j++)
+        if (static_cast<u64*>(blocks[i].get_ptr())[j] != ((thread << 32) | i))
+          is_valid.store(false, std::memory_order_relaxed);
+
+    if ((state >> 21) & 1)
+      list.deallocate_batch(blocks, allocated);
+    else
+      for (size_t i = 0; i < allocated; i++)
+        list.deallocate(blocks[i]);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  SharedFreeList list;
+  std::atomic<bool> is_valid = true;
+  std::thread threads[8];
+  for (size_t i = 0; i < 8; i++)
+    threads[i] = std::thread(stress, std::ref(list), i, std::ref(is_valid));
+  for (auto& thread : threads)
+    thread.join();
+  std::cout << std::boolalpha << is_valid.load() << (list.get_count() <= 256);
+  return EXIT_SUCCESS;
+}
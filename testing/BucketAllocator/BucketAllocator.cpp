@@ -0,0 +1,71 @@
+//truetruetruetruetrue
+#include <cstdlib>
+
+#define COLT_USE_IOSTREAMS
+#include "colt/details/allocator.h"
+
+using namespace colt;
+using namespace colt::memory;
+
+/// @brief The count of blocks allocated to span many slabs
+static constexpr size_t BLOCK_COUNT = 20000;
+
+int main(int argc, char** argv)
+{
+  std::cout << std::boolalpha;
+
+  //Sizes are rounded up to the smallest class that can hold them
+  using Small = SmallAllocator_t;
+  std::cout << (Small::get_class_index(1) == 0 && Small::get_class_index(16) == 0
+    && Small::get_class_index(17) == 1 && Small::get_class_index(100) == 5
+    && Small::get_class_index(384) == 8 && Small::get_class_index(385) == 9
+    && Small::get_class_index(512) == 9);
+
+  SmallAllocator_t bucket;
+  //A freed block is reused by the next allocation of its class only
+  MemBlock first = bucket.allocate({ 40 });
+  bucket.deallocate(first);
+  MemBlock other_class = bucket.allocate({ 200 });
+  MemBlock same_class = bucket.allocate({ 48 });
+  std::cout << (same_class.get_ptr() == first.get_ptr() && other_class.get_ptr() != first.get_ptr());
+  bucket.deallocate(other_class);
+  bucket.deallocate(same_class);
+
+  //Blocks spanning many slabs are all owned, and reused once freed
+  MemBlock* blocks = static_cast<MemBlock*>(std::malloc(BLOCK_COUNT * sizeof(MemBlock)));
+  if (blocks == nullptr)
+    return EXIT_FAILURE;
+  bool is_owned = true;
+  uintptr_t address_sum = 0;
+  for (size_t i = 0; i < BLOCK_COUNT; i++)
+  {
+    blocks[i] = bucket.allocate({ 16 + (i % 32) * 16 });
+    std::memset(blocks[i].get_ptr(), static_cast<int>(i), blocks[i].get_byte_size().size);
+    is_owned &= bucket.owns(blocks[i]);
+    address_sum += reinterpret_cast<uintptr_t>(blocks[i].get_ptr());
+  }
+  for (size_t i = 0; i < BLOCK_COUNT; i++)
+    bucket.deallocate(blocks[i]);
+  //The free lists are LIFO: the same allocations return the same blocks
+  for (size_t i = 0; i < BLOCK_COUNT; i++)
+  {
+    blocks[i] = bucket.allocate({ 16 + (i % 32) * 16 });
+    address_sum -= reinterpret_cast<uintptr_t>(blocks[i].get_ptr());
+  }
+  std::cout << (is_owned && address_sum == 0);
+  for (size_t i = 0; i < BLOCK_COUNT; i++)
+    bucket.deallocate(blocks[i]);
+  std::free(blocks);
+
+  //Sizes greater than the greatest class go to the underlying allocator
+  MemBlock big = bucket.allocate({ 513 });
+  std::memset(big.get_ptr(), 0, 513);
+  std::cout << !bucket.owns(big);
+  bucket.deallocate(big);
+
+  //Memory of another allocator is not owned
+  void* foreign = std::malloc(64);
+  std::cout << !bucket.owns({ foreign, 64 });
+  std::free(foreign);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,81 @@
+//truetruetruetruetruetrue
+#include <cstdlib>
+#include <filesystem>
+
+#define COLT_USE_IOSTREAMS
+#include "colt/utility/FileLoader.h"
+
+using namespace colt;
+
+/// @brief The count of files that exist (more than the queue depth used)
+static constexpr size_t FILE_COUNT = 20;
+
+/// @brief Returns the expected content of the file 'i'
+String expected_content(size_t i) noexcept
+{
+  static constexpr const char* DIGITS = "0123456789";
+  String content;
+  //The file 0 is empty, the others contain up to 104500 characters
+  for (size_t j = 0; j < i * 1000; j++)
+    content.append(StringView{ DIGITS, DIGITS + 1 + (i + j) % 10 });
+  return content;
+}
+
+/// @brief Check the results of loading the files, followed by a missing path
+bool check_results(const Vector<Expected<String, StringError>>& results) noexcept
+{
+  if (results.get_size() != FILE_COUNT + 1)
+    return false;
+  if (!results[0].is_error() || results[0].get_error() != StringError::EOF_HIT)
+    return false;
+  for (size_t i = 1; i < FILE_COUNT; i++)
+    if (results[i].is_error() || results[i].get_value() != expected_content(i))
+      return false;
+  return results[FILE_COUNT].is_error() && results[FILE_COUNT].get_error() == StringError::INVALID_PATH;
+}
+
+int main(int argc, char** argv)
+{
+  const auto directory = std::filesystem::temp_directory_path() / "colt_file_loader_test";
+  std::filesystem::create_directories(directory);
+
+  //The paths must not be moved, as the StringViews point to their characters
+  Vector<String> paths = Vector<String>(FILE_COUNT + 1);
+  Vector<StringView> views = Vector<StringView>(FILE_COUNT + 1);
+  for (size_t i = 0; i <= FILE_COUNT; i++)
+  {
+    const auto path = (directory / ("file" + std::to_string(i) + ".txt")).string();
+    paths.push_back(String{ StringView{ path.c_str() } });
+    views.push_back(static_cast<StringView>(paths.get_back()));
+    if (i == FILE_COUNT)
+    {
+      //The last path does not exist
+      std::filesystem::remove(path);
+      continue;
+    }
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr)
+      return EXIT_FAILURE;
+    const String content = expected_content(i);
+    std::fwrite(content.get_data(), 1, content.get_size(), file);
+    std::fclose(file);
+  }
+
+  std::cout << std::boolalpha;
+  //More files than files in flight, then a single file in flight
+  for (size_t queue_depth : { 64, 4, 1 })
+    std::cout << check_results(load_files(views.to_view(), queue_depth));
+
+  //The fallback used when io_uring is not supported
+  for (size_t thread_count : { 1, 3 })
+  {
+    Vector<Expected<String, StringError>> results = Vector<Expected<String, StringError>>(views.get_size(), InPlace);
+    details::load_files_threaded(views.to_view(), results, thread_count);
+    std::cout << check_results(results);
+  }
+
+  //No files
+  std::cout << load_files(ContiguousView<StringView>{ views.get_data(), static_cast<size_t>(0) }).is_empty();
+  std::filesystem::remove_all(directory);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,86 @@
+//truetruetruetruetruetruetrue
+#include <cstdlib>
+
+#define COLT_USE_IOSTREAMS
+#include "colt/algorithm/GroupAggregate.h"
+
+using namespace colt;
+
+/// @brief Compares 'group_aggregate' to a naive loop over keys in [0, key_range)
+bool matches_naive(ContiguousView<u32> keys, ContiguousView<i32> values, u32 key_range,
+  size_t thread_count, size_t group_count_hint) noexcept
+{
+  Vector<i64> sums = Vector<i64>(key_range, InPlace, i64(0));
+  Vector<u64> counts = Vector<u64>(key_range, InPlace, u64(0));
+  Vector<i32> mins = Vector<i32>(key_range, InPlace, i32(0));
+  Vector<i32> maxs = Vector<i32>(key_range, InPlace, i32(0));
+  size_t group_count = 0;
+  for (size_t i = 0; i < keys.get_size(); i++)
+  {
+    const u32 key = keys[i];
+    if (counts[key] == 0)
+    {
+      ++group_count;
+      mins[key] = values[i];
+      maxs[key] = values[i];
+    }
+    sums[key] += values[i];
+    ++counts[key];
+    mins[key] = values[i] < mins[key] ? values[i] : mins[key];
+    maxs[key] = maxs[key] < values[i] ? values[i] : maxs[key];
+  }
+
+  auto result = algo::group_aggregate<DefaultHash<u32>, DefaultEqual<u32>>({ thread_count, group_count_hint },
+    keys, values, algo::Sum{}, algo::Count{}, algo::Min{}, algo::Max{});
+  if (result.get_size() != group_count)
+    return false;
+  //Each group appears once, as the counts of all the groups sum to the count of rows
+  u64 total = 0;
+  for (size_t i = 0; i < result.get_size(); i++)
+  {
+    const u32 key = result.keys[i];
+    if (result.get_column<0>()[i] != sums[key] || result.get_column<1>()[i] != counts[key]
+      || result.get_column<2>()[i] != mins[key] || result.get_column<3>()[i] != maxs[key])
+      return false;
+    total += result.get_column<1>()[i];
+  }
+  return total == keys.get_size();
+}
+
+int main(int argc, char** argv)
+{
+  u64 state = 1;
+  auto next_random = [&]()
+    {
+      state = state * 6364136223846793005 + 1442695040888963407;
+      return static_cast<u32>(state >> 33);
+    };
+
+  //Few groups, then about as many groups as rows
+  constexpr size_t COUNT = 100000;
+  for (u32 key_range : { 100, 80000 })
+  {
+    Vector<u32> keys;
+    Vector<i32> values;
+    for (size_t i = 0; i < COUNT; i++)
+    {
+      keys.push_back(next_random() % key_range);
+      values.push_back(static_cast<i32>(next_random() % 2001) - 1000);
+    }
+    std::cout << std::boolalpha;
+    for (size_t thread_count : { 1, 4 })
+      for (size_t hint : { static_cast<size_t>(0), static_cast<size_t>(key_range) })
+        if (!matches_naive(keys.to_view(), values.to_view(), key_range, thread_count, hint))
+          return EXIT_FAILURE;
+    std::cout << true << matches_naive(keys.to_view(), values.to_view(), key_range, 3, 0)
+      << matches_naive(keys.to_view(), values.to_view(), key_range, 0, key_range / 2);
+  }
+
+  //The default overload, and an empty input
+  u32 keys[] = { 1, 2, 1 };
+  i32 values[] = { 5, 6, 7 };
+  auto result = algo::group_aggregate<u32, i32>({ keys, 3 }, { values, 3 }, algo::Sum{});
+  auto empty = algo::group_aggregate<u32, i32>({ keys, static_cast<size_t>(0) }, { values, static_cast<size_t>(0) }, algo::Sum{});
+  std::cout << (result.get_size() == 2 && empty.get_size() == 0);
+  return EXIT_SUCCESS;
+}
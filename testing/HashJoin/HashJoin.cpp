@@ -0,0 +1,97 @@
+//truetruetruetruetruetrue
+#include <cstdlib>
+
+#define COLT_USE_IOSTREAMS
+#include "colt/algorithm/HashJoin.h"
+
+using namespace colt;
+
+/// @brief Returns a pseudo-random number
+u64 next_random(u64& state) noexcept
+{
+  state = state * 6364136223846793005 + 1442695040888963407;
+  return state >> 33;
+}
+
+/// @brief Compares 'hash_join' to a nested loop join on small columns
+bool matches_nested_loop(ContiguousView<u64> build, ContiguousView<u64> probe, size_t thread_count) noexcept
+{
+  auto pairs = algo::hash_join(build, probe, thread_count);
+  size_t expected = 0;
+  for (size_t i = 0; i < build.get_size(); i++)
+  {
+    for (size_t j = 0; j < probe.get_size(); j++)
+    {
+      if (build[i] != probe[j])
+        continue;
+      ++expected;
+      bool found = false;
+      for (auto& pair : pairs)
+        found |= pair.first == i && pair.second == j;
+      if (!found)
+        return false;
+    }
+  }
+  return pairs.get_size() == expected;
+}
+
+/// @brief Checks 'hash_join' on columns whose keys are smaller than 'key_range':
+/// each pair must have equal keys, appear once, and the count of pairs must be the expected one
+bool matches_counts(ContiguousView<u64> build, ContiguousView<u64> probe, u64 key_range, size_t thread_count) noexcept
+{
+  auto pairs = algo::hash_join(build, probe, thread_count);
+  Vector<size_t> build_counts = Vector<size_t>(key_range, InPlace, static_cast<size_t>(0));
+  for (auto key : build)
+    ++build_counts[key];
+  size_t expected = 0;
+  for (auto key : probe)
+    expected += build_counts[key];
+
+  //Each (build, probe) pair at most once: counts the pairs of each probe row
+  Vector<size_t> probe_pairs = Vector<size_t>(probe.get_size(), InPlace, static_cast<size_t>(0));
+  for (auto& pair : pairs)
+  {
+    if (build[pair.first] != probe[pair.second])
+      return false;
+    ++probe_pairs[pair.second];
+  }
+  for (size_t j = 0; j < probe.get_size(); j++)
+    if (probe_pairs[j] != build_counts[probe[j]])
+      return false;
+  return pairs.get_size() == expected;
+}
+
+int main(int argc, char** argv)
+{
+  u64 state = 1;
+  std::cout << std::boolalpha;
+
+  //Duplicates on both sides, missing keys, and the extreme keys
+  Vector<u64> build;
+  Vector<u64> probe;
+  for (size_t i = 0; i < 300; i++)
+    build.push_back(next_random(state) % 100);
+  for (size_t i = 0; i < 400; i++)
+    probe.push_back(next_random(state) % 150);
+  build.push_back(0);
+  build.push_back(~u64(0));
+  build.push_back(~u64(0));
+  probe.push_back(~u64(0));
+  for (size_t thread_count : { 1, 3 })
+    std::cout << matches_nested_loop(build.to_view(), probe.to_view(), thread_count);
+
+  //Empty columns
+  std::cout << (algo::hash_join(ContiguousView<u64>{ build.get_data(), static_cast<size_t>(0) }, probe.to_view()).get_size() == 0);
+
+  //Multiple partitions, partitioned on multiple threads, some of them empty or skewed
+  constexpr u64 KEY_RANGE = 50000;
+  Vector<u64> large_build;
+  Vector<u64> large_probe;
+  for (size_t i = 0; i < 40000; i++)
+    large_build.push_back(i % 7 == 0 ? 42 : next_random(state) % KEY_RANGE);
+  for (size_t i = 0; i < 150000; i++)
+    large_probe.push_back(next_random(state) % KEY_RANGE);
+  for (size_t thread_count : { 1, 2, 4 })
+    std::cout << matches_counts(large_build.to_view(), large_probe.to_view(), KEY_RANGE, thread_count);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,55 @@
+//truefalse1000truefalse500true{ hello }false1truefalse032
+#include <cstdlib>
+
+#define COLT_USE_IOSTREAMS
+#include "colt/data_structs/Set.h"
+#include "colt/data_structs/String.h"
+
+using namespace colt;
+
+int main(int argc, char** argv)
+{
+  HashSet<u64> set;
+  for (u64 i = 0; i < 1000; i++)
+    set.insert(i * 7919);
+  std::cout << std::boolalpha << set.contains(7919) << set.contains(7920);
+
+  //Inserting an existing value does nothing
+  for (u64 i = 0; i < 1000; i++)
+    set.insert(i * 7919);
+  std::cout << set.get_size();
+
+  //Erasing half of the values leaves tombstones that are skipped
+  for (u64 i = 0; i < 1000; i += 2)
+    set.erase(i * 7919);
+  std::cout << set.contains(7919) << set.contains(0) << set.get_size();
+
+  u64 sum = 0;
+  for (auto value : set)
+    sum += value / 7919;
+  //Sum of the odd numbers in [0, 1000)
+  std::cout << (sum == 250000);
+
+  HashSet<String> strings;
+  strings.insert(String{ "hello" });
+  strings.insert(String{ "hello" });
+  std::cout << strings;
+
+  //A moved-from HashSet has no capacity, but can still be used
+  HashSet<u64> moved_to = std::move(set);
+  std::cout << set.contains(7919);
+  set.insert(1);
+  std::cout << set.get_size() << (set.contains(1) && moved_to.contains(7919));
+
+  //Inserting and erasing distinct values fills the slots with tombstones:
+  //they count toward the load factor, so the set is rehashed without growing
+  HashSet<u64> churn;
+  for (u64 round = 0; round < 200; round++)
+  {
+    for (u64 i = 0; i < 10; i++)
+      churn.insert(round * 10 + i);
+    for (u64 i = 0; i < 10; i++)
+      churn.erase(round * 10 + i);
+  }
+  std::cout << churn.contains(999999) << churn.get_size() << churn.get_capacity();
+}
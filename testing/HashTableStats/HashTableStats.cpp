@@ -0,0 +1,49 @@
+//3 16 0 2 3 4 3 1 1.375 3 6 0/1 0 3 6 15/3 16 0 2 3 4 3 1 1.375 3 6 0/1 0 3 6 15
+#include <cstdlib>
+
+#define COLT_USE_IOSTREAMS
+#define COLT_HASH_TABLE_STATS
+#include "colt/data_structs/Map.h"
+#include "colt/data_structs/Set.h"
+
+using namespace colt;
+
+template<typename Table>
+/// @brief Fills 'table' (of capacity 16, hashing keys to themselves) with keys of home slot 0, then reuses a tombstone
+/// @tparam Table The Map or HashSet type
+/// @param table The table
+/// @param insert Inserts a key in the table
+void fill_then_reuse(Table& table, void(*insert)(Table&, u64)) noexcept
+{
+  //The keys 0, 16 and 32 occupy the slots 0, 1 and 2: 1 + 2 + 3 probes
+  insert(table, 0);
+  insert(table, 16);
+  insert(table, 32);
+  auto stats = table.get_stats();
+  std::cout << stats.size << ' ' << stats.capacity << ' ' << stats.tombstone_count << ' '
+    << stats.avg_hit_probe << ' ' << stats.max_hit_probe << ' ' << stats.max_miss_probe << ' '
+    << stats.max_cluster_length << ' ' << stats.cluster_histogram[1] << ' ' << stats.avg_miss_probe << ' '
+    << stats.lookup_count << ' ' << stats.probe_count << ' ' << stats.rehash_count << '/';
+
+  //Erasing 16 (2 probes) leaves a tombstone in slot 1.
+  //Inserting 32 probes past the tombstone (3 probes) and finds it: no duplicate.
+  //Inserting 48 probes up to the EMPTY slot 3 (4 probes), then reuses the tombstone.
+  table.erase(16);
+  std::cout << table.get_stats().tombstone_count << ' ';
+  insert(table, 32);
+  insert(table, 48);
+  stats = table.get_stats();
+  std::cout << stats.tombstone_count << ' ' << stats.size << ' ' << stats.lookup_count << ' '
+    << stats.probe_count;
+}
+
+int main(int argc, char** argv)
+{
+  Map<u64, u64, IdentityHash> map = Map<u64, u64, IdentityHash>(static_cast<size_t>(16));
+  fill_then_reuse<decltype(map)>(map, [](decltype(map)& table, u64 key) { table.insert(key, key); });
+  std::cout << '/';
+
+  HashSet<u64, IdentityHash> set = HashSet<u64, IdentityHash>(static_cast<size_t>(16));
+  fill_then_reuse<decltype(set)>(set, [](decltype(set)& table, u64 key) { table.insert(key); });
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,33 @@
+//{ count: 1001, min: 1, p50: 503, p90: 911, p99: 991, p99.9: 1007, max: 1000000 }1111
+#include <cstdlib>
+
+#define COLT_USE_IOSTREAMS
+#include "colt/utility/Histogram.h"
+
+using namespace colt;
+
+int main(int argc, char** argv)
+{
+  {
+    LatencyHistogram<> first;
+    LatencyHistogram<> second;
+    for (u64 i = 1; i <= 1000; i++)
+      (i % 2 == 0 ? first : second).record(i);
+    second.record(1000000);
+    first.merge(second);
+    std::cout << first;
+  }
+  {
+    LatencyHistogram<> histogram;
+    for (u64 i = 0; i < 10000; i++)
+      histogram.record(i * i);
+    Vector<u8> bytes;
+    histogram.serialize(bytes);
+    auto copy = LatencyHistogram<>::deserialize(bytes.to_view());
+    std::cout << (copy.is_error() ? false : copy->get_percentile(99.0) == histogram.get_percentile(99.0));
+    std::cout << (bytes.get_size() < 2048);
+    bytes.pop_back();
+    std::cout << LatencyHistogram<>::deserialize(bytes.to_view()).is_error();
+    std::cout << LatencyHistogram<3>::deserialize(bytes.to_view()).is_error();
+  }
+}
@@ -0,0 +1,50 @@
+//truefalse1000truefalse500truetrue501[{ 7: 1 }]true
+#include <cstdlib>
+
+#define COLT_USE_IOSTREAMS
+#include "colt/data_structs/IntMap.h"
+
+using namespace colt;
+
+int main(int argc, char** argv)
+{
+  IntMap<u64, u32> map;
+  for (u32 i = 0; i < 1000; i++)
+    map.insert(i * 7919, i);
+  std::cout << std::boolalpha << map.contains(7919) << map.contains(7920);
+
+  //Inserting an existing key does nothing
+  for (u32 i = 0; i < 1000; i++)
+    map.insert(i * 7919, 0);
+  std::cout << map.get_size();
+
+  //Erasing shifts the following keys back: the remaining keys must still be found
+  for (u32 i = 0; i < 1000; i += 2)
+    map.erase(i * 7919);
+  std::cout << map.contains(7919) << map.contains(0) << map.get_size();
+
+  bool all_found = true;
+  for (u32 i = 1; i < 1000; i += 2)
+    all_found &= map.find(i * 7919) != nullptr && *map.find(i * 7919) == i;
+  std::cout << all_found;
+
+  //The key marking EMPTY slots can also be inserted
+  map.insert(IntMap<u64, u32>::EMPTY_KEY, 1);
+  std::cout << (*map.find(IntMap<u64, u32>::EMPTY_KEY) == 1) << map.get_size();
+
+  IntMap<u32, u32> small;
+  small.insert_or_assign(7, 0);
+  small.insert_or_assign(7, 1);
+  std::cout << small;
+
+  //Keys differing only in their high bits must not share the lowest bits of their hash
+  bool low_bits_used[256] = {};
+  size_t distinct_low_bits = 0;
+  for (u64 i = 0; i < 256; i++)
+  {
+    const size_t low_bits = FastIntHash{}(i << 40) & 255;
+    distinct_low_bits += !low_bits_used[low_bits];
+    low_bits_used[low_bits] = true;
+  }
+  std::cout << (distinct_low_bits >= 128);
+}
@@ -0,0 +1,83 @@
+//3true10true100000truetrue70000145000truefalse032
+#include <cstdlib>
+
+#define COLT_USE_IOSTREAMS
+#include "colt/data_structs/Map.h"
+
+using namespace colt;
+
+/// @brief Hashes 8 consecutive keys to the same value, which makes long probes
+struct CollidingHash
+{
+  size_t operator()(u64 key) const noexcept { return DefaultHash<u64>{}(key / 8); }
+};
+
+int main(int argc, char** argv)
+{
+  //Small input (calling thread): duplicates and keys already present are not inserted
+  Map<u32, u32> small;
+  small.insert(1, 100);
+  std::pair<u32, u32> pairs[] = { { 1, 1 }, { 2, 2 }, { 2, 3 }, { 3, 3 }, { 4, 4 } };
+  std::cout << small.bulk_build({ pairs, 5 }) << std::boolalpha
+    << (small.find(1)->second == 100 && small.find(2)->second == 2);
+
+  //Large input (multiple threads): each key appears twice, the first pair wins
+  Map<u64, u64> large;
+  for (u64 i = 0; i < 10; i++)
+    large.insert(i * 3, 0);
+  Vector<std::pair<u64, u64>> many;
+  for (u64 i = 0; i < 100000; i++)
+    many.push_back({ i, i + 1 });
+  for (u64 i = 0; i < 100000; i++)
+    many.push_back({ i, 0 });
+  const size_t inserted = large.bulk_build(many.to_view(), 4);
+  bool first_wins = true;
+  for (u64 i = 0; i < 100000; i++)
+  {
+    auto slot = large.find(i);
+    first_wins &= slot != nullptr && slot->second == (i % 3 == 0 && i < 30 ? 0 : i + 1);
+  }
+  std::cout << 100000 - inserted << first_wins << large.get_size() << (large.get_size() == inserted + 10);
+
+  //Rehashes the large Map on multiple threads
+  large.reserve(large.get_capacity() * 2);
+  bool all_found = true;
+  for (u64 i = 0; i < 100000; i++)
+    all_found &= large.contains(i);
+  std::cout << all_found;
+
+  //Tombstones (every 4th key erased) precede live keys in the probes: these keys are not inserted again
+  Map<u64, u64, CollidingHash> erased;
+  erased.reserve(400000);
+  for (u64 i = 0; i < 100000; i++)
+    erased.insert(i, i);
+  for (u64 i = 0; i < 100000; i += 4)
+    erased.erase(i);
+  Vector<std::pair<u64, u64>> live_and_new;
+  for (u64 i = 0; i < 100000; i++)
+    if (i % 4 != 0)
+      live_and_new.push_back({ i, 0 });
+  for (u64 i = 100000; i < 170000; i++)
+    live_and_new.push_back({ i, i });
+  std::cout << erased.bulk_build(live_and_new.to_view(), 4) << erased.get_size();
+  bool values_kept = true;
+  for (u64 i = 0; i < 170000; i++)
+  {
+    auto slot = erased.find(i);
+    values_kept &= (i < 100000 && i % 4 == 0) ? slot == nullptr : (slot != nullptr && slot->second == i);
+  }
+  std::cout << values_kept;
+
+  //Inserting and erasing distinct keys fills the slots with tombstones:
+  //they count toward the load factor, so the Map is rehashed without growing
+  Map<u64, u64> churn;
+  for (u64 round = 0; round < 200; round++)
+  {
+    for (u64 i = 0; i < 10; i++)
+      churn.insert(round * 10 + i, i);
+    for (u64 i = 0; i < 10; i++)
+      churn.erase(round * 10 + i);
+  }
+  std::cout << churn.contains(999999) << churn.get_size() << churn.get_capacity();
+  return EXIT_SUCCESS;
+}
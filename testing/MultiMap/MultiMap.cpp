@@ -0,0 +1,40 @@
+//3050true[0, 7, 14, 21, 28][0, 7, 14, 21, 28]00[{ 1: [1, 3] }]2
+#include <cstdlib>
+
+#define COLT_USE_IOSTREAMS
+#include "colt/data_structs/MultiMap.h"
+
+using namespace colt;
+
+int main(int argc, char** argv)
+{
+  MultiMap<u32, u32> map;
+  //More values than a chunk can contain
+  for (u32 i = 0; i < 30; i++)
+    map.insert(i % 7, i);
+  map.insert(100, 0);
+  std::cout << map.get_value_count() - 1 << map.get_count(1) << map.get_count(50);
+
+  //The values keep their insertion order once frozen
+  Vector<u32> before;
+  map.for_each_value(0, [&](u32 value) { before.push_back(value); });
+  map.freeze();
+  std::cout << std::boolalpha << map.is_frozen() << before.to_view() << map.find(0);
+
+  std::cout << map.find(50).get_size() << map.get_count(2) - 4;
+
+  std::pair<u32, u32> pairs[] = { { 1, 1 }, { 2, 2 }, { 1, 3 } };
+  auto built = MultiMap<u32, u32>::build({ pairs, 3 });
+  MultiMap<u32, u32> only_one;
+  only_one.insert(1, 1);
+  only_one.insert(1, 3);
+  only_one.freeze();
+  std::cout << only_one;
+
+  //A moved-from MultiMap has no capacity, but can still be used
+  MultiMap<u32, u32> moved_to = std::move(only_one);
+  only_one.insert(5, 1);
+  only_one.insert(5, 2);
+  std::cout << only_one.get_count(5);
+  return built.find(1).get_size() == 2 && built.find(2)[0] == 2 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
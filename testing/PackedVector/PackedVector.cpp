@@ -0,0 +1,59 @@
+//7[0, 1, 2, 3, 100]13[0, 1, 2, 3, 5000][1, 2][3, 5000]0000truetruetruetrue
+#include <cstdlib>
+
+#define COLT_USE_IOSTREAMS
+#include "colt/data_structs/PackedVector.h"
+
+using namespace colt;
+
+int main(int argc, char** argv)
+{
+  {
+    PackedVector<u32> vec1;
+    for (u32 i = 0; i < 4; i++)
+      vec1.push_back(i);
+    vec1.push_back(100);
+    std::cout << vec1.get_bit_width() << vec1.to_vector();
+    vec1.set(4, 5000);
+    std::cout << vec1.get_bit_width() << vec1.to_vector();
+
+    //Ranges are clamped to the size, and empty ranges give empty Vectors
+    std::cout << vec1.to_vector(Range{ 1, 3 }) << vec1.to_vector(Range{ 3, 1000 })
+      << vec1.to_vector(Range{ 2, 2 }).get_size() << vec1.to_vector(Range{ 5, End }).get_size()
+      << vec1.to_vector(Range{ 10, 20 }).get_size() << PackedVector<u32>{}.to_vector().get_size();
+  }
+  {
+    //Full width integers, straddling the words
+    PackedVector<u64> vec1;
+    for (u64 i = 0; i < 100; i++)
+      vec1.push_back(i * 0x9E3779B97F4A7C15ULL);
+    bool all_equal = vec1.get_bit_width() == 64;
+    auto decoded = vec1.to_vector(Range{ 37, 63 });
+    for (size_t i = 0; i < decoded.get_size(); i++)
+      all_equal &= decoded[i] == (i + 37) * 0x9E3779B97F4A7C15ULL;
+    std::cout << (all_equal && decoded.get_size() == 26 ? "true" : "false");
+  }
+  {
+    Vector<u64> ids;
+    u64 current = 1000000;
+    for (size_t i = 0; i < 1000; i++)
+    {
+      //Sorted ids, with rare large gaps
+      current += (i % 97 == 0) ? 1000000 : (i % 7) + 1;
+      ids.push_back(current);
+    }
+    
+    DeltaVector<u64> vec1(ids.to_view());
+    PackedVector<u64> vec2(ids.to_view());
+    
+    bool all_equal = true;
+    for (size_t i = 0; i < ids.get_size(); i++)
+      all_equal &= vec1[i] == ids[i] && vec2[i] == ids[i];
+    std::cout << (all_equal ? "true" : "false");
+    auto decoded = vec1.to_vector();
+    for (size_t i = 0; i < ids.get_size(); i++)
+      all_equal &= decoded[i] == ids[i];
+    std::cout << (all_equal ? "true" : "false");
+    std::cout << (vec1.get_byte_size().size * 4 < ids.get_byte_size().size ? "true" : "false");
+  }
+}
@@ -0,0 +1,23 @@
+//\[0, 3, 3, 4, 9, 11\]\[3, 3, 4, 9, 11, 20\]20true
+#include <cstdlib>
+
+#define COLT_USE_IOSTREAMS
+#include "colt/algorithm/Scan.h"
+
+using namespace colt;
+
+int main(int argc, char** argv)
+{
+  //The offsets of the rows of a CSR layout from their counts
+  u32 counts[] = { 3, 0, 1, 5, 2, 9 };
+  u32 offsets[6];
+  const u32 total = algo::exclusive_scan<u32>({ counts, 6 }, offsets);
+  algo::inclusive_scan<u32>({ counts, 6 }, counts);
+  std::cout << ContiguousView<u32>{ offsets, 6 } << ContiguousView<u32>{ counts, 6 } << total;
+
+  //On multiple threads, in place
+  Vector<u64> values = Vector<u64>(1000003, InPlace, u64(1));
+  const u64 sum = algo::inclusive_scan<u64>(values.to_view(), values.get_data(), 0, 4);
+  std::cout << std::boolalpha << (sum == 1000003);
+  return values[0] == 1 && values[500000] == 500001 && values[1000002] == 1000003 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,77 @@
+//truetruetruetruetrue
+#include <cstdlib>
+
+#define COLT_USE_IOSTREAMS
+#include "colt/data_structs/Vector.h"
+
+using namespace colt;
+
+/// @brief Check if the memory of 'vec' is owned by the scratch allocator of the thread
+/// @param vec The Vector to check
+/// @return True if the memory of 'vec' is owned by the scratch allocator
+bool is_in_scratch(const Vector<u64>& vec) noexcept
+{
+  return memory::details::get_thread_scratch().owns({ const_cast<u64*>(vec.get_data()), vec.get_byte_size().size });
+}
+
+/// @brief Check if 'vec' contains all the integers in [0, count)
+/// @param vec The Vector to check
+/// @param count The expected size
+/// @return True if 'vec' contains all the integers in [0, count)
+bool is_iota(const Vector<u64>& vec, u64 count) noexcept
+{
+  bool result = vec.get_size() == count;
+  for (u64 i = 0; i < vec.get_size(); i++)
+    result &= vec[i] == i;
+  return result;
+}
+
+int main(int argc, char** argv)
+{
+  std::cout << std::boolalpha;
+
+  //Without a scope, InScratch allocates through the global allocator
+  {
+    Vector<u64> vec = Vector<u64>(16, InScratch);
+    for (u64 i = 0; i < 100; i++)
+      vec.push_back(i);
+    std::cout << (!is_in_scratch(vec) && is_iota(vec, 100));
+  }
+
+  const char* stack_top = memory::details::get_thread_scratch().get_marker().stack_top;
+  //A Vector created before the scope does not grow into it
+  Vector<u64> before;
+  {
+    memory::ScratchScope scope;
+    for (u64 i = 0; i < 10000; i++)
+      before.push_back(i);
+    std::cout << !is_in_scratch(before);
+  }
+  std::cout << is_iota(before, 10000);
+
+  {
+    memory::ScratchScope scope;
+    //Overflows the stack of the scratch allocator into chunks
+    Vector<u64> vec = Vector<u64>(16, InScratch);
+    for (u64 i = 0; i < 10000; i++)
+      vec.push_back(i);
+    const bool in_scratch = is_in_scratch(vec) && is_iota(vec, 10000);
+
+    //A Vector of an enclosing scope that grows in a nested scope leaves the scratch
+    Vector<u64> outer = Vector<u64>(4, InScratch);
+    {
+      memory::ScratchScope nested;
+      Vector<u64> inner = Vector<u64>(4, InScratch);
+      for (u64 i = 0; i < 10000; i++)
+      {
+        outer.push_back(i);
+        inner.push_back(i);
+      }
+    }
+    std::cout << (in_scratch && !is_in_scratch(outer) && is_iota(outer, 10000));
+  }
+
+  //The scope freed all of its memory
+  std::cout << (memory::details::get_thread_scratch().get_marker().stack_top == stack_top);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,29 @@
+//5\[1, 2, 3\]\[9, 8, 7\]\[9, 8, 7\]true
+#include <cstdlib>
+
+#define COLT_USE_IOSTREAMS
+#include "colt/algorithm/Select.h"
+
+using namespace colt;
+
+int main(int argc, char** argv)
+{
+  Vector<u32> values = { 7, 3, 9, 1, 5, 8, 2, 6, 4 };
+  Vector<u32> median = values;
+  algo::nth_element(median, 4);
+  Vector<u32> sorted = values;
+  algo::partial_sort(sorted, 3);
+  std::cout << median[4] << ContiguousView<u32>{ sorted.get_data(), 3 };
+
+  //The 3 largest values of a stream
+  algo::TopK<u32> top = algo::TopK<u32>{ 3 };
+  top.push_all(values.to_iter());
+  std::cout << top.to_sorted().to_view() << algo::top_k(values.to_view(), 3, 2).to_view();
+
+  Vector<u32> many;
+  for (u32 i = 0; i < 100000; i++)
+    many.push_back((i * 7919) % 100000);
+  auto largest = algo::top_k(many.to_view(), 10);
+  std::cout << std::boolalpha << (top.get_threshold() == 7);
+  return largest.get_size() == 10 && largest[0] == 99999 && largest[9] == 99990 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
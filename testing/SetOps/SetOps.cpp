@@ -0,0 +1,41 @@
+//\[3, 5, 8, 13, 21\]\[1, 2, 3, 4, 5, 6, 8, 13, 21, 34\]\[1, 2, 4, 6\]\[5, 21\]\[\]
+#include <cstdlib>
+
+#define COLT_USE_IOSTREAMS
+#include "colt/algorithm/SetOps.h"
+
+using namespace colt;
+
+int main(int argc, char** argv)
+{
+  u32 a[] = { 1, 2, 3, 4, 5, 6, 8, 13, 21 };
+  u32 b[] = { 3, 5, 8, 13, 21, 34 };
+  u32 c[] = { 5, 7, 21 };
+
+  Vector<u32> intersection;
+  algo::set_intersection<u32>({ a, 9 }, { b, 6 }, intersection);
+  Vector<u32> merged;
+  algo::set_union<u32>({ a, 9 }, { b, 6 }, merged);
+  Vector<u32> difference;
+  algo::set_difference<u32>({ a, 9 }, { b, 6 }, difference);
+  ContiguousView<u32> sets[] = { { a, 9 }, { b, 6 }, { c, 3 } };
+  Vector<u32> all;
+  algo::set_intersection<u32>({ sets, 3 }, all);
+  std::cout << intersection.to_view() << merged.to_view() << difference.to_view() << all.to_view();
+
+  //One value against many: galloping
+  Vector<u32> large;
+  for (u32 i = 0; i < 1000; i++)
+    large.push_back(i * 2);
+  u32 odd[] = { 999 };
+  Vector<u32> none;
+  algo::set_intersection<u32>({ odd, 1 }, large.to_view(), none);
+  std::cout << none.to_view();
+
+  Vector<u32> with_odd;
+  algo::set_union<u32>(large.to_view(), { odd, 1 }, with_odd);
+  Vector<u32> without;
+  algo::set_difference<u32>(large.to_view(), { large.get_data() + 1, 998 }, without);
+  return with_odd.get_size() == 1001 && with_odd[500] == 999
+    && without.get_size() == 2 && without[1] == 1998 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
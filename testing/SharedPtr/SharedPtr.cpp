@@ -0,0 +1,51 @@
+//211~Derived25242~Config17~Config
+#include <cstdlib>
+
+#define COLT_USE_IOSTREAMS
+#include "colt/data_structs/SharedPtr.h"
+
+using namespace colt;
+
+struct Base
+{
+  int value = 1;
+  virtual ~Base() = default;
+};
+
+struct Derived : public Base
+{
+  ~Derived() override { std::cout << "~Derived"; }
+};
+
+struct Config : public RefCounted<false>
+{
+  int value;
+  Config(int value) noexcept : value(value) {}
+  ~Config() { std::cout << "~Config"; }
+};
+
+int main(int argc, char** argv)
+{
+  {
+    auto derived = make_shared<Derived>();
+    SharedPtr<const Base> base = derived;
+    std::cout << base.get_use_count() << base->value;
+    derived.reset();
+    std::cout << base.get_use_count();
+  }
+  {
+    auto local = make_shared<int, false>(5);
+    auto copy = local;
+    std::cout << copy.get_use_count() << *copy;
+  }
+  {
+    auto config = make_shared<Config>(42);
+    SharedPtr<Config> from_raw = SharedPtr<Config>(config.get_ptr());
+    std::cout << config->get_ref_count() << from_raw->value;
+  }
+  {
+    //A new object is owned by the first SharedPtr alone
+    SharedPtr<Config> adopted = SharedPtr<Config>(memory::new_t<Config>(7).get_ptr());
+    std::cout << adopted.get_use_count() << adopted->value;
+  }
+}
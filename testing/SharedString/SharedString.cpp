@@ -0,0 +1,33 @@
+//truetrue2truefalsetruetruetruefalsetrue0true0true
+#include <cstdlib>
+
+#define COLT_USE_IOSTREAMS
+#include "colt/data_structs/SharedString.h"
+
+using namespace colt;
+
+int main(int argc, char** argv)
+{
+  SharedString hello = SharedString{ "hello" };
+  SharedString shared = hello;
+  //Copies share the same characters
+  std::cout << std::boolalpha << (shared == hello) << (shared.get_data() == hello.get_data()) << hello.get_use_count();
+
+  //The cached hash is the one of the StringView of the characters
+  std::cout << (hello.get_hash() == GetHash(StringView{ "hello" }))
+    << (hello == SharedString{ "world" }) << (hello == SharedString{ "hello" }) << (hello == StringView{ "hello" });
+
+  //The characters are hashed up to the 64th: these strings have the same size and hash
+  char chars[80];
+  std::memset(chars, 'a', sizeof(chars));
+  SharedString first = SharedString{ StringView{ chars, chars + sizeof(chars) } };
+  chars[sizeof(chars) - 1] = 'b';
+  SharedString last = SharedString{ StringView{ chars, chars + sizeof(chars) } };
+  std::cout << (first.get_hash() == last.get_hash()) << (first == last);
+
+  //The empty string does not allocate, and has the hash of an empty StringView
+  SharedString empty = SharedString{ "" };
+  std::cout << (empty == SharedString{}) << empty.get_size() << (empty.get_hash() == GetHash(StringView{}))
+    << empty.get_use_count() << (empty.c_str()[0] == '\0');
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,73 @@
+//truetrue3truetrue401truetruetrue
+#include <cstdlib>
+
+#define COLT_USE_IOSTREAMS
+#include "colt/data_structs/StringBuilder.h"
+
+using namespace colt;
+
+/// @brief Check if 'str' contains the 'size' characters of 'expected'
+bool equals(const StringOf<char>& str, const char* expected, size_t size) noexcept
+{
+  return str.get_size() == size && std::memcmp(str.get_data(), expected, size) == 0;
+}
+
+int main(int argc, char** argv)
+{
+  //The expected characters, as a contiguous array
+  static char expected[4096];
+  size_t expected_size = 0;
+  char line[100];
+  for (size_t i = 0; i < sizeof(line); i++)
+    line[i] = static_cast<char>('a' + i % 26);
+
+  StringBuilder builder;
+  std::cout << std::boolalpha << builder.is_empty();
+  //Appends of 100 characters and single characters cross the ends of the chunks of 256 and 512 characters
+  for (size_t i = 0; i < 15; i++)
+  {
+    builder.append(StringView{ line, line + sizeof(line) });
+    std::memcpy(expected + expected_size, line, sizeof(line));
+    expected_size += sizeof(line);
+    builder += static_cast<char>('0' + i % 10);
+    expected[expected_size++] = static_cast<char>('0' + i % 10);
+  }
+  std::cout << equals(builder.to_string(), expected, expected_size) << builder.get_chunk_count();
+
+  //The characters of a big append that do not fit in the last chunk are copied to a single new chunk
+  static char big[2000];
+  std::memset(big, 'z', sizeof(big));
+  builder.append(StringView{ big, big + sizeof(big) });
+  std::memcpy(expected + expected_size, big, sizeof(big));
+  expected_size += sizeof(big);
+  std::cout << (builder.get_size() == expected_size) << equals(builder.to_string(), expected, expected_size)
+    << builder.get_chunk_count();
+
+  //The chunks are written in order to a file descriptor and to a FILE
+  FILE* file = std::tmpfile();
+  if (file == nullptr)
+    return EXIT_FAILURE;
+#ifdef COLT_DETAILS_STRING_BUILDER_WRITEV
+  bool written = builder.write_to(fileno(file));
+#else
+  bool written = builder.write_to(file);
+  std::fflush(file);
+#endif
+  written = builder.write_to(file) && written;
+  std::fflush(file);
+  std::rewind(file);
+  static char read_back[2 * sizeof(expected)];
+  const size_t read_size = std::fread(read_back, 1, sizeof(read_back), file);
+  std::fclose(file);
+
+  //Clearing keeps only the first chunk, which is reused
+  builder.clear();
+  std::cout << builder.get_size() << builder.get_chunk_count();
+  builder += StringView{ "hello" };
+  std::cout << equals(builder.to_string(), "hello", 5);
+
+  std::cout << (written && read_size == 2 * expected_size)
+    << (std::memcmp(read_back, expected, expected_size) == 0
+      && std::memcmp(read_back + expected_size, expected, expected_size) == 0);
+  return EXIT_SUCCESS;
+}
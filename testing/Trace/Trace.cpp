@@ -0,0 +1,74 @@
+//truetruetruetruetrue
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#define COLT_USE_IOSTREAMS
+#define COLT_ENABLE_TRACING
+#include "colt/utility/Trace.h"
+
+using namespace colt;
+
+/// @brief Returns the count of TraceBuffer ever allocated
+size_t count_trace_buffers() noexcept
+{
+  size_t count = 0;
+  for (auto buffer = colt::details::get_trace_buffers().load(); buffer != nullptr; buffer = buffer->next)
+    ++count;
+  return count;
+}
+
+int main(int argc, char** argv)
+{
+  using colt::details::TraceBuffer;
+  using colt::details::TracePhase;
+
+  //The ring keeps the newest events: writing more than its capacity overwrites the oldest.
+  //(The slot of the event after the newest is not copied, as it may be being written.)
+  for (size_t i = 0; i < TraceBuffer::CAPACITY + 10; i++)
+  {
+    COLT_TRACE_SCOPE(i % 2 == 0 ? "even" : "odd");
+  }
+  auto events = trace::details::copy_trace_events(*colt::details::get_thread_trace_buffer());
+  bool is_ordered = events.get_size() == TraceBuffer::CAPACITY - 1;
+  for (size_t i = 1; i < events.get_size(); i++)
+    is_ordered &= events[i - 1].timestamp <= events[i].timestamp && events[i - 1].phase != events[i].phase;
+  //Copying the events may record the events of the allocator after the last scope
+  size_t last = events.get_size() - 1;
+  while (last != 0 && StringView{ events[last].name } != StringView{ "odd" } && StringView{ events[last].name } != StringView{ "even" })
+    --last;
+  std::cout << std::boolalpha << is_ordered
+    << (events[last].phase == TracePhase::END && StringView{ events[last].name } == StringView{ "odd" });
+
+  //Threads started one after the other reuse the buffer released by the previous one
+  uint32_t last_thread_id = 0;
+  for (size_t i = 0; i < 20; i++)
+  {
+    std::thread([&]()
+      {
+        COLT_TRACE_SCOPE("worker");
+        last_thread_id = colt::details::get_thread_trace_buffer()->thread_id;
+      }).join();
+  }
+  std::cout << (count_trace_buffers() == 2);
+
+  //The collector writes the events of each thread under its own identifier
+  FILE* file = std::tmpfile();
+  if (file == nullptr)
+    return EXIT_FAILURE;
+  const bool is_written = trace::write_chrome_trace(file);
+  const long size = std::ftell(file);
+  char* json = static_cast<char*>(std::malloc(static_cast<size_t>(size) + 1));
+  if (json == nullptr)
+    return EXIT_FAILURE;
+  std::rewind(file);
+  json[std::fread(json, 1, static_cast<size_t>(size), file)] = '\0';
+  std::fclose(file);
+
+  char last_tid[32];
+  std::snprintf(last_tid, sizeof(last_tid), "\"tid\":%u}", last_thread_id);
+  std::cout << (is_written && StringView{ json, json + size }.begins_with(StringView{ "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[" }))
+    << (std::strstr(json, "\"tid\":1}") != nullptr && std::strstr(json, last_tid) != nullptr);
+  std::free(json);
+  return EXIT_SUCCESS;
+}